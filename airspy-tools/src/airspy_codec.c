@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2026, despairspy contributors
+ *
+ * This file is part of AirSpy (based on HackRF project).
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+/*
+ * Compresses a raw capture losslessly with airspy_compress_capture(), or
+ * expands one with airspy_expand_capture(), and reports the ratio and the
+ * throughput. -C checks that an expanded file matches the original.
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define COMPARE_BLOCK (1 << 16)
+
+static double now_ms(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+
+static long long file_size(const char* path)
+{
+	FILE* f;
+	long long bytes;
+
+	f = fopen(path, "rb");
+	if (f == NULL)
+		return -1;
+	fseek(f, 0, SEEK_END);
+	bytes = ftell(f);
+	fclose(f);
+	return bytes;
+}
+
+/* Returns the offset of the first differing byte, -1 if the files are identical, -2 if they can't be compared */
+static long long compare(const char* a_path, const char* b_path)
+{
+	static unsigned char a[COMPARE_BLOCK];
+	static unsigned char b[COMPARE_BLOCK];
+	FILE* a_file;
+	FILE* b_file;
+	size_t a_count;
+	size_t b_count;
+	size_t i;
+	long long offset;
+	long long result;
+
+	a_file = fopen(a_path, "rb");
+	b_file = fopen(b_path, "rb");
+	if (a_file == NULL || b_file == NULL) {
+		if (a_file != NULL)
+			fclose(a_file);
+		if (b_file != NULL)
+			fclose(b_file);
+		return -2;
+	}
+
+	result = -1;
+	offset = 0;
+	for (;;) {
+		a_count = fread(a, 1, COMPARE_BLOCK, a_file);
+		b_count = fread(b, 1, COMPARE_BLOCK, b_file);
+		for (i = 0; i < a_count && i < b_count; i++) {
+			if (a[i] != b[i])
+				break;
+		}
+		if (i < a_count || i < b_count) {
+			result = offset + i;
+			break;
+		}
+		if (a_count == 0)
+			break;
+		offset += a_count;
+	}
+
+	fclose(a_file);
+	fclose(b_file);
+
+	return result;
+}
+
+static void usage(void)
+{
+	printf("airspy_codec: lossless compression of raw captures\n");
+	printf("Usage:\n");
+	printf("\t-i <filename>: Raw capture, or a compressed one with -x\n");
+	printf("\t-o <filename>: Output (use a .sigmf-data extension to get metadata alongside)\n");
+	printf("\t[-x]: Expand instead of compress\n");
+	printf("\t[-p packing]: 1=Input is 12-bit packed, default 0 (overridden by SigMF metadata)\n");
+	printf("\t[-C filename]: Compare the expanded output with the original capture\n");
+}
+
+int main(int argc, char** argv)
+{
+	int opt;
+	int result;
+	int expand;
+	uint8_t packed;
+	double t0;
+	double elapsed;
+	long long in_bytes;
+	long long out_bytes;
+	long long raw_bytes;
+	long long diff;
+	const char* input_path;
+	const char* output_path;
+	const char* compare_path;
+
+	input_path = NULL;
+	output_path = NULL;
+	compare_path = NULL;
+	expand = 0;
+	packed = 0;
+
+	while ((opt = getopt(argc, argv, "i:o:xp:C:h")) != EOF) {
+		switch (opt) {
+		case 'i':
+			input_path = optarg;
+			break;
+
+		case 'o':
+			output_path = optarg;
+			break;
+
+		case 'x':
+			expand = 1;
+			break;
+
+		case 'p':
+			packed = (uint8_t)atoi(optarg);
+			break;
+
+		case 'C':
+			compare_path = optarg;
+			break;
+
+		default:
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (input_path == NULL || output_path == NULL) {
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	t0 = now_ms();
+	if (expand)
+		result = airspy_expand_capture(input_path, output_path);
+	else
+		result = airspy_compress_capture(input_path, output_path, packed);
+	elapsed = now_ms() - t0;
+	if (result != AIRSPY_SUCCESS) {
+		printf("%s failed: %s (%d)\n", expand ? "airspy_expand_capture()" : "airspy_compress_capture()",
+			airspy_error_name(result), result);
+		return EXIT_FAILURE;
+	}
+
+	in_bytes = file_size(input_path);
+	out_bytes = file_size(output_path);
+	raw_bytes = expand ? out_bytes : in_bytes;
+
+	/* Throughput on the uncompressed side, 2 bytes per real sample unpacked and 1.5 packed */
+	printf("%lld -> %lld bytes (%.1f%%) in %.1f ms, %.1f MB/s uncompressed\n", in_bytes, out_bytes,
+		in_bytes > 0 ? 100.0 * out_bytes / in_bytes : 0.0, elapsed,
+		elapsed > 0 ? raw_bytes / (elapsed * 1000.0) : 0.0);
+
+	if (compare_path != NULL) {
+		diff = compare(output_path, compare_path);
+		if (diff == -2) {
+			printf("Can't compare with %s\n", compare_path);
+			return EXIT_FAILURE;
+		}
+		if (diff >= 0) {
+			printf("Differs from %s at byte %lld\n", compare_path, diff);
+			return EXIT_FAILURE;
+		}
+		printf("Identical to %s\n", compare_path);
+	}
+
+	return EXIT_SUCCESS;
+}
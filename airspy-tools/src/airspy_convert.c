@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2026, despairspy contributors
+ *
+ * This file is part of AirSpy (based on HackRF project).
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Converts a raw capture to IQ offline with airspy_convert_file(), and
+ * optionally compares the result with another conversion, e.g. a serial
+ * one made with -t 1.
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define COMPARE_BLOCK (1 << 16)
+
+static double now_ms(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+
+/* Returns the number of differing int16 values, or -1 if the files can't be compared */
+static long long compare(const char* a_path, const char* b_path, int* max_diff, long long* first_diff)
+{
+	static int16_t a[COMPARE_BLOCK];
+	static int16_t b[COMPARE_BLOCK];
+	FILE* a_file;
+	FILE* b_file;
+	size_t a_count;
+	size_t b_count;
+	size_t i;
+	long long offset;
+	long long diffs;
+	int diff;
+
+	a_file = fopen(a_path, "rb");
+	b_file = fopen(b_path, "rb");
+	if (a_file == NULL || b_file == NULL) {
+		if (a_file != NULL)
+			fclose(a_file);
+		if (b_file != NULL)
+			fclose(b_file);
+		return -1;
+	}
+
+	*max_diff = 0;
+	*first_diff = -1;
+	diffs = 0;
+	offset = 0;
+
+	for (;;) {
+		a_count = fread(a, sizeof(int16_t), COMPARE_BLOCK, a_file);
+		b_count = fread(b, sizeof(int16_t), COMPARE_BLOCK, b_file);
+		if (a_count != b_count) {
+			diffs = -1;
+			break;
+		}
+		if (a_count == 0)
+			break;
+
+		for (i = 0; i < a_count; i++) {
+			diff = abs(a[i] - b[i]);
+			if (diff != 0) {
+				if (*first_diff < 0)
+					*first_diff = offset + i;
+				diffs++;
+			}
+			if (diff > *max_diff)
+				*max_diff = diff;
+		}
+		offset += a_count;
+	}
+
+	fclose(a_file);
+	fclose(b_file);
+
+	return diffs;
+}
+
+static void usage(void)
+{
+	printf("airspy_convert: convert a raw capture to int16 IQ on all cores\n");
+	printf("Usage:\n");
+	printf("\t-i <filename>: Raw capture, e.g. recorded with airspy_rx -R\n");
+	printf("\t-o <filename>: IQ output (use a .sigmf-data extension to get metadata alongside)\n");
+	printf("\t[-t threads]: Worker threads, default one per CPU; 1 converts serially\n");
+	printf("\t[-c chunk_samples]: Real samples per chunk, default 4194304\n");
+	printf("\t[-P prime_samples]: Samples run through each chunk's converter beforehand, default 4096\n");
+	printf("\t[-p packing]: 1=Input is 12-bit packed, default 0 (overridden by SigMF metadata)\n");
+	printf("\t[-C filename]: Compare the output with another conversion of the same input\n");
+}
+
+int main(int argc, char** argv)
+{
+	int opt;
+	int result;
+	int max_diff;
+	long long diffs;
+	long long first_diff;
+	double t0;
+	double elapsed;
+	const char* input_path;
+	const char* output_path;
+	const char* compare_path;
+	airspy_convert_params_t params;
+	FILE* f;
+	long long bytes;
+
+	memset(&params, 0, sizeof(params));
+	input_path = NULL;
+	output_path = NULL;
+	compare_path = NULL;
+
+	while ((opt = getopt(argc, argv, "i:o:t:c:P:p:C:h")) != EOF) {
+		switch (opt) {
+		case 'i':
+			input_path = optarg;
+			break;
+
+		case 'o':
+			output_path = optarg;
+			break;
+
+		case 't':
+			params.threads = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'c':
+			params.chunk_samples = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'P':
+			params.prime_samples = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'p':
+			params.packed = (uint8_t)atoi(optarg);
+			break;
+
+		case 'C':
+			compare_path = optarg;
+			break;
+
+		default:
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (input_path == NULL || output_path == NULL) {
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	t0 = now_ms();
+	result = airspy_convert_file(input_path, output_path, &params);
+	elapsed = now_ms() - t0;
+	if (result != AIRSPY_SUCCESS) {
+		printf("airspy_convert_file() failed: %s (%d)\n", airspy_error_name(result), result);
+		return EXIT_FAILURE;
+	}
+
+	bytes = 0;
+	f = fopen(output_path, "rb");
+	if (f != NULL) {
+		fseek(f, 0, SEEK_END);
+		bytes = ftell(f);
+		fclose(f);
+	}
+
+	/* Four bytes per IQ sample out, two real samples in */
+	printf("%lld IQ samples in %.1f ms, %.2f MS/s real\n", bytes / 4, elapsed,
+		elapsed > 0 ? bytes / 2 / (elapsed * 1000.0) : 0.0);
+
+	if (compare_path != NULL) {
+		diffs = compare(output_path, compare_path, &max_diff, &first_diff);
+		if (diffs < 0) {
+			printf("Can't compare with %s (missing or different length)\n", compare_path);
+			return EXIT_FAILURE;
+		}
+		if (diffs == 0)
+			printf("Identical to %s\n", compare_path);
+		else
+			printf("%lld value(s) differ from %s, by up to %d LSB, the first at %lld\n",
+				diffs, compare_path, max_diff, first_diff);
+	}
+
+	return EXIT_SUCCESS;
+}
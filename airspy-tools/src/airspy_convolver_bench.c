@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2026, despairspy contributors
+ *
+ * This file is part of AirSpy (based on HackRF project).
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Throughput of the convolver against tap count, in the direct form,
+ * through overlap-save FFTs and as the convolver picks for itself, to
+ * show where one overtakes the other for a given block size.
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define MAX_LENGTHS (16)
+#define DEFAULT_LENGTHS "8,16,32,64,96,128,192,256,512,1024,4096"
+#define DEFAULT_BLOCK (65536)
+#define DEFAULT_SECONDS (1)
+#define MAX_TAPS (32768)
+
+static double now_ms(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+
+static void fill_random(float* data, size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++)
+		data[i] = (float)rand() / RAND_MAX - 0.5f;
+}
+
+/* Samples per second filtered, 0 on failure */
+static double run(const float* taps, uint32_t tap_count, uint32_t flags, const float* samples, float* output, int block,
+	int seconds)
+{
+	struct airspy_convolver* convolver;
+	uint64_t total = 0;
+	double t0;
+	double elapsed;
+
+	if (airspy_convolver_create(&convolver, taps, tap_count, flags) != AIRSPY_SUCCESS)
+		return 0.0;
+
+	t0 = now_ms();
+	do {
+		if (airspy_convolver_process(convolver, samples, (uint32_t)block, output) != AIRSPY_SUCCESS) {
+			airspy_convolver_free(convolver);
+			return 0.0;
+		}
+		total += block;
+		elapsed = now_ms() - t0;
+	} while (elapsed < seconds * 1000.0);
+
+	airspy_convolver_free(convolver);
+
+	return total / (elapsed / 1000.0);
+}
+
+static void usage(void)
+{
+	printf("airspy_convolver_bench: FIR throughput, direct form against overlap-save FFT\n");
+	printf("Usage:\n");
+	printf("\t[-l lengths]: Comma separated tap counts, default %s\n", DEFAULT_LENGTHS);
+	printf("\t[-b block]: IQ samples per block, default %d\n", DEFAULT_BLOCK);
+	printf("\t[-c]: Complex taps\n");
+	printf("\t[-t seconds]: Duration of each run, default %d\n", DEFAULT_SECONDS);
+}
+
+int main(int argc, char** argv)
+{
+	int opt;
+	int i;
+	int seconds;
+	int block;
+	int length_count;
+	uint32_t flags;
+	uint32_t lengths[MAX_LENGTHS];
+	uint32_t crossover;
+	double direct;
+	double fft;
+	double automatic;
+	char* length_list;
+	char* token;
+	float* samples;
+	float* output;
+	float* taps;
+
+	seconds = DEFAULT_SECONDS;
+	block = DEFAULT_BLOCK;
+	flags = 0;
+	length_list = NULL;
+
+	while ((opt = getopt(argc, argv, "l:b:ct:h")) != EOF) {
+		switch (opt) {
+		case 'l':
+			length_list = optarg;
+			break;
+
+		case 'b':
+			block = atoi(optarg);
+			break;
+
+		case 'c':
+			flags |= AIRSPY_CONVOLVER_COMPLEX;
+			break;
+
+		case 't':
+			seconds = atoi(optarg);
+			break;
+
+		default:
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (seconds < 1 || block < 1) {
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	length_count = 0;
+	length_list = strdup(length_list != NULL ? length_list : DEFAULT_LENGTHS);
+	for (token = strtok(length_list, ","); token != NULL && length_count < MAX_LENGTHS; token = strtok(NULL, ",")) {
+		lengths[length_count] = (uint32_t)strtoul(token, NULL, 0);
+		if (lengths[length_count] > 0 && lengths[length_count] <= MAX_TAPS)
+			length_count++;
+	}
+	free(length_list);
+
+	samples = (float*)malloc((size_t)block * 2 * sizeof(float));
+	output = (float*)malloc((size_t)block * 2 * sizeof(float));
+	taps = (float*)malloc((size_t)MAX_TAPS * 2 * sizeof(float));
+	if (samples == NULL || output == NULL || taps == NULL) {
+		printf("Out of memory\n");
+		return EXIT_FAILURE;
+	}
+	srand(1);
+	fill_random(samples, (size_t)block * 2);
+	fill_random(taps, (size_t)MAX_TAPS * 2);
+
+	printf("%s taps, %d IQ samples per block, %d s per run\n", flags & AIRSPY_CONVOLVER_COMPLEX ? "Complex" : "Real",
+		block, seconds);
+	printf("%-8s %14s %14s %14s\n", "taps", "direct MS/s", "FFT MS/s", "picked MS/s");
+
+	crossover = 0;
+	for (i = 0; i < length_count; i++) {
+		direct = run(taps, lengths[i], flags | AIRSPY_CONVOLVER_DIRECT, samples, output, block, seconds);
+		fft = run(taps, lengths[i], flags | AIRSPY_CONVOLVER_FFT, samples, output, block, seconds);
+		automatic = run(taps, lengths[i], flags, samples, output, block, seconds);
+		printf("%-8u %14.2f %14.2f %14.2f\n", lengths[i], direct / 1e6, fft / 1e6, automatic / 1e6);
+
+		if (crossover == 0 && fft > direct)
+			crossover = lengths[i];
+	}
+
+	if (crossover > 0)
+		printf("The FFT is faster from %u taps on\n", crossover);
+	else
+		printf("The direct form was faster at every length\n");
+
+	free(taps);
+	free(output);
+	free(samples);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2026, despairspy contributors
+ *
+ * This file is part of AirSpy (based on HackRF project).
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+/*
+ * Throughput of the correlator bank against template length, in the
+ * direct form and through the FFT, to show where one overtakes the
+ * other. Templates and samples are random; nothing is reported as a hit.
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define MAX_LENGTHS (16)
+#define DEFAULT_LENGTHS "8,16,32,64,128,256,512,1024,4096"
+#define DEFAULT_TEMPLATES (1)
+#define DEFAULT_BLOCK (65536)
+#define DEFAULT_SECONDS (1)
+
+static double now_ms(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+
+static void on_hit(void* ctx, const airspy_correlation_hit_t* hit)
+{
+	(void)hit;
+	(*(uint64_t*)ctx)++;
+}
+
+static void fill_random(float* data, size_t count)
+{
+	size_t i;
+
+	for (i = 0; i < count; i++)
+		data[i] = (float)rand() / RAND_MAX - 0.5f;
+}
+
+/* Stream samples per second the bank keeps up with, 0 on failure */
+static double run(const airspy_template_t* templates, uint32_t count, uint32_t flags, const float* samples, int block,
+	int seconds)
+{
+	struct airspy_correlator* correlator;
+	airspy_transfer_t transfer;
+	uint64_t hits = 0;
+	uint64_t total = 0;
+	double t0;
+	double elapsed;
+
+	if (airspy_correlator_create(&correlator, templates, count, flags) != AIRSPY_SUCCESS)
+		return 0.0;
+
+	memset(&transfer, 0, sizeof(transfer));
+	transfer.samples = (void*)samples;
+	transfer.sample_count = block;
+
+	t0 = now_ms();
+	do {
+		if (airspy_correlator_process(correlator, &transfer, on_hit, &hits) != AIRSPY_SUCCESS) {
+			airspy_correlator_free(correlator);
+			return 0.0;
+		}
+		transfer.sample_index += block;
+		total += block;
+		elapsed = now_ms() - t0;
+	} while (elapsed < seconds * 1000.0);
+
+	airspy_correlator_free(correlator);
+
+	return total / (elapsed / 1000.0);
+}
+
+static void usage(void)
+{
+	printf("airspy_correlator_bench: correlator bank throughput, direct form against FFT\n");
+	printf("Usage:\n");
+	printf("\t[-l lengths]: Comma separated template lengths, default %s\n", DEFAULT_LENGTHS);
+	printf("\t[-n templates]: Templates in the bank, all of the same length, default %d\n", DEFAULT_TEMPLATES);
+	printf("\t[-b block]: IQ samples per block, default %d\n", DEFAULT_BLOCK);
+	printf("\t[-t seconds]: Duration of each run, default %d\n", DEFAULT_SECONDS);
+}
+
+int main(int argc, char** argv)
+{
+	int opt;
+	int i;
+	int seconds;
+	int block;
+	int length_count;
+	uint32_t n;
+	uint32_t template_count;
+	uint32_t lengths[MAX_LENGTHS];
+	uint32_t crossover;
+	double direct;
+	double fft;
+	char* length_list;
+	char* token;
+	float* samples;
+	float* taps;
+	airspy_template_t* templates;
+
+	seconds = DEFAULT_SECONDS;
+	block = DEFAULT_BLOCK;
+	template_count = DEFAULT_TEMPLATES;
+	length_list = NULL;
+
+	while ((opt = getopt(argc, argv, "l:n:b:t:h")) != EOF) {
+		switch (opt) {
+		case 'l':
+			length_list = optarg;
+			break;
+
+		case 'n':
+			template_count = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'b':
+			block = atoi(optarg);
+			break;
+
+		case 't':
+			seconds = atoi(optarg);
+			break;
+
+		default:
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (seconds < 1 || block < 1 || template_count < 1 || template_count > 64) {
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	length_count = 0;
+	length_list = strdup(length_list != NULL ? length_list : DEFAULT_LENGTHS);
+	for (token = strtok(length_list, ","); token != NULL && length_count < MAX_LENGTHS; token = strtok(NULL, ",")) {
+		lengths[length_count] = (uint32_t)strtoul(token, NULL, 0);
+		if (lengths[length_count] > 0 && lengths[length_count] <= 16384)
+			length_count++;
+	}
+	free(length_list);
+
+	samples = (float*)malloc((size_t)block * 2 * sizeof(float));
+	taps = (float*)malloc((size_t)template_count * 16384 * 2 * sizeof(float));
+	templates = (airspy_template_t*)calloc(template_count, sizeof(airspy_template_t));
+	if (samples == NULL || taps == NULL || templates == NULL) {
+		printf("Out of memory\n");
+		return EXIT_FAILURE;
+	}
+	srand(1);
+	fill_random(samples, (size_t)block * 2);
+	fill_random(taps, (size_t)template_count * 16384 * 2);
+
+	printf("%u template(s) per bank, %d IQ samples per block, %d s per run\n", template_count, block, seconds);
+	printf("%-8s %14s %14s %16s %16s\n", "length", "direct MS/s", "FFT MS/s", "direct MS/s x n", "FFT MS/s x n");
+
+	crossover = 0;
+	for (i = 0; i < length_count; i++) {
+		for (n = 0; n < template_count; n++) {
+			templates[n].samples = taps + (size_t)n * 16384 * 2;
+			templates[n].length = lengths[i];
+			templates[n].threshold = 2.0f;
+		}
+
+		direct = run(templates, template_count, AIRSPY_CORRELATOR_DIRECT, samples, block, seconds);
+		fft = run(templates, template_count, AIRSPY_CORRELATOR_FFT, samples, block, seconds);
+		printf("%-8u %14.2f %14.2f %16.2f %16.2f\n", lengths[i], direct / 1e6, fft / 1e6,
+			direct * template_count / 1e6, fft * template_count / 1e6);
+
+		if (crossover == 0 && fft > direct)
+			crossover = lengths[i];
+	}
+
+	if (crossover > 0)
+		printf("The FFT is faster from %u taps on\n", crossover);
+	else
+		printf("The direct form was faster at every length\n");
+
+	free(templates);
+	free(taps);
+	free(samples);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2026, despairspy contributors
+ *
+ * This file is part of AirSpy (based on HackRF project).
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+/*
+ * Looks up a recording's sidecar index: lists where the stream was retuned,
+ * changed gain or lost samples, and finds the block holding a given time or
+ * sample without reading the capture.
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+
+/* Days since 1970-01-01 of a proleptic Gregorian date, so that UTC times don't depend on the local time zone */
+static long long days_from_civil(int y, int m, int d)
+{
+	long long era;
+	int yoe;
+	int doy;
+	int doe;
+
+	y -= m <= 2;
+	era = (y >= 0 ? y : y - 399) / 400;
+	yoe = y - (int)(era * 400);
+	doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+	doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + doe - 719468;
+}
+
+/* Seconds since the epoch, or an ISO 8601 UTC time like 2026-10-18T14:03:22.5 */
+static int parse_time(const char* text, int64_t* time_ns)
+{
+	int y, mo, d, h, mi;
+	double sec;
+	char* end;
+
+	if (sscanf(text, "%d-%d-%dT%d:%d:%lf", &y, &mo, &d, &h, &mi, &sec) == 6) {
+		*time_ns = ((days_from_civil(y, mo, d) * 86400 + h * 3600 + mi * 60) * 1000000000LL) +
+			(int64_t)(sec * 1e9 + 0.5);
+		return 0;
+	}
+
+	sec = strtod(text, &end);
+	if (end == text)
+		return -1;
+	*time_ns = (int64_t)(sec * 1e9 + 0.5);
+	return 0;
+}
+
+static void format_time(int64_t time_ns, char* text, size_t size)
+{
+	time_t seconds = (time_t)(time_ns / 1000000000);
+	struct tm tm_utc;
+	size_t len;
+
+#ifdef _WIN32
+	gmtime_s(&tm_utc, &seconds);
+#else
+	gmtime_r(&seconds, &tm_utc);
+#endif
+	len = strftime(text, size, "%Y-%m-%dT%H:%M:%S", &tm_utc);
+	snprintf(text + len, size - len, ".%06dZ", (int)(time_ns % 1000000000 / 1000));
+}
+
+static void print_entry(uint64_t n, const airspy_index_entry_t* e)
+{
+	char when[48];
+
+	format_time(e->time_ns, when, sizeof(when));
+	printf("#%llu %s sample %llu (+%u) at byte %llu, stream index %llu, %.6f MHz, gains %u/%u/%u%s%s%s%s%s\n",
+		(unsigned long long)n, when, (unsigned long long)e->sample_start, e->sample_count,
+		(unsigned long long)e->byte_offset, (unsigned long long)e->sample_index, e->freq_hz / 1e6,
+		e->lna_gain, e->mixer_gain, e->vga_gain,
+		(e->agc & AIRSPY_INDEX_LNA_AGC) ? " lna-agc" : "",
+		(e->agc & AIRSPY_INDEX_MIXER_AGC) ? " mixer-agc" : "",
+		(e->flags & AIRSPY_INDEX_DISCONTINUITY) ? " discontinuity" : "",
+		(e->flags & AIRSPY_INDEX_RETUNED) ? " retuned" : "",
+		(e->flags & AIRSPY_INDEX_GAIN_CHANGED) ? " gain-changed" : "");
+}
+
+static void usage(void)
+{
+	printf("airspy_index: look up a recording's sidecar index\n");
+	printf("Usage:\n");
+	printf("\t-r <filename>: Sample file of the recording (the .sigmf-index is found next to it)\n");
+	printf("\t[-t time]: Find the block at a UTC time, 2026-10-18T14:03:22.5, or in seconds since the epoch\n");
+	printf("\t[-s sample]: Find the block holding a sample of the file\n");
+	printf("\t[-e]: List the blocks that start after a retune, a gain change or a gap\n");
+	printf("Gains are LNA/mixer/VGA, 255 if never set\n");
+}
+
+int main(int argc, char** argv)
+{
+	int opt;
+	int result;
+	int events;
+	int have_time;
+	int have_sample;
+	int64_t time_ns;
+	uint64_t sample;
+	uint64_t count;
+	uint64_t n;
+	const char* path;
+	struct airspy_capture_index* index;
+	airspy_index_entry_t first;
+	airspy_index_entry_t last;
+	airspy_index_entry_t entry;
+
+	path = NULL;
+	events = 0;
+	have_time = 0;
+	have_sample = 0;
+	time_ns = 0;
+	sample = 0;
+
+	while ((opt = getopt(argc, argv, "r:t:s:eh")) != EOF) {
+		switch (opt) {
+		case 'r':
+			path = optarg;
+			break;
+
+		case 't':
+			if (parse_time(optarg, &time_ns) != 0) {
+				usage();
+				return EXIT_FAILURE;
+			}
+			have_time = 1;
+			break;
+
+		case 's':
+			sample = strtoull(optarg, NULL, 0);
+			have_sample = 1;
+			break;
+
+		case 'e':
+			events = 1;
+			break;
+
+		default:
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (path == NULL) {
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	result = airspy_index_open(&index, path);
+	if (result != AIRSPY_SUCCESS) {
+		printf("airspy_index_open() failed: %s (%d)\n", airspy_error_name(result), result);
+		return EXIT_FAILURE;
+	}
+
+	airspy_index_get_count(index, &count);
+	if (count == 0) {
+		printf("No blocks in the index\n");
+		airspy_index_close(index);
+		return EXIT_SUCCESS;
+	}
+
+	airspy_index_get(index, 0, &first);
+	airspy_index_get(index, count - 1, &last);
+	printf("%llu blocks, %llu samples over %.3f s\n", (unsigned long long)count,
+		(unsigned long long)(last.sample_start + last.sample_count), (last.time_ns - first.time_ns) / 1e9);
+
+	if (events) {
+		for (n = 0; n < count; n++) {
+			airspy_index_get(index, n, &entry);
+			if (entry.flags != 0)
+				print_entry(n, &entry);
+		}
+	}
+
+	if (have_time) {
+		airspy_index_find_time(index, time_ns, &n);
+		airspy_index_get(index, n, &entry);
+		print_entry(n, &entry);
+	}
+
+	if (have_sample) {
+		airspy_index_find_sample(index, sample, &n);
+		airspy_index_get(index, n, &entry);
+		print_entry(n, &entry);
+	}
+
+	airspy_index_close(index);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2026, despairspy contributors
+ *
+ * This file is part of AirSpy (based on HackRF project).
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Measures how long it takes to enumerate and open devices, one at a time
+ * and all at once with airspy_open_devices().
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define MAX_DEVICES (32)
+#define DEFAULT_ITERATIONS (10)
+
+typedef struct {
+	double min;
+	double max;
+	double total;
+	int count;
+} latency_t;
+
+static double now_ms(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+
+static void latency_add(latency_t* latency, double value)
+{
+	if (latency->count == 0 || value < latency->min)
+		latency->min = value;
+	if (latency->count == 0 || value > latency->max)
+		latency->max = value;
+	latency->total += value;
+	latency->count++;
+}
+
+static void latency_print(const char* name, const latency_t* latency)
+{
+	if (latency->count == 0) {
+		printf("%-28s no successful samples\n", name);
+		return;
+	}
+	printf("%-28s min %8.2f ms  avg %8.2f ms  max %8.2f ms  (%d samples)\n",
+		name, latency->min, latency->total / latency->count, latency->max, latency->count);
+}
+
+static void usage(void)
+{
+	printf("airspy_open_bench: measure device enumeration and open latency\n");
+	printf("Usage:\n");
+	printf("\t[-s serial_number_64bits]: Open device with specified 64bits serial number, may be repeated (default: all attached devices)\n");
+	printf("\t[-n iterations]: Number of open/close cycles, default %d\n", DEFAULT_ITERATIONS);
+	printf("\t[-r]: Also time airspy_init_rx() after each open, which now carries the deferred setup\n");
+}
+
+int main(int argc, char** argv)
+{
+	int opt;
+	int i;
+	int it;
+	int result;
+	int device_count;
+	int iterations;
+	int with_rx;
+	double t0;
+	uint64_t serials[MAX_DEVICES];
+	int results[MAX_DEVICES];
+	struct airspy_device* devices[MAX_DEVICES];
+	latency_t list_latency;
+	latency_t open_latency;
+	latency_t rx_latency;
+	latency_t parallel_latency;
+
+	device_count = 0;
+	iterations = DEFAULT_ITERATIONS;
+	with_rx = 0;
+
+	while ((opt = getopt(argc, argv, "s:n:rh")) != EOF) {
+		switch (opt) {
+		case 's':
+			if (device_count == MAX_DEVICES) {
+				printf("Too many serial numbers, at most %d\n", MAX_DEVICES);
+				return EXIT_FAILURE;
+			}
+			serials[device_count++] = strtoull(optarg, NULL, 0);
+			break;
+
+		case 'n':
+			iterations = atoi(optarg);
+			break;
+
+		case 'r':
+			with_rx = 1;
+			break;
+
+		default:
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (iterations < 1) {
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	memset(&list_latency, 0, sizeof(list_latency));
+	memset(&open_latency, 0, sizeof(open_latency));
+	memset(&rx_latency, 0, sizeof(rx_latency));
+	memset(&parallel_latency, 0, sizeof(parallel_latency));
+
+	/* The first enumeration has to read every serial descriptor, the following ones hit the cache */
+	t0 = now_ms();
+	result = airspy_list_devices(device_count == 0 ? serials : NULL, device_count == 0 ? MAX_DEVICES : 0);
+	printf("%-28s %8.2f ms\n", "airspy_list_devices (cold)", now_ms() - t0);
+	if (result < 0) {
+		printf("airspy_list_devices() failed: %s (%d)\n", airspy_error_name(result), result);
+		return EXIT_FAILURE;
+	}
+	if (device_count == 0) {
+		device_count = result;
+	}
+	if (device_count == 0) {
+		printf("No devices found\n");
+		return EXIT_FAILURE;
+	}
+
+	for (it = 0; it < iterations; it++) {
+		t0 = now_ms();
+		airspy_list_devices(NULL, 0);
+		latency_add(&list_latency, now_ms() - t0);
+	}
+
+	for (it = 0; it < iterations; it++) {
+		for (i = 0; i < device_count; i++) {
+			t0 = now_ms();
+			result = airspy_open_sn(&devices[i], serials[i]);
+			if (result != AIRSPY_SUCCESS) {
+				printf("airspy_open_sn(0x%016llX) failed: %s (%d)\n",
+					(unsigned long long)serials[i], airspy_error_name(result), result);
+				continue;
+			}
+			latency_add(&open_latency, now_ms() - t0);
+
+			if (with_rx) {
+				t0 = now_ms();
+				if (airspy_init_rx(devices[i]) == AIRSPY_SUCCESS) {
+					latency_add(&rx_latency, now_ms() - t0);
+				}
+			}
+
+			airspy_close(devices[i]);
+		}
+	}
+
+	for (it = 0; it < iterations; it++) {
+		t0 = now_ms();
+		result = airspy_open_devices(devices, serials, device_count, results);
+		if (result == AIRSPY_SUCCESS) {
+			latency_add(&parallel_latency, now_ms() - t0);
+		} else {
+			printf("airspy_open_devices() failed: %s (%d)\n", airspy_error_name(result), result);
+		}
+
+		for (i = 0; i < device_count; i++) {
+			if (results[i] == AIRSPY_SUCCESS) {
+				airspy_close(devices[i]);
+			}
+		}
+	}
+
+	printf("%d device(s), %d iteration(s)\n", device_count, iterations);
+	latency_print("airspy_list_devices (cached)", &list_latency);
+	latency_print("airspy_open_sn", &open_latency);
+	if (with_rx) {
+		latency_print("airspy_init_rx", &rx_latency);
+	}
+	latency_print("airspy_open_devices", &parallel_latency);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2026, despairspy contributors
+ *
+ * This file is part of AirSpy (based on HackRF project).
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Duty-cycles a stream the way a scanning monitor would, listening for a
+ * while and idling in between, and compares the first-sample latency of
+ * airspy_resume_rx() with a full airspy_term_rx()/airspy_init_rx() restart.
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#define DEFAULT_CYCLES (20)
+#define DEFAULT_LISTEN_MS (200)
+#define DEFAULT_IDLE_MS (2000)
+#define DEFAULT_FREQ_HZ (100000000)
+#define FIRST_BLOCK_TIMEOUT_MS (5000)
+
+typedef struct {
+	double min;
+	double max;
+	double total;
+	int count;
+} latency_t;
+
+typedef struct {
+	struct airspy_device* device;
+	volatile double first_block_ms;
+	volatile int waiting;
+	pthread_t thread;
+} bench_t;
+
+static double now_ms(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+
+static void sleep_ms(int ms)
+{
+#ifdef _WIN32
+	Sleep(ms);
+#else
+	usleep(ms * 1000);
+#endif
+}
+
+static void latency_add(latency_t* latency, double value)
+{
+	if (latency->count == 0 || value < latency->min)
+		latency->min = value;
+	if (latency->count == 0 || value > latency->max)
+		latency->max = value;
+	latency->total += value;
+	latency->count++;
+}
+
+static void latency_print(const char* name, const latency_t* latency)
+{
+	if (latency->count == 0) {
+		printf("%-24s no successful samples\n", name);
+		return;
+	}
+	printf("%-24s min %8.2f ms  avg %8.2f ms  max %8.2f ms  (%d samples)\n",
+		name, latency->min, latency->total / latency->count, latency->max, latency->count);
+}
+
+static int rx_callback(struct airspy_device* device, void* ctx, airspy_transfer_t* transfer)
+{
+	bench_t* bench = (bench_t*)ctx;
+
+	(void)device;
+	(void)transfer;
+
+	if (bench->waiting) {
+		bench->first_block_ms = now_ms();
+		bench->waiting = 0;
+	}
+	return 0;
+}
+
+static void* rx_thread(void* arg)
+{
+	bench_t* bench = (bench_t*)arg;
+
+	airspy_do_rx(bench->device, rx_callback, bench);
+	return NULL;
+}
+
+static int start_rx(bench_t* bench)
+{
+	int result;
+
+	result = airspy_init_rx(bench->device);
+	if (result != AIRSPY_SUCCESS)
+		return result;
+
+	if (pthread_create(&bench->thread, NULL, rx_thread, bench) != 0) {
+		airspy_term_rx(bench->device);
+		return AIRSPY_ERROR_THREAD;
+	}
+	return AIRSPY_SUCCESS;
+}
+
+static void stop_rx(bench_t* bench)
+{
+	airspy_term_rx(bench->device);
+	pthread_join(bench->thread, NULL);
+}
+
+/* Returns the time from t0 to the first delivered block, or a negative value on timeout */
+static double wait_first_block(bench_t* bench, double t0)
+{
+	while (bench->waiting) {
+		if (now_ms() - t0 > FIRST_BLOCK_TIMEOUT_MS)
+			return -1.0;
+		sleep_ms(1);
+	}
+	return bench->first_block_ms - t0;
+}
+
+static void usage(void)
+{
+	printf("airspy_pause_bench: compare pause/resume with a full stream restart\n");
+	printf("Usage:\n");
+	printf("\t[-s serial_number_64bits]: Open device with specified 64bits serial number\n");
+	printf("\t[-f frequency_Hz]: Tune to frequency, default %d\n", DEFAULT_FREQ_HZ);
+	printf("\t[-a samplerate]: Samplerate index or value in Hz, default is the device default\n");
+	printf("\t[-n cycles]: Number of listen/idle cycles for each method, default %d\n", DEFAULT_CYCLES);
+	printf("\t[-l listen_ms]: Listen time per cycle, default %d\n", DEFAULT_LISTEN_MS);
+	printf("\t[-i idle_ms]: Idle time per cycle, default %d\n", DEFAULT_IDLE_MS);
+}
+
+int main(int argc, char** argv)
+{
+	int opt;
+	int it;
+	int result;
+	int cycles;
+	int listen_ms;
+	int idle_ms;
+	int samplerate_set;
+	uint32_t samplerate;
+	uint32_t freq_hz;
+	uint64_t serial_number;
+	double t0;
+	double latency;
+	bench_t bench;
+	airspy_stream_stats_t stats;
+	latency_t pause_latency;
+	latency_t resume_latency;
+	latency_t resume_reported;
+	latency_t restart_latency;
+
+	serial_number = 0;
+	freq_hz = DEFAULT_FREQ_HZ;
+	samplerate = 0;
+	samplerate_set = 0;
+	cycles = DEFAULT_CYCLES;
+	listen_ms = DEFAULT_LISTEN_MS;
+	idle_ms = DEFAULT_IDLE_MS;
+
+	while ((opt = getopt(argc, argv, "s:f:a:n:l:i:h")) != EOF) {
+		switch (opt) {
+		case 's':
+			serial_number = strtoull(optarg, NULL, 0);
+			break;
+
+		case 'f':
+			freq_hz = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'a':
+			samplerate = (uint32_t)strtoul(optarg, NULL, 0);
+			samplerate_set = 1;
+			break;
+
+		case 'n':
+			cycles = atoi(optarg);
+			break;
+
+		case 'l':
+			listen_ms = atoi(optarg);
+			break;
+
+		case 'i':
+			idle_ms = atoi(optarg);
+			break;
+
+		default:
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (cycles < 1 || listen_ms < 0 || idle_ms < 0) {
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	memset(&bench, 0, sizeof(bench));
+	memset(&pause_latency, 0, sizeof(pause_latency));
+	memset(&resume_latency, 0, sizeof(resume_latency));
+	memset(&resume_reported, 0, sizeof(resume_reported));
+	memset(&restart_latency, 0, sizeof(restart_latency));
+
+	result = airspy_open_sn(&bench.device, serial_number);
+	if (result != AIRSPY_SUCCESS) {
+		printf("airspy_open_sn() failed: %s (%d)\n", airspy_error_name(result), result);
+		return EXIT_FAILURE;
+	}
+
+	if (samplerate_set) {
+		result = airspy_set_samplerate(bench.device, samplerate);
+		if (result != AIRSPY_SUCCESS) {
+			printf("airspy_set_samplerate() failed: %s (%d)\n", airspy_error_name(result), result);
+			airspy_close(bench.device);
+			return EXIT_FAILURE;
+		}
+	}
+
+	result = airspy_set_freq(bench.device, freq_hz);
+	if (result != AIRSPY_SUCCESS) {
+		printf("airspy_set_freq() failed: %s (%d)\n", airspy_error_name(result), result);
+		airspy_close(bench.device);
+		return EXIT_FAILURE;
+	}
+
+	/* Full restart: every cycle tears the stream down and brings it back up */
+	for (it = 0; it < cycles; it++) {
+		bench.waiting = 1;
+		t0 = now_ms();
+		result = start_rx(&bench);
+		if (result != AIRSPY_SUCCESS) {
+			printf("airspy_init_rx() failed: %s (%d)\n", airspy_error_name(result), result);
+			break;
+		}
+		latency = wait_first_block(&bench, t0);
+		if (latency >= 0.0)
+			latency_add(&restart_latency, latency);
+
+		sleep_ms(listen_ms);
+		stop_rx(&bench);
+		sleep_ms(idle_ms);
+	}
+
+	/* Hot standby: one stream, paused while idle */
+	result = start_rx(&bench);
+	if (result != AIRSPY_SUCCESS) {
+		printf("airspy_init_rx() failed: %s (%d)\n", airspy_error_name(result), result);
+		airspy_close(bench.device);
+		return EXIT_FAILURE;
+	}
+
+	for (it = 0; it < cycles; it++) {
+		sleep_ms(listen_ms);
+		airspy_pause_rx(bench.device);
+		sleep_ms(idle_ms);
+
+		bench.waiting = 1;
+		t0 = now_ms();
+		airspy_resume_rx(bench.device);
+		latency = wait_first_block(&bench, t0);
+		if (latency >= 0.0)
+			latency_add(&resume_latency, latency);
+
+		airspy_get_stream_stats(bench.device, &stats);
+		latency_add(&pause_latency, stats.last_pause_us / 1000.0);
+		latency_add(&resume_reported, stats.last_resume_us / 1000.0);
+	}
+
+	stop_rx(&bench);
+	airspy_close(bench.device);
+
+	printf("%d cycle(s), listen %d ms, idle %d ms\n", cycles, listen_ms, idle_ms);
+	latency_print("restart first block", &restart_latency);
+	latency_print("resume first block", &resume_latency);
+	latency_print("resume (library)", &resume_reported);
+	latency_print("pause (library)", &pause_latency);
+
+	return EXIT_SUCCESS;
+}
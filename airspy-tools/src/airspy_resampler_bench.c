@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2026, despairspy contributors
+ *
+ * This file is part of AirSpy (based on HackRF project).
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Quality and throughput of the resampler for a list of ratios: fractions
+ * go through the polyphase bank, decimals through the Farrow form. A tone
+ * well inside the output band is resampled and fitted, so everything else
+ * left in the output (stopband leakage, images, phase interpolation error)
+ * counts as noise; a tone that would alias onto the output band shows how
+ * far it is pushed down.
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <getopt.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define MAX_RATIOS (16)
+#define DEFAULT_RATIOS "6/25,12/25,3/125,3/625,5/4,0.24,0.2973"
+#define DEFAULT_BLOCK (65536)
+#define DEFAULT_SECONDS (1)
+#define TONE_SAMPLES (1 << 18)
+
+typedef struct {
+	char text[32];
+	airspy_resampler_params_t params;
+	double ratio;
+} ratio_t;
+
+static double now_ms(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+
+/* A complex tone of amplitude 0.5, freq in cycles per sample */
+static void fill_tone(float* data, uint32_t count, double freq)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		data[2 * i] = (float)(0.5 * cos(2.0 * M_PI * freq * i));
+		data[2 * i + 1] = (float)(0.5 * sin(2.0 * M_PI * freq * i));
+	}
+}
+
+/* Resamples a tone in one go, skipping the first quarter of the outputs while the filter fills */
+static uint32_t resample_tone(const ratio_t* ratio, const float* input, float* output, uint32_t* skip)
+{
+	struct airspy_resampler* resampler;
+	uint32_t count = 0;
+
+	if (airspy_resampler_create(&resampler, &ratio->params) != AIRSPY_SUCCESS)
+		return 0;
+	airspy_resampler_process(resampler, input, TONE_SAMPLES, output, &count);
+	airspy_resampler_free(resampler);
+
+	*skip = count / 4;
+	return count;
+}
+
+/* Signal to everything else in dB for a tone at freq (cycles per input sample), after a least squares fit */
+static double tone_snr(const ratio_t* ratio, float* input, float* output, double freq, double* gain_db)
+{
+	uint32_t count;
+	uint32_t skip;
+	uint32_t i;
+	double step;
+	double a_re = 0.0;
+	double a_im = 0.0;
+	double e_re;
+	double e_im;
+	double d_re;
+	double d_im;
+	double residual = 0.0;
+	double n;
+
+	fill_tone(input, TONE_SAMPLES, freq);
+	count = resample_tone(ratio, input, output, &skip);
+	if (count <= skip) {
+		*gain_db = -HUGE_VAL;
+		return 0.0;
+	}
+	n = count - skip;
+	step = 2.0 * M_PI * freq / ratio->ratio;
+
+	for (i = skip; i < count; i++) {
+		e_re = cos(step * i);
+		e_im = sin(step * i);
+		a_re += output[2 * i] * e_re + output[2 * i + 1] * e_im;
+		a_im += output[2 * i + 1] * e_re - output[2 * i] * e_im;
+	}
+	a_re /= n;
+	a_im /= n;
+
+	for (i = skip; i < count; i++) {
+		e_re = cos(step * i);
+		e_im = sin(step * i);
+		d_re = output[2 * i] - (a_re * e_re - a_im * e_im);
+		d_im = output[2 * i + 1] - (a_re * e_im + a_im * e_re);
+		residual += d_re * d_re + d_im * d_im;
+	}
+
+	*gain_db = 10.0 * log10((a_re * a_re + a_im * a_im) / 0.25);
+	return 10.0 * log10((a_re * a_re + a_im * a_im) * n / (residual + 1e-30));
+}
+
+/* Output power in dB relative to the input's for a tone at freq */
+static double tone_level(const ratio_t* ratio, float* input, float* output, double freq)
+{
+	uint32_t count;
+	uint32_t skip;
+	uint32_t i;
+	double power = 0.0;
+
+	fill_tone(input, TONE_SAMPLES, freq);
+	count = resample_tone(ratio, input, output, &skip);
+	if (count <= skip)
+		return 0.0;
+
+	for (i = skip; i < count; i++)
+		power += (double)output[2 * i] * output[2 * i] + (double)output[2 * i + 1] * output[2 * i + 1];
+	return 10.0 * log10(power / (count - skip) / 0.25 + 1e-30);
+}
+
+/* Input samples per second, 0 on failure */
+static double run(const ratio_t* ratio, const float* samples, float* output, int block, int seconds)
+{
+	struct airspy_resampler* resampler;
+	uint32_t produced;
+	uint64_t total = 0;
+	double t0;
+	double elapsed;
+
+	if (airspy_resampler_create(&resampler, &ratio->params) != AIRSPY_SUCCESS)
+		return 0.0;
+
+	t0 = now_ms();
+	do {
+		airspy_resampler_process(resampler, samples, (uint32_t)block, output, &produced);
+		total += block;
+		elapsed = now_ms() - t0;
+	} while (elapsed < seconds * 1000.0);
+
+	airspy_resampler_free(resampler);
+
+	return total / (elapsed / 1000.0);
+}
+
+static int parse_ratio(const char* text, uint32_t zero_crossings, ratio_t* ratio)
+{
+	char* end;
+
+	memset(ratio, 0, sizeof(*ratio));
+	snprintf(ratio->text, sizeof(ratio->text), "%s", text);
+	ratio->params.zero_crossings = zero_crossings;
+
+	if (strchr(text, '/') != NULL) {
+		ratio->params.interpolation = (uint32_t)strtoul(text, &end, 0);
+		ratio->params.decimation = (uint32_t)strtoul(end + 1, NULL, 0);
+		if (ratio->params.interpolation == 0 || ratio->params.decimation == 0)
+			return -1;
+		ratio->ratio = (double)ratio->params.interpolation / ratio->params.decimation;
+	} else {
+		ratio->params.ratio = strtod(text, NULL);
+		if (ratio->params.ratio <= 0.0)
+			return -1;
+		ratio->ratio = ratio->params.ratio;
+	}
+	return 0;
+}
+
+static void usage(void)
+{
+	printf("airspy_resampler_bench: resampler quality and throughput\n");
+	printf("Usage:\n");
+	printf("\t[-r ratios]: Comma separated output/input ratios, L/M for the polyphase bank or a decimal for the\n");
+	printf("\t             Farrow form, default %s\n", DEFAULT_RATIOS);
+	printf("\t[-z zero_crossings]: Of the lowpass on each side, default 16\n");
+	printf("\t[-b block]: IQ samples per block, default %d\n", DEFAULT_BLOCK);
+	printf("\t[-t seconds]: Duration of each run, default %d\n", DEFAULT_SECONDS);
+}
+
+int main(int argc, char** argv)
+{
+	int opt;
+	int i;
+	int seconds;
+	int block;
+	int ratio_count;
+	uint32_t zero_crossings;
+	uint32_t capacity;
+	double narrow;
+	double rate;
+	double snr;
+	double gain;
+	double alias;
+	char* ratio_list;
+	char* token;
+	float* samples;
+	float* input;
+	float* output;
+	ratio_t ratios[MAX_RATIOS];
+
+	seconds = DEFAULT_SECONDS;
+	block = DEFAULT_BLOCK;
+	zero_crossings = 0;
+	ratio_list = NULL;
+
+	while ((opt = getopt(argc, argv, "r:z:b:t:h")) != EOF) {
+		switch (opt) {
+		case 'r':
+			ratio_list = optarg;
+			break;
+
+		case 'z':
+			zero_crossings = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'b':
+			block = atoi(optarg);
+			break;
+
+		case 't':
+			seconds = atoi(optarg);
+			break;
+
+		default:
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (seconds < 1 || block < 1) {
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	ratio_count = 0;
+	ratio_list = strdup(ratio_list != NULL ? ratio_list : DEFAULT_RATIOS);
+	for (token = strtok(ratio_list, ","); token != NULL && ratio_count < MAX_RATIOS; token = strtok(NULL, ",")) {
+		if (parse_ratio(token, zero_crossings, &ratios[ratio_count]) == 0 && ratios[ratio_count].ratio <= 16.0)
+			ratio_count++;
+	}
+	free(ratio_list);
+
+	/* Room for the largest ratio accepted above */
+	capacity = (block > TONE_SAMPLES ? block : TONE_SAMPLES) * 16 + 2;
+	samples = (float*)malloc((size_t)block * 2 * sizeof(float));
+	input = (float*)malloc((size_t)TONE_SAMPLES * 2 * sizeof(float));
+	output = (float*)malloc((size_t)capacity * 2 * sizeof(float));
+	if (samples == NULL || input == NULL || output == NULL) {
+		printf("Out of memory\n");
+		return EXIT_FAILURE;
+	}
+	srand(1);
+	for (i = 0; i < block * 2; i++)
+		samples[i] = (float)rand() / RAND_MAX - 0.5f;
+
+	printf("%d IQ samples per block, %d s per run; the tone is at a fifth of the narrower band, and when decimating\n",
+		block, seconds);
+	printf("the alias is at two thirds of the output rate, which folds onto the edge of the flat band\n");
+	printf("%-10s %8s %10s %10s %10s %8s %10s\n", "ratio", "form", "in MS/s", "out MS/s", "SNR dB", "gain dB",
+		"alias dB");
+
+	for (i = 0; i < ratio_count; i++) {
+		narrow = ratios[i].ratio < 1.0 ? ratios[i].ratio : 1.0;
+		snr = tone_snr(&ratios[i], input, output, 0.2 * narrow, &gain);
+		rate = run(&ratios[i], samples, output, block, seconds);
+		if (rate == 0.0) {
+			printf("%-10s rejected\n", ratios[i].text);
+			continue;
+		}
+
+		printf("%-10s %8s %10.2f %10.2f %10.1f %8.3f", ratios[i].text,
+			ratios[i].params.ratio > 0.0 ? "Farrow" : "bank", rate / 1e6, rate * ratios[i].ratio / 1e6, snr, gain);
+		if (ratios[i].ratio < 1.0) {
+			alias = tone_level(&ratios[i], input, output, 2.0 * ratios[i].ratio / 3.0);
+			printf(" %10.1f\n", alias);
+		} else {
+			printf(" %10s\n", "-");
+		}
+	}
+
+	free(output);
+	free(input);
+	free(samples);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2026, despairspy contributors
+ *
+ * This file is part of AirSpy (based on HackRF project).
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Records a stream to a SigMF file pair with the library's disk writer.
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <getopt.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#define DEFAULT_FREQ_HZ (900000000)
+#define MEGABYTE (1024 * 1024)
+
+typedef struct {
+	struct airspy_device* device;
+	uint64_t samples_to_xfer;
+	volatile uint64_t samples_seen;
+	int result;
+} rx_t;
+
+static volatile int do_exit = 0;
+
+static void sleep_ms(int ms)
+{
+#ifdef _WIN32
+	Sleep(ms);
+#else
+	usleep(ms * 1000);
+#endif
+}
+
+#ifdef _WIN32
+BOOL WINAPI sighandler(int signum)
+{
+	if (CTRL_C_EVENT == signum) {
+		do_exit = 1;
+		return TRUE;
+	}
+	return FALSE;
+}
+#else
+static void sighandler(int signum)
+{
+	(void)signum;
+	do_exit = 1;
+}
+#endif
+
+static int rx_callback(struct airspy_device* device, void* ctx, airspy_transfer_t* transfer)
+{
+	rx_t* rx = (rx_t*)ctx;
+
+	(void)device;
+
+	rx->samples_seen += transfer->sample_count;
+	if (rx->samples_to_xfer != 0 && rx->samples_seen >= rx->samples_to_xfer)
+		return 1;
+	return do_exit;
+}
+
+static void* rx_thread(void* arg)
+{
+	rx_t* rx = (rx_t*)arg;
+
+	rx->result = airspy_do_rx(rx->device, rx_callback, rx);
+	return NULL;
+}
+
+static void usage(void)
+{
+	printf("airspy_rx: record to disk\n");
+	printf("Usage:\n");
+	printf("\t-r <filename>: Sample file, metadata is written alongside (use a .sigmf-data extension)\n");
+	printf("\t[-s serial_number_64bits]: Open device with specified 64bits serial number\n");
+	printf("\t[-f frequency_MHz]: Tune to frequency, default %.3f\n", DEFAULT_FREQ_HZ / 1e6);
+	printf("\t[-a samplerate]: Samplerate index or value in Hz, default is the device default\n");
+	printf("\t[-p packing]: 1=Enable 12-bit packing, default 0\n");
+	printf("\t[-R]: Record raw ADC samples instead of converted IQ\n");
+	printf("\t[-Z]: Record raw ADC samples losslessly compressed (airspy_codec -x expands them)\n");
+	printf("\t[-l lna_gain] [-m mixer_gain] [-v vga_gain]: Gains 0..15\n");
+	printf("\t[-b bias_tee]: 1=Enable the bias tee, default 0\n");
+	printf("\t[-n num_samples]: Number of IQ samples to receive, default unlimited\n");
+	printf("\t[-d]: Open the file with O_DIRECT\n");
+	printf("\t[-u]: Write with pwrite() instead of io_uring\n");
+	printf("\t[-P prealloc_MB]: Reserve disk space up front, default none\n");
+	printf("\t[-B backlog_MB]: In-memory backlog, default 64\n");
+	printf("\t[-D description]: SigMF description\n");
+	printf("\t[-S bucket[:fft_size]]: Power summaries per bucket of IQ samples, per FFT bin too with fft_size\n");
+}
+
+int main(int argc, char** argv)
+{
+	int opt;
+	int result;
+	int lna_gain = -1;
+	int mixer_gain = -1;
+	int vga_gain = -1;
+	int bias_tee = 0;
+	int packing = 0;
+	int samplerate_set = 0;
+	uint32_t samplerate = 0;
+	double freq_mhz = DEFAULT_FREQ_HZ / 1e6;
+	uint64_t serial_number = 0;
+	airspy_record_params_t params;
+	airspy_record_stats_t stats;
+	airspy_stream_stats_t stream_stats;
+	uint64_t last_bytes = 0;
+	char* end;
+	pthread_t thread;
+	rx_t rx;
+
+	memset(&params, 0, sizeof(params));
+	memset(&rx, 0, sizeof(rx));
+	params.format = AIRSPY_RECORD_IQ_INT16;
+
+	while ((opt = getopt(argc, argv, "r:s:f:a:p:RZl:m:v:b:n:duP:B:D:S:h")) != EOF) {
+		switch (opt) {
+		case 'r':
+			params.path = optarg;
+			break;
+
+		case 's':
+			serial_number = strtoull(optarg, NULL, 0);
+			break;
+
+		case 'f':
+			freq_mhz = strtod(optarg, NULL);
+			break;
+
+		case 'a':
+			samplerate = (uint32_t)strtoul(optarg, NULL, 0);
+			samplerate_set = 1;
+			break;
+
+		case 'p':
+			packing = atoi(optarg);
+			break;
+
+		case 'R':
+			params.format = AIRSPY_RECORD_RAW;
+			break;
+
+		case 'Z':
+			params.format = AIRSPY_RECORD_RAW_COMPRESSED;
+			break;
+
+		case 'l':
+			lna_gain = atoi(optarg);
+			break;
+
+		case 'm':
+			mixer_gain = atoi(optarg);
+			break;
+
+		case 'v':
+			vga_gain = atoi(optarg);
+			break;
+
+		case 'b':
+			bias_tee = atoi(optarg);
+			break;
+
+		case 'n':
+			rx.samples_to_xfer = strtoull(optarg, NULL, 0);
+			break;
+
+		case 'd':
+			params.flags |= AIRSPY_RECORD_DIRECT_IO;
+			break;
+
+		case 'u':
+			params.flags |= AIRSPY_RECORD_NO_IO_URING;
+			break;
+
+		case 'P':
+			params.preallocate_bytes = strtoull(optarg, NULL, 0) * MEGABYTE;
+			break;
+
+		case 'B':
+			params.backlog_bytes = (uint32_t)strtoul(optarg, NULL, 0) * MEGABYTE;
+			break;
+
+		case 'D':
+			params.description = optarg;
+			break;
+
+		case 'S':
+			params.power_bucket = (uint32_t)strtoul(optarg, &end, 0);
+			if (*end == ':')
+				params.power_fft_size = (uint32_t)strtoul(end + 1, NULL, 0);
+			break;
+
+		default:
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (params.path == NULL) {
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	result = airspy_open_sn(&rx.device, serial_number);
+	if (result != AIRSPY_SUCCESS) {
+		printf("airspy_open_sn() failed: %s (%d)\n", airspy_error_name(result), result);
+		return EXIT_FAILURE;
+	}
+
+	if (samplerate_set)
+		result = airspy_set_samplerate(rx.device, samplerate);
+	if (result == AIRSPY_SUCCESS)
+		result = airspy_set_packing(rx.device, (uint8_t)packing);
+	if (result == AIRSPY_SUCCESS)
+		result = airspy_set_rf_bias(rx.device, (uint8_t)bias_tee);
+	if (result == AIRSPY_SUCCESS && lna_gain >= 0)
+		result = airspy_set_lna_gain(rx.device, (uint8_t)lna_gain);
+	if (result == AIRSPY_SUCCESS && mixer_gain >= 0)
+		result = airspy_set_mixer_gain(rx.device, (uint8_t)mixer_gain);
+	if (result == AIRSPY_SUCCESS && vga_gain >= 0)
+		result = airspy_set_vga_gain(rx.device, (uint8_t)vga_gain);
+	if (result == AIRSPY_SUCCESS)
+		result = airspy_set_freq(rx.device, (uint32_t)(freq_mhz * 1e6 + 0.5));
+	if (result != AIRSPY_SUCCESS) {
+		printf("Device setup failed: %s (%d)\n", airspy_error_name(result), result);
+		airspy_close(rx.device);
+		return EXIT_FAILURE;
+	}
+
+	result = airspy_start_recording(rx.device, &params);
+	if (result != AIRSPY_SUCCESS) {
+		printf("airspy_start_recording() failed: %s (%d)\n", airspy_error_name(result), result);
+		airspy_close(rx.device);
+		return EXIT_FAILURE;
+	}
+
+#ifdef _WIN32
+	SetConsoleCtrlHandler((PHANDLER_ROUTINE)sighandler, TRUE);
+#else
+	signal(SIGINT, sighandler);
+	signal(SIGTERM, sighandler);
+#endif
+
+	result = airspy_init_rx(rx.device);
+	if (result != AIRSPY_SUCCESS || pthread_create(&thread, NULL, rx_thread, &rx) != 0) {
+		printf("airspy_init_rx() failed: %s (%d)\n", airspy_error_name(result), result);
+		airspy_stop_recording(rx.device);
+		airspy_close(rx.device);
+		return EXIT_FAILURE;
+	}
+
+	airspy_get_record_stats(rx.device, &stats);
+	printf("Recording to %s (%s%s)\n", params.path, stats.io_uring ? "io_uring" : "pwrite",
+		stats.direct_io ? ", O_DIRECT" : "");
+
+	while (!do_exit && airspy_is_streaming(rx.device) == AIRSPY_TRUE) {
+		sleep_ms(1000);
+		airspy_get_record_stats(rx.device, &stats);
+		printf("%7.2f MB/s  backlog peak %6.1f MB  dropped %llu blocks\n",
+			(stats.bytes_written - last_bytes) / (double)MEGABYTE,
+			stats.backlog_high_water / (double)MEGABYTE,
+			(unsigned long long)stats.blocks_dropped);
+		last_bytes = stats.bytes_written;
+		if (rx.samples_to_xfer != 0 && rx.samples_seen >= rx.samples_to_xfer)
+			break;
+	}
+
+	airspy_term_rx(rx.device);
+	pthread_join(thread, NULL);
+
+	airspy_get_record_stats(rx.device, &stats);
+	airspy_get_stream_stats(rx.device, &stream_stats);
+	result = airspy_stop_recording(rx.device);
+
+	printf("%llu block(s) recorded, %llu block(s) dropped by the writer, %llu sample(s) lost in the stream\n",
+		(unsigned long long)stats.blocks_recorded, (unsigned long long)stats.blocks_dropped,
+		(unsigned long long)stream_stats.dropped_samples);
+	if (stats.power_blocks_dropped > 0)
+		printf("%llu block(s) left out of the power summaries\n", (unsigned long long)stats.power_blocks_dropped);
+	if (result != AIRSPY_SUCCESS)
+		printf("airspy_stop_recording() failed: %s (%d)\n", airspy_error_name(result), result);
+
+	airspy_close(rx.device);
+
+	return result == AIRSPY_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,432 @@
+/*
+ * Copyright (c) 2026, despairspy contributors
+ *
+ * This file is part of AirSpy (based on HackRF project).
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+/*
+ * Loopback throughput of the streaming server: the simulator feeds it, and
+ * clients on this host read as fast as they can, for each client count in
+ * turn. Optionally the VITA-49 stream goes to a local UDP socket as well.
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define MAX_CLIENTS (64)
+#define DEFAULT_SECONDS (3)
+#define DEFAULT_PORT (12345)
+#define DEFAULT_COUNTS "1,2,4,8"
+#define RECV_BUFFER (1 << 20)
+
+typedef struct {
+	uint16_t port;
+	uint8_t format;
+	uint32_t decimation;
+	volatile int* stop;
+	volatile uint64_t bytes;
+	int result;
+} client_t;
+
+typedef struct {
+	int fd;
+	volatile int* stop;
+	volatile uint64_t packets;
+	volatile uint64_t bytes;
+	volatile uint64_t gaps;
+} udp_sink_t;
+
+static double now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void sleep_ms(int ms)
+{
+	usleep(ms * 1000);
+}
+
+static int send_command(int fd, uint8_t command, uint32_t value)
+{
+	uint8_t buffer[5];
+
+	buffer[0] = command;
+	buffer[1] = (uint8_t)(value >> 24);
+	buffer[2] = (uint8_t)(value >> 16);
+	buffer[3] = (uint8_t)(value >> 8);
+	buffer[4] = (uint8_t)value;
+	return send(fd, buffer, sizeof(buffer), 0) == (ssize_t)sizeof(buffer) ? 0 : -1;
+}
+
+static void* client_thread(void* arg)
+{
+	client_t* client = (client_t*)arg;
+	struct sockaddr_in addr;
+	struct timeval tv;
+	uint8_t* buffer;
+	ssize_t n;
+	int fd;
+
+	client->result = -1;
+	buffer = (uint8_t*)malloc(RECV_BUFFER);
+	fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (buffer == NULL || fd < 0) {
+		free(buffer);
+		return NULL;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(client->port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	/* Wakes up now and then to notice the end of the run */
+	tv.tv_sec = 0;
+	tv.tv_usec = 100000;
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+	if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+		recv(fd, buffer, 12, MSG_WAITALL) != 12 || memcmp(buffer, "RTL0", 4) != 0 ||
+		send_command(fd, AIRSPY_SERVER_CMD_FORMAT, client->format) != 0 ||
+		send_command(fd, AIRSPY_SERVER_CMD_DECIMATION, client->decimation) != 0) {
+		close(fd);
+		free(buffer);
+		return NULL;
+	}
+
+	while (!*client->stop) {
+		n = recv(fd, buffer, RECV_BUFFER, 0);
+		if (n == 0)
+			break;
+		if (n > 0)
+			client->bytes += n;
+	}
+
+	client->result = 0;
+	close(fd);
+	free(buffer);
+	return NULL;
+}
+
+static void* udp_thread(void* arg)
+{
+	udp_sink_t* sink = (udp_sink_t*)arg;
+	uint8_t packet[2048];
+	uint32_t expected = 0;
+	uint32_t count;
+	ssize_t n;
+	int first = 1;
+
+	while (!*sink->stop) {
+		n = recv(sink->fd, packet, sizeof(packet), 0);
+		if (n < 4)
+			continue;
+
+		/* The header's 4-bit packet count shows what was lost on the way */
+		count = (packet[1] >> 0) & 0xf;
+		if (!first && count != expected)
+			sink->gaps++;
+		expected = (count + 1) & 0xf;
+		first = 0;
+
+		sink->packets++;
+		sink->bytes += n;
+	}
+
+	return NULL;
+}
+
+static int open_udp_sink(uint16_t port)
+{
+	struct sockaddr_in addr;
+	struct timeval tv;
+	int size = 4 << 20;
+	int fd;
+
+	fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0)
+		return -1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	tv.tv_sec = 0;
+	tv.tv_usec = 100000;
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+	if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+static void* rx_thread(void* arg)
+{
+	struct airspy_device* device = (struct airspy_device*)arg;
+
+	airspy_do_rx(device, NULL, NULL);
+	return NULL;
+}
+
+static size_t sample_bytes(int format)
+{
+	return format == AIRSPY_SERVER_U8 ? 2 : format == AIRSPY_SERVER_FLOAT32 ? 8 : 4;
+}
+
+static int run(const airspy_sim_params_t* sim, const airspy_server_params_t* params, int format, int clients, int seconds,
+	int udp)
+{
+	static client_t client[MAX_CLIENTS];
+	pthread_t threads[MAX_CLIENTS];
+	pthread_t rx;
+	pthread_t udp_rx;
+	struct airspy_device* device;
+	airspy_server_stats_t stats;
+	udp_sink_t sink;
+	volatile int stop = 0;
+	double t0;
+	double elapsed;
+	double total;
+	double slowest;
+	double mbps;
+	int started;
+	int result;
+	int i;
+
+	memset(&sink, 0, sizeof(sink));
+	sink.fd = -1;
+	sink.stop = &stop;
+
+	result = airspy_open_sim(&device, sim);
+	if (result != AIRSPY_SUCCESS)
+		return result;
+
+	if (udp) {
+		sink.fd = open_udp_sink(params->tcp_port + 1);
+		if (sink.fd < 0 || pthread_create(&udp_rx, NULL, udp_thread, &sink) != 0) {
+			airspy_close(device);
+			return AIRSPY_ERROR_OTHER;
+		}
+	}
+
+	result = airspy_start_server(device, params);
+	if (result == AIRSPY_SUCCESS)
+		result = airspy_init_rx(device);
+	if (result != AIRSPY_SUCCESS || pthread_create(&rx, NULL, rx_thread, device) != 0) {
+		stop = 1;
+		if (udp) {
+			pthread_join(udp_rx, NULL);
+			close(sink.fd);
+		}
+		airspy_close(device);
+		return result != AIRSPY_SUCCESS ? result : AIRSPY_ERROR_THREAD;
+	}
+
+	for (started = 0; started < clients; started++) {
+		memset(&client[started], 0, sizeof(client[started]));
+		client[started].port = params->tcp_port;
+		client[started].format = (uint8_t)format;
+		client[started].decimation = params->udp_decimation;
+		client[started].stop = &stop;
+		if (pthread_create(&threads[started], NULL, client_thread, &client[started]) != 0)
+			break;
+	}
+
+	t0 = now_ms();
+	while (now_ms() - t0 < seconds * 1000.0)
+		sleep_ms(10);
+	elapsed = now_ms() - t0;
+
+	airspy_get_server_stats(device, &stats);
+	stop = 1;
+	airspy_term_rx(device);
+	pthread_join(rx, NULL);
+	for (i = 0; i < started; i++)
+		pthread_join(threads[i], NULL);
+	if (udp) {
+		pthread_join(udp_rx, NULL);
+		close(sink.fd);
+	}
+	airspy_close(device);
+
+	total = 0;
+	slowest = 0;
+	for (i = 0; i < started; i++) {
+		mbps = client[i].bytes / (elapsed * 1000.0);
+		total += mbps;
+		if (i == 0 || mbps < slowest)
+			slowest = mbps;
+	}
+
+	printf("%7d %10.1f %10.1f %10.2f %10.1f %9llu %9llu %9llu", started, started > 0 ? total / started : 0.0, slowest,
+		started > 0 ? total / started / sample_bytes(format) : 0.0, total,
+		(unsigned long long)stats.blocks_dropped, (unsigned long long)stats.zerocopy_sends,
+		(unsigned long long)stats.zerocopy_copied);
+	if (udp)
+		printf(" %9.1f %8llu %8llu", sink.bytes / (elapsed * 1000.0), (unsigned long long)stats.udp_dropped,
+			(unsigned long long)sink.gaps);
+	printf("\n");
+
+	return AIRSPY_SUCCESS;
+}
+
+static void usage(void)
+{
+	printf("airspy_server_bench: loopback throughput of the streaming server against the simulator\n");
+	printf("Usage:\n");
+	printf("\t[-c counts]: Comma separated client counts, default %s\n", DEFAULT_COUNTS);
+	printf("\t[-t seconds]: Duration of each run, default %d\n", DEFAULT_SECONDS);
+	printf("\t[-f format]: 0=u8, 1=int16 (default), 2=float32\n");
+	printf("\t[-d decimation]: Power of two, default 1\n");
+	printf("\t[-a rate]: IQ sample rate to pace the simulator at, default unpaced\n");
+	printf("\t[-q depth]: Blocks queued per client, default 16\n");
+	printf("\t[-P port]: TCP port, the UDP sink takes the next one, default %d\n", DEFAULT_PORT);
+	printf("\t[-u]: Also send VITA-49 over UDP, in int16 unless -f 2\n");
+}
+
+int main(int argc, char** argv)
+{
+	airspy_sim_params_t sim;
+	airspy_server_params_t params;
+	char destination[32];
+	char* count_list;
+	char* token;
+	uint32_t decimation;
+	int format;
+	int seconds;
+	int udp;
+	int clients;
+	int result;
+	int opt;
+	int bit;
+
+	memset(&sim, 0, sizeof(sim));
+	memset(&params, 0, sizeof(params));
+	sim.seed = 1;
+	sim.flags = AIRSPY_SIM_UNPACED;
+	params.address = "127.0.0.1";
+	params.tcp_port = DEFAULT_PORT;
+	params.max_clients = MAX_CLIENTS;
+	seconds = DEFAULT_SECONDS;
+	format = AIRSPY_SERVER_INT16;
+	decimation = 1;
+	udp = 0;
+	count_list = NULL;
+
+	while ((opt = getopt(argc, argv, "c:t:f:d:a:q:P:uh")) != EOF) {
+		switch (opt) {
+		case 'c':
+			count_list = optarg;
+			break;
+
+		case 't':
+			seconds = atoi(optarg);
+			break;
+
+		case 'f':
+			format = atoi(optarg);
+			break;
+
+		case 'd':
+			decimation = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'a':
+			sim.samplerate = (uint32_t)strtoul(optarg, NULL, 0);
+			sim.flags = 0;
+			break;
+
+		case 'q':
+			params.queue_depth = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'P':
+			params.tcp_port = (uint16_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'u':
+			udp = 1;
+			break;
+
+		default:
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	for (bit = 0; bit < 8 && (1u << bit) != decimation; bit++) {
+	}
+	if (seconds < 1 || format < AIRSPY_SERVER_U8 || format > AIRSPY_SERVER_FLOAT32 || bit == 8) {
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	/* VITA-49 has no u8, so the UDP stream is int16 then */
+	params.decimations = 1u << bit;
+	params.udp_format = format == AIRSPY_SERVER_FLOAT32 ? AIRSPY_SERVER_FLOAT32 : AIRSPY_SERVER_INT16;
+	params.udp_decimation = decimation;
+	if (udp) {
+		snprintf(destination, sizeof(destination), "127.0.0.1:%u", params.tcp_port + 1);
+		params.udp_destination = destination;
+	}
+
+	printf("%d s per run, %s, decimation %u, simulator %s\n", seconds,
+		format == AIRSPY_SERVER_U8 ? "u8" : format == AIRSPY_SERVER_FLOAT32 ? "float32" : "int16", decimation,
+		sim.samplerate > 0 ? "paced" : "unpaced");
+	printf("%7s %10s %10s %10s %10s %9s %9s %9s", "clients", "MB/s each", "slowest", "MS/s each", "MB/s all",
+		"dropped", "zc sends", "zc copied");
+	if (udp)
+		printf(" %9s %8s %8s", "UDP MB/s", "UDP lost", "gaps");
+	printf("\n");
+
+	count_list = strdup(count_list != NULL ? count_list : DEFAULT_COUNTS);
+	for (token = strtok(count_list, ","); token != NULL; token = strtok(NULL, ",")) {
+		clients = atoi(token);
+		if (clients < 0 || clients > MAX_CLIENTS)
+			continue;
+		result = run(&sim, &params, format, clients, seconds, udp);
+		if (result != AIRSPY_SUCCESS) {
+			printf("run failed: %s (%d)\n", airspy_error_name(result), result);
+			free(count_list);
+			return EXIT_FAILURE;
+		}
+	}
+	free(count_list);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2026, despairspy contributors
+ *
+ * This file is part of AirSpy (based on HackRF project).
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Streams from the in-process simulator to find the highest sample rate the
+ * host side keeps up with, and how each configuration behaves under the
+ * injected jitter and faults. Nothing here touches USB, so the numbers are
+ * for the library's own transfer handling and conversion.
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#define MAX_RATES (16)
+#define DEFAULT_SECONDS (2)
+#define DEFAULT_RECOVERY (3)
+#define DEFAULT_RATES "2500000,10000000,20000000,40000000,80000000"
+
+typedef struct {
+	struct airspy_device* device;
+	volatile uint64_t samples;
+	volatile uint64_t discontinuities;
+	int result;
+} bench_t;
+
+typedef struct {
+	double msps;
+	int result;
+	int stopped; /* The stream ended before the run did */
+	airspy_stream_stats_t stream;
+	airspy_sim_stats_t sim;
+} run_t;
+
+static double now_ms(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+
+static void sleep_ms(int ms)
+{
+#ifdef _WIN32
+	Sleep(ms);
+#else
+	usleep(ms * 1000);
+#endif
+}
+
+static int rx_callback(struct airspy_device* device, void* ctx, airspy_transfer_t* transfer)
+{
+	bench_t* bench = (bench_t*)ctx;
+
+	(void)device;
+
+	bench->samples += transfer->sample_count;
+	if (transfer->flags & AIRSPY_TRANSFER_DISCONTINUITY)
+		bench->discontinuities++;
+	return 0;
+}
+
+static void* rx_thread(void* arg)
+{
+	bench_t* bench = (bench_t*)arg;
+
+	bench->result = airspy_do_rx(bench->device, rx_callback, bench);
+	return NULL;
+}
+
+static int run(const airspy_sim_params_t* params, int packing, uint32_t recovery, uint32_t workers, int seconds,
+	run_t* out)
+{
+	bench_t bench;
+	pthread_t thread;
+	double t0;
+	double elapsed;
+	int result;
+
+	memset(&bench, 0, sizeof(bench));
+	memset(out, 0, sizeof(*out));
+
+	result = airspy_open_sim(&bench.device, params);
+	if (result != AIRSPY_SUCCESS)
+		return result;
+
+	result = airspy_set_packing(bench.device, (uint8_t)packing);
+	if (result == AIRSPY_SUCCESS)
+		result = airspy_set_recovery(bench.device, recovery);
+	if (result == AIRSPY_SUCCESS)
+		result = airspy_set_conversion_threads(bench.device, workers);
+	if (result == AIRSPY_SUCCESS)
+		result = airspy_init_rx(bench.device);
+	if (result != AIRSPY_SUCCESS) {
+		airspy_close(bench.device);
+		return result;
+	}
+
+	if (pthread_create(&thread, NULL, rx_thread, &bench) != 0) {
+		airspy_close(bench.device);
+		return AIRSPY_ERROR_THREAD;
+	}
+
+	t0 = now_ms();
+	while (now_ms() - t0 < seconds * 1000.0 && airspy_is_streaming(bench.device) == AIRSPY_TRUE)
+		sleep_ms(10);
+	elapsed = now_ms() - t0;
+	out->stopped = airspy_is_streaming(bench.device) != AIRSPY_TRUE;
+
+	airspy_term_rx(bench.device);
+	pthread_join(thread, NULL);
+
+	airspy_get_stream_stats(bench.device, &out->stream);
+	airspy_get_sim_stats(bench.device, &out->sim);
+	airspy_close(bench.device);
+
+	out->msps = bench.samples / (elapsed * 1000.0);
+	out->result = bench.result;
+
+	return AIRSPY_SUCCESS;
+}
+
+static void print_header(void)
+{
+	printf("%-8s %-9s %10s %10s %9s %8s %8s %9s %10s %8s %s\n",
+		"packing", "target", "MS/s", "overruns", "failed", "recov", "dropped", "late ms", "faults", "waits", "status");
+}
+
+static void print_run(int packing, const char* target, const run_t* r)
+{
+	printf("%-8s %-9s %10.2f %10llu %9llu %8llu %8llu %9.2f %10llu %8llu %s\n",
+		packing ? "12-bit" : "16-bit", target, r->msps,
+		(unsigned long long)r->sim.blocks_overrun,
+		(unsigned long long)r->stream.failed_transfers,
+		(unsigned long long)r->stream.recoveries,
+		(unsigned long long)r->stream.dropped_samples,
+		r->sim.max_late_us / 1000.0,
+		(unsigned long long)(r->sim.errors_injected + r->sim.stalls_injected + r->sim.short_injected),
+		(unsigned long long)r->stream.conversion_waits,
+		r->result != AIRSPY_SUCCESS ? airspy_error_name((enum airspy_error)r->result) : r->stopped ? "stopped" : "ok");
+}
+
+static void usage(void)
+{
+	printf("airspy_stream_bench: streaming throughput and drop behavior against the simulator\n");
+	printf("Usage:\n");
+	printf("\t[-a rates]: Comma separated IQ sample rates to pace the simulator at, default %s\n", DEFAULT_RATES);
+	printf("\t[-t seconds]: Duration of each run, default %d\n", DEFAULT_SECONDS);
+	printf("\t[-p packing]: 0=16-bit transfers, 1=12-bit packed, 2=both (default)\n");
+	printf("\t[-j jitter_us]: Random completion delay up to this, default 0\n");
+	printf("\t[-e error_ppm] [-S stall_ppm] [-x short_ppm]: Injected faults per million transfers, default 0\n");
+	printf("\t[-R attempts]: Recovery attempts, 0 disables recovery, default %d\n", DEFAULT_RECOVERY);
+	printf("\t[-z seed]: Seed for faults and jitter, default 1\n");
+	printf("\t[-w workers]: Conversion threads, 0 converts on the streaming thread, default 0\n");
+}
+
+int main(int argc, char** argv)
+{
+	int opt;
+	int i;
+	int result;
+	int packing;
+	int first_packing;
+	int last_packing;
+	int seconds;
+	int rate_count;
+	uint32_t recovery;
+	uint32_t workers;
+	uint32_t rates[MAX_RATES];
+	uint32_t sustained;
+	char* rate_list;
+	char* token;
+	char target[32];
+	airspy_sim_params_t params;
+	run_t r;
+
+	memset(&params, 0, sizeof(params));
+	params.seed = 1;
+	seconds = DEFAULT_SECONDS;
+	recovery = DEFAULT_RECOVERY;
+	workers = 0;
+	first_packing = 0;
+	last_packing = 1;
+	rate_list = NULL;
+
+	while ((opt = getopt(argc, argv, "a:t:p:j:e:S:x:R:z:w:h")) != EOF) {
+		switch (opt) {
+		case 'a':
+			rate_list = optarg;
+			break;
+
+		case 't':
+			seconds = atoi(optarg);
+			break;
+
+		case 'p':
+			packing = atoi(optarg);
+			first_packing = packing == 1 ? 1 : 0;
+			last_packing = packing == 0 ? 0 : 1;
+			break;
+
+		case 'j':
+			params.jitter_us = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'e':
+			params.error_ppm = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'S':
+			params.stall_ppm = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'x':
+			params.short_ppm = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'R':
+			recovery = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'z':
+			params.seed = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		case 'w':
+			workers = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+
+		default:
+			usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (seconds < 1) {
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	rate_count = 0;
+	rate_list = strdup(rate_list != NULL ? rate_list : DEFAULT_RATES);
+	for (token = strtok(rate_list, ","); token != NULL && rate_count < MAX_RATES; token = strtok(NULL, ",")) {
+		rates[rate_count] = (uint32_t)strtoul(token, NULL, 0);
+		if (rates[rate_count] > 0)
+			rate_count++;
+	}
+	free(rate_list);
+
+	printf("%d s per run, jitter %u us, faults %u/%u/%u ppm (error/stall/short), recovery %u, %u conversion thread(s)\n",
+		seconds, params.jitter_us, params.error_ppm, params.stall_ppm, params.short_ppm, recovery, workers);
+	print_header();
+
+	for (packing = first_packing; packing <= last_packing; packing++) {
+		/* Unpaced, transfers complete as soon as they are queued: the host side is the only limit */
+		params.flags = AIRSPY_SIM_UNPACED;
+		params.samplerate = 0;
+		result = run(&params, packing, recovery, workers, seconds, &r);
+		if (result != AIRSPY_SUCCESS) {
+			printf("airspy_open_sim() failed: %s (%d)\n", airspy_error_name(result), result);
+			return EXIT_FAILURE;
+		}
+		print_run(packing, "max", &r);
+
+		params.flags = 0;
+		sustained = 0;
+		for (i = 0; i < rate_count; i++) {
+			params.samplerate = rates[i];
+			result = run(&params, packing, recovery, workers, seconds, &r);
+			if (result != AIRSPY_SUCCESS) {
+				printf("airspy_open_sim() failed: %s (%d)\n", airspy_error_name(result), result);
+				return EXIT_FAILURE;
+			}
+			snprintf(target, sizeof(target), "%.2f", rates[i] / 1e6);
+			print_run(packing, target, &r);
+
+			if (r.sim.blocks_overrun == 0 && r.result == AIRSPY_SUCCESS && !r.stopped && rates[i] > sustained)
+				sustained = rates[i];
+		}
+
+		if (sustained > 0)
+			printf("%s: sustained up to %.2f MS/s without overruns\n", packing ? "12-bit" : "16-bit", sustained / 1e6);
+		else
+			printf("%s: no paced rate was sustained without overruns\n", packing ? "12-bit" : "16-bit");
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -27,10 +27,38 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <libusb.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
 
 #include "iqconverter_int16.h"
 #include "filters.h"
+#include "sweep.h"
+#include "recorder.h"
+#include "file_source.h"
+#include "capture_index.h"
+#include "pyramid.h"
+#include "trigger.h"
+#include "squelch.h"
+#include "correlator.h"
+#include "resampler.h"
+#include "convolver.h"
+#include "sample_format.h"
+#include "transport.h"
+#include "sim.h"
+#include "packing.h"
+#include "convert.h"
+#include "convert_pool.h"
+#include "loan.h"
+#include "broker.h"
+#include "fanout.h"
+#include "server.h"
 
 #include "airspy.h"
 
@@ -44,6 +72,19 @@ typedef int bool;
 #define UNPACKED_SIZE (16)
 #define RAW_BUFFER_COUNT (8)
 
+#define DEFAULT_BUFFER_SIZE (262144)
+#define PACKED_BUFFER_SIZE (6144 * 24)
+/* Small transfers keep the data still in flight after a retune short */
+#define SWEEP_BUFFER_SIZE (16384)
+#define SWEEP_SETTLE_TRANSFERS (2)
+
+/* Bounds how long airspy_term_rx() waits for cancelled transfers to come back */
+#define TERM_DRAIN_ATTEMPTS (100)
+#define TERM_DRAIN_TIMEOUT_US (10000)
+
+/* Time constant of the DC removed from real samples, in blocks */
+#define REAL_DC_BLOCKS (16)
+
 #ifdef AIRSPY_BIG_ENDIAN
 #define TO_LE(x) __builtin_bswap32(x)
 #else
@@ -61,6 +102,32 @@ typedef struct {
     uint32_t freq_hz;
 } set_freq_params_t;
 
+#define CONFIG_SAMPLERATE (1 << 0)
+#define CONFIG_PACKING (1 << 1)
+#define CONFIG_LNA_AGC (1 << 2)
+#define CONFIG_MIXER_AGC (1 << 3)
+#define CONFIG_LNA_GAIN (1 << 4)
+#define CONFIG_MIXER_GAIN (1 << 5)
+#define CONFIG_VGA_GAIN (1 << 6)
+#define CONFIG_RF_BIAS (1 << 7)
+#define CONFIG_FREQ (1 << 8)
+
+/* Last value successfully written for each setting, replayed onto a standby device */
+typedef struct {
+    uint32_t valid;
+    uint32_t samplerate;
+    uint32_t freq_hz;
+    uint8_t packing;
+    uint8_t lna_agc;
+    uint8_t mixer_agc;
+    uint8_t lna_gain;
+    uint8_t mixer_gain;
+    uint8_t vga_gain;
+    uint8_t rf_bias;
+} device_config_t;
+
+#define EVENT_PENDING(event) (1 << (event))
+
 typedef struct airspy_device
 {
     libusb_context* usb_context;
@@ -77,11 +144,228 @@ typedef struct airspy_device
     void *output_buffer;
     uint16_t *unpacked_samples;
     bool packing_enabled;
+    uint32_t samplerate;
     void* ctx;
 
     iqconverter_int16_t conv;
+    /* What the callback gets; segments of the squelch are formatted into output */
+    enum airspy_sample_type sample_type;
+    void* output;
+    size_t output_size;
+    /* Real sample types: the DC removed, in output units, once a block has been seen */
+    int32_t real_dc;
+    bool real_dc_valid;
+    /* Set when successive blocks are converted on worker threads */
+    uint32_t conversion_threads;
+    convert_pool_t* pool;
+    /* Set in loan mode, where blocks are handed out with their buffer */
+    uint32_t loan_count;
+    loan_pool_t* loans;
+    bool loans_exhausted;
+    /* Set once anything subscribed */
+    fanout_t* fanout;
+    broker_t* broker;
+    struct airspy_subscriber* broker_subscriber;
+    server_t* server;
+
+    sweep_t *sweep;
+    bool sweep_retune;
+
+    device_config_t config;
+    struct airspy_device *standby;
+    bool shared_context;
+    bool hotplug_registered;
+    libusb_hotplug_callback_handle hotplug_handle;
+    airspy_event_cb_fn event_callback;
+    void* event_ctx;
+    uint32_t pending_events;
+    uint32_t transfers_in_flight;
+    bool departed;
+    volatile bool standby_departed;
+    bool standby_lost_reported;
+    struct airspy_device *retired;
+
+    uint32_t recovery_max_attempts;
+    uint32_t recovery_attempts;
+    struct libusb_transfer** failed_transfers;
+    uint32_t failed_count;
+    bool failed_stall;
+    bool recovery_resubmitted;
+    uint64_t failure_time_us;
+    uint64_t sample_index;
+    uint64_t pending_dropped;
+    airspy_stream_stats_t stats;
+
+    volatile bool paused;
+    volatile uint64_t pause_request_us;
+    volatile uint64_t resume_request_us;
+    bool converter_stale;
+
+    /* Recording can be started and stopped from any thread while streaming */
+    pthread_mutex_t record_lock;
+    recorder_t *recorder;
+    enum airspy_record_format record_format;
+    trigger_t *trigger;
+    int trigger_request; /* Set by airspy_trigger(), taken by the next block */
+
+    /* Gates what reaches the callback and IQ recordings, NULL for everything */
+    squelch_t *squelch;
+
+    /* Set for a virtual device replaying a capture, which has no USB side */
+    file_source_t* file;
+    uint32_t file_flags;
+    uint64_t replay_start_us;
+    uint64_t replay_samples;
+    uint64_t file_seek; /* 1 + the sample a pending airspy_seek_file() goes to, 0 for none */
+    bool replay_seeked;
+
+    /* Where vendor requests and transfers go: libusb, the replay or the simulator */
+    const transport_ops_t* transport;
+    void* transport_handle;
+    sim_t* sim;
 } airspy_device_t;
 
+static uint64_t airspy_now_us(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq;
+    LARGE_INTEGER count;
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (uint64_t)(count.QuadPart * 1000000.0 / freq.QuadPart);
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+static void airspy_sleep_us(uint64_t us)
+{
+#ifdef _WIN32
+    Sleep((DWORD)(us / 1000));
+#else
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(us / 1000000);
+    ts.tv_nsec = (long)(us % 1000000) * 1000;
+    nanosleep(&ts, NULL);
+#endif
+}
+
+/* IQ samples delivered per transfer: a packed transfer carries 8 samples per 12 bytes */
+static uint32_t airspy_block_samples(const airspy_device_t* device)
+{
+    return device->packing_enabled ? device->buffer_size / 3 : device->buffer_size / (sizeof(uint16_t) * 2);
+}
+
+static int usb_transport_control(void* handle, uint8_t request_type, uint8_t request,
+    uint16_t value, uint16_t index, unsigned char* data, uint16_t length, unsigned int timeout)
+{
+    airspy_device_t* device = (airspy_device_t*)handle;
+
+    return libusb_control_transfer(device->usb_device, request_type, request, value, index, data, length, timeout);
+}
+
+static int usb_transport_submit(void* handle, struct libusb_transfer* transfer)
+{
+    (void)handle;
+    return libusb_submit_transfer(transfer);
+}
+
+static int usb_transport_cancel(void* handle, struct libusb_transfer* transfer)
+{
+    (void)handle;
+    return libusb_cancel_transfer(transfer);
+}
+
+static int usb_transport_clear_halt(void* handle, unsigned char endpoint)
+{
+    airspy_device_t* device = (airspy_device_t*)handle;
+
+    return libusb_clear_halt(device->usb_device, endpoint);
+}
+
+static int usb_transport_handle_events(void* handle, struct timeval* timeout)
+{
+    airspy_device_t* device = (airspy_device_t*)handle;
+
+    return libusb_handle_events_timeout_completed(device->usb_context, timeout, NULL);
+}
+
+/* The handle is the device itself, so a failover swapping usb_device is picked up */
+static const transport_ops_t usb_transport = {
+    usb_transport_control,
+    usb_transport_submit,
+    usb_transport_cancel,
+    usb_transport_clear_halt,
+    usb_transport_handle_events
+};
+
+static int airspy_replay_block(airspy_device_t* device);
+
+/* A replayed capture accepts all settings and reads back zeroes */
+static int replay_transport_control(void* handle, uint8_t request_type, uint8_t request,
+    uint16_t value, uint16_t index, unsigned char* data, uint16_t length, unsigned int timeout)
+{
+    (void)handle;
+    (void)request;
+    (void)value;
+    (void)index;
+    (void)timeout;
+
+    if ((request_type & LIBUSB_ENDPOINT_IN) && data != NULL)
+    {
+        memset(data, 0, length);
+    }
+    return length;
+}
+
+/* Blocks are handed over straight from the file, there are no transfers to queue */
+static int replay_transport_submit(void* handle, struct libusb_transfer* transfer)
+{
+    (void)handle;
+    (void)transfer;
+    return LIBUSB_ERROR_NOT_SUPPORTED;
+}
+
+static int replay_transport_cancel(void* handle, struct libusb_transfer* transfer)
+{
+    (void)handle;
+    (void)transfer;
+    return LIBUSB_ERROR_NOT_FOUND;
+}
+
+static int replay_transport_clear_halt(void* handle, unsigned char endpoint)
+{
+    (void)handle;
+    (void)endpoint;
+    return 0;
+}
+
+static int replay_transport_handle_events(void* handle, struct timeval* timeout)
+{
+    (void)timeout;
+    return airspy_replay_block((airspy_device_t*)handle);
+}
+
+static const transport_ops_t replay_transport = {
+    replay_transport_control,
+    replay_transport_submit,
+    replay_transport_cancel,
+    replay_transport_clear_halt,
+    replay_transport_handle_events
+};
+
+/* Every vendor request goes through here so that a virtual device can stand in */
+static int airspy_control_transfer(airspy_device_t* device, uint8_t request_type, uint8_t request,
+    uint16_t value, uint16_t index, unsigned char* data, uint16_t length, unsigned int timeout)
+{
+    return device->transport->control(device->transport_handle, request_type, request, value, index, data, length, timeout);
+}
+
 static const uint16_t airspy_usb_vid = 0x1d50;
 static const uint16_t airspy_usb_pid = 0x60a1;
 
@@ -93,6 +377,31 @@ static const char str_prefix_serial_airspy[STR_PREFIX_SERIAL_AIRSPY_SIZE] =
 
 #define GAIN_COUNT (22)
 
+/* USB 3.0 allows up to 7 tiers of hubs */
+#define ENUM_CACHE_MAX_PORTS (7)
+#define ENUM_CACHE_SIZE (64)
+
+typedef struct {
+    uint64_t serial_number;
+    uint8_t bus_number;
+    uint8_t device_address; /* New on every enumeration, so a device swapped on the same port doesn't match */
+    uint8_t port_count;
+    uint8_t ports[ENUM_CACHE_MAX_PORTS];
+} enum_cache_entry_t;
+
+/* Ordered by how promising a bus path is when looking for a serial number */
+enum enum_path_class
+{
+    ENUM_PATH_MATCH = 0,
+    ENUM_PATH_UNKNOWN = 1,
+    ENUM_PATH_OTHER = 2
+};
+
+/* Serial number of every device seen so far, keyed by bus path and address; shared by all contexts in the process */
+static enum_cache_entry_t enum_cache[ENUM_CACHE_SIZE];
+static int enum_cache_count;
+static pthread_mutex_t enum_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
 static
 uint8_t airspy_linearity_vga_gains[GAIN_COUNT] = { 13, 12, 11, 11, 11, 11, 11, 10, 10, 10, 10, 10, 10, 10, 10, 10, 9, 8, 7, 6, 5, 4 };
 
@@ -121,7 +430,7 @@ static int cancel_transfers(airspy_device_t* device)
         {
             if (device->transfers[transfer_index] != NULL)
             {
-                libusb_cancel_transfer(device->transfers[transfer_index]);
+                device->transport->cancel(device->transport_handle, device->transfers[transfer_index]);
             }
         }
         return AIRSPY_SUCCESS;
@@ -150,26 +459,34 @@ static int free_transfers(airspy_device_t* device)
         }
         free(device->transfers);
         device->transfers = NULL;
+    }
 
-        if (device->output_buffer != NULL)
-        {
-            free(device->output_buffer);
-            device->output_buffer = NULL;
-        }
+    if (device->failed_transfers != NULL)
+    {
+        free(device->failed_transfers);
+        device->failed_transfers = NULL;
+    }
+    device->failed_count = 0;
 
-        if (device->unpacked_samples != NULL)
-        {
-            free(device->unpacked_samples);
-            device->unpacked_samples = NULL;
-        }
+    /* These may be left over from a partially failed allocate_transfers() */
+    if (device->output_buffer != NULL)
+    {
+        free(device->output_buffer);
+        device->output_buffer = NULL;
+    }
+
+    if (device->unpacked_samples != NULL)
+    {
+        free(device->unpacked_samples);
+        device->unpacked_samples = NULL;
+    }
 
-        for (i = 0; i < RAW_BUFFER_COUNT; i++)
+    for (i = 0; i < RAW_BUFFER_COUNT; i++)
+    {
+        if (device->received_samples_queue[i] != NULL)
         {
-            if (device->received_samples_queue[i] != NULL)
-            {
-                free(device->received_samples_queue[i]);
-                device->received_samples_queue[i] = NULL;
-            }
+            free(device->received_samples_queue[i]);
+            device->received_samples_queue[i] = NULL;
         }
     }
 
@@ -213,6 +530,12 @@ static int allocate_transfers(airspy_device_t* const device)
             return AIRSPY_ERROR_NO_MEM;
         }
 
+        device->failed_transfers = (struct libusb_transfer**) calloc(device->transfer_count, sizeof(struct libusb_transfer*));
+        if (device->failed_transfers == NULL)
+        {
+            return AIRSPY_ERROR_NO_MEM;
+        }
+
         for (transfer_index = 0; transfer_index<device->transfer_count; transfer_index++)
         {
             device->transfers[transfer_index] = libusb_alloc_transfer(0);
@@ -245,6 +568,28 @@ static int allocate_transfers(airspy_device_t* const device)
     }
 }
 
+static int resize_transfers(airspy_device_t* device, uint32_t buffer_size)
+{
+    if (buffer_size == device->buffer_size)
+    {
+        return AIRSPY_SUCCESS;
+    }
+
+    /* A drain that timed out in airspy_term_rx() leaves transfers the transport still owns */
+    if (device->transfers_in_flight != 0)
+    {
+        return AIRSPY_ERROR_BUSY;
+    }
+
+    cancel_transfers(device);
+    free_transfers(device);
+
+    /* Reallocated by the next airspy_init_rx() */
+    device->buffer_size = buffer_size;
+
+    return AIRSPY_SUCCESS;
+}
+
 static int prepare_transfers(airspy_device_t* device, const uint_fast8_t endpoint_address, libusb_transfer_cb_fn callback)
 {
     int error;
@@ -256,11 +601,12 @@ static int prepare_transfers(airspy_device_t* device, const uint_fast8_t endpoin
             device->transfers[transfer_index]->endpoint = endpoint_address;
             device->transfers[transfer_index]->callback = callback;
 
-            error = libusb_submit_transfer(device->transfers[transfer_index]);
+            error = device->transport->submit(device->transport_handle, device->transfers[transfer_index]);
             if (error != 0)
             {
                 return AIRSPY_ERROR_LIBUSB;
             }
+            device->transfers_in_flight++;
         }
 
         return AIRSPY_SUCCESS;
@@ -271,1248 +617,3826 @@ static int prepare_transfers(airspy_device_t* device, const uint_fast8_t endpoin
     }
 }
 
-static inline void unpack_samples(uint32_t *input, uint16_t *output, int length)
+/*
+ * Park a transfer that didn't make it for airspy_do_rx() to resubmit, or end
+ * the stream if recovery is off. dropped is the number of IQ samples lost
+ * with it.
+ */
+static void airspy_transfer_failed(airspy_device_t* device, struct libusb_transfer* usb_transfer, uint32_t dropped)
 {
-    int i, j;
+    device->stats.failed_transfers++;
 
-    for (i = 0, j = 0; j < length; i += 3, j += 8)
+    if (device->recovery_max_attempts == 0)
     {
-        output[j + 0] = (input[i] >> 20) & 0xfff;
-        output[j + 1] = (input[i] >> 8) & 0xfff;
-        output[j + 2] = ((input[i] & 0xff) << 4) | ((input[i + 1] >> 28) & 0xf);
-        output[j + 3] = ((input[i + 1] & 0xfff0000) >> 16);
-        output[j + 4] = ((input[i + 1] & 0xfff0) >> 4);
-        output[j + 5] = ((input[i + 1] & 0xf) << 8) | ((input[i + 2] & 0xff000000) >> 24);
-        output[j + 6] = ((input[i + 2] >> 12) & 0xfff);
-        output[j + 7] = ((input[i + 2] & 0xfff));
+        device->streaming = false;
+        return;
     }
-}
-
-static
-void airspy_libusb_transfer_callback(struct libusb_transfer* usb_transfer)
-{
-    airspy_device_t* device = (airspy_device_t*)usb_transfer->user_data;
 
-    if (!device->streaming || device->stop_requested)
+    if (device->failure_time_us == 0)
     {
-        return;
+        device->failure_time_us = airspy_now_us();
     }
 
-    if (usb_transfer->status == LIBUSB_TRANSFER_COMPLETED && usb_transfer->actual_length == usb_transfer->length)
+    if (usb_transfer->status == LIBUSB_TRANSFER_STALL)
     {
-        airspy_transfer_t transfer;
+        device->failed_stall = true;
+    }
 
-        iqconverter_int16_process(&device->conv, (uint16_t *)usb_transfer->buffer,
-                device->buffer_size / sizeof(uint16_t));
+    device->failed_transfers[device->failed_count++] = usb_transfer;
+    device->pending_dropped += dropped;
+    device->stats.dropped_samples += dropped;
+}
 
-        transfer.samples = usb_transfer->buffer;
-        /* Samples are 2 bytes each, I/Q */
-        transfer.sample_count = device->buffer_size / (sizeof(uint16_t) * 2);
+static void airspy_recovery_done(airspy_device_t* device)
+{
+    uint32_t elapsed;
 
-        /* Call the RX callback */
-        if (0 != device->callback(device, device->ctx, &transfer)) {
-            device->stop_requested = true;
-        }
+    elapsed = (uint32_t)(airspy_now_us() - device->failure_time_us);
 
-        if (libusb_submit_transfer(usb_transfer) != 0)
-        {
-            device->streaming = false;
-        }
-    }
-    else
+    device->stats.recoveries++;
+    device->stats.last_recovery_us = elapsed;
+    device->stats.total_recovery_us += elapsed;
+    if (elapsed > device->stats.max_recovery_us)
     {
-        device->streaming = false;
+        device->stats.max_recovery_us = elapsed;
     }
+
+    device->failure_time_us = 0;
+    device->recovery_attempts = 0;
+    device->recovery_resubmitted = false;
 }
 
-static
-void airspy_open_exit(airspy_device_t* device)
+static void airspy_record_block(airspy_device_t* device, enum airspy_record_format format, const void* data,
+    uint32_t bytes, uint32_t samples, uint64_t sample_index)
 {
-    if (device->usb_device != NULL)
+    pthread_mutex_lock(&device->record_lock);
+    if (device->recorder != NULL && device->record_format == format)
     {
-        libusb_release_interface(device->usb_device, 0);
-        libusb_close(device->usb_device);
-        device->usb_device = NULL;
+        recorder_write(device->recorder, data, bytes, samples, sample_index);
     }
-    libusb_exit(device->usb_context);
-    device->usb_context = NULL;
+    pthread_mutex_unlock(&device->record_lock);
 }
 
-static void upper_string(unsigned char *string, size_t len)
+/* Power summaries and the trigger ring take the converted IQ, whatever the recording's format */
+static void airspy_record_converted(airspy_device_t* device, const airspy_transfer_t* transfer)
 {
-    while (len > 0)
+    pthread_mutex_lock(&device->record_lock);
+    if (device->recorder != NULL)
     {
-        if (*string >= 'a' && *string <= 'z')
-        {
-            *string = *string - 32;
-        }
-        string++;
-        len--;
+        recorder_power(device->recorder, (const int16_t *)transfer->samples, transfer->sample_count, transfer->sample_index);
+    }
+    if (device->trigger != NULL)
+    {
+        trigger_write(device->trigger, transfer, __atomic_exchange_n(&device->trigger_request, 0, __ATOMIC_ACQUIRE));
     }
+    pthread_mutex_unlock(&device->record_lock);
 }
 
-static void airspy_open_device(airspy_device_t* device,
-    int* ret,
-    uint16_t vid,
-    uint16_t pid,
-    uint64_t serial_number_val)
+/* The gain settings as the capture index records them */
+static uint32_t airspy_record_gain_state(airspy_device_t* device)
 {
-    int i;
-    int result;
-    libusb_device_handle** libusb_dev_handle;
-    int serial_number_len;
-    libusb_device_handle* dev_handle;
-    libusb_device *dev;
-    libusb_device** devices = NULL;
+    const device_config_t* config = &device->config;
+    uint8_t agc = 0;
 
-    ssize_t cnt;
-    int serial_descriptor_index;
-    struct libusb_device_descriptor device_descriptor;
-    char serial_number_expected[SERIAL_AIRSPY_EXPECTED_SIZE + 1];
-    unsigned char serial_number[SERIAL_AIRSPY_EXPECTED_SIZE + 1];
-    uint32_t serial_number_msb_val;
-    uint32_t serial_number_lsb_val;
+    if ((config->valid & CONFIG_LNA_AGC) && config->lna_agc)
+    {
+        agc |= AIRSPY_INDEX_LNA_AGC;
+    }
+    if ((config->valid & CONFIG_MIXER_AGC) && config->mixer_agc)
+    {
+        agc |= AIRSPY_INDEX_MIXER_AGC;
+    }
 
-    libusb_dev_handle = &device->usb_device;
-    *libusb_dev_handle = NULL;
+    return CAPTURE_INDEX_GAIN((config->valid & CONFIG_LNA_GAIN) ? config->lna_gain : AIRSPY_INDEX_GAIN_UNKNOWN,
+        (config->valid & CONFIG_MIXER_GAIN) ? config->mixer_gain : AIRSPY_INDEX_GAIN_UNKNOWN,
+        (config->valid & CONFIG_VGA_GAIN) ? config->vga_gain : AIRSPY_INDEX_GAIN_UNKNOWN, agc);
+}
 
-    cnt = libusb_get_device_list(device->usb_context, &devices);
-    if (cnt < 0)
+static void airspy_record_gain(airspy_device_t* device)
+{
+    pthread_mutex_lock(&device->record_lock);
+    if (device->recorder != NULL)
     {
-        *ret = AIRSPY_ERROR_NOT_FOUND;
-        return;
+        recorder_set_gain(device->recorder, airspy_record_gain_state(device));
     }
+    if (device->trigger != NULL)
+    {
+        trigger_set_gain(device->trigger, airspy_record_gain_state(device));
+    }
+    pthread_mutex_unlock(&device->record_lock);
+}
 
-    i = 0;
-    while ((dev = devices[i++]) != NULL)
+static void airspy_reset_converter(airspy_device_t* device)
+{
+    iqconverter_int16_reset(&device->conv);
+    if (device->pool != NULL)
     {
-        libusb_get_device_descriptor(dev, &device_descriptor);
+        convert_pool_reset(device->pool);
+    }
+}
+
+/*
+ * Converted IQ to the callback's sample type. Blocks are done in place, as
+ * nothing reads them after the callback; segments of the squelch aren't,
+ * as they may point into its history.
+ */
+static bool airspy_format_samples(airspy_device_t* device, airspy_transfer_t* transfer)
+{
+    void* output = transfer->samples;
+    size_t size;
 
-        if ((device_descriptor.idVendor == vid) &&
-            (device_descriptor.idProduct == pid))
+    if (device->squelch != NULL)
+    {
+        size = (size_t)transfer->sample_count * sample_format_size(device->sample_type);
+        if (size > device->output_size)
         {
-            if (serial_number_val != SERIAL_NUMBER_UNUSED)
-            {
-                serial_descriptor_index = device_descriptor.iSerialNumber;
-                if (serial_descriptor_index > 0)
-                {
-                    if (libusb_open(dev, libusb_dev_handle) != 0)
-                    {
-                        *libusb_dev_handle = NULL;
-                        continue;
-                    }
-                    dev_handle = *libusb_dev_handle;
-                    serial_number_len = libusb_get_string_descriptor_ascii(dev_handle,
-                        serial_descriptor_index,
-                        serial_number,
-                        sizeof(serial_number));
-                    if (serial_number_len == SERIAL_AIRSPY_EXPECTED_SIZE)
-                    {
-                        serial_number[SERIAL_AIRSPY_EXPECTED_SIZE] = 0;
-                        upper_string(serial_number, SERIAL_AIRSPY_EXPECTED_SIZE);
-                        serial_number_msb_val = (uint32_t)(serial_number_val >> 32);
-                        serial_number_lsb_val = (uint32_t)(serial_number_val & 0xFFFFFFFF);
-
-                        sprintf(serial_number_expected, "%s%08X%08X",
-                            str_prefix_serial_airspy,
-                            serial_number_msb_val,
-                            serial_number_lsb_val);
-
-                        if (strncmp((const char*)serial_number, serial_number_expected, SERIAL_AIRSPY_EXPECTED_SIZE) == 0)
-                        {
-#ifdef __linux__
-                            /* Check whether a kernel driver is attached to interface #0. If so, we'll
-                            * need to detach it.
-                            */
-                            if (libusb_kernel_driver_active(dev_handle, 0))
-                            {
-                                libusb_detach_kernel_driver(dev_handle, 0);
-                            }
-#endif
-                            result = libusb_set_configuration(dev_handle, 1);
-                            if (result != 0)
-                            {
-                                libusb_close(dev_handle);
-                                *libusb_dev_handle = NULL;
-                                continue;
-                            }
-                            result = libusb_claim_interface(dev_handle, 0);
-                            if (result != 0)
-                            {
-                                libusb_close(dev_handle);
-                                *libusb_dev_handle = NULL;
-                                continue;
-                            }
-                            break;
-                        }
-                        else
-                        {
-                            libusb_close(dev_handle);
-                            *libusb_dev_handle = NULL;
-                            continue;
-                        }
-                    }
-                    else
-                    {
-                        libusb_close(dev_handle);
-                        *libusb_dev_handle = NULL;
-                        continue;
-                    }
-                }
-            }
-            else
+            free(device->output);
+            device->output = malloc(size);
+            device->output_size = device->output != NULL ? size : 0;
+            if (device->output == NULL)
             {
-                if (libusb_open(dev, libusb_dev_handle) == 0)
-                {
-                    dev_handle = *libusb_dev_handle;
-#ifdef __linux__
-                    /* Check whether a kernel driver is attached to interface #0. If so, we'll
-                    * need to detach it.
-                    */
-                    if (libusb_kernel_driver_active(dev_handle, 0))
-                    {
-                        libusb_detach_kernel_driver(dev_handle, 0);
-                    }
-#endif
-                    result = libusb_set_configuration(dev_handle, 1);
-                    if (result != 0)
-                    {
-                        libusb_close(dev_handle);
-                        *libusb_dev_handle = NULL;
-                        continue;
-                    }
-                    result = libusb_claim_interface(dev_handle, 0);
-                    if (result != 0)
-                    {
-                        libusb_close(dev_handle);
-                        *libusb_dev_handle = NULL;
-                        continue;
-                    }
-                    break;
-                }
+                return false;
             }
         }
+        output = device->output;
     }
-    libusb_free_device_list(devices, 1);
 
-    dev_handle = device->usb_device;
-    if (dev_handle == NULL)
+    switch (device->sample_type)
     {
-        *ret = AIRSPY_ERROR_NOT_FOUND;
-        return;
+    case AIRSPY_SAMPLE_UINT16_MAG:
+        sample_format_magnitude((const int16_t *)transfer->samples, (uint16_t *)output, transfer->sample_count);
+        break;
+
+    case AIRSPY_SAMPLE_UINT32_POWER:
+        sample_format_power((const int16_t *)transfer->samples, (uint32_t *)output, transfer->sample_count);
+        break;
+
+    case AIRSPY_SAMPLE_INT8_IQ:
+        transfer->exponent = sample_format_int8((const int16_t *)transfer->samples, (int8_t *)output,
+            transfer->sample_count);
+        break;
+
+    default:
+        break;
     }
 
-    *ret = AIRSPY_SUCCESS;
-    return;
+    transfer->samples = output;
+    return true;
 }
 
-static int airspy_read_samplerates_from_fw(struct airspy_device* device, uint32_t* buffer, const uint32_t len)
+/* What passes the squelch, or every block without one: IQ recording and the RX callback */
+static void airspy_deliver_segment(void* ctx, airspy_transfer_t* transfer)
 {
-    int result;
+    airspy_device_t* device = (airspy_device_t*)ctx;
 
-    result = libusb_control_transfer(
-        device->usb_device,
-        LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-        AIRSPY_GET_SAMPLERATES,
-        0,
-        len,
-        (unsigned char*)buffer,
-        (len > 0 ? len : 1) * sizeof(uint32_t),
-        0);
+    airspy_record_block(device, AIRSPY_RECORD_IQ_INT16, transfer->samples,
+        transfer->sample_count * sizeof(int16_t) * 2, transfer->sample_count, transfer->sample_index);
 
-    if (result < 1)
+    if (device->sample_type != AIRSPY_SAMPLE_INT16_IQ && device->callback != NULL &&
+        !airspy_format_samples(device, transfer))
     {
-        return AIRSPY_ERROR_OTHER;
+        /* Out of memory ends the stream like a callback asking to */
+        device->stop_requested = true;
+        return;
     }
 
-    return AIRSPY_SUCCESS;
+    /* Call the RX callback */
+    if (device->callback != NULL && 0 != device->callback(device, device->ctx, transfer)) {
+        device->stop_requested = true;
+    }
 }
 
-static int airspy_open_init(airspy_device_t** device, uint64_t serial_number)
+/* A converted block: recording, the sweep, subscribers and the squelch or the RX callback */
+static void airspy_deliver_block(airspy_device_t* device, airspy_transfer_t* transfer)
 {
-    airspy_device_t* lib_device;
-    int libusb_error;
-    int result;
-
-    *device = NULL;
+    airspy_record_converted(device, transfer);
 
-    lib_device = (airspy_device_t*)calloc(1, sizeof(airspy_device_t));
-    if (lib_device == NULL)
+    if (device->sweep != NULL)
     {
-        return AIRSPY_ERROR_NO_MEM;
+        airspy_record_block(device, AIRSPY_RECORD_IQ_INT16, transfer->samples,
+            transfer->sample_count * sizeof(int16_t) * 2, transfer->sample_count, transfer->sample_index);
+        if (sweep_process(device->sweep, (const int16_t *)transfer->samples, transfer->sample_count))
+        {
+            device->sweep_retune = true;
+        }
+        return;
     }
 
-    libusb_error = libusb_init(&lib_device->usb_context);
-    if (libusb_error != 0)
+    if (device->fanout != NULL)
     {
-        free(lib_device);
-        return AIRSPY_ERROR_LIBUSB;
+        fanout_iq(device->fanout, transfer);
     }
 
-    airspy_open_device(lib_device,
-        &result,
-        airspy_usb_vid,
-        airspy_usb_pid,
-        serial_number);
-    if (lib_device->usb_device == NULL)
+    if (device->squelch != NULL)
     {
-        libusb_exit(lib_device->usb_context);
-        free(lib_device);
-        return result;
+        squelch_process(device->squelch, transfer, airspy_deliver_segment, device);
     }
+    else
+    {
+        airspy_deliver_segment(device, transfer);
+    }
+}
 
+/*
+ * Loan mode: takes a buffer for the block, together with *storage when that
+ * already holds it. Running out is reported rather than waited for; the
+ * block then goes out without a buffer.
+ */
+static struct airspy_buffer* airspy_loan_block(airspy_device_t* device, void** storage)
+{
+    struct airspy_buffer* buffer;
+
+    buffer = loan_pool_take(device->loans, storage);
+    if (buffer == NULL)
+    {
+        device->stats.buffers_exhausted++;
+        if (!device->loans_exhausted)
+        {
+            device->loans_exhausted = true;
+            device->pending_events |= EVENT_PENDING(AIRSPY_EVENT_BUFFERS_EXHAUSTED);
+        }
+    }
+    else
+    {
+        device->loans_exhausted = false;
+    }
+
+    return buffer;
+}
+
+/* Blocks still coming out of the pool once the stream is stopping are dropped */
+static void airspy_pool_deliver(void* ctx, airspy_transfer_t* transfer, void** storage)
+{
+    airspy_device_t* device = (airspy_device_t*)ctx;
+
+    if (!device->stop_requested)
+    {
+        if (device->loans != NULL && device->squelch == NULL)
+        {
+            transfer->buffer = airspy_loan_block(device, storage);
+        }
+        airspy_deliver_block(device, transfer);
+    }
+}
+
+static bool airspy_real_samples(const airspy_device_t* device)
+{
+    return device->sweep == NULL && (device->sample_type == AIRSPY_SAMPLE_UINT16_REAL ||
+        device->sample_type == AIRSPY_SAMPLE_INT16_REAL || device->sample_type == AIRSPY_SAMPLE_INT16_REAL_DC);
+}
+
+/*
+ * A block of real ADC samples, which skips the converter and every stage
+ * after it. The DC follows the mean of each block, which costs a pass
+ * over the block rather than a filter per sample.
+ */
+static void airspy_deliver_real(airspy_device_t* device, airspy_transfer_t* transfer)
+{
+    uint16_t* samples = (uint16_t*)transfer->samples;
+    int32_t mean;
+
+    transfer->sample_count *= 2;
+    transfer->sample_index *= 2;
+    transfer->dropped_samples *= 2;
+
+    if (device->sample_type == AIRSPY_SAMPLE_INT16_REAL_DC)
+    {
+        /* In output units, where a code is 16 */
+        mean = (int32_t)((sample_format_sum(samples, transfer->sample_count) << 4) / transfer->sample_count) - (2048 << 4);
+        if (!device->real_dc_valid)
+        {
+            device->real_dc = mean;
+            device->real_dc_valid = true;
+        }
+        else
+        {
+            device->real_dc += (mean - device->real_dc) / REAL_DC_BLOCKS;
+        }
+    }
+
+    if (device->sample_type != AIRSPY_SAMPLE_UINT16_REAL)
+    {
+        sample_format_real(samples, transfer->sample_count,
+            device->sample_type == AIRSPY_SAMPLE_INT16_REAL_DC ? device->real_dc : 0);
+    }
+
+    if (device->callback != NULL && 0 != device->callback(device, device->ctx, transfer)) {
+        device->stop_requested = true;
+    }
+}
+
+/*
+ * Everything a completed block goes through, whether it came from a USB
+ * transfer or from a replayed file. *buffer holds device->buffer_size bytes
+ * as received; unpacked samples are converted in place, packed ones are
+ * only read. In loan mode an unpacked block is handed out as it is and
+ * *buffer replaced with a spare. With a conversion pool the block is copied
+ * out and delivered later, from airspy_do_rx(), once it and every block
+ * before it are done.
+ */
+static void airspy_process_block(airspy_device_t* device, unsigned char** buffer)
+{
+    airspy_transfer_t transfer;
+    uint16_t* samples;
+    uint32_t real_count;
+    bool real;
+    bool loan;
+
+    if (device->paused)
+    {
+        if (device->pause_request_us != 0)
+        {
+            device->stats.last_pause_us = (uint32_t)(airspy_now_us() - device->pause_request_us);
+            device->pause_request_us = 0;
+        }
+
+        /* Skip the conversion and the callback */
+        device->pending_dropped += airspy_block_samples(device);
+        device->converter_stale = true;
+        return;
+    }
+
+    if (device->converter_stale)
+    {
+        airspy_reset_converter(device);
+        device->converter_stale = false;
+    }
+
+    if (device->resume_request_us != 0)
+    {
+        device->stats.last_resume_us = (uint32_t)(airspy_now_us() - device->resume_request_us);
+        if (device->stats.last_resume_us > device->stats.max_resume_us)
+        {
+            device->stats.max_resume_us = device->stats.last_resume_us;
+        }
+        device->resume_request_us = 0;
+    }
+
+    transfer.sample_count = airspy_block_samples(device);
+    real_count = transfer.sample_count * 2;
+
+    device->sample_index += device->pending_dropped;
+    transfer.sample_index = device->sample_index;
+    transfer.dropped_samples = device->pending_dropped;
+    transfer.flags = device->pending_dropped != 0 || device->replay_seeked ? AIRSPY_TRANSFER_DISCONTINUITY : 0;
+    device->replay_seeked = false;
+    device->sample_index += transfer.sample_count;
+    device->pending_dropped = 0;
+    device->stats.transfers++;
+    transfer.buffer = NULL;
+    transfer.exponent = 0;
+
+    /* Raw recordings count real ADC samples, two per IQ sample */
+    airspy_record_block(device, AIRSPY_RECORD_RAW, *buffer, device->buffer_size, real_count, transfer.sample_index * 2);
+
+    if (device->fanout != NULL && device->sweep == NULL)
+    {
+        fanout_raw(device->fanout, *buffer, &transfer);
+    }
+
+    real = airspy_real_samples(device);
+
+    /* Sweeps retune between blocks and stay on this thread */
+    if (device->pool != NULL && device->sweep == NULL && !real)
+    {
+        if (convert_pool_submit(device->pool, *buffer, &transfer, airspy_pool_deliver, device))
+        {
+            device->stats.conversion_waits++;
+        }
+        return;
+    }
+
+    /* Sweeps keep their blocks to themselves, the squelch only passes parts of them on */
+    loan = device->loans != NULL && device->sweep == NULL && (device->squelch == NULL || real);
+
+    if (device->packing_enabled)
+    {
+        samples = device->unpacked_samples;
+        if (loan)
+        {
+            transfer.buffer = airspy_loan_block(device, NULL);
+            if (transfer.buffer != NULL)
+            {
+                samples = (uint16_t *)transfer.buffer->data;
+            }
+        }
+        unpack_samples((uint32_t *)*buffer, samples, real_count);
+    }
+    else
+    {
+        samples = (uint16_t *)*buffer;
+        if (loan)
+        {
+            transfer.buffer = airspy_loan_block(device, (void**)buffer);
+        }
+    }
+
+    transfer.samples = samples;
+
+    if (real)
+    {
+        airspy_deliver_real(device, &transfer);
+        return;
+    }
+
+    iqconverter_int16_process(&device->conv, samples, real_count);
+
+    airspy_deliver_block(device, &transfer);
+}
+
+static
+void airspy_libusb_transfer_callback(struct libusb_transfer* usb_transfer)
+{
+    airspy_device_t* device = (airspy_device_t*)usb_transfer->user_data;
+    int error;
+
+    device->transfers_in_flight--;
+
+    if (!device->streaming || device->stop_requested || device->departed)
+    {
+        return;
+    }
+
+    if (usb_transfer->status == LIBUSB_TRANSFER_COMPLETED && usb_transfer->actual_length == usb_transfer->length)
+    {
+        if (device->recovery_resubmitted)
+        {
+            airspy_recovery_done(device);
+        }
+
+        airspy_process_block(device, &usb_transfer->buffer);
+
+        error = device->transport->submit(device->transport_handle, usb_transfer);
+        if (error == LIBUSB_ERROR_NO_DEVICE)
+        {
+            device->departed = true;
+        }
+        else if (error != 0)
+        {
+            airspy_transfer_failed(device, usb_transfer, 0);
+        }
+        else
+        {
+            device->transfers_in_flight++;
+        }
+    }
+    else if (usb_transfer->status == LIBUSB_TRANSFER_NO_DEVICE)
+    {
+        /* airspy_do_rx() decides whether to fail over once every transfer is back */
+        device->departed = true;
+    }
+    else
+    {
+        airspy_transfer_failed(device, usb_transfer, airspy_block_samples(device));
+    }
+}
+
+static int LIBUSB_CALL airspy_hotplug_callback(libusb_context* context, libusb_device* dev, libusb_hotplug_event event, void* user_data)
+{
+    airspy_device_t* device = (airspy_device_t*)user_data;
+
+    (void)context;
+
+    /* Only flag what happened here, the work is done by airspy_do_rx() outside of event handling */
+    if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED)
+    {
+        device->pending_events |= EVENT_PENDING(AIRSPY_EVENT_DEVICE_ARRIVED);
+    }
+    else if (device->usb_device != NULL && libusb_get_device(device->usb_device) == dev)
+    {
+        device->departed = true;
+    }
+    else if (device->standby != NULL && device->standby->usb_device != NULL &&
+        libusb_get_device(device->standby->usb_device) == dev)
+    {
+        device->standby_departed = true;
+    }
+
+    return 0;
+}
+
+static
+void airspy_open_exit(airspy_device_t* device)
+{
+    if (device->file != NULL)
+    {
+        file_source_close(device->file);
+        device->file = NULL;
+        return;
+    }
+    if (device->sim != NULL)
+    {
+        sim_close(device->sim);
+        device->sim = NULL;
+        return;
+    }
+    if (device->hotplug_registered)
+    {
+        libusb_hotplug_deregister_callback(device->usb_context, device->hotplug_handle);
+        device->hotplug_registered = false;
+    }
+    if (device->usb_device != NULL)
+    {
+        libusb_release_interface(device->usb_device, 0);
+        libusb_close(device->usb_device);
+        device->usb_device = NULL;
+    }
+    /* A standby borrows the context of the device it backs up */
+    if (!device->shared_context)
+    {
+        libusb_exit(device->usb_context);
+    }
+    device->usb_context = NULL;
+}
+
+static void upper_string(unsigned char *string, size_t len)
+{
+    while (len > 0)
+    {
+        if (*string >= 'a' && *string <= 'z')
+        {
+            *string = *string - 32;
+        }
+        string++;
+        len--;
+    }
+}
+
+static int airspy_claim_device(libusb_device_handle* dev_handle)
+{
+    int result;
+
+#ifdef __linux__
+    /* Check whether a kernel driver is attached to interface #0. If so, we'll
+    * need to detach it.
+    */
+    if (libusb_kernel_driver_active(dev_handle, 0))
+    {
+        libusb_detach_kernel_driver(dev_handle, 0);
+    }
+#endif
+    result = libusb_set_configuration(dev_handle, 1);
+    if (result != 0)
+    {
+        return AIRSPY_ERROR_LIBUSB;
+    }
+
+    result = libusb_claim_interface(dev_handle, 0);
+    if (result != 0)
+    {
+        return AIRSPY_ERROR_LIBUSB;
+    }
+
+    return AIRSPY_SUCCESS;
+}
+
+/*
+ * Read the "AIRSPY SN:" string descriptor of an open device and parse the
+ * serial number out of it.
+ */
+static int airspy_read_serial_number(libusb_device_handle* dev_handle, int serial_descriptor_index, uint64_t* serial_number_val)
+{
+    int i;
+    int serial_number_len;
+    unsigned char serial_number[SERIAL_AIRSPY_EXPECTED_SIZE + 1];
+    uint64_t value;
+    unsigned char c;
+
+    if (serial_descriptor_index <= 0)
+    {
+        return AIRSPY_ERROR_NOT_FOUND;
+    }
+
+    serial_number_len = libusb_get_string_descriptor_ascii(dev_handle,
+        serial_descriptor_index,
+        serial_number,
+        sizeof(serial_number));
+    if (serial_number_len != SERIAL_AIRSPY_EXPECTED_SIZE)
+    {
+        return AIRSPY_ERROR_NOT_FOUND;
+    }
+
+    upper_string(serial_number, SERIAL_AIRSPY_EXPECTED_SIZE);
+    if (memcmp(serial_number, str_prefix_serial_airspy, STR_PREFIX_SERIAL_AIRSPY_SIZE) != 0)
+    {
+        return AIRSPY_ERROR_NOT_FOUND;
+    }
+
+    value = 0;
+    for (i = STR_PREFIX_SERIAL_AIRSPY_SIZE; i < SERIAL_AIRSPY_EXPECTED_SIZE; i++)
+    {
+        c = serial_number[i];
+        if (c >= '0' && c <= '9')
+        {
+            value = (value << 4) | (c - '0');
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            value = (value << 4) | (c - 'A' + 10);
+        }
+        else
+        {
+            return AIRSPY_ERROR_NOT_FOUND;
+        }
+    }
+
+    *serial_number_val = value;
+
+    return AIRSPY_SUCCESS;
+}
+
+static void airspy_get_bus_path(libusb_device* dev, enum_cache_entry_t* entry)
+{
+    int port_count;
+
+    memset(entry, 0, sizeof(*entry));
+    entry->bus_number = libusb_get_bus_number(dev);
+    entry->device_address = libusb_get_device_address(dev);
+    port_count = libusb_get_port_numbers(dev, entry->ports, ENUM_CACHE_MAX_PORTS);
+    entry->port_count = port_count > 0 ? (uint8_t)port_count : 0;
+}
+
+static enum_cache_entry_t* enum_cache_find_path(const enum_cache_entry_t* path)
+{
+    int i;
+
+    for (i = 0; i < enum_cache_count; i++)
+    {
+        if (enum_cache[i].bus_number == path->bus_number &&
+            enum_cache[i].device_address == path->device_address &&
+            enum_cache[i].port_count == path->port_count &&
+            memcmp(enum_cache[i].ports, path->ports, path->port_count) == 0)
+        {
+            return &enum_cache[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns ENUM_PATH_UNKNOWN if nothing is cached for this bus path, otherwise
+ * whether the cached serial number matches.
+ */
+static int enum_cache_classify(const enum_cache_entry_t* path, uint64_t serial_number_val)
+{
+    enum_cache_entry_t* entry;
+    int result;
+
+    pthread_mutex_lock(&enum_cache_lock);
+    entry = enum_cache_find_path(path);
+    if (entry == NULL)
+    {
+        result = ENUM_PATH_UNKNOWN;
+    }
+    else if (entry->serial_number == serial_number_val)
+    {
+        result = ENUM_PATH_MATCH;
+    }
+    else
+    {
+        result = ENUM_PATH_OTHER;
+    }
+    pthread_mutex_unlock(&enum_cache_lock);
+
+    return result;
+}
+
+static int enum_cache_lookup(const enum_cache_entry_t* path, uint64_t* serial_number_val)
+{
+    enum_cache_entry_t* entry;
+
+    pthread_mutex_lock(&enum_cache_lock);
+    entry = enum_cache_find_path(path);
+    if (entry != NULL)
+    {
+        *serial_number_val = entry->serial_number;
+    }
+    pthread_mutex_unlock(&enum_cache_lock);
+
+    return entry != NULL;
+}
+
+static void enum_cache_store(const enum_cache_entry_t* path, uint64_t serial_number_val)
+{
+    int i;
+    enum_cache_entry_t* entry;
+
+    pthread_mutex_lock(&enum_cache_lock);
+
+    /* A serial number lives at exactly one bus path, and a bus path holds one device at a time */
+    for (i = 0; i < enum_cache_count; i++)
+    {
+        if (enum_cache[i].serial_number == serial_number_val ||
+            (enum_cache[i].bus_number == path->bus_number &&
+             enum_cache[i].port_count == path->port_count &&
+             memcmp(enum_cache[i].ports, path->ports, path->port_count) == 0))
+        {
+            enum_cache[i--] = enum_cache[--enum_cache_count];
+        }
+    }
+
+    if (enum_cache_count == ENUM_CACHE_SIZE)
+    {
+        memmove(&enum_cache[0], &enum_cache[1], (ENUM_CACHE_SIZE - 1) * sizeof(enum_cache_entry_t));
+        enum_cache_count--;
+    }
+    entry = &enum_cache[enum_cache_count++];
+
+    *entry = *path;
+    entry->serial_number = serial_number_val;
+
+    pthread_mutex_unlock(&enum_cache_lock);
+}
+
+/*
+ * Open a device by serial number. Bus paths whose serial number is already
+ * known from an earlier enumeration are tried first and devices cached with
+ * a different serial number are only opened if nothing else matched, so the
+ * usual cost is a single libusb_open() and string descriptor read.
+ */
+static void airspy_open_device(airspy_device_t* device,
+    int* ret,
+    uint16_t vid,
+    uint16_t pid,
+    uint64_t serial_number_val)
+{
+    int i;
+    int pass;
+    libusb_device_handle* dev_handle;
+    libusb_device *dev;
+    libusb_device** devices = NULL;
+
+    ssize_t cnt;
+    struct libusb_device_descriptor device_descriptor;
+    enum_cache_entry_t path;
+    uint64_t serial_number_read;
+
+    device->usb_device = NULL;
+
+    cnt = libusb_get_device_list(device->usb_context, &devices);
+    if (cnt < 0)
+    {
+        *ret = AIRSPY_ERROR_NOT_FOUND;
+        return;
+    }
+
+    for (pass = ENUM_PATH_MATCH; pass <= ENUM_PATH_OTHER && device->usb_device == NULL; pass++)
+    {
+        i = 0;
+        while ((dev = devices[i++]) != NULL)
+        {
+            libusb_get_device_descriptor(dev, &device_descriptor);
+
+            if ((device_descriptor.idVendor != vid) ||
+                (device_descriptor.idProduct != pid))
+            {
+                continue;
+            }
+
+            if (serial_number_val == SERIAL_NUMBER_UNUSED)
+            {
+                /* Any device will do, a single pass is enough */
+                if (pass != ENUM_PATH_MATCH || libusb_open(dev, &dev_handle) != 0)
+                {
+                    continue;
+                }
+            }
+            else
+            {
+                airspy_get_bus_path(dev, &path);
+                if (enum_cache_classify(&path, serial_number_val) != pass)
+                {
+                    continue;
+                }
+
+                if (libusb_open(dev, &dev_handle) != 0)
+                {
+                    continue;
+                }
+
+                if (airspy_read_serial_number(dev_handle, device_descriptor.iSerialNumber, &serial_number_read) != AIRSPY_SUCCESS)
+                {
+                    libusb_close(dev_handle);
+                    continue;
+                }
+
+                enum_cache_store(&path, serial_number_read);
+
+                if (serial_number_read != serial_number_val)
+                {
+                    libusb_close(dev_handle);
+                    continue;
+                }
+            }
+
+            if (airspy_claim_device(dev_handle) != AIRSPY_SUCCESS)
+            {
+                libusb_close(dev_handle);
+                continue;
+            }
+
+            device->usb_device = dev_handle;
+            break;
+        }
+    }
+    libusb_free_device_list(devices, 1);
+
+    if (device->usb_device == NULL)
+    {
+        *ret = AIRSPY_ERROR_NOT_FOUND;
+        return;
+    }
+
+    *ret = AIRSPY_SUCCESS;
+    return;
+}
+
+static int airspy_read_samplerates_from_fw(struct airspy_device* device, uint32_t* buffer, const uint32_t len)
+{
+    int result;
+
+    result = airspy_control_transfer(
+        device,
+        LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+        AIRSPY_GET_SAMPLERATES,
+        0,
+        len,
+        (unsigned char*)buffer,
+        (len > 0 ? len : 1) * sizeof(uint32_t),
+        0);
+
+    if (result < 1)
+    {
+        return AIRSPY_ERROR_OTHER;
+    }
+
+    return AIRSPY_SUCCESS;
+}
+
+static int airspy_load_samplerates(airspy_device_t* device)
+{
+    int result;
+
+    if (device->supported_samplerates != NULL)
+    {
+        return AIRSPY_SUCCESS;
+    }
+
+    result = airspy_read_samplerates_from_fw(device, &device->supported_samplerate_count, 0);
+    if (result == AIRSPY_SUCCESS && device->supported_samplerate_count > 0)
+    {
+        device->supported_samplerates = (uint32_t *) malloc(device->supported_samplerate_count * sizeof(uint32_t));
+        if (device->supported_samplerates == NULL)
+        {
+            return AIRSPY_ERROR_NO_MEM;
+        }
+
+        result = airspy_read_samplerates_from_fw(device, device->supported_samplerates, device->supported_samplerate_count);
+        if (result != AIRSPY_SUCCESS)
+        {
+            free(device->supported_samplerates);
+            device->supported_samplerates = NULL;
+        }
+    }
+    else
+    {
+        result = AIRSPY_ERROR_OTHER;
+    }
+
+    if (result != AIRSPY_SUCCESS)
+    {
+        device->supported_samplerate_count = 2;
+        device->supported_samplerates = (uint32_t *) malloc(device->supported_samplerate_count * sizeof(uint32_t));
+        if (device->supported_samplerates == NULL)
+        {
+            return AIRSPY_ERROR_NO_MEM;
+        }
+        device->supported_samplerates[0] = 10000000;
+        device->supported_samplerates[1] = 2500000;
+    }
+
+    if (device->samplerate == 0)
+    {
+        device->samplerate = device->supported_samplerates[0];
+    }
+
+    return AIRSPY_SUCCESS;
+}
+
+static int airspy_open_init(airspy_device_t** device, uint64_t serial_number)
+{
+    airspy_device_t* lib_device;
+    int libusb_error;
+    int result;
+
+    *device = NULL;
+
+    lib_device = (airspy_device_t*)calloc(1, sizeof(airspy_device_t));
+    if (lib_device == NULL)
+    {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    libusb_error = libusb_init(&lib_device->usb_context);
+    if (libusb_error != 0)
+    {
+        free(lib_device);
+        return AIRSPY_ERROR_LIBUSB;
+    }
+
+    airspy_open_device(lib_device,
+        &result,
+        airspy_usb_vid,
+        airspy_usb_pid,
+        serial_number);
+    if (lib_device->usb_device == NULL)
+    {
+        libusb_exit(lib_device->usb_context);
+        free(lib_device);
+        return result;
+    }
+
+    pthread_mutex_init(&lib_device->record_lock, NULL);
+
+    lib_device->transport = &usb_transport;
+    lib_device->transport_handle = lib_device;
     lib_device->transfers = NULL;
     lib_device->callback = NULL;
     lib_device->transfer_count = 16;
-    lib_device->buffer_size = 262144;
+    lib_device->buffer_size = DEFAULT_BUFFER_SIZE;
     lib_device->packing_enabled = false;
     lib_device->streaming = false;
     lib_device->stop_requested = false;
 
-    result = airspy_read_samplerates_from_fw(lib_device, &lib_device->supported_samplerate_count, 0);
-    if (result == AIRSPY_SUCCESS)
+    /* Without hotplug support a departure is still noticed from the transfer status */
+    if (libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG))
+    {
+        lib_device->hotplug_registered = libusb_hotplug_register_callback(lib_device->usb_context,
+            LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+            LIBUSB_HOTPLUG_NO_FLAGS,
+            airspy_usb_vid,
+            airspy_usb_pid,
+            LIBUSB_HOTPLUG_MATCH_ANY,
+            airspy_hotplug_callback,
+            lib_device,
+            &lib_device->hotplug_handle) == LIBUSB_SUCCESS;
+    }
+
+    /*
+     * The samplerate list and the transfers are set up on first use (see
+     * airspy_load_samplerates() and airspy_init_rx()) to keep opening cheap.
+     */
+    airspy_set_packing(lib_device, 0);
+
+    /* Initialize the sample converter */
+    if (0 != iqconverter_int16_init(&lib_device->conv, HB_KERNEL_INT16, HB_KERNEL_INT16_LEN)) {
+        airspy_open_exit(lib_device);
+        pthread_mutex_destroy(&lib_device->record_lock);
+        free(lib_device);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    *device = lib_device;
+
+    return AIRSPY_SUCCESS;
+}
+
+static bool airspy_standby_usable(airspy_device_t* device)
+{
+    return device->standby != NULL && !device->standby_departed;
+}
+
+/* A standby that missed a configuration change can't be swapped in blindly any more */
+static void airspy_check_standby(airspy_device_t* device, int result)
+{
+    if (result != AIRSPY_SUCCESS)
+    {
+        device->standby_departed = true;
+    }
+}
+
+static void airspy_dispatch_events(airspy_device_t* device)
+{
+    int event;
+    uint32_t events;
+
+    if (device->standby_departed && !device->standby_lost_reported)
+    {
+        device->standby_lost_reported = true;
+        device->pending_events |= EVENT_PENDING(AIRSPY_EVENT_STANDBY_LOST);
+    }
+
+    events = device->pending_events;
+    device->pending_events = 0;
+
+    if (device->event_callback == NULL)
+    {
+        return;
+    }
+
+    for (event = AIRSPY_EVENT_DEVICE_ARRIVED; event <= AIRSPY_EVENT_BUFFERS_EXHAUSTED; event++)
+    {
+        if (events & EVENT_PENDING(event))
+        {
+            device->event_callback(device, device->event_ctx, (enum airspy_event)event);
+        }
+    }
+}
+
+typedef struct {
+    airspy_device_t** device;
+    uint64_t serial_number;
+    int result;
+} open_job_t;
+
+static void* airspy_open_worker(void* arg)
+{
+    open_job_t* job = (open_job_t*)arg;
+
+    job->result = airspy_open_init(job->device, job->serial_number);
+
+    return NULL;
+}
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    void ADDCALL airspy_lib_version(airspy_lib_version_t* lib_version)
+    {
+        lib_version->major_version = AIRSPY_VER_MAJOR;
+        lib_version->minor_version = AIRSPY_VER_MINOR;
+        lib_version->revision = AIRSPY_VER_REVISION;
+    }
+
+    /* airspy_init() deprecated */
+    int ADDCALL airspy_init(void)
+    {
+        return AIRSPY_SUCCESS;
+    }
+
+    /* airspy_exit() deprecated */
+    int ADDCALL airspy_exit(void)
+    {
+        return AIRSPY_SUCCESS;
+    }
+
+    int ADDCALL airspy_open_sn(airspy_device_t** device, uint64_t serial_number)
+    {
+        int result;
+
+        result = airspy_open_init(device, serial_number);
+        return result;
+    }
+
+    int ADDCALL airspy_open(airspy_device_t** device)
+    {
+        int result;
+
+        result = airspy_open_init(device, SERIAL_NUMBER_UNUSED);
+        return result;
+    }
+
+    int ADDCALL airspy_open_file(airspy_device_t** device, const char* path, const airspy_file_params_t* params)
+    {
+        airspy_device_t* lib_device;
+        double meta_samplerate;
+        int meta_packed;
+        uint32_t samplerate;
+        int packed;
+        int result;
+
+        *device = NULL;
+
+        if (path == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+
+        samplerate = params != NULL ? params->samplerate : 0;
+        packed = params != NULL ? params->packed : 0;
+        if (samplerate == 0)
+        {
+            if (file_source_read_meta(path, &meta_samplerate, &meta_packed) != 0)
+            {
+                return AIRSPY_ERROR_INVALID_PARAM;
+            }
+            /* Raw captures are described at the real ADC rate */
+            samplerate = (uint32_t)(meta_samplerate / 2 + 0.5);
+            packed = meta_packed;
+            if (samplerate == 0)
+            {
+                return AIRSPY_ERROR_INVALID_PARAM;
+            }
+        }
+
+        lib_device = (airspy_device_t*)calloc(1, sizeof(airspy_device_t));
+        if (lib_device == NULL)
+        {
+            return AIRSPY_ERROR_NO_MEM;
+        }
+
+        lib_device->supported_samplerates = (uint32_t*)malloc(sizeof(uint32_t));
+        if (lib_device->supported_samplerates == NULL)
+        {
+            free(lib_device);
+            return AIRSPY_ERROR_NO_MEM;
+        }
+        lib_device->supported_samplerates[0] = samplerate;
+        lib_device->supported_samplerate_count = 1;
+        lib_device->samplerate = samplerate;
+
+        result = file_source_open(&lib_device->file, path);
+        if (result != AIRSPY_SUCCESS)
+        {
+            free(lib_device->supported_samplerates);
+            free(lib_device);
+            return result;
+        }
+
+        pthread_mutex_init(&lib_device->record_lock, NULL);
+
+        lib_device->transport = &replay_transport;
+        lib_device->transport_handle = lib_device;
+        lib_device->file_flags = params != NULL ? params->flags : 0;
+        /* Blocks are delivered one at a time, a single buffer will do */
+        lib_device->transfer_count = 1;
+        lib_device->buffer_size = DEFAULT_BUFFER_SIZE;
+        /* Compressed captures decode to unpacked samples whatever they were recorded from */
+        airspy_set_packing(lib_device, packed != 0 && !file_source_compressed(lib_device->file));
+
+        if (0 != iqconverter_int16_init(&lib_device->conv, HB_KERNEL_INT16, HB_KERNEL_INT16_LEN)) {
+            airspy_close(lib_device);
+            return AIRSPY_ERROR_NO_MEM;
+        }
+
+        *device = lib_device;
+
+        return AIRSPY_SUCCESS;
+    }
+
+    int ADDCALL airspy_convert_file(const char* input_path, const char* output_path, const airspy_convert_params_t* params)
+    {
+        return convert_file(input_path, output_path, params, HB_KERNEL_INT16, HB_KERNEL_INT16_LEN);
+    }
+
+    int ADDCALL airspy_seek_file(airspy_device_t* device, uint64_t sample)
+    {
+        if (device->file == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+
+        /* Taken up by the streaming thread before its next block */
+        __atomic_store_n(&device->file_seek, sample + 1, __ATOMIC_RELEASE);
+
+        return AIRSPY_SUCCESS;
+    }
+
+    int ADDCALL airspy_compress_capture(const char* input_path, const char* output_path, uint8_t packed)
+    {
+        return convert_compress(input_path, output_path, packed != 0);
+    }
+
+    int ADDCALL airspy_expand_capture(const char* input_path, const char* output_path)
+    {
+        return convert_expand(input_path, output_path);
+    }
+
+    int ADDCALL airspy_open_sim(airspy_device_t** device, const airspy_sim_params_t* params)
+    {
+        airspy_device_t* lib_device;
+        int result;
+
+        *device = NULL;
+
+        lib_device = (airspy_device_t*)calloc(1, sizeof(airspy_device_t));
+        if (lib_device == NULL)
+        {
+            return AIRSPY_ERROR_NO_MEM;
+        }
+
+        result = sim_open(&lib_device->sim, params);
+        if (result != AIRSPY_SUCCESS)
+        {
+            free(lib_device);
+            return result;
+        }
+
+        pthread_mutex_init(&lib_device->record_lock, NULL);
+
+        lib_device->transport = &sim_transport;
+        lib_device->transport_handle = lib_device->sim;
+        lib_device->transfer_count = 16;
+        lib_device->buffer_size = DEFAULT_BUFFER_SIZE;
+        airspy_set_packing(lib_device, 0);
+
+        if (0 != iqconverter_int16_init(&lib_device->conv, HB_KERNEL_INT16, HB_KERNEL_INT16_LEN)) {
+            airspy_close(lib_device);
+            return AIRSPY_ERROR_NO_MEM;
+        }
+
+        *device = lib_device;
+
+        return AIRSPY_SUCCESS;
+    }
+
+    int ADDCALL airspy_list_devices(uint64_t* serials, int count)
+    {
+        int i;
+        int output_count;
+        libusb_context* context;
+        libusb_device* dev;
+        libusb_device** devices = NULL;
+        libusb_device_handle* dev_handle;
+        struct libusb_device_descriptor device_descriptor;
+        enum_cache_entry_t path;
+        uint64_t serial_number_val;
+
+        if (serials == NULL && count != 0)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+
+        if (libusb_init(&context) != 0)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+
+        if (libusb_get_device_list(context, &devices) < 0)
+        {
+            libusb_exit(context);
+            return AIRSPY_ERROR_LIBUSB;
+        }
+
+        output_count = 0;
+        i = 0;
+        while ((dev = devices[i++]) != NULL && (count == 0 || output_count < count))
+        {
+            libusb_get_device_descriptor(dev, &device_descriptor);
+
+            if ((device_descriptor.idVendor != airspy_usb_vid) ||
+                (device_descriptor.idProduct != airspy_usb_pid))
+            {
+                continue;
+            }
+
+            /* Only devices on a bus path we haven't seen yet need to be opened */
+            airspy_get_bus_path(dev, &path);
+            if (!enum_cache_lookup(&path, &serial_number_val))
+            {
+                if (libusb_open(dev, &dev_handle) != 0)
+                {
+                    continue;
+                }
+
+                if (airspy_read_serial_number(dev_handle, device_descriptor.iSerialNumber, &serial_number_val) != AIRSPY_SUCCESS)
+                {
+                    libusb_close(dev_handle);
+                    continue;
+                }
+
+                libusb_close(dev_handle);
+                enum_cache_store(&path, serial_number_val);
+            }
+
+            if (serials != NULL)
+            {
+                serials[output_count] = serial_number_val;
+            }
+            output_count++;
+        }
+
+        libusb_free_device_list(devices, 1);
+        libusb_exit(context);
+
+        return output_count;
+    }
+
+    int ADDCALL airspy_open_devices(airspy_device_t** devices, const uint64_t* serial_numbers, int count, int* results)
+    {
+        int i;
+        int result;
+        open_job_t* jobs;
+        pthread_t* threads;
+        bool* started;
+
+        if (devices == NULL || count <= 0)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+
+        jobs = (open_job_t*)calloc(count, sizeof(open_job_t));
+        threads = (pthread_t*)calloc(count, sizeof(pthread_t));
+        started = (bool*)calloc(count, sizeof(bool));
+        if (jobs == NULL || threads == NULL || started == NULL)
+        {
+            free(jobs);
+            free(threads);
+            free(started);
+            return AIRSPY_ERROR_NO_MEM;
+        }
+
+        /* Each device has its own libusb context, so the opens only contend on the kernel */
+        for (i = 0; i < count; i++)
+        {
+            jobs[i].device = &devices[i];
+            jobs[i].serial_number = serial_numbers != NULL ? serial_numbers[i] : SERIAL_NUMBER_UNUSED;
+            started[i] = pthread_create(&threads[i], NULL, airspy_open_worker, &jobs[i]) == 0;
+        }
+
+        result = AIRSPY_SUCCESS;
+        for (i = 0; i < count; i++)
+        {
+            if (started[i])
+            {
+                pthread_join(threads[i], NULL);
+            }
+            else
+            {
+                airspy_open_worker(&jobs[i]);
+            }
+
+            if (results != NULL)
+            {
+                results[i] = jobs[i].result;
+            }
+
+            if (jobs[i].result != AIRSPY_SUCCESS && result == AIRSPY_SUCCESS)
+            {
+                result = jobs[i].result;
+            }
+        }
+
+        free(jobs);
+        free(threads);
+        free(started);
+
+        return result;
+    }
+
+    int ADDCALL airspy_close(airspy_device_t* device)
+    {
+        int result;
+
+        result = AIRSPY_SUCCESS;
+
+        if (device != NULL)
+        {
+            result = airspy_term_rx(device);
+
+            if (device->sweep != NULL)
+            {
+                sweep_free(device->sweep);
+            }
+
+            airspy_stop_recording(device);
+            airspy_stop_trigger_capture(device);
+            squelch_free(device->squelch);
+
+            /* These share our USB context, so they have to go first */
+            airspy_detach_standby(device);
+
+            airspy_open_exit(device);
+            free_transfers(device);
+            convert_pool_destroy(device->pool);
+            loan_pool_destroy(device->loans);
+            airspy_stop_broker(device);
+            airspy_stop_server(device);
+            fanout_free(device->fanout);
+            iqconverter_int16_free(&device->conv);
+            free(device->output);
+            free(device->supported_samplerates);
+            pthread_mutex_destroy(&device->record_lock);
+            free(device);
+        }
+
+        return result;
+    }
+
+    int ADDCALL airspy_get_samplerates(struct airspy_device* device, uint32_t* buffer, const uint32_t len)
+    {
+        int result;
+
+        result = airspy_load_samplerates(device);
+        if (result != AIRSPY_SUCCESS)
+        {
+            return result;
+        }
+
+        if (len == 0)
+        {
+            *buffer = device->supported_samplerate_count;
+        }
+        else if (len <= device->supported_samplerate_count)
+        {
+            memcpy(buffer, device->supported_samplerates, len * sizeof(uint32_t));
+        }
+        else
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+
+        return AIRSPY_SUCCESS;
+    }
+
+    int ADDCALL airspy_set_samplerate(airspy_device_t* device, uint32_t samplerate)
+    {
+        int result;
+        uint8_t retval;
+        uint8_t length;
+        uint32_t i;
+        uint32_t samplerate_hz;
+
+        result = airspy_load_samplerates(device);
+        if (result != AIRSPY_SUCCESS)
+        {
+            return result;
+        }
+
+        samplerate_hz = samplerate;
+        if (samplerate < device->supported_samplerate_count)
+        {
+            samplerate_hz = device->supported_samplerates[samplerate];
+        }
+
+        if (samplerate >= MIN_SAMPLERATE_BY_VALUE)
+        {
+            for (i = 0; i < device->supported_samplerate_count; i++)
+            {
+                if (samplerate == device->supported_samplerates[i])
+                {
+                    samplerate = i;
+                    break;
+                }
+            }
+
+            if (samplerate >= MIN_SAMPLERATE_BY_VALUE)
+            {
+                samplerate /= 1000;
+            }
+        }
+
+        device->transport->clear_halt(device->transport_handle, LIBUSB_ENDPOINT_IN | 1);
+
+        length = 1;
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_SET_SAMPLERATE,
+            0,
+            samplerate,
+            &retval,
+            length,
+            0
+            );
+
+        if (result < length) {
+            return AIRSPY_ERROR_LIBUSB;
+        } else {
+            device->samplerate = samplerate_hz;
+            device->config.samplerate = samplerate_hz;
+            device->config.valid |= CONFIG_SAMPLERATE;
+            if (airspy_standby_usable(device))
+            {
+                airspy_check_standby(device, airspy_set_samplerate(device->standby, samplerate_hz));
+            }
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_set_receiver_mode(airspy_device_t* device, receiver_mode_t value)
+    {
+        int result;
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_RECEIVER_MODE,
+            value,
+            0,
+            NULL,
+            0,
+            0
+            );
+
+        if (result != 0) {
+            return AIRSPY_ERROR_LIBUSB;
+        } else {
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    static int airspy_start_streaming(airspy_device_t* device)
+    {
+        int result;
+
+        if (device->file != NULL)
+        {
+            /* Playback carries on from where the last stream stopped */
+            airspy_reset_converter(device);
+            device->replay_start_us = airspy_now_us();
+            device->replay_samples = 0;
+            return AIRSPY_SUCCESS;
+        }
+
+        result = airspy_set_receiver_mode(device, RECEIVER_MODE_OFF);
+        if (result != AIRSPY_SUCCESS)
+        {
+            return result;
+        }
+
+        device->transport->clear_halt(device->transport_handle, LIBUSB_ENDPOINT_IN | 1);
+
+        airspy_reset_converter(device);
+
+        result = airspy_set_receiver_mode(device, RECEIVER_MODE_RX);
+        if (result != AIRSPY_SUCCESS) {
+            return result;
+        }
+
+        /* Every transfer is submitted afresh, including any parked for recovery */
+        device->failed_count = 0;
+        device->failed_stall = false;
+
+        return prepare_transfers(device, LIBUSB_ENDPOINT_IN | 1, (libusb_transfer_cb_fn)airspy_libusb_transfer_callback);
+    }
+
+    /*
+     * Put the standby's handle in place of the departed one. The old handle is
+     * parked in the retired standby and only closed by a later attach, detach
+     * or close, so a setter racing with the swap never touches a freed handle.
+     */
+    static int airspy_swap_standby(airspy_device_t* device)
+    {
+        airspy_device_t* standby;
+        libusb_device_handle* departed_handle;
+        uint32_t transfer_index;
+
+        if (!airspy_standby_usable(device))
+        {
+            return AIRSPY_ERROR_NOT_FOUND;
+        }
+
+        if (device->retired != NULL)
+        {
+            airspy_close(device->retired);
+        }
+
+        standby = device->standby;
+        departed_handle = device->usb_device;
+        device->usb_device = standby->usb_device;
+        standby->usb_device = departed_handle;
+
+        device->standby = NULL;
+        device->retired = standby;
+        device->departed = false;
+
+        if (device->transfers != NULL)
+        {
+            for (transfer_index = 0; transfer_index < device->transfer_count; transfer_index++)
+            {
+                device->transfers[transfer_index]->dev_handle = device->usb_device;
+            }
+        }
+
+        return AIRSPY_SUCCESS;
+    }
+
+    /*
+     * Called from airspy_do_rx() once the streaming device is gone. Waits for
+     * every transfer to come back, then either restarts the stream on the
+     * standby (whose configuration already matches) or gives up.
+     */
+    static int airspy_handle_departure(airspy_device_t* device)
+    {
+        if (device->transfers_in_flight > 0)
+        {
+            cancel_transfers(device);
+            return AIRSPY_SUCCESS;
+        }
+
+        if (airspy_swap_standby(device) == AIRSPY_SUCCESS &&
+            airspy_start_streaming(device) == AIRSPY_SUCCESS)
+        {
+            device->pending_events |= EVENT_PENDING(AIRSPY_EVENT_FAILOVER);
+            return AIRSPY_SUCCESS;
+        }
+
+        device->streaming = false;
+        device->pending_events |= EVENT_PENDING(AIRSPY_EVENT_DEVICE_LEFT);
+        return AIRSPY_ERROR_STREAMING_STOPPED;
+    }
+
+    /*
+     * Called from airspy_do_rx() while transfers are parked as failed. A
+     * first round keeps the receiver and converter running: the lost blocks
+     * are whole transfers, so the fs/4 translation stays in phase and only
+     * the filter history spans the gap. A stall needs the halt cleared,
+     * which is only done once the endpoint is quiet. If a round fails again
+     * before a block gets through, the receiver is restarted and the
+     * converter reset with it.
+     */
+    static int airspy_recover_stream(airspy_device_t* device)
+    {
+        int result;
+        bool restart;
+        uint32_t i;
+
+        restart = device->recovery_attempts > 0;
+
+        if ((device->failed_stall || restart) && device->transfers_in_flight > 0)
+        {
+            /* Cancelled transfers come back as failed and join this round */
+            cancel_transfers(device);
+            return AIRSPY_SUCCESS;
+        }
+
+        device->recovery_attempts++;
+        if (device->recovery_attempts > device->recovery_max_attempts)
+        {
+            device->stats.failed_recoveries++;
+            device->streaming = false;
+            return AIRSPY_ERROR_STREAMING_STOPPED;
+        }
+
+        if (restart)
+        {
+            result = airspy_set_receiver_mode(device, RECEIVER_MODE_OFF);
+            if (result == AIRSPY_SUCCESS)
+            {
+                device->transport->clear_halt(device->transport_handle, LIBUSB_ENDPOINT_IN | 1);
+                airspy_reset_converter(device);
+                result = airspy_set_receiver_mode(device, RECEIVER_MODE_RX);
+            }
+            if (result != AIRSPY_SUCCESS)
+            {
+                device->stats.failed_recoveries++;
+                device->streaming = false;
+                return AIRSPY_ERROR_STREAMING_STOPPED;
+            }
+        }
+        else if (device->failed_stall)
+        {
+            device->transport->clear_halt(device->transport_handle, LIBUSB_ENDPOINT_IN | 1);
+        }
+        device->failed_stall = false;
+
+        for (i = 0; i < device->failed_count; i++)
+        {
+            if (device->transport->submit(device->transport_handle, device->failed_transfers[i]) != 0)
+            {
+                device->stats.failed_recoveries++;
+                device->streaming = false;
+                return AIRSPY_ERROR_STREAMING_STOPPED;
+            }
+            device->transfers_in_flight++;
+        }
+        device->failed_count = 0;
+        device->recovery_resubmitted = true;
+
+        return AIRSPY_SUCCESS;
+    }
+
+    /*
+     * Enable receiving with the given Airspy device.
+     */
+    int ADDCALL airspy_init_rx(airspy_device_t* device)
+    {
+        int result;
+        size_t loan_size;
+
+        device->departed = false;
+        device->recovery_attempts = 0;
+        device->recovery_resubmitted = false;
+        device->failure_time_us = 0;
+        device->sample_index = 0;
+        device->pending_dropped = 0;
+        memset(&device->stats, 0, sizeof(device->stats));
+        device->paused = false;
+        device->pause_request_us = 0;
+        device->resume_request_us = 0;
+        device->converter_stale = false;
+        device->loans_exhausted = false;
+
+        if (device->transfers == NULL)
+        {
+            result = allocate_transfers(device);
+            if (result != AIRSPY_SUCCESS)
+            {
+                free_transfers(device);
+                return result;
+            }
+        }
+
+        if (device->conversion_threads > 0 && device->pool == NULL)
+        {
+            result = convert_pool_create(&device->pool, device->conversion_threads, device->buffer_size,
+                device->packing_enabled, HB_KERNEL_INT16, HB_KERNEL_INT16_LEN);
+            if (result != AIRSPY_SUCCESS)
+            {
+                return result;
+            }
+        }
+
+        if (device->loan_count > 0)
+        {
+            /* Loaned buffers trade places with the blocks they carry, so they are the size of whatever holds those */
+            if (device->pool != NULL)
+            {
+                loan_size = convert_pool_storage_bytes(device->pool);
+            }
+            else
+            {
+                loan_size = airspy_block_samples(device) * 2 * sizeof(int16_t);
+            }
+
+            if (device->loans != NULL && loan_pool_size(device->loans) != loan_size)
+            {
+                if (loan_pool_outstanding(device->loans) > 0)
+                {
+                    return AIRSPY_ERROR_BUSY;
+                }
+                loan_pool_destroy(device->loans);
+                device->loans = NULL;
+            }
+
+            if (device->loans == NULL)
+            {
+                result = loan_pool_create(&device->loans, device->loan_count, loan_size);
+                if (result != AIRSPY_SUCCESS)
+                {
+                    return result;
+                }
+            }
+        }
+
+        if (device->squelch != NULL)
+        {
+            squelch_reset(device->squelch, device->samplerate);
+        }
+        device->real_dc_valid = false;
+
+        if (device->fanout != NULL)
+        {
+            result = fanout_start(device->fanout, airspy_block_samples(device), device->buffer_size);
+            if (result != AIRSPY_SUCCESS)
+            {
+                return result;
+            }
+        }
+
+        result = airspy_start_streaming(device);
+        if (result != AIRSPY_SUCCESS) {
+            return result;
+        }
+
+        device->streaming = true;
+        device->stop_requested = false;
+
+        /* We're now ready to receive samples, so call do_rx from your worker thread. */
+        return result;
+    }
+
+    /*
+     * The virtual device's stand-in for USB event handling: deliver the next
+     * block of the file, after waiting for its due time when paced.
+     */
+    static int airspy_replay_block(airspy_device_t* device)
+    {
+        const uint8_t* block;
+        unsigned char* buffer;
+        uint64_t due_us;
+        uint64_t now_us;
+        uint64_t seek;
+
+        seek = __atomic_exchange_n(&device->file_seek, 0, __ATOMIC_ACQUIRE);
+        if (seek != 0)
+        {
+            /* The file holds real samples, two per IQ sample */
+            device->sample_index = file_source_seek(device->file, seek - 1, device->packing_enabled) / 2;
+            device->converter_stale = true;
+            device->replay_seeked = true;
+        }
+
+        block = file_source_next(device->file, device->buffer_size, (device->file_flags & AIRSPY_FILE_LOOP) != 0);
+        if (block == NULL)
+        {
+            device->streaming = false;
+            return AIRSPY_SUCCESS;
+        }
+
+        if (device->file_flags & AIRSPY_FILE_PACED)
+        {
+            due_us = device->replay_start_us + device->replay_samples * 1000000 / device->samplerate;
+            now_us = airspy_now_us();
+            if (due_us > now_us)
+            {
+                airspy_sleep_us(due_us - now_us);
+            }
+        }
+
+        if (device->packing_enabled)
+        {
+            /* Packed blocks are only read, straight from the mapping */
+            buffer = (unsigned char*)block;
+            airspy_process_block(device, &buffer);
+        }
+        else
+        {
+            /* Unpacked blocks are converted in place, so they need a private copy */
+            memcpy(device->transfers[0]->buffer, block, device->buffer_size);
+            airspy_process_block(device, &device->transfers[0]->buffer);
+        }
+        device->replay_samples += airspy_block_samples(device);
+
+        return AIRSPY_SUCCESS;
+    }
+
+    /*
+     * Perform RX. This function blocks until you disable receive, usually on a parent thread.
+     */
+    int ADDCALL airspy_do_rx(airspy_device_t* device, airspy_sample_block_cb_fn callback, void *ctx)
+    {
+        int result = 0;
+        struct timeval timeout = { 0, 500000 };
+
+        device->callback = callback;
+        device->ctx = ctx;
+
+        while (device->streaming && !device->stop_requested)
+        {
+            int error = device->transport->handle_events(device->transport_handle, &timeout);
+            if (error < 0)
+            {
+                if (error != LIBUSB_ERROR_INTERRUPTED) {
+                    device->streaming = false;
+                    result = AIRSPY_ERROR_STREAMING_STOPPED;
+                }
+            }
+
+            if (device->pool != NULL)
+            {
+                convert_pool_deliver(device->pool, airspy_pool_deliver, device);
+            }
+
+            if (device->sweep != NULL)
+            {
+                if (sweep_stop_requested(device->sweep))
+                {
+                    device->stop_requested = true;
+                }
+                else if (device->sweep_retune)
+                {
+                    /* Retune outside of the transfer callback; control transfers can't be issued from there */
+                    device->sweep_retune = false;
+                    if (airspy_set_freq(device, sweep_next_freq(device->sweep)) != AIRSPY_SUCCESS)
+                    {
+                        device->streaming = false;
+                        result = AIRSPY_ERROR_STREAMING_STOPPED;
+                    }
+                    else
+                    {
+                        sweep_retuned(device->sweep);
+                    }
+                }
+            }
+
+            if (device->departed && device->streaming && !device->stop_requested)
+            {
+                result = airspy_handle_departure(device);
+            }
+            else if (device->failed_count > 0 && device->streaming && !device->stop_requested)
+            {
+                result = airspy_recover_stream(device);
+            }
+
+            airspy_dispatch_events(device);
+        }
+
+        /* The tail of a stream that ended by itself, such as a replay reaching the end of the file */
+        if (device->pool != NULL)
+        {
+            convert_pool_drain(device->pool, airspy_pool_deliver, device);
+        }
+
+        airspy_dispatch_events(device);
+
+        return result;
+    }
+
+    /*
+     * Terminate sample reception
+     */
+    int ADDCALL airspy_term_rx(airspy_device_t* device)
+    {
+        int i;
+        struct timeval timeout = { 0, TERM_DRAIN_TIMEOUT_US };
+
+        device->stop_requested = true;
+
+        cancel_transfers(device);
+
+        /* Reap the cancelled transfers so the next airspy_init_rx() can submit them again */
+        for (i = 0; i < TERM_DRAIN_ATTEMPTS && device->transfers_in_flight > 0; i++)
+        {
+            if (device->transport->handle_events(device->transport_handle, &timeout) < 0)
+            {
+                break;
+            }
+        }
+
+        return airspy_set_receiver_mode(device, RECEIVER_MODE_OFF);
+    }
+
+    int ADDCALL airspy_si5351c_read(airspy_device_t* device, uint8_t register_number, uint8_t* value)
+    {
+        uint8_t temp_value;
+        int result;
+
+        temp_value = 0;
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_SI5351C_READ,
+            0,
+            register_number,
+            (unsigned char*)&temp_value,
+            1,
+            0);
+
+        if (result < 1)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            *value = temp_value;
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_si5351c_write(airspy_device_t* device, uint8_t register_number, uint8_t value)
+    {
+        int result;
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_SI5351C_WRITE,
+            value,
+            register_number,
+            NULL,
+            0,
+            0);
+
+        if (result != 0)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_r820t_read(airspy_device_t* device, uint8_t register_number, uint8_t* value)
+    {
+        int result;
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_R820T_READ,
+            0,
+            register_number,
+            (unsigned char*)value,
+            1,
+            0);
+
+        if (result < 1)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_r820t_write(airspy_device_t* device, uint8_t register_number, uint8_t value)
+    {
+        int result;
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_R820T_WRITE,
+            value,
+            register_number,
+            NULL,
+            0,
+            0);
+
+        if (result != 0)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_gpio_read(airspy_device_t* device, airspy_gpio_port_t port, airspy_gpio_pin_t pin, uint8_t* value)
+    {
+        int result;
+        uint8_t port_pin;
+
+        port_pin = ((uint8_t)port) << 5;
+        port_pin = port_pin | pin;
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_GPIO_READ,
+            0,
+            port_pin,
+            (unsigned char*)value,
+            1,
+            0);
+
+        if (result < 1)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_gpio_write(airspy_device_t* device, airspy_gpio_port_t port, airspy_gpio_pin_t pin, uint8_t value)
+    {
+        int result;
+        uint8_t port_pin;
+
+        port_pin = ((uint8_t)port) << 5;
+        port_pin = port_pin | pin;
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_GPIO_WRITE,
+            value,
+            port_pin,
+            NULL,
+            0,
+            0);
+
+        if (result != 0)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+
+    int ADDCALL airspy_gpiodir_read(airspy_device_t* device, airspy_gpio_port_t port, airspy_gpio_pin_t pin, uint8_t* value)
+    {
+        int result;
+        uint8_t port_pin;
+
+        port_pin = ((uint8_t)port) << 5;
+        port_pin = port_pin | pin;
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_GPIODIR_READ,
+            0,
+            port_pin,
+            (unsigned char*)value,
+            1,
+            0);
+
+        if (result < 1)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_gpiodir_write(airspy_device_t* device, airspy_gpio_port_t port, airspy_gpio_pin_t pin, uint8_t value)
+    {
+        int result;
+        uint8_t port_pin;
+
+        port_pin = ((uint8_t)port) << 5;
+        port_pin = port_pin | pin;
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_GPIODIR_WRITE,
+            value,
+            port_pin,
+            NULL,
+            0,
+            0);
+
+        if (result != 0)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_spiflash_erase(airspy_device_t* device)
+    {
+        int result;
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_SPIFLASH_ERASE,
+            0,
+            0,
+            NULL,
+            0,
+            0);
+
+        if (result != 0)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_spiflash_erase_sector(airspy_device_t* device, const uint16_t sector_num)
+    {
+        int result;
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_SPIFLASH_ERASE_SECTOR,
+            sector_num,
+            0,
+            NULL,
+            0,
+            0);
+
+        if (result != 0)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_spiflash_write(airspy_device_t* device, const uint32_t address, const uint16_t length, unsigned char* const data)
+    {
+        int result;
+
+        if (address > 0x0FFFFF)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_SPIFLASH_WRITE,
+            address >> 16,
+            address & 0xFFFF,
+            data,
+            length,
+            0);
+
+        if (result < length)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_spiflash_read(airspy_device_t* device, const uint32_t address, const uint16_t length, unsigned char* data)
+    {
+        int result;
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_SPIFLASH_READ,
+            address >> 16,
+            address & 0xFFFF,
+            data,
+            length,
+            0);
+
+        if (result < length)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_board_id_read(airspy_device_t* device, uint8_t* value)
+    {
+        int result;
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_BOARD_ID_READ,
+            0,
+            0,
+            value,
+            1,
+            0);
+
+        if (result < 1)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_version_string_read(airspy_device_t* device, char* version, uint8_t length)
+    {
+#define VERSION_LOCAL_SIZE (128)
+        int result;
+        char version_local[VERSION_LOCAL_SIZE];
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_VERSION_STRING_READ,
+            0,
+            0,
+            (unsigned char*)version_local,
+            (VERSION_LOCAL_SIZE - 1),
+            0);
+
+        if (result < 0)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else
+        {
+            if (length > 0)
+            {
+                memcpy(version, version_local, length - 1);
+                version[length - 1] = 0;
+                return AIRSPY_SUCCESS;
+            }
+            else
+            {
+                return AIRSPY_ERROR_INVALID_PARAM;
+            }
+        }
+    }
+
+    int ADDCALL airspy_board_partid_serialno_read(airspy_device_t* device, airspy_read_partid_serialno_t* read_partid_serialno)
+    {
+        uint8_t length;
+        int result;
+
+        length = sizeof(airspy_read_partid_serialno_t);
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_BOARD_PARTID_SERIALNO_READ,
+            0,
+            0,
+            (unsigned char*)read_partid_serialno,
+            length,
+            0);
+
+        if (result < length)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+
+            read_partid_serialno->part_id[0] = TO_LE(read_partid_serialno->part_id[0]);
+            read_partid_serialno->part_id[1] = TO_LE(read_partid_serialno->part_id[1]);
+            read_partid_serialno->serial_no[0] = TO_LE(read_partid_serialno->serial_no[0]);
+            read_partid_serialno->serial_no[1] = TO_LE(read_partid_serialno->serial_no[1]);
+            read_partid_serialno->serial_no[2] = TO_LE(read_partid_serialno->serial_no[2]);
+            read_partid_serialno->serial_no[3] = TO_LE(read_partid_serialno->serial_no[3]);
+
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_set_freq(airspy_device_t* device, const uint32_t freq_hz)
+    {
+        set_freq_params_t set_freq_params;
+        uint8_t length;
+        int result;
+
+        set_freq_params.freq_hz = TO_LE(freq_hz);
+        length = sizeof(set_freq_params_t);
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_SET_FREQ,
+            0,
+            0,
+            (unsigned char*)&set_freq_params,
+            length,
+            0
+            );
+
+        if (result < length)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            device->config.freq_hz = freq_hz;
+            device->config.valid |= CONFIG_FREQ;
+
+            pthread_mutex_lock(&device->record_lock);
+            if (device->recorder != NULL)
+            {
+                recorder_set_freq(device->recorder, freq_hz);
+            }
+            if (device->trigger != NULL)
+            {
+                trigger_set_freq(device->trigger, freq_hz);
+            }
+            pthread_mutex_unlock(&device->record_lock);
+
+            if (airspy_standby_usable(device))
+            {
+                airspy_check_standby(device, airspy_set_freq(device->standby, freq_hz));
+            }
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_set_lna_gain(airspy_device_t* device, uint8_t value)
+    {
+        int result;
+        uint8_t retval;
+        uint8_t length;
+
+        if (value > 14)
+            value = 14;
+
+        length = 1;
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_SET_LNA_GAIN,
+            0,
+            value,
+            &retval,
+            length,
+            0
+            );
+
+        if (result < length)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            device->config.lna_gain = value;
+            device->config.valid |= CONFIG_LNA_GAIN;
+            airspy_record_gain(device);
+            if (airspy_standby_usable(device))
+            {
+                airspy_check_standby(device, airspy_set_lna_gain(device->standby, value));
+            }
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_set_mixer_gain(airspy_device_t* device, uint8_t value)
+    {
+        int result;
+        uint8_t retval;
+        uint8_t length;
+
+        if (value > 15)
+            value = 15;
+
+        length = 1;
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_SET_MIXER_GAIN,
+            0,
+            value,
+            &retval,
+            length,
+            0
+            );
+
+        if (result < length)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            device->config.mixer_gain = value;
+            device->config.valid |= CONFIG_MIXER_GAIN;
+            airspy_record_gain(device);
+            if (airspy_standby_usable(device))
+            {
+                airspy_check_standby(device, airspy_set_mixer_gain(device->standby, value));
+            }
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_set_vga_gain(airspy_device_t* device, uint8_t value)
+    {
+        int result;
+        uint8_t retval;
+        uint8_t length;
+
+        if (value > 15)
+            value = 15;
+
+        length = 1;
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_SET_VGA_GAIN,
+            0,
+            value,
+            &retval,
+            length,
+            0
+            );
+
+        if (result < length)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            device->config.vga_gain = value;
+            device->config.valid |= CONFIG_VGA_GAIN;
+            airspy_record_gain(device);
+            if (airspy_standby_usable(device))
+            {
+                airspy_check_standby(device, airspy_set_vga_gain(device->standby, value));
+            }
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_set_lna_agc(airspy_device_t* device, uint8_t value)
+    {
+        int result;
+        uint8_t retval;
+        uint8_t length;
+
+        length = 1;
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_SET_LNA_AGC,
+            0,
+            value,
+            &retval,
+            length,
+            0
+            );
+
+        if (result < length)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            device->config.lna_agc = value;
+            device->config.valid |= CONFIG_LNA_AGC;
+            airspy_record_gain(device);
+            if (airspy_standby_usable(device))
+            {
+                airspy_check_standby(device, airspy_set_lna_agc(device->standby, value));
+            }
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_set_mixer_agc(airspy_device_t* device, uint8_t value)
+    {
+        int result;
+        uint8_t retval;
+        uint8_t length;
+
+        length = 1;
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_SET_MIXER_AGC,
+            0,
+            value,
+            &retval,
+            length,
+            0
+            );
+
+        if (result < length)
+        {
+            return AIRSPY_ERROR_LIBUSB;
+        }
+        else {
+            device->config.mixer_agc = value;
+            device->config.valid |= CONFIG_MIXER_AGC;
+            airspy_record_gain(device);
+            if (airspy_standby_usable(device))
+            {
+                airspy_check_standby(device, airspy_set_mixer_agc(device->standby, value));
+            }
+            return AIRSPY_SUCCESS;
+        }
+    }
+
+    int ADDCALL airspy_set_linearity_gain(struct airspy_device* device, uint8_t value)
+    {
+        int rc;
+        value = GAIN_COUNT - 1 - value;
+
+        if (value >= GAIN_COUNT)
+        {
+            value = GAIN_COUNT - 1;
+        }
+        else if (value < 0)
+        {
+            value = 0;
+        }
+
+        rc = airspy_set_mixer_agc(device, 0);
+        if (rc < 0)
+            return rc;
+
+        rc = airspy_set_lna_agc(device, 0);
+        if (rc < 0)
+            return rc;
+
+        rc = airspy_set_vga_gain(device, airspy_linearity_vga_gains[value]);
+        if (rc < 0)
+            return rc;
+
+        rc = airspy_set_mixer_gain(device, airspy_linearity_mixer_gains[value]);
+        if (rc < 0)
+            return rc;
+
+        rc = airspy_set_lna_gain(device, airspy_linearity_lna_gains[value]);
+        if (rc < 0)
+            return rc;
+
+        return AIRSPY_SUCCESS;
+    }
+
+    int ADDCALL airspy_set_sensitivity_gain(struct airspy_device* device, uint8_t value)
+    {
+        int rc;
+        value = GAIN_COUNT - 1 - value;
+
+        if (value >= GAIN_COUNT)
+        {
+            value = GAIN_COUNT - 1;
+        }
+        else if (value < 0)
+        {
+            value = 0;
+        }
+
+        rc = airspy_set_mixer_agc(device, 0);
+        if (rc < 0)
+            return rc;
+
+        rc = airspy_set_lna_agc(device, 0);
+        if (rc < 0)
+            return rc;
+
+        rc = airspy_set_vga_gain(device, airspy_sensitivity_vga_gains[value]);
+        if (rc < 0)
+            return rc;
+
+        rc = airspy_set_mixer_gain(device, airspy_sensitivity_mixer_gains[value]);
+        if (rc < 0)
+            return rc;
+
+        rc = airspy_set_lna_gain(device, airspy_sensitivity_lna_gains[value]);
+        if (rc < 0)
+            return rc;
+
+        return AIRSPY_SUCCESS;
+    }
+
+    int ADDCALL airspy_set_rf_bias(airspy_device_t* device, uint8_t value)
+    {
+        int result;
+
+        result = airspy_gpio_write(device, GPIO_PORT1, GPIO_PIN13, value);
+        if (result == AIRSPY_SUCCESS)
+        {
+            device->config.rf_bias = value;
+            device->config.valid |= CONFIG_RF_BIAS;
+            if (airspy_standby_usable(device))
+            {
+                airspy_check_standby(device, airspy_set_rf_bias(device->standby, value));
+            }
+        }
+
+        return result;
+    }
+
+    int ADDCALL airspy_set_packing(airspy_device_t* device, uint8_t value)
     {
-        lib_device->supported_samplerates = (uint32_t *) malloc(lib_device->supported_samplerate_count * sizeof(uint32_t));
-        result = airspy_read_samplerates_from_fw(lib_device, lib_device->supported_samplerates, lib_device->supported_samplerate_count);
-        if (result != AIRSPY_SUCCESS)
+        int result;
+        uint8_t retval;
+        bool packing_enabled;
+
+        /* Raw recordings, the trigger ring and the broker's readers assume the packing they started with */
+        if (device->streaming || device->sweep != NULL || ((device->broker != NULL || device->trigger != NULL ||
+                (device->recorder != NULL && device->record_format == AIRSPY_RECORD_RAW)) &&
+                (value != 0) != device->packing_enabled))
         {
-            free(lib_device->supported_samplerates);
+            return AIRSPY_ERROR_BUSY;
+        }
+
+        result = airspy_control_transfer(
+            device,
+            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+            AIRSPY_SET_PACKING,
+            0,
+            value,
+            &retval,
+            1,
+            0);
+
+        if (result < 1)
+        {
+            return  AIRSPY_ERROR_LIBUSB;
+        }
+
+        packing_enabled = value ? true : false;
+        if (packing_enabled != device->packing_enabled)
+        {
+            cancel_transfers(device);
+            free_transfers(device);
+            convert_pool_destroy(device->pool);
+            device->pool = NULL;
+
+            device->packing_enabled = packing_enabled;
+            device->buffer_size = packing_enabled ? PACKED_BUFFER_SIZE : DEFAULT_BUFFER_SIZE;
+        }
+
+        device->config.packing = value;
+        device->config.valid |= CONFIG_PACKING;
+        if (airspy_standby_usable(device))
+        {
+            airspy_check_standby(device, airspy_set_packing(device->standby, value));
         }
+
+        return AIRSPY_SUCCESS;
     }
 
-    if (result != AIRSPY_SUCCESS)
+    int ADDCALL airspy_start_sweep(airspy_device_t* device, const airspy_sweep_params_t* params, airspy_sweep_cb_fn callback, void* sweep_ctx)
     {
-        lib_device->supported_samplerate_count = 2;
-        lib_device->supported_samplerates = (uint32_t *) malloc(lib_device->supported_samplerate_count * sizeof(uint32_t));
-        lib_device->supported_samplerates[0] = 10000000;
-        lib_device->supported_samplerates[1] = 2500000;
+        int result;
+        uint32_t settle_samples;
+
+        if (params == NULL || callback == NULL || device->packing_enabled)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+
+        if ((device->streaming && !device->stop_requested) || device->sweep != NULL)
+        {
+            return AIRSPY_ERROR_BUSY;
+        }
+
+        result = airspy_load_samplerates(device);
+        if (result != AIRSPY_SUCCESS)
+        {
+            return result;
+        }
+
+        settle_samples = params->settle_samples;
+        if (settle_samples == 0)
+        {
+            /* Whatever was sampled before the retune can still be queued in the device and the transfer being filled */
+            settle_samples = SWEEP_SETTLE_TRANSFERS * (SWEEP_BUFFER_SIZE / (sizeof(uint16_t) * 2)) + device->samplerate / 1000;
+        }
+
+        result = sweep_init(&device->sweep, params, device->samplerate, settle_samples, device, callback, sweep_ctx);
+        if (result != AIRSPY_SUCCESS)
+        {
+            return result;
+        }
+
+        result = resize_transfers(device, SWEEP_BUFFER_SIZE);
+        if (result == AIRSPY_SUCCESS)
+        {
+            result = airspy_set_freq(device, sweep_next_freq(device->sweep));
+        }
+
+        if (result != AIRSPY_SUCCESS)
+        {
+            airspy_stop_sweep(device);
+            return result;
+        }
+
+        sweep_retuned(device->sweep);
+        device->sweep_retune = false;
+
+        return AIRSPY_SUCCESS;
     }
 
-    airspy_set_packing(lib_device, 0);
+    int ADDCALL airspy_stop_sweep(airspy_device_t* device)
+    {
+        int result;
 
-    result = allocate_transfers(lib_device);
-    if (result != 0)
+        if (device->streaming && !device->stop_requested)
+        {
+            return AIRSPY_ERROR_BUSY;
+        }
+
+        if (device->sweep == NULL)
+        {
+            return AIRSPY_SUCCESS;
+        }
+
+        result = resize_transfers(device, device->packing_enabled ? PACKED_BUFFER_SIZE : DEFAULT_BUFFER_SIZE);
+        if (result != AIRSPY_SUCCESS)
+        {
+            return result;
+        }
+
+        sweep_free(device->sweep);
+        device->sweep = NULL;
+
+        return AIRSPY_SUCCESS;
+    }
+
+    static int airspy_replay_config(airspy_device_t* device, const device_config_t* config)
     {
-        airspy_open_exit(lib_device);
-        free(lib_device->supported_samplerates);
-        free(lib_device);
-        return AIRSPY_ERROR_NO_MEM;
+        int result = AIRSPY_SUCCESS;
+
+        if (result == AIRSPY_SUCCESS && (config->valid & CONFIG_SAMPLERATE))
+        {
+            result = airspy_set_samplerate(device, config->samplerate);
+        }
+        if (result == AIRSPY_SUCCESS && (config->valid & CONFIG_PACKING))
+        {
+            result = airspy_set_packing(device, config->packing);
+        }
+        if (result == AIRSPY_SUCCESS && (config->valid & CONFIG_LNA_AGC))
+        {
+            result = airspy_set_lna_agc(device, config->lna_agc);
+        }
+        if (result == AIRSPY_SUCCESS && (config->valid & CONFIG_MIXER_AGC))
+        {
+            result = airspy_set_mixer_agc(device, config->mixer_agc);
+        }
+        if (result == AIRSPY_SUCCESS && (config->valid & CONFIG_LNA_GAIN))
+        {
+            result = airspy_set_lna_gain(device, config->lna_gain);
+        }
+        if (result == AIRSPY_SUCCESS && (config->valid & CONFIG_MIXER_GAIN))
+        {
+            result = airspy_set_mixer_gain(device, config->mixer_gain);
+        }
+        if (result == AIRSPY_SUCCESS && (config->valid & CONFIG_VGA_GAIN))
+        {
+            result = airspy_set_vga_gain(device, config->vga_gain);
+        }
+        if (result == AIRSPY_SUCCESS && (config->valid & CONFIG_RF_BIAS))
+        {
+            result = airspy_set_rf_bias(device, config->rf_bias);
+        }
+        if (result == AIRSPY_SUCCESS && (config->valid & CONFIG_FREQ))
+        {
+            result = airspy_set_freq(device, config->freq_hz);
+        }
+
+        return result;
     }
 
-    /* Initialize the sample converter */
-    if (0 != iqconverter_int16_init(&lib_device->conv, HB_KERNEL_INT16, HB_KERNEL_INT16_LEN)) {
-        return AIRSPY_ERROR_NO_MEM;
+    int ADDCALL airspy_set_recovery(airspy_device_t* device, uint32_t max_attempts)
+    {
+        device->recovery_max_attempts = max_attempts;
+
+        return AIRSPY_SUCCESS;
     }
 
-    *device = lib_device;
+    int ADDCALL airspy_set_conversion_threads(airspy_device_t* device, uint32_t threads)
+    {
+        if (device->streaming && !device->stop_requested)
+        {
+            return AIRSPY_ERROR_BUSY;
+        }
 
-    return AIRSPY_SUCCESS;
-}
+        if (threads != device->conversion_threads)
+        {
+            convert_pool_destroy(device->pool);
+            device->pool = NULL;
+            device->conversion_threads = threads;
+        }
 
-#ifdef __cplusplus
-extern "C"
-{
-#endif
+        return AIRSPY_SUCCESS;
+    }
 
-    void ADDCALL airspy_lib_version(airspy_lib_version_t* lib_version)
+    int ADDCALL airspy_set_sample_type(airspy_device_t* device, enum airspy_sample_type sample_type)
     {
-        lib_version->major_version = AIRSPY_VER_MAJOR;
-        lib_version->minor_version = AIRSPY_VER_MINOR;
-        lib_version->revision = AIRSPY_VER_REVISION;
+        if (device->streaming && !device->stop_requested)
+        {
+            return AIRSPY_ERROR_BUSY;
+        }
+
+        switch (sample_type)
+        {
+        case AIRSPY_SAMPLE_INT16_IQ:
+        case AIRSPY_SAMPLE_UINT16_MAG:
+        case AIRSPY_SAMPLE_UINT32_POWER:
+        case AIRSPY_SAMPLE_INT8_IQ:
+        case AIRSPY_SAMPLE_UINT16_REAL:
+        case AIRSPY_SAMPLE_INT16_REAL:
+        case AIRSPY_SAMPLE_INT16_REAL_DC:
+            device->sample_type = sample_type;
+            return AIRSPY_SUCCESS;
+
+        default:
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
     }
 
-    /* airspy_init() deprecated */
-    int ADDCALL airspy_init(void)
+    int ADDCALL airspy_set_buffer_loans(airspy_device_t* device, uint32_t buffers)
     {
+        if (device->streaming && !device->stop_requested)
+        {
+            return AIRSPY_ERROR_BUSY;
+        }
+
+        if (buffers != device->loan_count)
+        {
+            if (device->loans != NULL)
+            {
+                if (loan_pool_outstanding(device->loans) > 0)
+                {
+                    return AIRSPY_ERROR_BUSY;
+                }
+                loan_pool_destroy(device->loans);
+                device->loans = NULL;
+            }
+            device->loan_count = buffers;
+        }
+
         return AIRSPY_SUCCESS;
     }
 
-    /* airspy_exit() deprecated */
-    int ADDCALL airspy_exit(void)
+    int ADDCALL airspy_release_buffer(airspy_device_t* device, struct airspy_buffer* buffer)
     {
+        if (buffer == NULL || device->loans == NULL || loan_pool_release(device->loans, buffer) != 0)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+
         return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_open_sn(airspy_device_t** device, uint64_t serial_number)
+    int ADDCALL airspy_subscribe(airspy_device_t* device, const airspy_subscriber_params_t* params,
+        airspy_sample_block_cb_fn callback, void* ctx, struct airspy_subscriber** subscriber)
     {
+        airspy_subscriber_params_t sub;
         int result;
 
-        result = airspy_open_init(device, serial_number);
-        return result;
+        if (params == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+
+        if ((device->streaming && !device->stop_requested) || device->sweep != NULL)
+        {
+            return AIRSPY_ERROR_BUSY;
+        }
+
+        if (device->fanout == NULL)
+        {
+            result = fanout_create(&device->fanout, device);
+            if (result != AIRSPY_SUCCESS)
+            {
+                return result;
+            }
+        }
+
+        sub = *params;
+        sub.flags &= ~FANOUT_SUBSCRIBER_HOLD;
+
+        return fanout_subscribe(device->fanout, &sub, callback, ctx, subscriber);
     }
 
-    int ADDCALL airspy_open(airspy_device_t** device)
+    int ADDCALL airspy_unsubscribe(airspy_device_t* device, struct airspy_subscriber* subscriber)
     {
-        int result;
+        if (device->fanout == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
 
-        result = airspy_open_init(device, SERIAL_NUMBER_UNUSED);
-        return result;
+        if (device->streaming && !device->stop_requested)
+        {
+            return AIRSPY_ERROR_BUSY;
+        }
+
+        return fanout_unsubscribe(device->fanout, subscriber);
     }
 
-    int ADDCALL airspy_close(airspy_device_t* device)
+    int ADDCALL airspy_get_subscriber_stats(airspy_device_t* device, struct airspy_subscriber* subscriber,
+        airspy_subscriber_stats_t* stats)
+    {
+        if (device->fanout == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+
+        return fanout_get_stats(device->fanout, subscriber, stats);
+    }
+
+    int ADDCALL airspy_start_broker(airspy_device_t* device, const airspy_broker_params_t* params)
     {
+        airspy_subscriber_params_t sub;
+        size_t slot_bytes;
         int result;
 
-        result = AIRSPY_SUCCESS;
+        if (params == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
 
-        if (device != NULL)
+        if ((device->streaming && !device->stop_requested) || device->sweep != NULL || device->broker != NULL)
         {
-            result = airspy_term_rx(device);
+            return AIRSPY_ERROR_BUSY;
+        }
 
-            airspy_open_exit(device);
-            free_transfers(device);
-            iqconverter_int16_free(&device->conv);
-            free(device->supported_samplerates);
-            free(device);
+        memset(&sub, 0, sizeof(sub));
+        sub.format = params->format;
+        sub.decimation = params->decimation;
+        sub.fft_size = params->fft_size;
+        sub.flags = AIRSPY_SUBSCRIBER_INLINE;
+
+        slot_bytes = fanout_block_bytes(&sub, airspy_block_samples(device), device->buffer_size);
+        if (slot_bytes == 0)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+
+        if (device->fanout == NULL)
+        {
+            result = fanout_create(&device->fanout, device);
+            if (result != AIRSPY_SUCCESS)
+            {
+                return result;
+            }
+        }
+
+        result = broker_create(&device->broker, params, slot_bytes, device->packing_enabled);
+        if (result != AIRSPY_SUCCESS)
+        {
+            device->broker = NULL;
+            return result;
+        }
+
+        result = fanout_subscribe(device->fanout, &sub, broker_publish, device->broker, &device->broker_subscriber);
+        if (result != AIRSPY_SUCCESS)
+        {
+            broker_free(device->broker);
+            device->broker = NULL;
         }
 
         return result;
     }
 
-    int ADDCALL airspy_get_samplerates(struct airspy_device* device, uint32_t* buffer, const uint32_t len)
+    int ADDCALL airspy_stop_broker(airspy_device_t* device)
     {
-        if (len == 0)
+        if (device->broker == NULL)
         {
-            *buffer = device->supported_samplerate_count;
+            return AIRSPY_SUCCESS;
         }
-        else if (len <= device->supported_samplerate_count)
+
+        if (device->streaming && !device->stop_requested)
         {
-            memcpy(buffer, device->supported_samplerates, len * sizeof(uint32_t));
+            return AIRSPY_ERROR_BUSY;
         }
-        else
+
+        fanout_unsubscribe(device->fanout, device->broker_subscriber);
+        broker_free(device->broker);
+        device->broker = NULL;
+        device->broker_subscriber = NULL;
+
+        return AIRSPY_SUCCESS;
+    }
+
+    int ADDCALL airspy_get_broker_stats(airspy_device_t* device, airspy_broker_stats_t* stats)
+    {
+        if (device->broker == NULL || stats == NULL)
         {
             return AIRSPY_ERROR_INVALID_PARAM;
         }
 
+        broker_get_stats(device->broker, stats);
+
         return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_set_samplerate(airspy_device_t* device, uint32_t samplerate)
+    int ADDCALL airspy_start_server(airspy_device_t* device, const airspy_server_params_t* params)
     {
         int result;
-        uint8_t retval;
-        uint8_t length;
-        uint32_t i;
 
-        if (samplerate >= MIN_SAMPLERATE_BY_VALUE)
+        if ((device->streaming && !device->stop_requested) || device->sweep != NULL || device->server != NULL)
         {
-            for (i = 0; i < device->supported_samplerate_count; i++)
-            {
-                if (samplerate == device->supported_samplerates[i])
-                {
-                    samplerate = i;
-                    break;
-                }
-            }
+            return AIRSPY_ERROR_BUSY;
+        }
 
-            if (samplerate >= MIN_SAMPLERATE_BY_VALUE)
+        if (device->fanout == NULL)
+        {
+            result = fanout_create(&device->fanout, device);
+            if (result != AIRSPY_SUCCESS)
             {
-                samplerate /= 1000;
+                return result;
             }
         }
 
-        libusb_clear_halt(device->usb_device, LIBUSB_ENDPOINT_IN | 1);
-
-        length = 1;
-
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_SET_SAMPLERATE,
-            0,
-            samplerate,
-            &retval,
-            length,
-            0
-            );
-
-        if (result < length) {
-            return AIRSPY_ERROR_LIBUSB;
-        } else {
-            return AIRSPY_SUCCESS;
+        result = server_create(&device->server, device->fanout, device, params);
+        if (result != AIRSPY_SUCCESS)
+        {
+            device->server = NULL;
         }
+
+        return result;
     }
 
-    int ADDCALL airspy_set_receiver_mode(airspy_device_t* device, receiver_mode_t value)
+    int ADDCALL airspy_stop_server(airspy_device_t* device)
     {
-        int result;
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_RECEIVER_MODE,
-            value,
-            0,
-            NULL,
-            0,
-            0
-            );
-
-        if (result != 0) {
-            return AIRSPY_ERROR_LIBUSB;
-        } else {
+        if (device->server == NULL)
+        {
             return AIRSPY_SUCCESS;
         }
-    }
-
-    /*
-     * Enable receiving with the given Airspy device.
-     */
-    int ADDCALL airspy_init_rx(airspy_device_t* device)
-    {
-        int result;
 
-        result = airspy_set_receiver_mode(device, RECEIVER_MODE_OFF);
-        if (result != AIRSPY_SUCCESS)
+        if (device->streaming && !device->stop_requested)
         {
-            return result;
+            return AIRSPY_ERROR_BUSY;
         }
 
-        libusb_clear_halt(device->usb_device, LIBUSB_ENDPOINT_IN | 1);
+        server_free(device->server);
+        device->server = NULL;
 
-        iqconverter_int16_reset(&device->conv);
+        return AIRSPY_SUCCESS;
+    }
 
-        result = airspy_set_receiver_mode(device, RECEIVER_MODE_RX);
-        if (result != AIRSPY_SUCCESS) {
-            return result;
+    int ADDCALL airspy_get_server_stats(airspy_device_t* device, airspy_server_stats_t* stats)
+    {
+        if (device->server == NULL || stats == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
 
-        result = prepare_transfers(device, LIBUSB_ENDPOINT_IN | 1, (libusb_transfer_cb_fn)airspy_libusb_transfer_callback);
-        if (result != AIRSPY_SUCCESS) {
-            return result;
-        }
+        server_get_stats(device->server, stats);
 
-        device->streaming = true;
-        device->stop_requested = false;
+        return AIRSPY_SUCCESS;
+    }
 
-        /* We're now ready to receive samples, so call do_rx from your worker thread. */
-        return result;
+    int ADDCALL airspy_reader_open(struct airspy_reader** reader, const char* name)
+    {
+        return broker_reader_open(reader, name);
     }
 
-    /*
-     * Perform RX. This function blocks until you disable receive, usually on a parent thread.
-     */
-    int ADDCALL airspy_do_rx(airspy_device_t* device, airspy_sample_block_cb_fn callback, void *ctx)
+    int ADDCALL airspy_reader_next(struct airspy_reader* reader, airspy_transfer_t* transfer, uint32_t timeout_ms)
     {
-        int result = 0;
-        struct timeval timeout = { 0, 500000 };
+        if (reader == NULL || transfer == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
 
-        device->callback = callback;
-        device->ctx = ctx;
+        return broker_reader_next(reader, transfer, timeout_ms);
+    }
 
-        while (device->streaming && !device->stop_requested)
+    int ADDCALL airspy_reader_release(struct airspy_reader* reader)
+    {
+        if (reader == NULL)
         {
-            int error = libusb_handle_events_timeout_completed(device->usb_context, &timeout, NULL);
-            if (error < 0)
-            {
-                if (error != LIBUSB_ERROR_INTERRUPTED) {
-                    device->streaming = false;
-                    result = AIRSPY_ERROR_STREAMING_STOPPED;
-                }
-            }
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
 
-        return result;
+        return broker_reader_release(reader);
     }
 
-    /*
-     * Terminate sample reception
-     */
-    int ADDCALL airspy_term_rx(airspy_device_t* device)
+    int ADDCALL airspy_reader_get_stats(struct airspy_reader* reader, airspy_reader_stats_t* stats)
     {
-        device->stop_requested = true;
-        cancel_transfers(device);
-        return airspy_set_receiver_mode(device, RECEIVER_MODE_OFF);
+        if (reader == NULL || stats == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+
+        broker_reader_get_stats(reader, stats);
+
+        return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_si5351c_read(airspy_device_t* device, uint8_t register_number, uint8_t* value)
+    int ADDCALL airspy_reader_close(struct airspy_reader* reader)
     {
-        uint8_t temp_value;
-        int result;
+        broker_reader_close(reader);
 
-        temp_value = 0;
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_SI5351C_READ,
-            0,
-            register_number,
-            (unsigned char*)&temp_value,
-            1,
-            0);
+        return AIRSPY_SUCCESS;
+    }
 
-        if (result < 1)
+    int ADDCALL airspy_pause_rx(airspy_device_t* device)
+    {
+        if (!device->paused)
         {
-            return AIRSPY_ERROR_LIBUSB;
-        }
-        else {
-            *value = temp_value;
-            return AIRSPY_SUCCESS;
+            device->resume_request_us = 0;
+            device->pause_request_us = airspy_now_us();
+            device->paused = true;
         }
+
+        return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_si5351c_write(airspy_device_t* device, uint8_t register_number, uint8_t value)
+    int ADDCALL airspy_resume_rx(airspy_device_t* device)
     {
-        int result;
+        if (device->paused)
+        {
+            device->pause_request_us = 0;
+            device->resume_request_us = airspy_now_us();
+            device->paused = false;
+        }
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_SI5351C_WRITE,
-            value,
-            register_number,
-            NULL,
-            0,
-            0);
+        return AIRSPY_SUCCESS;
+    }
 
-        if (result != 0)
+    int ADDCALL airspy_get_stream_stats(airspy_device_t* device, airspy_stream_stats_t* stats)
+    {
+        if (stats == NULL)
         {
-            return AIRSPY_ERROR_LIBUSB;
-        }
-        else {
-            return AIRSPY_SUCCESS;
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
+
+        memcpy(stats, &device->stats, sizeof(*stats));
+
+        return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_r820t_read(airspy_device_t* device, uint8_t register_number, uint8_t* value)
+    int ADDCALL airspy_start_recording(airspy_device_t* device, const airspy_record_params_t* params)
     {
         int result;
+        recorder_t* recorder;
+        recorder_meta_t meta;
+        char version[VERSION_LOCAL_SIZE];
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_R820T_READ,
-            0,
-            register_number,
-            (unsigned char*)value,
-            1,
-            0);
-
-        if (result < 1)
+        if (params == NULL || params->path == NULL ||
+            (params->format != AIRSPY_RECORD_IQ_INT16 && params->format != AIRSPY_RECORD_RAW &&
+                params->format != AIRSPY_RECORD_RAW_COMPRESSED))
         {
-            return AIRSPY_ERROR_LIBUSB;
-        }
-        else {
-            return AIRSPY_SUCCESS;
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
-    }
 
-    int ADDCALL airspy_r820t_write(airspy_device_t* device, uint8_t register_number, uint8_t value)
-    {
-        int result;
+        if (device->recorder != NULL)
+        {
+            return AIRSPY_ERROR_BUSY;
+        }
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_R820T_WRITE,
-            value,
-            register_number,
-            NULL,
-            0,
-            0);
+        result = airspy_load_samplerates(device);
+        if (result != AIRSPY_SUCCESS)
+        {
+            return result;
+        }
 
-        if (result != 0)
+        memset(&meta, 0, sizeof(meta));
+        if (params->format != AIRSPY_RECORD_IQ_INT16)
         {
-            return AIRSPY_ERROR_LIBUSB;
+            meta.datatype = "ru16_le";
+            meta.sample_rate = 2.0 * device->samplerate;
+            meta.packed = device->packing_enabled;
+            meta.compressed = params->format == AIRSPY_RECORD_RAW_COMPRESSED;
+            meta.raw = 1;
         }
-        else {
-            return AIRSPY_SUCCESS;
+        else
+        {
+            meta.datatype = "ci16_le";
+            meta.sample_rate = device->samplerate;
+        }
+        meta.freq_hz = (device->config.valid & CONFIG_FREQ) ? device->config.freq_hz : 0;
+        meta.gain = airspy_record_gain_state(device);
+        if (airspy_version_string_read(device, version, sizeof(version)) == AIRSPY_SUCCESS && version[0] != '\0')
+        {
+            meta.hw = version;
+        }
+
+        result = recorder_open(&recorder, params, &meta);
+        if (result != AIRSPY_SUCCESS)
+        {
+            return result;
         }
+
+        pthread_mutex_lock(&device->record_lock);
+        /* Compressed recordings take the raw blocks, the recorder encodes them */
+        device->record_format = params->format == AIRSPY_RECORD_IQ_INT16 ? AIRSPY_RECORD_IQ_INT16 : AIRSPY_RECORD_RAW;
+        device->recorder = recorder;
+        pthread_mutex_unlock(&device->record_lock);
+
+        return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_gpio_read(airspy_device_t* device, airspy_gpio_port_t port, airspy_gpio_pin_t pin, uint8_t* value)
+    int ADDCALL airspy_stop_recording(airspy_device_t* device)
     {
-        int result;
-        uint8_t port_pin;
-
-        port_pin = ((uint8_t)port) << 5;
-        port_pin = port_pin | pin;
+        recorder_t* recorder;
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_GPIO_READ,
-            0,
-            port_pin,
-            (unsigned char*)value,
-            1,
-            0);
+        pthread_mutex_lock(&device->record_lock);
+        recorder = device->recorder;
+        device->recorder = NULL;
+        pthread_mutex_unlock(&device->record_lock);
 
-        if (result < 1)
+        if (recorder == NULL)
         {
-            return AIRSPY_ERROR_LIBUSB;
-        }
-        else {
             return AIRSPY_SUCCESS;
         }
+
+        return recorder_close(recorder);
     }
 
-    int ADDCALL airspy_gpio_write(airspy_device_t* device, airspy_gpio_port_t port, airspy_gpio_pin_t pin, uint8_t value)
+    int ADDCALL airspy_get_record_stats(airspy_device_t* device, airspy_record_stats_t* stats)
     {
-        int result;
-        uint8_t port_pin;
-
-        port_pin = ((uint8_t)port) << 5;
-        port_pin = port_pin | pin;
-
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_GPIO_WRITE,
-            value,
-            port_pin,
-            NULL,
-            0,
-            0);
+        if (stats == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
 
-        if (result != 0)
+        pthread_mutex_lock(&device->record_lock);
+        if (device->recorder != NULL)
         {
-            return AIRSPY_ERROR_LIBUSB;
+            recorder_get_stats(device->recorder, stats);
         }
-        else {
-            return AIRSPY_SUCCESS;
+        else
+        {
+            memset(stats, 0, sizeof(*stats));
         }
-    }
+        pthread_mutex_unlock(&device->record_lock);
 
+        return AIRSPY_SUCCESS;
+    }
 
-    int ADDCALL airspy_gpiodir_read(airspy_device_t* device, airspy_gpio_port_t port, airspy_gpio_pin_t pin, uint8_t* value)
+    int ADDCALL airspy_index_open(struct airspy_capture_index** index, const char* path)
     {
-        int result;
-        uint8_t port_pin;
-
-        port_pin = ((uint8_t)port) << 5;
-        port_pin = port_pin | pin;
+        if (index == NULL || path == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_GPIODIR_READ,
-            0,
-            port_pin,
-            (unsigned char*)value,
-            1,
-            0);
+        return capture_index_open(index, path);
+    }
 
-        if (result < 1)
+    int ADDCALL airspy_index_close(struct airspy_capture_index* index)
+    {
+        if (index != NULL)
         {
-            return AIRSPY_ERROR_LIBUSB;
-        }
-        else {
-            return AIRSPY_SUCCESS;
+            capture_index_close(index);
         }
+
+        return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_gpiodir_write(airspy_device_t* device, airspy_gpio_port_t port, airspy_gpio_pin_t pin, uint8_t value)
+    int ADDCALL airspy_index_get_count(struct airspy_capture_index* index, uint64_t* count)
     {
-        int result;
-        uint8_t port_pin;
+        if (index == NULL || count == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
 
-        port_pin = ((uint8_t)port) << 5;
-        port_pin = port_pin | pin;
+        *count = capture_index_count(index);
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_GPIODIR_WRITE,
-            value,
-            port_pin,
-            NULL,
-            0,
-            0);
+        return AIRSPY_SUCCESS;
+    }
 
-        if (result != 0)
+    int ADDCALL airspy_index_get(struct airspy_capture_index* index, uint64_t n, airspy_index_entry_t* entry)
+    {
+        if (index == NULL || entry == NULL || n >= capture_index_count(index))
         {
-            return AIRSPY_ERROR_LIBUSB;
-        }
-        else {
-            return AIRSPY_SUCCESS;
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
+
+        capture_index_get(index, n, entry);
+
+        return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_spiflash_erase(airspy_device_t* device)
+    int ADDCALL airspy_index_find_sample(struct airspy_capture_index* index, uint64_t sample, uint64_t* n)
     {
-        int result;
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_SPIFLASH_ERASE,
-            0,
-            0,
-            NULL,
-            0,
-            0);
-
-        if (result != 0)
+        if (index == NULL || n == NULL)
         {
-            return AIRSPY_ERROR_LIBUSB;
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
-        else {
-            return AIRSPY_SUCCESS;
+
+        if (capture_index_count(index) == 0)
+        {
+            return AIRSPY_ERROR_NOT_FOUND;
         }
+
+        *n = capture_index_find_sample(index, sample);
+
+        return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_spiflash_erase_sector(airspy_device_t* device, const uint16_t sector_num)
+    int ADDCALL airspy_index_find_time(struct airspy_capture_index* index, int64_t time_ns, uint64_t* n)
     {
-        int result;
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_SPIFLASH_ERASE_SECTOR,
-            sector_num,
-            0,
-            NULL,
-            0,
-            0);
-
-        if (result != 0)
+        if (index == NULL || n == NULL)
         {
-            return AIRSPY_ERROR_LIBUSB;
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
-        else {
-            return AIRSPY_SUCCESS;
+
+        if (capture_index_count(index) == 0)
+        {
+            return AIRSPY_ERROR_NOT_FOUND;
         }
+
+        *n = capture_index_find_time(index, time_ns);
+
+        return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_spiflash_write(airspy_device_t* device, const uint32_t address, const uint16_t length, unsigned char* const data)
+    int ADDCALL airspy_start_trigger_capture(airspy_device_t* device, const airspy_trigger_params_t* params)
     {
         int result;
+        trigger_t* trigger;
+        recorder_meta_t meta;
+        char version[VERSION_LOCAL_SIZE];
 
-        if (address > 0x0FFFFF)
+        if (params == NULL || params->path == NULL)
         {
             return AIRSPY_ERROR_INVALID_PARAM;
         }
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_SPIFLASH_WRITE,
-            address >> 16,
-            address & 0xFFFF,
-            data,
-            length,
-            0);
+        if (device->trigger != NULL)
+        {
+            return AIRSPY_ERROR_BUSY;
+        }
 
-        if (result < length)
+        result = airspy_load_samplerates(device);
+        if (result != AIRSPY_SUCCESS)
         {
-            return AIRSPY_ERROR_LIBUSB;
+            return result;
         }
-        else {
-            return AIRSPY_SUCCESS;
+
+        memset(&meta, 0, sizeof(meta));
+        meta.datatype = "ci16_le";
+        meta.sample_rate = device->samplerate;
+        meta.freq_hz = (device->config.valid & CONFIG_FREQ) ? device->config.freq_hz : 0;
+        meta.gain = airspy_record_gain_state(device);
+        if (airspy_version_string_read(device, version, sizeof(version)) == AIRSPY_SUCCESS && version[0] != '\0')
+        {
+            meta.hw = version;
+        }
+
+        result = trigger_open(&trigger, params, &meta, airspy_block_samples(device));
+        if (result != AIRSPY_SUCCESS)
+        {
+            return result;
         }
+
+        pthread_mutex_lock(&device->record_lock);
+        device->trigger_request = 0;
+        device->trigger = trigger;
+        pthread_mutex_unlock(&device->record_lock);
+
+        return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_spiflash_read(airspy_device_t* device, const uint32_t address, const uint16_t length, unsigned char* data)
+    int ADDCALL airspy_trigger(airspy_device_t* device)
     {
-        int result;
+        __atomic_store_n(&device->trigger_request, 1, __ATOMIC_RELEASE);
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_SPIFLASH_READ,
-            address >> 16,
-            address & 0xFFFF,
-            data,
-            length,
-            0);
+        return AIRSPY_SUCCESS;
+    }
 
-        if (result < length)
+    int ADDCALL airspy_stop_trigger_capture(airspy_device_t* device)
+    {
+        trigger_t* trigger;
+
+        pthread_mutex_lock(&device->record_lock);
+        trigger = device->trigger;
+        device->trigger = NULL;
+        pthread_mutex_unlock(&device->record_lock);
+
+        if (trigger == NULL)
         {
-            return AIRSPY_ERROR_LIBUSB;
-        }
-        else {
             return AIRSPY_SUCCESS;
         }
+
+        return trigger_close(trigger);
     }
 
-    int ADDCALL airspy_board_id_read(airspy_device_t* device, uint8_t* value)
+    int ADDCALL airspy_get_trigger_stats(airspy_device_t* device, airspy_trigger_stats_t* stats)
     {
-        int result;
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_BOARD_ID_READ,
-            0,
-            0,
-            value,
-            1,
-            0);
+        if (stats == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
 
-        if (result < 1)
+        pthread_mutex_lock(&device->record_lock);
+        if (device->trigger != NULL)
         {
-            return AIRSPY_ERROR_LIBUSB;
+            trigger_get_stats(device->trigger, stats);
         }
-        else {
-            return AIRSPY_SUCCESS;
+        else
+        {
+            memset(stats, 0, sizeof(*stats));
         }
+        pthread_mutex_unlock(&device->record_lock);
+
+        return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_version_string_read(airspy_device_t* device, char* version, uint8_t length)
+    int ADDCALL airspy_set_squelch(airspy_device_t* device, const airspy_squelch_params_t* params)
     {
-#define VERSION_LOCAL_SIZE (128)
+        squelch_t* squelch = NULL;
         int result;
-        char version_local[VERSION_LOCAL_SIZE];
-
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_VERSION_STRING_READ,
-            0,
-            0,
-            (unsigned char*)version_local,
-            (VERSION_LOCAL_SIZE - 1),
-            0);
 
-        if (result < 0)
+        if (device->streaming && !device->stop_requested)
         {
-            return AIRSPY_ERROR_LIBUSB;
+            return AIRSPY_ERROR_BUSY;
         }
-        else
+
+        if (params != NULL)
         {
-            if (length > 0)
-            {
-                memcpy(version, version_local, length - 1);
-                version[length - 1] = 0;
-                return AIRSPY_SUCCESS;
-            }
-            else
+            result = squelch_create(&squelch, params);
+            if (result != AIRSPY_SUCCESS)
             {
-                return AIRSPY_ERROR_INVALID_PARAM;
+                return result;
             }
         }
+
+        squelch_free(device->squelch);
+        device->squelch = squelch;
+
+        return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_board_partid_serialno_read(airspy_device_t* device, airspy_read_partid_serialno_t* read_partid_serialno)
+    int ADDCALL airspy_get_squelch_stats(airspy_device_t* device, airspy_squelch_stats_t* stats)
     {
-        uint8_t length;
-        int result;
-
-        length = sizeof(airspy_read_partid_serialno_t);
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_BOARD_PARTID_SERIALNO_READ,
-            0,
-            0,
-            (unsigned char*)read_partid_serialno,
-            length,
-            0);
+        if (stats == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
 
-        if (result < length)
+        if (device->squelch != NULL)
         {
-            return AIRSPY_ERROR_LIBUSB;
+            squelch_get_stats(device->squelch, stats);
+        }
+        else
+        {
+            memset(stats, 0, sizeof(*stats));
+            stats->noise_floor_db = NAN;
         }
-        else {
 
-            read_partid_serialno->part_id[0] = TO_LE(read_partid_serialno->part_id[0]);
-            read_partid_serialno->part_id[1] = TO_LE(read_partid_serialno->part_id[1]);
-            read_partid_serialno->serial_no[0] = TO_LE(read_partid_serialno->serial_no[0]);
-            read_partid_serialno->serial_no[1] = TO_LE(read_partid_serialno->serial_no[1]);
-            read_partid_serialno->serial_no[2] = TO_LE(read_partid_serialno->serial_no[2]);
-            read_partid_serialno->serial_no[3] = TO_LE(read_partid_serialno->serial_no[3]);
+        return AIRSPY_SUCCESS;
+    }
 
-            return AIRSPY_SUCCESS;
+    int ADDCALL airspy_correlator_create(struct airspy_correlator** correlator, const airspy_template_t* templates,
+        uint32_t count, uint32_t flags)
+    {
+        if (correlator == NULL || templates == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
+
+        return correlator_create(correlator, templates, count, flags);
     }
 
-    int ADDCALL airspy_set_freq(airspy_device_t* device, const uint32_t freq_hz)
+    int ADDCALL airspy_correlator_process(struct airspy_correlator* correlator, const airspy_transfer_t* transfer,
+        airspy_correlation_cb_fn callback, void* ctx)
     {
-        set_freq_params_t set_freq_params;
-        uint8_t length;
-        int result;
+        if (transfer == NULL || callback == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
 
-        set_freq_params.freq_hz = TO_LE(freq_hz);
-        length = sizeof(set_freq_params_t);
+        return correlator_process(correlator, transfer, callback, ctx);
+    }
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_SET_FREQ,
-            0,
-            0,
-            (unsigned char*)&set_freq_params,
-            length,
-            0
-            );
+    int ADDCALL airspy_correlator_free(struct airspy_correlator* correlator)
+    {
+        correlator_free(correlator);
 
-        if (result < length)
-        {
-            return AIRSPY_ERROR_LIBUSB;
-        }
-        else {
-            return AIRSPY_SUCCESS;
-        }
+        return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_set_lna_gain(airspy_device_t* device, uint8_t value)
+    int ADDCALL airspy_subscribe_correlator(airspy_device_t* device, struct airspy_correlator* correlator,
+        uint32_t decimation, airspy_correlation_cb_fn callback, void* ctx, struct airspy_subscriber** subscriber)
     {
-        int result;
-        uint8_t retval;
-        uint8_t length;
+        airspy_subscriber_params_t params;
+
+        if (correlator == NULL || callback == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
 
-        if (value > 14)
-            value = 14;
+        memset(&params, 0, sizeof(params));
+        params.format = AIRSPY_SUBSCRIBER_IQ_FLOAT32;
+        params.decimation = decimation;
 
-        length = 1;
+        correlator_bind(correlator, callback, ctx);
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_SET_LNA_GAIN,
-            0,
-            value,
-            &retval,
-            length,
-            0
-            );
+        return airspy_subscribe(device, &params, correlator_block, correlator, subscriber);
+    }
 
-        if (result < length)
+    int ADDCALL airspy_resampler_create(struct airspy_resampler** resampler, const airspy_resampler_params_t* params)
+    {
+        if (resampler == NULL || params == NULL)
         {
-            return AIRSPY_ERROR_LIBUSB;
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
-        else {
-            return AIRSPY_SUCCESS;
+
+        return resampler_create(resampler, params);
+    }
+
+    int ADDCALL airspy_resampler_process(struct airspy_resampler* resampler, const float* input, uint32_t count,
+        float* output, uint32_t* output_count)
+    {
+        if (resampler == NULL || (count > 0 && (input == NULL || output == NULL)) || output_count == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
+
+        *output_count = resampler_process(resampler, input, count, output);
+
+        return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_set_mixer_gain(airspy_device_t* device, uint8_t value)
+    uint32_t ADDCALL airspy_resampler_max_output(struct airspy_resampler* resampler, uint32_t count)
     {
-        int result;
-        uint8_t retval;
-        uint8_t length;
+        return resampler_max_output(resampler, count);
+    }
 
-        if (value > 15)
-            value = 15;
+    int ADDCALL airspy_resampler_reset(struct airspy_resampler* resampler)
+    {
+        resampler_reset(resampler);
 
-        length = 1;
+        return AIRSPY_SUCCESS;
+    }
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_SET_MIXER_GAIN,
-            0,
-            value,
-            &retval,
-            length,
-            0
-            );
+    int ADDCALL airspy_resampler_free(struct airspy_resampler* resampler)
+    {
+        resampler_free(resampler);
 
-        if (result < length)
+        return AIRSPY_SUCCESS;
+    }
+
+    int ADDCALL airspy_convolver_create(struct airspy_convolver** convolver, const float* taps, uint32_t tap_count,
+        uint32_t flags)
+    {
+        if (convolver == NULL)
         {
-            return AIRSPY_ERROR_LIBUSB;
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
-        else {
-            return AIRSPY_SUCCESS;
+
+        return convolver_create(convolver, taps, tap_count, flags);
+    }
+
+    int ADDCALL airspy_convolver_process(struct airspy_convolver* convolver, const float* input, uint32_t count,
+        float* output)
+    {
+        if (count > 0 && (input == NULL || output == NULL))
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
+
+        return convolver_process(convolver, input, count, output);
     }
 
-    int ADDCALL airspy_set_vga_gain(airspy_device_t* device, uint8_t value)
+    int ADDCALL airspy_convolver_reset(struct airspy_convolver* convolver)
     {
-        int result;
-        uint8_t retval;
-        uint8_t length;
+        convolver_reset(convolver);
 
-        if (value > 15)
-            value = 15;
+        return AIRSPY_SUCCESS;
+    }
 
-        length = 1;
+    int ADDCALL airspy_convolver_free(struct airspy_convolver* convolver)
+    {
+        convolver_free(convolver);
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_SET_VGA_GAIN,
-            0,
-            value,
-            &retval,
-            length,
-            0
-            );
+        return AIRSPY_SUCCESS;
+    }
 
-        if (result < length)
+    int ADDCALL airspy_subscribe_convolver(airspy_device_t* device, struct airspy_convolver* convolver,
+        const airspy_subscriber_params_t* params, airspy_sample_block_cb_fn callback, void* ctx,
+        struct airspy_subscriber** subscriber)
+    {
+        airspy_subscriber_params_t sub;
+
+        if (convolver == NULL || params == NULL || callback == NULL)
         {
-            return AIRSPY_ERROR_LIBUSB;
-        }
-        else {
-            return AIRSPY_SUCCESS;
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
-    }
 
-    int ADDCALL airspy_set_lna_agc(airspy_device_t* device, uint8_t value)
-    {
-        int result;
-        uint8_t retval;
-        uint8_t length;
+        sub = *params;
+        sub.format = AIRSPY_SUBSCRIBER_IQ_FLOAT32;
 
-        length = 1;
+        convolver_bind(convolver, callback, ctx);
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_SET_LNA_AGC,
-            0,
-            value,
-            &retval,
-            length,
-            0
-            );
+        return airspy_subscribe(device, &sub, convolver_block, convolver, subscriber);
+    }
 
-        if (result < length)
+    int ADDCALL airspy_power_open(struct airspy_power_pyramid** pyramid, const char* path)
+    {
+        if (pyramid == NULL || path == NULL)
         {
-            return AIRSPY_ERROR_LIBUSB;
-        }
-        else {
-            return AIRSPY_SUCCESS;
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
+
+        return pyramid_reader_open(pyramid, path);
     }
 
-    int ADDCALL airspy_set_mixer_agc(airspy_device_t* device, uint8_t value)
+    int ADDCALL airspy_power_close(struct airspy_power_pyramid* pyramid)
     {
-        int result;
-        uint8_t retval;
-        uint8_t length;
-
-        length = 1;
+        if (pyramid != NULL)
+        {
+            pyramid_reader_close(pyramid);
+        }
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_SET_MIXER_AGC,
-            0,
-            value,
-            &retval,
-            length,
-            0
-            );
+        return AIRSPY_SUCCESS;
+    }
 
-        if (result < length)
+    int ADDCALL airspy_power_get_info(struct airspy_power_pyramid* pyramid, airspy_power_info_t* info)
+    {
+        if (pyramid == NULL || info == NULL)
         {
-            return AIRSPY_ERROR_LIBUSB;
-        }
-        else {
-            return AIRSPY_SUCCESS;
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
+
+        pyramid_reader_info(pyramid, info);
+
+        return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_set_linearity_gain(struct airspy_device* device, uint8_t value)
+    int ADDCALL airspy_power_read(struct airspy_power_pyramid* pyramid, uint32_t level, uint64_t first,
+        uint32_t count, airspy_power_summary_t* summaries, float* bins)
     {
-        int rc;
-        value = GAIN_COUNT - 1 - value;
+        airspy_power_info_t info;
 
-        if (value >= GAIN_COUNT)
+        if (pyramid == NULL || (summaries == NULL && count > 0))
         {
-            value = GAIN_COUNT - 1;
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
-        else if (value < 0)
+
+        pyramid_reader_info(pyramid, &info);
+        if (level >= info.levels || first > info.buckets[level] || count > info.buckets[level] - first)
         {
-            value = 0;
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
 
-        rc = airspy_set_mixer_agc(device, 0);
-        if (rc < 0)
-            return rc;
+        pyramid_reader_read(pyramid, level, first, count, summaries, bins);
 
-        rc = airspy_set_lna_agc(device, 0);
-        if (rc < 0)
-            return rc;
+        return AIRSPY_SUCCESS;
+    }
 
-        rc = airspy_set_vga_gain(device, airspy_linearity_vga_gains[value]);
-        if (rc < 0)
-            return rc;
+    int ADDCALL airspy_get_sim_stats(airspy_device_t* device, airspy_sim_stats_t* stats)
+    {
+        if (stats == NULL || device->sim == NULL)
+        {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
 
-        rc = airspy_set_mixer_gain(device, airspy_linearity_mixer_gains[value]);
-        if (rc < 0)
-            return rc;
+        sim_get_stats(device->sim, stats);
 
-        rc = airspy_set_lna_gain(device, airspy_linearity_lna_gains[value]);
-        if (rc < 0)
-            return rc;
+        return AIRSPY_SUCCESS;
+    }
+
+    int ADDCALL airspy_set_event_callback(airspy_device_t* device, airspy_event_cb_fn callback, void* event_ctx)
+    {
+        device->event_callback = callback;
+        device->event_ctx = event_ctx;
 
         return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_set_sensitivity_gain(struct airspy_device* device, uint8_t value)
+    int ADDCALL airspy_attach_standby(airspy_device_t* device, uint64_t serial_number)
     {
-        int rc;
-        value = GAIN_COUNT - 1 - value;
+        int result;
+        airspy_device_t* standby;
 
-        if (value >= GAIN_COUNT)
+        /* Only a USB device can be backed up by another */
+        if (device->transport != &usb_transport)
         {
-            value = GAIN_COUNT - 1;
+            return AIRSPY_ERROR_INVALID_PARAM;
         }
-        else if (value < 0)
+
+        if (device->standby != NULL)
         {
-            value = 0;
+            return AIRSPY_ERROR_BUSY;
         }
 
-        rc = airspy_set_mixer_agc(device, 0);
-        if (rc < 0)
-            return rc;
+        if (device->retired != NULL)
+        {
+            airspy_close(device->retired);
+            device->retired = NULL;
+        }
 
-        rc = airspy_set_lna_agc(device, 0);
-        if (rc < 0)
-            return rc;
+        standby = (airspy_device_t*)calloc(1, sizeof(airspy_device_t));
+        if (standby == NULL)
+        {
+            return AIRSPY_ERROR_NO_MEM;
+        }
 
-        rc = airspy_set_vga_gain(device, airspy_sensitivity_vga_gains[value]);
-        if (rc < 0)
-            return rc;
+        pthread_mutex_init(&standby->record_lock, NULL);
+
+        /* Sharing the context means one event loop sees both devices come and go */
+        standby->usb_context = device->usb_context;
+        standby->shared_context = true;
+        standby->transport = &usb_transport;
+        standby->transport_handle = standby;
+        standby->transfer_count = device->transfer_count;
+        standby->buffer_size = DEFAULT_BUFFER_SIZE;
+
+        airspy_open_device(standby,
+            &result,
+            airspy_usb_vid,
+            airspy_usb_pid,
+            serial_number);
+        if (standby->usb_device == NULL)
+        {
+            pthread_mutex_destroy(&standby->record_lock);
+            free(standby);
+            return result;
+        }
 
-        rc = airspy_set_mixer_gain(device, airspy_sensitivity_mixer_gains[value]);
-        if (rc < 0)
-            return rc;
+        result = airspy_set_receiver_mode(standby, RECEIVER_MODE_OFF);
+        if (result == AIRSPY_SUCCESS)
+        {
+            result = airspy_replay_config(standby, &device->config);
+        }
+        if (result != AIRSPY_SUCCESS)
+        {
+            airspy_close(standby);
+            return result;
+        }
 
-        rc = airspy_set_lna_gain(device, airspy_sensitivity_lna_gains[value]);
-        if (rc < 0)
-            return rc;
+        device->standby_departed = false;
+        device->standby_lost_reported = false;
+        device->standby = standby;
 
         return AIRSPY_SUCCESS;
     }
 
-    int ADDCALL airspy_set_rf_bias(airspy_device_t* device, uint8_t value)
+    int ADDCALL airspy_detach_standby(airspy_device_t* device)
     {
-        return airspy_gpio_write(device, GPIO_PORT1, GPIO_PIN13, value);
-    }
+        airspy_device_t* standby;
 
-    int ADDCALL airspy_set_packing(airspy_device_t* device, uint8_t value)
-    {
-        int result;
-        uint8_t retval;
-        bool packing_enabled;
+        if (device->retired != NULL)
+        {
+            airspy_close(device->retired);
+            device->retired = NULL;
+        }
 
-        if (device->streaming)
+        standby = device->standby;
+        device->standby = NULL;
+
+        if (standby != NULL)
         {
-            return AIRSPY_ERROR_BUSY;
+            airspy_close(standby);
         }
 
-        result = libusb_control_transfer(
-            device->usb_device,
-            LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
-            AIRSPY_SET_PACKING,
-            0,
-            value,
-            &retval,
-            1,
-            0);
+        return AIRSPY_SUCCESS;
+    }
 
-        if (result < 1)
+    int ADDCALL airspy_failover(airspy_device_t* device)
+    {
+        if (!airspy_standby_usable(device))
         {
-            return  AIRSPY_ERROR_LIBUSB;
+            return AIRSPY_ERROR_NOT_FOUND;
         }
 
-        packing_enabled = value ? true : false;
-        if (packing_enabled != device->packing_enabled)
+        if (device->streaming && !device->stop_requested)
         {
+            /* airspy_do_rx() takes it from here, exactly as if the device had been unplugged */
+            airspy_set_receiver_mode(device, RECEIVER_MODE_OFF);
+            device->departed = true;
             cancel_transfers(device);
-            free_transfers(device);
-
-            device->packing_enabled = packing_enabled;
-            device->buffer_size = packing_enabled ? (6144 * 24) : 262144;
-
-            result = allocate_transfers(device);
-            if (result != 0)
-            {
-                return AIRSPY_ERROR_NO_MEM;
-            }
+            return AIRSPY_SUCCESS;
         }
 
-        return AIRSPY_SUCCESS;
+        airspy_set_receiver_mode(device, RECEIVER_MODE_OFF);
+        return airspy_swap_standby(device);
     }
 
     int ADDCALL airspy_is_streaming(airspy_device_t* device)
@@ -1554,6 +4478,12 @@ extern "C"
         case AIRSPY_ERROR_STREAMING_STOPPED:
             return "AIRSPY_ERROR_STREAMING_STOPPED";
 
+        case AIRSPY_ERROR_TIMEOUT:
+            return "AIRSPY_ERROR_TIMEOUT";
+
+        case AIRSPY_ERROR_OVERRUN:
+            return "AIRSPY_ERROR_OVERRUN";
+
         case AIRSPY_ERROR_OTHER:
             return "AIRSPY_ERROR_OTHER";
 
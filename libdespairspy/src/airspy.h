@@ -71,6 +71,8 @@ enum airspy_error
 	AIRSPY_ERROR_THREAD = -1001,
 	AIRSPY_ERROR_STREAMING_THREAD_ERR = -1002,
 	AIRSPY_ERROR_STREAMING_STOPPED = -1003,
+	AIRSPY_ERROR_TIMEOUT = -1004,
+	AIRSPY_ERROR_OVERRUN = -1005,
 	AIRSPY_ERROR_OTHER = -9999,
 };
 
@@ -83,12 +85,49 @@ enum airspy_board_id
 #define MAX_CONFIG_PAGE_SIZE (0x10000)
 
 struct airspy_device;
+struct airspy_buffer;
+
+enum airspy_sample_type
+{
+	AIRSPY_SAMPLE_INT16_IQ = 0, /* Interleaved I and Q */
+	AIRSPY_SAMPLE_UINT16_MAG = 1, /* sqrt(I^2 + Q^2), up to 0.0073% over before rounding */
+	AIRSPY_SAMPLE_UINT32_POWER = 2, /* I^2 + Q^2, exact */
+	AIRSPY_SAMPLE_INT8_IQ = 3, /* Interleaved I and Q, rounded to the smallest exponent that fits the block */
+	AIRSPY_SAMPLE_UINT16_REAL = 4, /* ADC codes as received, unpacked; no IQ conversion */
+	AIRSPY_SAMPLE_INT16_REAL = 5, /* ADC codes less 2048, to full scale; no IQ conversion */
+	AIRSPY_SAMPLE_INT16_REAL_DC = 6, /* AIRSPY_SAMPLE_INT16_REAL less the mean of recent blocks */
+};
+
+#define AIRSPY_TRANSFER_DISCONTINUITY (1 << 0) /* Samples were lost immediately before this block */
+#define AIRSPY_TRANSFER_BURST_START (1 << 1) /* Squelch only: the first samples of a burst */
+#define AIRSPY_TRANSFER_BURST_END (1 << 2) /* Squelch only: the last samples of a burst */
 
 typedef struct {
 	void* samples;
 	int sample_count;
+	uint64_t sample_index; /* Index of the first sample since airspy_init_rx(), lost samples included */
+	uint64_t dropped_samples; /* Lower bound of the samples lost, or skipped while paused, immediately before this block */
+	uint32_t flags;
+	struct airspy_buffer* buffer; /* Loan mode only: keeps samples valid until passed to airspy_release_buffer() */
+	uint32_t exponent; /* AIRSPY_SAMPLE_INT8_IQ only: the int16 IQ is each sample times 2^exponent */
 } airspy_transfer_t, airspy_transfer;
 
+typedef struct {
+	uint64_t transfers; /* Blocks delivered */
+	uint64_t failed_transfers;
+	uint64_t dropped_samples;
+	uint32_t recoveries;
+	uint32_t failed_recoveries; /* Rounds that ended the stream */
+	uint32_t last_recovery_us; /* From the first failed transfer to the next delivered block */
+	uint32_t max_recovery_us;
+	uint64_t total_recovery_us;
+	uint32_t last_pause_us; /* From airspy_pause_rx() to the first block held back */
+	uint32_t last_resume_us; /* From airspy_resume_rx() to the first block delivered */
+	uint32_t max_resume_us;
+	uint64_t conversion_waits; /* Blocks that waited for a free slot in the conversion pool */
+	uint64_t buffers_exhausted; /* Blocks delivered without a buffer because every one was on loan */
+} airspy_stream_stats_t;
+
 typedef struct {
 	uint32_t part_id[2];
 	uint32_t serial_no[4];
@@ -102,10 +141,356 @@ typedef struct {
 
 typedef int (*airspy_sample_block_cb_fn)(struct airspy_device *device, void *ctx, airspy_transfer* transfer);
 
+enum airspy_subscriber_format
+{
+	AIRSPY_SUBSCRIBER_RAW = 0, /* ADC samples as received, packed or not; counts and indices are in real samples */
+	AIRSPY_SUBSCRIBER_IQ_INT16 = 1,
+	AIRSPY_SUBSCRIBER_IQ_FLOAT32 = 2, /* Full scale is 1.0 */
+	AIRSPY_SUBSCRIBER_PSD = 3, /* Power spectra in dBFS, fft_size floats each with DC in the middle */
+};
+
+#define AIRSPY_SUBSCRIBER_INLINE (1 << 0) /* Called on the airspy_do_rx() thread instead of a thread of its own */
+
+typedef struct {
+	enum airspy_subscriber_format format;
+	uint32_t decimation; /* IQ and PSD only, 0 or 1 for none */
+	uint32_t interpolation; /* IQ and PSD only, resamples by interpolation / decimation when above 1 */
+	uint32_t fft_size; /* PSD only, a power of two between 16 and 65536 */
+	uint32_t queue_depth; /* Blocks held for the subscriber's thread before newer ones are dropped, 0 for 16 */
+	uint32_t flags;
+} airspy_subscriber_params_t;
+
+typedef struct {
+	uint64_t blocks; /* Passed to the callback */
+	uint64_t dropped_blocks; /* Lost to a full queue */
+	uint32_t queue_high_water;
+} airspy_subscriber_stats_t;
+
+struct airspy_subscriber;
+
+typedef struct {
+	const char* name; /* Shared memory object, a single component starting with '/' */
+	enum airspy_subscriber_format format;
+	uint32_t decimation; /* As for subscribers */
+	uint32_t fft_size;
+	uint32_t slots; /* Blocks in the ring, 0 for 32 */
+} airspy_broker_params_t;
+
+typedef struct {
+	uint64_t blocks_published;
+	uint32_t readers; /* Attached and still running */
+	uint64_t max_lag; /* Blocks the slowest reader is behind */
+	uint64_t reader_overruns; /* Blocks readers lost to falling a full ring behind, summed */
+} airspy_broker_stats_t;
+
+struct airspy_reader;
+
+typedef struct {
+	enum airspy_subscriber_format format; /* What the broker publishes */
+	uint32_t decimation;
+	uint32_t fft_size;
+	uint32_t slots;
+	uint32_t packed; /* Raw samples are packed */
+	uint64_t blocks; /* Read and released intact */
+	uint64_t overruns; /* Overwritten before the reader got to them */
+	uint64_t torn; /* Overwritten while the reader held them */
+	uint64_t lag; /* Published but not read yet */
+} airspy_reader_stats_t;
+
+enum airspy_server_format
+{
+	AIRSPY_SERVER_U8 = 0, /* Offset binary bytes, what rtl_tcp clients expect */
+	AIRSPY_SERVER_INT16 = 1, /* Sent from the stage's own blocks, without copying them where the kernel allows */
+	AIRSPY_SERVER_FLOAT32 = 2, /* Full scale is 1.0 */
+};
+
+#define AIRSPY_SERVER_CONTROL (1 << 0) /* Clients may tune and set gains */
+
+/* rtl_tcp commands added by the server, with the value as the command's parameter */
+#define AIRSPY_SERVER_CMD_FORMAT 0x80 /* An enum airspy_server_format */
+#define AIRSPY_SERVER_CMD_DECIMATION 0x81 /* One of those offered */
+
+typedef struct {
+	const char* address; /* To listen on, NULL for any */
+	uint16_t tcp_port; /* For rtl_tcp clients, 0 for none */
+	const char* udp_destination; /* "host:port" to send VITA-49 packets to, NULL for none */
+	enum airspy_server_format udp_format; /* INT16 or FLOAT32 */
+	uint32_t udp_decimation; /* 0 or 1 for none */
+	uint32_t stream_id; /* VITA-49 stream identifier */
+	uint32_t decimations; /* Bit n offers TCP clients decimation by 2^n, 0 for none */
+	uint32_t max_clients; /* 0 for 8 */
+	uint32_t queue_depth; /* Blocks queued per client before it misses some, 0 for 16 */
+	uint32_t flags;
+} airspy_server_params_t;
+
+typedef struct {
+	uint32_t clients;
+	uint64_t bytes_sent;
+	uint64_t blocks_sent;
+	uint64_t blocks_dropped; /* Missed by clients that fell queue_depth behind */
+	uint64_t zerocopy_sends; /* Sends made with MSG_ZEROCOPY, where the kernel supports it */
+	uint64_t zerocopy_copied; /* Of those, the ones the kernel copied after all, as it does over loopback */
+	uint64_t udp_packets;
+	uint64_t udp_dropped; /* Packets the socket had no room for */
+} airspy_server_stats_t;
+
+typedef struct {
+	uint32_t freq_start_hz; /* Lower edge of the first step */
+	uint32_t freq_stop_hz; /* The sweep ends with the step covering this frequency */
+	uint32_t step_hz; /* 0 selects 3/4 of the sample rate, rounded to a whole number of bins */
+	uint32_t fft_size; /* Power of two between 64 and 65536 */
+	uint32_t averages; /* FFT frames averaged per dwell, at least 1 */
+	uint32_t settle_samples; /* IQ samples dropped after each retune, 0 selects a default covering in-flight transfers */
+} airspy_sweep_params_t;
+
+typedef struct {
+	uint64_t sweep_index;
+	uint32_t freq_start_hz;
+	double bin_width_hz;
+	uint32_t bin_count;
+	uint32_t dropped_steps; /* Bins of dropped steps are NaN */
+	const float* power_db; /* dBFS per bin, valid only during the callback */
+} airspy_sweep_result_t;
+
+enum airspy_record_format
+{
+	AIRSPY_RECORD_IQ_INT16 = 0, /* Converted IQ as passed to the sample callback, SigMF ci16_le */
+	AIRSPY_RECORD_RAW = 1, /* ADC samples as received, SigMF ru16_le (or packed 12-bit when packing is enabled) */
+	AIRSPY_RECORD_RAW_COMPRESSED = 2, /* ADC samples losslessly compressed, ru16_le once decoded; see airspy_compress_capture() */
+};
+
+#define AIRSPY_RECORD_DIRECT_IO (1 << 0) /* Bypass the page cache with O_DIRECT where the filesystem allows it */
+#define AIRSPY_RECORD_NO_IO_URING (1 << 1) /* Write with pwrite() even if io_uring is available */
+
+typedef struct {
+	const char* path; /* Sample file; metadata goes to the same name with .sigmf-meta in place of .sigmf-data */
+	enum airspy_record_format format;
+	uint32_t flags;
+	uint64_t preallocate_bytes; /* Reserved on disk up front, 0 for none */
+	uint32_t backlog_bytes; /* In-memory backlog between the stream and the disk, 0 for the default of 64 MiB */
+	const char* description; /* SigMF core:description, may be NULL */
+	uint32_t power_bucket; /* IQ samples per power summary at the finest level, 0 for no summaries */
+	uint32_t power_fft_size; /* 0, or a power of two from 16 to 4096 dividing power_bucket for per-bin summaries too */
+} airspy_record_params_t;
+
+typedef struct {
+	uint64_t bytes_written;
+	uint64_t blocks_recorded;
+	uint64_t blocks_dropped; /* Blocks that didn't fit in the backlog */
+	uint64_t samples_dropped;
+	uint32_t backlog_high_water; /* Bytes */
+	uint32_t write_errors;
+	uint32_t io_uring; /* 1 if writes go through io_uring */
+	uint32_t direct_io; /* 1 if the file was opened with O_DIRECT */
+	uint64_t power_blocks_dropped; /* Blocks left out of the power summaries, the summary thread was behind */
+} airspy_record_stats_t;
+
+#define AIRSPY_TRIGGER_POWER (1 << 0) /* Fire when the mean power over a window rises above threshold_db */
+
+typedef struct {
+	const char* path; /* Snapshot n goes to path-n.sigmf-data, with its metadata and index alongside */
+	uint32_t pre_ms; /* Converted IQ kept in memory and written from before the trigger */
+	uint32_t post_ms; /* Written from after it */
+	uint32_t flags; /* AIRSPY_TRIGGER_* */
+	float threshold_db; /* Mean |x|^2 in dBFS, a full scale complex tone reads 0 */
+	uint32_t window; /* IQ samples per power measurement, 0 for 1024 */
+} airspy_trigger_params_t;
+
+typedef struct {
+	uint64_t triggers; /* Snapshots started */
+	uint64_t triggers_ignored; /* Fired while a snapshot was still being written */
+	uint64_t snapshots_written;
+	uint64_t samples_missing; /* Of the snapshots' windows: older than the ring, lost in the stream or overwritten first */
+	uint64_t blocks_skipped; /* Larger than a ring slot */
+	uint64_t last_trigger_index; /* Stream sample_index the last trigger fired at */
+	uint32_t write_errors;
+} airspy_trigger_stats_t;
+
+typedef struct {
+	float snr_db; /* A window opens the squelch this far above the noise floor */
+	uint32_t window; /* IQ samples per power measurement, 0 for 256 */
+	uint32_t floor_ms; /* Time constant of the noise floor, 0 for 1000 */
+	uint32_t pre_samples; /* Forwarded before the first window above the threshold */
+	uint32_t post_samples; /* And after the last one */
+} airspy_squelch_params_t;
+
+typedef struct {
+	uint64_t bursts;
+	uint64_t samples_in;
+	uint64_t samples_forwarded;
+	float noise_floor_db; /* Mean |x|^2 in dBFS, NaN until the first window */
+} airspy_squelch_stats_t;
+
+#define AIRSPY_CORRELATOR_DIRECT (1 << 0) /* Every template in the direct form, whatever its length */
+#define AIRSPY_CORRELATOR_FFT (1 << 1) /* Every template through the FFT */
+
+typedef struct {
+	const float* samples; /* length complex values, interleaved re/im, in the order they arrive */
+	uint32_t length; /* Up to 16384 */
+	float threshold; /* Score that makes a hit, 0..1 */
+} airspy_template_t;
+
+typedef struct {
+	uint64_t sample_index; /* Of the sample matching the template's first, at the rate the correlator is fed */
+	uint32_t template_index;
+	float score; /* |<x,t>|^2 / (|x|^2 |t|^2), 1 when the samples are a scaled and rotated copy of the template */
+	float phase; /* Of <x,t> in radians, the rotation */
+} airspy_correlation_hit_t;
+
+typedef void (*airspy_correlation_cb_fn)(void* ctx, const airspy_correlation_hit_t* hit);
+
+struct airspy_correlator;
+
+typedef struct {
+	uint32_t interpolation; /* Output rate = input rate * interpolation / decimation, up to 1024 phases once reduced */
+	uint32_t decimation;
+	double ratio; /* Output rate / input rate for any other ratio, through the Farrow form; 0 for the rational form */
+	uint32_t zero_crossings; /* Of the lowpass on each side, 0 for 16; more is sharper and slower */
+} airspy_resampler_params_t;
+
+struct airspy_resampler;
+
+#define AIRSPY_CONVOLVER_COMPLEX (1 << 0) /* Taps are complex, interleaved re/im */
+#define AIRSPY_CONVOLVER_DIRECT (1 << 1) /* Always the direct form, whatever the taps and blocks */
+#define AIRSPY_CONVOLVER_FFT (1 << 2) /* Always overlap-save FFT convolution */
+
+struct airspy_convolver;
+
+#define AIRSPY_INDEX_DISCONTINUITY (1 << 0) /* Samples are missing before the block, or it is the first */
+#define AIRSPY_INDEX_RETUNED (1 << 1) /* The frequency changed since the block before */
+#define AIRSPY_INDEX_GAIN_CHANGED (1 << 2) /* A gain or AGC setting changed since the block before */
+
+#define AIRSPY_INDEX_GAIN_UNKNOWN (0xff) /* The gain was never set while the device was open */
+#define AIRSPY_INDEX_LNA_AGC (1 << 0)
+#define AIRSPY_INDEX_MIXER_AGC (1 << 1)
+
+/* A recorded block; samples are real ADC samples in raw captures and IQ samples otherwise */
+typedef struct {
+	uint64_t sample_start; /* In the capture file */
+	uint64_t sample_index; /* In the stream */
+	uint64_t byte_offset; /* Of the block in the capture file, or of its first codec block when compressed */
+	int64_t time_ns; /* When the block reached the recorder, ns since the Unix epoch; monotonic within a recording */
+	uint32_t sample_count;
+	uint32_t freq_hz; /* 0 if never set */
+	uint8_t lna_gain; /* AIRSPY_INDEX_GAIN_UNKNOWN if never set, as for mixer_gain and vga_gain */
+	uint8_t mixer_gain;
+	uint8_t vga_gain;
+	uint8_t agc; /* AIRSPY_INDEX_LNA_AGC | AIRSPY_INDEX_MIXER_AGC */
+	uint32_t flags; /* AIRSPY_INDEX_* */
+} airspy_index_entry_t;
+
+struct airspy_capture_index;
+
+#define AIRSPY_POWER_MAX_LEVELS (16)
+
+/* Power |x|^2 of the IQ samples in a bucket, in dBFS: a full scale complex tone reads 0 */
+typedef struct {
+	float min_db; /* NaN if no samples went in */
+	float max_db;
+	float mean_db;
+	uint32_t samples; /* Fewer than the bucket's where samples were lost or left out */
+} airspy_power_summary_t;
+
+typedef struct {
+	double sample_rate; /* IQ samples per second */
+	uint64_t first_sample_index; /* Stream sample_index (IQ samples) at which bucket 0 of every level starts */
+	uint32_t bucket_samples; /* IQ samples per bucket of level 0; a bucket of level n spans factor^n times as many */
+	uint32_t factor;
+	uint32_t fft_size; /* Bins per bucket, 0 without per-bin summaries */
+	uint32_t levels; /* The last has a single bucket, unless the recording was cut short */
+	uint64_t buckets[AIRSPY_POWER_MAX_LEVELS]; /* Per level */
+} airspy_power_info_t;
+
+struct airspy_power_pyramid;
+
+#define AIRSPY_FILE_PACED (1 << 0) /* Deliver blocks at the nominal sample rate instead of as fast as possible */
+#define AIRSPY_FILE_LOOP (1 << 1) /* Start over at the end of the file instead of stopping */
+
+typedef struct {
+	uint32_t samplerate; /* IQ sample rate of the capture in Hz; 0 takes it from the SigMF metadata */
+	uint8_t packed; /* Capture is in the 12-bit packed wire format (ignored when samplerate is 0) */
+	uint32_t flags;
+} airspy_file_params_t;
+
+typedef struct {
+	uint32_t threads; /* Workers, 0 for one per online CPU; 1 converts serially without priming, as a reference */
+	uint32_t chunk_samples; /* Real samples per chunk, 0 for 4 Mi */
+	uint32_t prime_samples; /* Real samples ahead of each chunk run through its converter first, 0 for 4096 */
+	uint8_t packed; /* Input is in the 12-bit packed wire format; taken from the SigMF metadata if there is any */
+} airspy_convert_params_t;
+
+#define AIRSPY_SIM_UNPACED (1 << 0) /* Complete transfers as fast as they are submitted instead of at the sample rate */
+
+typedef struct {
+	uint32_t samplerate; /* IQ sample rate the simulated firmware starts at and offers, 0 for 10 MS/s */
+	uint32_t flags;
+	uint32_t jitter_us; /* Each completion is late by a random amount up to this */
+	uint32_t error_ppm; /* Per-transfer odds, in parts per million, of an error, a stall and a short transfer */
+	uint32_t stall_ppm;
+	uint32_t short_ppm;
+	uint64_t disconnect_after; /* The device vanishes after this many blocks, 0 for never */
+	uint32_t seed; /* Seed for the fault and jitter generator */
+} airspy_sim_params_t;
+
+typedef struct {
+	uint64_t blocks_completed;
+	uint64_t blocks_overrun; /* Produced while no transfer was queued to take them, and lost */
+	uint64_t errors_injected;
+	uint64_t stalls_injected;
+	uint64_t short_injected;
+	uint32_t max_late_us; /* Largest delay between a block being due and its transfer completing */
+} airspy_sim_stats_t;
+
+enum airspy_event
+{
+	AIRSPY_EVENT_DEVICE_ARRIVED = 0, /* Some AirSpy was plugged in, e.g. to attach as the new standby */
+	AIRSPY_EVENT_DEVICE_LEFT = 1, /* The streaming device is gone and there was no standby to take over */
+	AIRSPY_EVENT_STANDBY_LOST = 2, /* The standby device is gone or failed to follow a configuration change; detach it */
+	AIRSPY_EVENT_FAILOVER = 3, /* The standby has replaced the departed device and streaming continues */
+	AIRSPY_EVENT_BUFFERS_EXHAUSTED = 4, /* Loan mode: every buffer is out, blocks arrive without one until some come back */
+};
+
+typedef void (*airspy_event_cb_fn)(struct airspy_device *device, void *ctx, enum airspy_event event);
+
+typedef int (*airspy_sweep_cb_fn)(struct airspy_device *device, void *ctx, const airspy_sweep_result_t* result);
+
 extern ADDAPI void ADDCALL airspy_lib_version(airspy_lib_version_t* lib_version);
 
 extern ADDAPI int ADDCALL airspy_open_sn(struct airspy_device** device, uint64_t serial_number);
 extern ADDAPI int ADDCALL airspy_open(struct airspy_device** device);
+/* Fills serials with up to count attached serial numbers (count 0 just counts them) and returns how many were found, or an error */
+extern ADDAPI int ADDCALL airspy_list_devices(uint64_t* serials, int count);
+/*
+ * Open count devices concurrently. serial_numbers may be NULL to open any count devices. Returns AIRSPY_SUCCESS if all
+ * were opened, otherwise the first error; results (may be NULL) receives the status of each open and failed entries of
+ * devices are set to NULL.
+ */
+extern ADDAPI int ADDCALL airspy_open_devices(struct airspy_device** devices, const uint64_t* serial_numbers, int count, int* results);
+/*
+ * Open a raw capture (AIRSPY_RECORD_RAW or AIRSPY_RECORD_RAW_COMPRESSED, or any stream of ADC samples) as a virtual
+ * device. airspy_do_rx() feeds the mapped file through the same converter and callback as a live stream, and returns at
+ * the end of the file. Settings are accepted and ignored, except the sample rate which sets the pace. Not available on
+ * Windows.
+ */
+extern ADDAPI int ADDCALL airspy_open_file(struct airspy_device** device, const char* path, const airspy_file_params_t* params);
+/*
+ * Convert a raw capture to SigMF ci16_le IQ, as streaming it would, on params->threads workers; the call returns when
+ * the output is written. With the default priming the output is the same as with threads = 1. Not available on Windows.
+ */
+extern ADDAPI int ADDCALL airspy_convert_file(const char* input_path, const char* output_path, const airspy_convert_params_t* params);
+/*
+ * Compress a raw capture losslessly to the AIRSPY_RECORD_RAW_COMPRESSED format, which airspy_open_file() replays
+ * directly, and expand one back byte for byte. packed gives the input's format when it has no metadata; an input that
+ * isn't whole samples, or whole 12-byte groups when packed, gives AIRSPY_ERROR_INVALID_PARAM. Not available on Windows.
+ */
+extern ADDAPI int ADDCALL airspy_compress_capture(const char* input_path, const char* output_path, uint8_t packed);
+extern ADDAPI int ADDCALL airspy_expand_capture(const char* input_path, const char* output_path);
+/*
+ * Open an in-process simulator as a device. It stands in for the USB transport: transfers are submitted, completed,
+ * resubmitted and cancelled as with libusb, and filled with a synthetic 12-bit test tone at the simulated rate.
+ * Faults and timing jitter can be injected to exercise recovery. Not available on Windows.
+ */
+extern ADDAPI int ADDCALL airspy_open_sim(struct airspy_device** device, const airspy_sim_params_t* params);
 extern ADDAPI int ADDCALL airspy_close(struct airspy_device* device);
 
 extern ADDAPI int ADDCALL airspy_get_samplerates(struct airspy_device* device, uint32_t* buffer, const uint32_t len);
@@ -183,6 +568,218 @@ extern ADDAPI int ADDCALL airspy_set_rf_bias(struct airspy_device* dev, uint8_t
 /* Parameter value shall be 0=Disable Packing or 1=Enable Packing */
 extern ADDAPI int ADDCALL airspy_set_packing(struct airspy_device* device, uint8_t value);
 
+/*
+ * Sweep mode: call airspy_start_sweep() before airspy_init_rx(), then airspy_do_rx() retunes across the
+ * plan while streaming. Blocks go to the sweep engine instead of the sample callback (which may be NULL);
+ * averaged FFT bins are computed on a worker thread and a stitched spectrum is passed to callback once
+ * per sweep. A non-zero return from callback stops airspy_do_rx(). Packing is not supported while sweeping.
+ */
+extern ADDAPI int ADDCALL airspy_start_sweep(struct airspy_device* device, const airspy_sweep_params_t* params, airspy_sweep_cb_fn callback, void* sweep_ctx);
+extern ADDAPI int ADDCALL airspy_stop_sweep(struct airspy_device* device);
+
+/*
+ * Hotplug and warm standby. Events are delivered from the airspy_do_rx() thread, outside of USB event handling, so
+ * the event callback may call back into the library (e.g. airspy_attach_standby() on AIRSPY_EVENT_DEVICE_ARRIVED).
+ */
+extern ADDAPI int ADDCALL airspy_set_event_callback(struct airspy_device* device, airspy_event_cb_fn callback, void* event_ctx);
+/*
+ * Open a second device (serial_number 0 for any free one) on the same USB context, replay the current configuration
+ * (samplerate, packing, gains, AGC, bias tee, frequency) onto it and mirror every later change. When the streaming
+ * device departs, airspy_do_rx() swaps the standby in and restarts the stream without returning.
+ */
+extern ADDAPI int ADDCALL airspy_attach_standby(struct airspy_device* device, uint64_t serial_number);
+extern ADDAPI int ADDCALL airspy_detach_standby(struct airspy_device* device);
+/* Hand streaming over to the standby now, e.g. ahead of planned maintenance */
+extern ADDAPI int ADDCALL airspy_failover(struct airspy_device* device);
+
+/*
+ * Stream recovery, disabled by default. With max_attempts > 0 a failed transfer no longer ends the stream: airspy_do_rx()
+ * resubmits it (clearing the endpoint halt after a stall) and tags the next block with AIRSPY_TRANSFER_DISCONTINUITY.
+ * The converter keeps its state across the gap unless a round fails again, which restarts the receiver. The stream is
+ * stopped after max_attempts consecutive rounds without a delivered block.
+ */
+extern ADDAPI int ADDCALL airspy_set_recovery(struct airspy_device* device, uint32_t max_attempts);
+/*
+ * Converts successive blocks on a pool of threads, 0 (the default) for inline, for rates one core can't keep up with.
+ * Blocks still reach the callback in order on the airspy_do_rx() thread, as converted inline, about one transfer period
+ * later. Only while not streaming.
+ */
+extern ADDAPI int ADDCALL airspy_set_conversion_threads(struct airspy_device* device, uint32_t threads);
+/*
+ * What the sample callback receives, AIRSPY_SAMPLE_INT16_IQ by default. The other IQ types are worked out from IQ just
+ * before the callback; every other stage still gets IQ, and sample_count and sample_index keep counting IQ samples. The
+ * real types skip the IQ conversion, count real samples at twice the IQ rate, and leave only raw recordings and
+ * subscribers fed. Only while not streaming.
+ */
+extern ADDAPI int ADDCALL airspy_set_sample_type(struct airspy_device* device, enum airspy_sample_type sample_type);
+/*
+ * Loan mode, disabled by default: with buffers > 0, a block delivered with a transfer->buffer keeps its samples valid
+ * until that buffer is passed to airspy_release_buffer(), from any thread, and every such buffer must be. Only while
+ * not streaming and with no buffer out.
+ */
+extern ADDAPI int ADDCALL airspy_set_buffer_loans(struct airspy_device* device, uint32_t buffers);
+extern ADDAPI int ADDCALL airspy_release_buffer(struct airspy_device* device, struct airspy_buffer* buffer);
+/*
+ * Subscribers receive the stream alongside the RX callback, each in its own format and rate, on a thread of its own
+ * unless AIRSPY_SUBSCRIBER_INLINE; with only subscribers, airspy_do_rx() may be given a NULL callback. Callbacks run in
+ * stream order, samples stay valid until they return, and returning nonzero stops deliveries to that subscriber only.
+ * sample_index and dropped_samples count samples at the subscriber's rate. Sweeps have the stream to themselves, and
+ * subscribers are added and removed only while not streaming.
+ */
+extern ADDAPI int ADDCALL airspy_subscribe(struct airspy_device* device, const airspy_subscriber_params_t* params,
+	airspy_sample_block_cb_fn callback, void* ctx, struct airspy_subscriber** subscriber);
+extern ADDAPI int ADDCALL airspy_unsubscribe(struct airspy_device* device, struct airspy_subscriber* subscriber);
+extern ADDAPI int ADDCALL airspy_get_subscriber_stats(struct airspy_device* device, struct airspy_subscriber* subscriber,
+	airspy_subscriber_stats_t* stats);
+/*
+ * The broker publishes the stream, in one subscriber format, to other processes through a POSIX shared memory ring
+ * of params->slots blocks. It is an inline subscriber and never waits for readers: each slot carries a sequence
+ * number that is odd while it is written, and a reader that falls a full ring behind loses the oldest blocks. A
+ * name left behind by a broker that died is reused; one held by a running broker is AIRSPY_ERROR_BUSY. Only while
+ * not streaming, and the packing can't change until the broker is stopped.
+ */
+extern ADDAPI int ADDCALL airspy_start_broker(struct airspy_device* device, const airspy_broker_params_t* params);
+extern ADDAPI int ADDCALL airspy_stop_broker(struct airspy_device* device);
+extern ADDAPI int ADDCALL airspy_get_broker_stats(struct airspy_device* device, airspy_broker_stats_t* stats);
+/*
+ * Serves the stream from a thread of its own to rtl_tcp clients, which start with rtl_tcp's bytes at the lowest offered
+ * decimation, and to one UDP destination as VITA-49. Nothing waits on the network: a client queue_depth blocks behind
+ * misses blocks. Only while not streaming.
+ */
+extern ADDAPI int ADDCALL airspy_start_server(struct airspy_device* device, const airspy_server_params_t* params);
+extern ADDAPI int ADDCALL airspy_stop_server(struct airspy_device* device);
+extern ADDAPI int ADDCALL airspy_get_server_stats(struct airspy_device* device, airspy_server_stats_t* stats);
+/*
+ * Readers attach to a broker by name from any process, without a device, and start at the newest block. Up to 32
+ * can be attached at once. airspy_reader_next() waits up to timeout_ms for a block (AIRSPY_ERROR_TIMEOUT), and fills
+ * transfer with samples pointing straight into the ring; AIRSPY_ERROR_STREAMING_STOPPED once the broker has stopped
+ * or died and everything published was read. Nothing stops the broker overwriting a block that is being read, so
+ * the samples are only known to be intact when airspy_reader_release() returns AIRSPY_SUCCESS rather than
+ * AIRSPY_ERROR_OVERRUN. Asking for the next block releases the current one.
+ */
+extern ADDAPI int ADDCALL airspy_reader_open(struct airspy_reader** reader, const char* name);
+extern ADDAPI int ADDCALL airspy_reader_next(struct airspy_reader* reader, airspy_transfer_t* transfer, uint32_t timeout_ms);
+extern ADDAPI int ADDCALL airspy_reader_release(struct airspy_reader* reader);
+extern ADDAPI int ADDCALL airspy_reader_get_stats(struct airspy_reader* reader, airspy_reader_stats_t* stats);
+extern ADDAPI int ADDCALL airspy_reader_close(struct airspy_reader* reader);
+/*
+ * Hot standby: while paused the receiver keeps running and transfers keep cycling, but blocks are neither converted
+ * nor passed to the callback. The first block after airspy_resume_rx() arrives within one transfer period and is
+ * tagged with AIRSPY_TRANSFER_DISCONTINUITY; the converter is reset for it. Both may be called from any thread.
+ */
+extern ADDAPI int ADDCALL airspy_pause_rx(struct airspy_device* device);
+extern ADDAPI int ADDCALL airspy_resume_rx(struct airspy_device* device);
+/* Counters since airspy_init_rx(), may be read from any thread */
+extern ADDAPI int ADDCALL airspy_get_stream_stats(struct airspy_device* device, airspy_stream_stats_t* stats);
+
+/*
+ * Record the stream to params->path as SigMF. Blocks are handed to a writer thread without blocking airspy_do_rx();
+ * those that don't fit in the backlog are dropped and counted. May be started and stopped while streaming, and the
+ * sample callback may be NULL while recording. Not available on Windows.
+ */
+extern ADDAPI int ADDCALL airspy_start_recording(struct airspy_device* device, const airspy_record_params_t* params);
+/* Flushes the backlog and writes the SigMF metadata; returns an error if any write failed */
+extern ADDAPI int ADDCALL airspy_stop_recording(struct airspy_device* device);
+extern ADDAPI int ADDCALL airspy_get_record_stats(struct airspy_device* device, airspy_record_stats_t* stats);
+
+/*
+ * Pre-trigger capture: keep the last pre_ms of converted IQ in memory and write it with the post_ms after each trigger
+ * as a SigMF recording of its own. airspy_do_rx() feeds the ring under the device's record lock, held elsewhere only
+ * briefly, and a snapshot thread writes it out without stalling the stream. airspy_trigger() may be called from any
+ * thread or a signal handler; AIRSPY_TRIGGER_POWER also fires on the power threshold. Not available on Windows.
+ */
+extern ADDAPI int ADDCALL airspy_start_trigger_capture(struct airspy_device* device, const airspy_trigger_params_t* params);
+extern ADDAPI int ADDCALL airspy_trigger(struct airspy_device* device);
+extern ADDAPI int ADDCALL airspy_stop_trigger_capture(struct airspy_device* device);
+extern ADDAPI int ADDCALL airspy_get_trigger_stats(struct airspy_device* device, airspy_trigger_stats_t* stats);
+
+/*
+ * Squelch, disabled by default: only bursts more than snr_db above the noise floor, with pre_samples before and
+ * post_samples after them, reach the sample callback and IQ recordings. A burst comes as segments in order, the first
+ * flagged AIRSPY_TRANSFER_BURST_START and the last AIRSPY_TRANSFER_BURST_END, each with the sample_index of its first
+ * sample, so pre-padding may start in the previous block. A burst cut short by lost samples has no end segment and the
+ * next segment is flagged AIRSPY_TRANSFER_DISCONTINUITY. Segments never come with a loan buffer. NULL params disables
+ * it. Only while not streaming.
+ */
+extern ADDAPI int ADDCALL airspy_set_squelch(struct airspy_device* device, const airspy_squelch_params_t* params);
+extern ADDAPI int ADDCALL airspy_get_squelch_stats(struct airspy_device* device, airspy_squelch_stats_t* stats);
+
+/*
+ * Correlator bank: slides up to 64 complex templates over float IQ and reports each hit, the best score of a run above
+ * its template's threshold, when the run ends or a template length into it. airspy_correlator_process() takes blocks in
+ * stream order and calls callback for every hit before it returns; a gap in sample_index reports what is pending and
+ * starts over. airspy_subscribe_correlator() runs one and callback on a subscriber of its own at decimation. A
+ * correlator serves one stream at a time, and is freed after airspy_unsubscribe().
+ */
+extern ADDAPI int ADDCALL airspy_correlator_create(struct airspy_correlator** correlator, const airspy_template_t* templates,
+	uint32_t count, uint32_t flags);
+extern ADDAPI int ADDCALL airspy_correlator_process(struct airspy_correlator* correlator, const airspy_transfer_t* transfer,
+	airspy_correlation_cb_fn callback, void* ctx);
+extern ADDAPI int ADDCALL airspy_correlator_free(struct airspy_correlator* correlator);
+extern ADDAPI int ADDCALL airspy_subscribe_correlator(struct airspy_device* device, struct airspy_correlator* correlator,
+	uint32_t decimation, airspy_correlation_cb_fn callback, void* ctx, struct airspy_subscriber** subscriber);
+
+/*
+ * Resampler for complex float IQ, by interpolation / decimation or by any ratio given as a double.
+ * airspy_resampler_process() takes count interleaved samples in stream order and writes up to
+ * airspy_resampler_max_output(count) to output, flat to about two thirds of the narrower band and delayed by
+ * zero_crossings / min(ratio, 1) input samples, rounded up to a multiple of 4.
+ */
+extern ADDAPI int ADDCALL airspy_resampler_create(struct airspy_resampler** resampler, const airspy_resampler_params_t* params);
+extern ADDAPI int ADDCALL airspy_resampler_process(struct airspy_resampler* resampler, const float* input, uint32_t count,
+	float* output, uint32_t* output_count);
+extern ADDAPI uint32_t ADDCALL airspy_resampler_max_output(struct airspy_resampler* resampler, uint32_t count);
+extern ADDAPI int ADDCALL airspy_resampler_reset(struct airspy_resampler* resampler);
+extern ADDAPI int ADDCALL airspy_resampler_free(struct airspy_resampler* resampler);
+
+/*
+ * Convolver: a FIR filter with user taps over complex float IQ, with no latency beyond the filter's own.
+ * airspy_convolver_process() takes count interleaved samples in stream order and writes as many, in place when output
+ * is input. airspy_subscribe_convolver() filters a subscriber's blocks as AIRSPY_SUBSCRIBER_IQ_FLOAT32 and hands
+ * callback each with the subscriber's transfer fields; a gap in sample_index clears the filter. A convolver serves one
+ * stream at a time, and is freed after airspy_unsubscribe().
+ */
+extern ADDAPI int ADDCALL airspy_convolver_create(struct airspy_convolver** convolver, const float* taps, uint32_t tap_count,
+	uint32_t flags);
+extern ADDAPI int ADDCALL airspy_convolver_process(struct airspy_convolver* convolver, const float* input, uint32_t count,
+	float* output);
+extern ADDAPI int ADDCALL airspy_convolver_reset(struct airspy_convolver* convolver);
+extern ADDAPI int ADDCALL airspy_convolver_free(struct airspy_convolver* convolver);
+extern ADDAPI int ADDCALL airspy_subscribe_convolver(struct airspy_device* device, struct airspy_convolver* convolver,
+	const airspy_subscriber_params_t* params, airspy_sample_block_cb_fn callback, void* ctx,
+	struct airspy_subscriber** subscriber);
+
+/*
+ * Every recording also gets a sidecar index with an entry per block, .sigmf-index in place of .sigmf-data.
+ * airspy_index_open() maps the index of the capture at path; the find functions return the last entry starting at or
+ * before a sample or time, the first entry if none does, and AIRSPY_ERROR_NOT_FOUND for an empty index.
+ */
+extern ADDAPI int ADDCALL airspy_index_open(struct airspy_capture_index** index, const char* path);
+extern ADDAPI int ADDCALL airspy_index_close(struct airspy_capture_index* index);
+extern ADDAPI int ADDCALL airspy_index_get_count(struct airspy_capture_index* index, uint64_t* count);
+extern ADDAPI int ADDCALL airspy_index_get(struct airspy_capture_index* index, uint64_t n, airspy_index_entry_t* entry);
+extern ADDAPI int ADDCALL airspy_index_find_sample(struct airspy_capture_index* index, uint64_t sample, uint64_t* n);
+extern ADDAPI int ADDCALL airspy_index_find_time(struct airspy_capture_index* index, int64_t time_ns, uint64_t* n);
+/*
+ * Power summaries of a recording made with power_bucket set, .sigmf-power in place of .sigmf-data: min, max and mean
+ * dBFS per bucket, in levels of ever larger buckets. airspy_power_read() fills count summaries from bucket first of
+ * level and, unless bins is NULL, count * 3 * fft_size floats: min, max and mean per bin.
+ */
+extern ADDAPI int ADDCALL airspy_power_open(struct airspy_power_pyramid** pyramid, const char* path);
+extern ADDAPI int ADDCALL airspy_power_close(struct airspy_power_pyramid* pyramid);
+extern ADDAPI int ADDCALL airspy_power_get_info(struct airspy_power_pyramid* pyramid, airspy_power_info_t* info);
+extern ADDAPI int ADDCALL airspy_power_read(struct airspy_power_pyramid* pyramid, uint32_t level, uint64_t first,
+	uint32_t count, airspy_power_summary_t* summaries, float* bins);
+/*
+ * Continue a replay from sample (real ADC samples into the file, as in the index, rounded down to a multiple of 8) on a
+ * device opened with airspy_open_file(). May be called while streaming: the next block comes from there, flagged
+ * AIRSPY_TRANSFER_DISCONTINUITY, with sample_index following the file position. Seeking a compressed capture goes
+ * through its block index. AIRSPY_ERROR_INVALID_PARAM for other devices.
+ */
+extern ADDAPI int ADDCALL airspy_seek_file(struct airspy_device* device, uint64_t sample);
+/* What the simulator behind a device opened with airspy_open_sim() has done; AIRSPY_ERROR_INVALID_PARAM for any other device */
+extern ADDAPI int ADDCALL airspy_get_sim_stats(struct airspy_device* device, airspy_sim_stats_t* stats);
+
 extern ADDAPI const char* ADDCALL airspy_error_name(enum airspy_error errcode);
 extern ADDAPI const char* ADDCALL airspy_board_id_name(enum airspy_board_id board_id);
 
@@ -0,0 +1,633 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "broker.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef __linux__
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#define BROKER_HAVE_FUTEX
+#endif
+#endif
+
+#define BROKER_MAGIC 0x52425341
+#define BROKER_VERSION 1
+#define BROKER_ALIGN 64
+#define BROKER_POLL_US 1000
+
+typedef struct
+{
+    volatile uint32_t pid;      /* 0 while the entry is free */
+    uint32_t reserved;
+    volatile uint64_t next;     /* Next block the reader will look at */
+    volatile uint64_t overruns;
+    volatile uint64_t torn;
+} broker_reader_entry_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t writer_pid;
+    uint64_t slot_bytes;
+    uint64_t slot_stride;
+    uint64_t slots_offset;
+    uint32_t format;
+    uint32_t decimation;
+    uint32_t fft_size;
+    uint32_t packed;
+
+    volatile uint64_t write_seq;    /* Blocks published */
+    volatile uint32_t wake;         /* Bumped on every publish, for readers to sleep on */
+    volatile uint32_t waiters;
+    volatile uint32_t closed;
+    uint32_t reserved2;
+
+    broker_reader_entry_t readers[BROKER_MAX_READERS];
+} broker_header_t;
+
+/* Followed by the data, at BROKER_ALIGN */
+typedef struct
+{
+    volatile uint64_t seq;      /* 2n + 1 while block n is written, 2n + 2 once it is complete */
+    uint64_t sample_index;
+    uint64_t dropped_samples;
+    uint64_t bytes;
+    int32_t sample_count;
+    uint32_t flags;
+} broker_slot_t;
+
+struct broker
+{
+    char *name;
+    size_t size;
+    broker_header_t *header;
+    enum airspy_subscriber_format format;
+};
+
+struct airspy_reader
+{
+    size_t size;
+    broker_header_t *header;
+    broker_reader_entry_t *entry;
+    uint64_t next;
+    uint64_t reading;
+    uint64_t expected;
+    int holding;
+    uint64_t blocks;
+    uint64_t overruns;
+    uint64_t torn;
+};
+
+#ifndef _WIN32
+
+static broker_slot_t *broker_slot(broker_header_t *header, uint64_t n)
+{
+    return (broker_slot_t *) ((uint8_t *) header + header->slots_offset + (n % header->slot_count) * header->slot_stride);
+}
+
+static int broker_pid_alive(uint32_t pid)
+{
+    return 0 == kill((pid_t) pid, 0) || EPERM == errno;
+}
+
+static void broker_wake(broker_header_t *header)
+{
+    __atomic_add_fetch(&header->wake, 1, __ATOMIC_RELEASE);
+#ifdef BROKER_HAVE_FUTEX
+    if (__atomic_load_n(&header->waiters, __ATOMIC_ACQUIRE) != 0) {
+        syscall(SYS_futex, &header->wake, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+#endif
+}
+
+/* Sleeps until the writer publishes or timeout_us passes */
+static void broker_wait(broker_header_t *header, uint64_t seen, uint64_t timeout_us)
+{
+    struct timespec ts;
+
+    if (timeout_us > BROKER_POLL_US * 100) {
+        /* Wake up now and then to notice a writer that died */
+        timeout_us = BROKER_POLL_US * 100;
+    }
+    ts.tv_sec = (time_t) (timeout_us / 1000000);
+    ts.tv_nsec = (long) (timeout_us % 1000000) * 1000;
+
+#ifdef BROKER_HAVE_FUTEX
+    {
+        uint32_t wake;
+
+        __atomic_add_fetch(&header->waiters, 1, __ATOMIC_ACQ_REL);
+        wake = __atomic_load_n(&header->wake, __ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&header->write_seq, __ATOMIC_ACQUIRE) == seen && !header->closed) {
+            syscall(SYS_futex, &header->wake, FUTEX_WAIT, wake, &ts, NULL, 0);
+        }
+        __atomic_sub_fetch(&header->waiters, 1, __ATOMIC_ACQ_REL);
+    }
+#else
+    (void) seen;
+    if (timeout_us > BROKER_POLL_US) {
+        ts.tv_sec = 0;
+        ts.tv_nsec = BROKER_POLL_US * 1000;
+    }
+    nanosleep(&ts, NULL);
+#endif
+}
+
+static uint64_t broker_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int broker_create(broker_t **broker_out, const airspy_broker_params_t *params, size_t slot_bytes, int packed)
+{
+    broker_t *broker;
+    broker_header_t *header;
+    broker_header_t existing;
+    uint32_t slot_count;
+    size_t stride;
+    size_t offset;
+    int fd;
+
+    if (NULL == params || NULL == params->name || '/' != params->name[0] || 0 == slot_bytes) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    slot_count = params->slots > 0 ? params->slots : BROKER_DEFAULT_SLOTS;
+    offset = (sizeof(broker_header_t) + BROKER_ALIGN - 1) / BROKER_ALIGN * BROKER_ALIGN;
+    stride = BROKER_ALIGN + (slot_bytes + BROKER_ALIGN - 1) / BROKER_ALIGN * BROKER_ALIGN;
+
+    broker = (broker_t *) calloc(1, sizeof(broker_t));
+    if (NULL == broker) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+    broker->name = strdup(params->name);
+    broker->size = offset + stride * slot_count;
+    broker->format = params->format;
+    if (NULL == broker->name) {
+        free(broker);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    fd = shm_open(params->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && EEXIST == errno) {
+        /* Left behind by a broker that didn't get to clean up; one that is still running keeps it */
+        fd = shm_open(params->name, O_RDONLY, 0);
+        if (fd >= 0) {
+            if (pread(fd, &existing, sizeof(existing), 0) == (ssize_t) sizeof(existing) &&
+                    BROKER_MAGIC == existing.magic && !existing.closed && broker_pid_alive(existing.writer_pid)) {
+                close(fd);
+                free(broker->name);
+                free(broker);
+                return AIRSPY_ERROR_BUSY;
+            }
+            close(fd);
+        }
+        shm_unlink(params->name);
+        fd = shm_open(params->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+    if (fd < 0) {
+        free(broker->name);
+        free(broker);
+        return AIRSPY_ERROR_OTHER;
+    }
+
+    if (ftruncate(fd, (off_t) broker->size) != 0) {
+        close(fd);
+        shm_unlink(params->name);
+        free(broker->name);
+        free(broker);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    header = (broker_header_t *) mmap(NULL, broker->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == header) {
+        shm_unlink(params->name);
+        free(broker->name);
+        free(broker);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    /* A fresh object reads as zeroes, so every slot starts out empty */
+    header->version = BROKER_VERSION;
+    header->slot_count = slot_count;
+    header->writer_pid = (uint32_t) getpid();
+    header->slot_bytes = slot_bytes;
+    header->slot_stride = stride;
+    header->slots_offset = offset;
+    header->format = (uint32_t) params->format;
+    header->decimation = params->decimation > 1 ? params->decimation : 1;
+    header->fft_size = params->format == AIRSPY_SUBSCRIBER_PSD ? params->fft_size : 0;
+    header->packed = params->format == AIRSPY_SUBSCRIBER_RAW && packed;
+    __atomic_store_n(&header->magic, BROKER_MAGIC, __ATOMIC_RELEASE);
+
+    broker->header = header;
+    *broker_out = broker;
+
+    return AIRSPY_SUCCESS;
+}
+
+void broker_free(broker_t *broker)
+{
+    if (NULL == broker) {
+        return;
+    }
+
+    __atomic_store_n(&broker->header->closed, 1, __ATOMIC_RELEASE);
+    broker_wake(broker->header);
+
+    /* Attached readers keep their mapping; new ones can't find it */
+    shm_unlink(broker->name);
+    munmap(broker->header, broker->size);
+    free(broker->name);
+    free(broker);
+}
+
+int broker_publish(struct airspy_device *device, void *ctx, airspy_transfer_t *transfer)
+{
+    broker_t *broker = (broker_t *) ctx;
+    broker_header_t *header = broker->header;
+    broker_slot_t *slot;
+    uint64_t bytes;
+    uint64_t n;
+
+    (void) device;
+
+    switch (broker->format) {
+    case AIRSPY_SUBSCRIBER_RAW:
+        /* Eight packed samples to three words */
+        bytes = header->packed ? (uint64_t) transfer->sample_count * 3 / 2 : (uint64_t) transfer->sample_count * sizeof(uint16_t);
+        break;
+    case AIRSPY_SUBSCRIBER_IQ_FLOAT32:
+        bytes = (uint64_t) transfer->sample_count * 2 * sizeof(float);
+        break;
+    case AIRSPY_SUBSCRIBER_PSD:
+        bytes = (uint64_t) transfer->sample_count * sizeof(float);
+        break;
+    default:
+        bytes = (uint64_t) transfer->sample_count * 2 * sizeof(int16_t);
+        break;
+    }
+
+    if (bytes > header->slot_bytes) {
+        /* Can't happen while the packing is held */
+        return 0;
+    }
+
+    n = header->write_seq;
+    slot = broker_slot(header, n);
+
+    __atomic_store_n(&slot->seq, 2 * n + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->sample_index = transfer->sample_index;
+    slot->dropped_samples = transfer->dropped_samples;
+    slot->bytes = bytes;
+    slot->sample_count = transfer->sample_count;
+    slot->flags = transfer->flags;
+    memcpy((uint8_t *) slot + BROKER_ALIGN, transfer->samples, bytes);
+
+    __atomic_store_n(&slot->seq, 2 * n + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->write_seq, n + 1, __ATOMIC_RELEASE);
+    broker_wake(header);
+
+    return 0;
+}
+
+void broker_get_stats(broker_t *broker, airspy_broker_stats_t *stats)
+{
+    broker_header_t *header = broker->header;
+    uint64_t written;
+    uint64_t next;
+    uint64_t lag;
+    uint32_t pid;
+    uint32_t i;
+
+    memset(stats, 0, sizeof(*stats));
+    written = __atomic_load_n(&header->write_seq, __ATOMIC_ACQUIRE);
+    stats->blocks_published = written;
+
+    for (i = 0; i < BROKER_MAX_READERS; i++) {
+        pid = __atomic_load_n(&header->readers[i].pid, __ATOMIC_ACQUIRE);
+        if (0 == pid || !broker_pid_alive(pid)) {
+            continue;
+        }
+        stats->readers++;
+        next = __atomic_load_n(&header->readers[i].next, __ATOMIC_RELAXED);
+        lag = written > next ? written - next : 0;
+        if (lag > stats->max_lag) {
+            stats->max_lag = lag;
+        }
+        stats->reader_overruns += header->readers[i].overruns;
+    }
+}
+
+/* Takes a free entry in the reader table, or one whose process is gone */
+static broker_reader_entry_t *broker_claim_entry(broker_header_t *header)
+{
+    broker_reader_entry_t *entry;
+    uint32_t self;
+    uint32_t pid;
+    uint32_t i;
+
+    self = (uint32_t) getpid();
+    for (i = 0; i < BROKER_MAX_READERS; i++) {
+        entry = &header->readers[i];
+        pid = __atomic_load_n(&entry->pid, __ATOMIC_ACQUIRE);
+        if (pid != 0 && broker_pid_alive(pid)) {
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&entry->pid, &pid, self, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            entry->overruns = 0;
+            entry->torn = 0;
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+int broker_reader_open(struct airspy_reader **reader_out, const char *name)
+{
+    struct airspy_reader *reader;
+    broker_header_t *header;
+    struct stat st;
+    int fd;
+
+    if (NULL == reader_out || NULL == name) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return AIRSPY_ERROR_NOT_FOUND;
+    }
+
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(broker_header_t)) {
+        close(fd);
+        return AIRSPY_ERROR_NOT_FOUND;
+    }
+
+    header = (broker_header_t *) mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == header) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != BROKER_MAGIC || header->version != BROKER_VERSION ||
+            header->slots_offset + header->slot_stride * header->slot_count > (uint64_t) st.st_size) {
+        munmap(header, (size_t) st.st_size);
+        return AIRSPY_ERROR_NOT_FOUND;
+    }
+
+    reader = (struct airspy_reader *) calloc(1, sizeof(struct airspy_reader));
+    if (NULL == reader) {
+        munmap(header, (size_t) st.st_size);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    reader->entry = broker_claim_entry(header);
+    if (NULL == reader->entry) {
+        free(reader);
+        munmap(header, (size_t) st.st_size);
+        return AIRSPY_ERROR_BUSY;
+    }
+
+    reader->size = (size_t) st.st_size;
+    reader->header = header;
+    reader->next = __atomic_load_n(&header->write_seq, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&reader->entry->next, reader->next, __ATOMIC_RELAXED);
+
+    *reader_out = reader;
+
+    return AIRSPY_SUCCESS;
+}
+
+void broker_reader_close(struct airspy_reader *reader)
+{
+    if (NULL == reader) {
+        return;
+    }
+
+    __atomic_store_n(&reader->entry->pid, 0, __ATOMIC_RELEASE);
+    munmap(reader->header, reader->size);
+    free(reader);
+}
+
+static void broker_reader_sync(struct airspy_reader *reader)
+{
+    __atomic_store_n(&reader->entry->next, reader->next, __ATOMIC_RELAXED);
+    reader->entry->overruns = reader->overruns;
+    reader->entry->torn = reader->torn;
+}
+
+int broker_reader_next(struct airspy_reader *reader, airspy_transfer_t *transfer, uint32_t timeout_ms)
+{
+    broker_header_t *header = reader->header;
+    broker_slot_t *slot;
+    uint64_t deadline;
+    uint64_t written;
+    uint64_t seq;
+    uint64_t now;
+
+    if (reader->holding) {
+        broker_reader_release(reader);
+    }
+
+    deadline = broker_now_us() + (uint64_t) timeout_ms * 1000;
+
+    for (;;) {
+        written = __atomic_load_n(&header->write_seq, __ATOMIC_ACQUIRE);
+
+        while (written > reader->next) {
+            if (written - reader->next > header->slot_count) {
+                /* Lapped: everything older than one ring is gone */
+                reader->overruns += written - header->slot_count - reader->next;
+                reader->next = written - header->slot_count;
+            }
+
+            slot = broker_slot(header, reader->next);
+            seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+            if (seq == 2 * reader->next + 2) {
+                transfer->samples = (uint8_t *) slot + BROKER_ALIGN;
+                transfer->sample_count = slot->sample_count;
+                transfer->sample_index = slot->sample_index;
+                transfer->dropped_samples = slot->dropped_samples;
+                transfer->flags = slot->flags;
+                transfer->buffer = NULL;
+
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq) {
+                    reader->holding = 1;
+                    reader->reading = reader->next;
+                    reader->expected = seq;
+                    broker_reader_sync(reader);
+                    return AIRSPY_SUCCESS;
+                }
+            }
+
+            /* Overwritten before we got to it */
+            reader->overruns++;
+            reader->next++;
+        }
+        broker_reader_sync(reader);
+
+        if (__atomic_load_n(&header->closed, __ATOMIC_ACQUIRE) || !broker_pid_alive(header->writer_pid)) {
+            return AIRSPY_ERROR_STREAMING_STOPPED;
+        }
+
+        now = broker_now_us();
+        if (now >= deadline) {
+            return AIRSPY_ERROR_TIMEOUT;
+        }
+        broker_wait(header, written, deadline - now);
+    }
+}
+
+int broker_reader_release(struct airspy_reader *reader)
+{
+    broker_slot_t *slot;
+    uint64_t seq;
+
+    if (!reader->holding) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    slot = broker_slot(reader->header, reader->reading);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+
+    reader->holding = 0;
+    reader->next = reader->reading + 1;
+
+    if (seq != reader->expected) {
+        reader->torn++;
+        broker_reader_sync(reader);
+        return AIRSPY_ERROR_OVERRUN;
+    }
+
+    reader->blocks++;
+    broker_reader_sync(reader);
+
+    return AIRSPY_SUCCESS;
+}
+
+void broker_reader_get_stats(struct airspy_reader *reader, airspy_reader_stats_t *stats)
+{
+    broker_header_t *header = reader->header;
+    uint64_t written;
+
+    written = __atomic_load_n(&header->write_seq, __ATOMIC_ACQUIRE);
+
+    stats->format = (enum airspy_subscriber_format) header->format;
+    stats->decimation = header->decimation;
+    stats->fft_size = header->fft_size;
+    stats->slots = header->slot_count;
+    stats->packed = header->packed;
+    stats->blocks = reader->blocks;
+    stats->overruns = reader->overruns;
+    stats->torn = reader->torn;
+    stats->lag = written > reader->next ? written - reader->next : 0;
+}
+
+#else
+
+int broker_create(broker_t **broker, const airspy_broker_params_t *params, size_t slot_bytes, int packed)
+{
+    (void) broker;
+    (void) params;
+    (void) slot_bytes;
+    (void) packed;
+    return AIRSPY_ERROR_OTHER;
+}
+
+void broker_free(broker_t *broker)
+{
+    (void) broker;
+}
+
+int broker_publish(struct airspy_device *device, void *ctx, airspy_transfer_t *transfer)
+{
+    (void) device;
+    (void) ctx;
+    (void) transfer;
+    return 1;
+}
+
+void broker_get_stats(broker_t *broker, airspy_broker_stats_t *stats)
+{
+    (void) broker;
+    memset(stats, 0, sizeof(*stats));
+}
+
+int broker_reader_open(struct airspy_reader **reader, const char *name)
+{
+    (void) reader;
+    (void) name;
+    return AIRSPY_ERROR_OTHER;
+}
+
+void broker_reader_close(struct airspy_reader *reader)
+{
+    (void) reader;
+}
+
+int broker_reader_next(struct airspy_reader *reader, airspy_transfer_t *transfer, uint32_t timeout_ms)
+{
+    (void) reader;
+    (void) transfer;
+    (void) timeout_ms;
+    return AIRSPY_ERROR_OTHER;
+}
+
+int broker_reader_release(struct airspy_reader *reader)
+{
+    (void) reader;
+    return AIRSPY_ERROR_OTHER;
+}
+
+void broker_reader_get_stats(struct airspy_reader *reader, airspy_reader_stats_t *stats)
+{
+    (void) reader;
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef BROKER_H
+#define BROKER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "airspy.h"
+
+#define BROKER_DEFAULT_SLOTS 32
+#define BROKER_MAX_READERS 32
+
+typedef struct broker broker_t;
+
+/*
+ * The publishing side of a shared memory ring: a header, a table of
+ * attached readers and slot_count slots of slot_bytes each, in a POSIX
+ * shared memory object. Each slot is guarded by a sequence number, odd
+ * while the slot is being written, so the writer never waits for readers;
+ * a reader that falls a full ring behind loses blocks instead.
+ */
+int broker_create(broker_t **broker, const airspy_broker_params_t *params, size_t slot_bytes, int packed);
+/* Marks the ring closed, which readers see once they have caught up, and unlinks it */
+void broker_free(broker_t *broker);
+
+/* Subscriber callback publishing each block into the ring; ctx is the broker */
+int broker_publish(struct airspy_device *device, void *ctx, airspy_transfer_t *transfer);
+
+void broker_get_stats(broker_t *broker, airspy_broker_stats_t *stats);
+
+/*
+ * The reading side, for any process. A reader starts at the newest block
+ * and sees the ring's memory directly: a block returned by
+ * broker_reader_next() is only known to be intact once
+ * broker_reader_release() says so.
+ */
+int broker_reader_open(struct airspy_reader **reader, const char *name);
+void broker_reader_close(struct airspy_reader *reader);
+int broker_reader_next(struct airspy_reader *reader, airspy_transfer_t *transfer, uint32_t timeout_ms);
+int broker_reader_release(struct airspy_reader *reader);
+void broker_reader_get_stats(struct airspy_reader *reader, airspy_reader_stats_t *stats);
+
+#endif // BROKER_H
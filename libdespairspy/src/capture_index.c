@@ -0,0 +1,176 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "capture_index.h"
+#include "recorder.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+struct airspy_capture_index
+{
+    const uint8_t *data;
+    uint64_t size;
+    const capture_index_record_t *records;
+    uint64_t count;
+};
+
+#ifndef _WIN32
+
+int capture_index_open(capture_index_t **out, const char *capture_path)
+{
+    capture_index_t *index;
+    const capture_index_header_t *header;
+    struct stat st;
+    char *path;
+    void *data;
+    int fd;
+
+    path = recorder_sidecar_path(capture_path, CAPTURE_INDEX_SUFFIX);
+    if (NULL == path) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+    fd = open(path, O_RDONLY);
+    free(path);
+    if (fd < 0) {
+        return AIRSPY_ERROR_NOT_FOUND;
+    }
+
+    if (fstat(fd, &st) != 0 || (uint64_t) st.st_size < sizeof(capture_index_header_t)) {
+        close(fd);
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    header = (const capture_index_header_t *) data;
+    if (header->magic != CAPTURE_INDEX_MAGIC || header->version != CAPTURE_INDEX_VERSION ||
+            header->record_size != sizeof(capture_index_record_t)) {
+        munmap(data, (size_t) st.st_size);
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    index = (capture_index_t *) calloc(1, sizeof(capture_index_t));
+    if (NULL == index) {
+        munmap(data, (size_t) st.st_size);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    index->data = (const uint8_t *) data;
+    index->size = (uint64_t) st.st_size;
+    index->records = (const capture_index_record_t *) (index->data + sizeof(capture_index_header_t));
+    index->count = (index->size - sizeof(capture_index_header_t)) / sizeof(capture_index_record_t);
+
+    *out = index;
+    return AIRSPY_SUCCESS;
+}
+
+void capture_index_close(capture_index_t *index)
+{
+    munmap((void *) index->data, (size_t) index->size);
+    free(index);
+}
+
+#else
+
+int capture_index_open(capture_index_t **index, const char *capture_path)
+{
+    (void) index;
+    (void) capture_path;
+    return AIRSPY_ERROR_OTHER;
+}
+
+void capture_index_close(capture_index_t *index)
+{
+    (void) index;
+}
+
+#endif
+
+uint64_t capture_index_count(capture_index_t *index)
+{
+    return index->count;
+}
+
+void capture_index_get(capture_index_t *index, uint64_t n, airspy_index_entry_t *entry)
+{
+    const capture_index_record_t *record = &index->records[n];
+
+    entry->sample_start = record->sample_start;
+    entry->sample_index = record->sample_index;
+    entry->byte_offset = record->byte_offset;
+    entry->time_ns = record->time_ns;
+    entry->sample_count = record->sample_count;
+    entry->freq_hz = record->freq_hz;
+    entry->lna_gain = (uint8_t) record->gain;
+    entry->mixer_gain = (uint8_t) (record->gain >> 8);
+    entry->vga_gain = (uint8_t) (record->gain >> 16);
+    entry->agc = (uint8_t) (record->gain >> 24);
+    entry->flags = record->flags;
+}
+
+/* Both keys only grow along the file, the recorder makes sure of it for the time */
+uint64_t capture_index_find_sample(capture_index_t *index, uint64_t sample)
+{
+    uint64_t lo = 0;
+    uint64_t hi = index->count;
+
+    while (hi - lo > 1) {
+        uint64_t mid = lo + (hi - lo) / 2;
+
+        if (index->records[mid].sample_start <= sample) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+uint64_t capture_index_find_time(capture_index_t *index, int64_t time_ns)
+{
+    uint64_t lo = 0;
+    uint64_t hi = index->count;
+
+    while (hi - lo > 1) {
+        uint64_t mid = lo + (hi - lo) / 2;
+
+        if (index->records[mid].time_ns <= time_ns) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
@@ -0,0 +1,79 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef CAPTURE_INDEX_H
+#define CAPTURE_INDEX_H
+
+#include <stdint.h>
+
+#include "airspy.h"
+
+#define CAPTURE_INDEX_SUFFIX ".sigmf-index"
+#define CAPTURE_INDEX_MAGIC 0x58495344u /* "DSIX" */
+#define CAPTURE_INDEX_VERSION 1
+
+#define CAPTURE_INDEX_RAW (1 << 0) /* Samples are real ADC samples rather than IQ */
+
+/*
+ * The sidecar index of a recording: this header, then a record per block
+ * written, in order, in host byte order like the capture itself. A
+ * recording that was cut short leaves a readable prefix.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t flags;
+    double sample_rate;
+    uint64_t reserved;
+} capture_index_header_t;
+
+typedef struct {
+    uint64_t sample_start;
+    uint64_t sample_index;
+    uint64_t byte_offset;
+    int64_t time_ns;
+    uint32_t sample_count;
+    uint32_t freq_hz;
+    uint32_t gain; /* LNA | mixer << 8 | VGA << 16 | AGC bits << 24 */
+    uint32_t flags;
+} capture_index_record_t;
+
+#define CAPTURE_INDEX_GAIN(lna, mixer, vga, agc) \
+    ((uint32_t) (lna) | (uint32_t) (mixer) << 8 | (uint32_t) (vga) << 16 | (uint32_t) (agc) << 24)
+
+struct airspy_capture_index;
+typedef struct airspy_capture_index capture_index_t;
+
+/* Maps the index next to a capture, read-only */
+int capture_index_open(capture_index_t **index, const char *capture_path);
+void capture_index_close(capture_index_t *index);
+
+uint64_t capture_index_count(capture_index_t *index);
+void capture_index_get(capture_index_t *index, uint64_t n, airspy_index_entry_t *entry);
+
+/* Binary searches for the last record starting at or before sample or time_ns, or the first one */
+uint64_t capture_index_find_sample(capture_index_t *index, uint64_t sample);
+uint64_t capture_index_find_time(capture_index_t *index, int64_t time_ns);
+
+#endif // CAPTURE_INDEX_H
@@ -0,0 +1,465 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include <string.h>
+
+#include "codec.h"
+
+#define CODEC_FILE_MAGIC 0x465a5344u   /* "DSZF" */
+#define CODEC_BLOCK_MAGIC 0x425a5344u  /* "DSZB" */
+#define CODEC_FOOTER_MAGIC 0x495a5344u /* "DSZI" */
+#define CODEC_VERSION 1
+
+#define CODEC_FRAME_HEADER 4
+
+enum codec_predictor
+{
+    CODEC_OFFSET = 0, /* From the frame minimum */
+    CODEC_DELTA = 1,  /* From the previous sample */
+    CODEC_LINEAR = 2, /* From the line through the previous two */
+};
+
+static inline uint16_t zigzag(uint16_t d)
+{
+    return (uint16_t) ((d << 1) ^ (uint16_t) ((int16_t) d >> 15));
+}
+
+static inline uint16_t unzigzag(uint16_t u)
+{
+    return (uint16_t) ((u >> 1) ^ (uint16_t) -(u & 1));
+}
+
+static inline void put32(uint8_t *p, uint32_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+static inline void put64(uint8_t *p, uint64_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+static inline uint32_t get32(const uint8_t *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t get64(const uint8_t *p)
+{
+    uint64_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static unsigned bit_width(uint32_t v)
+{
+    unsigned width = 0;
+
+    while (v != 0) {
+        width++;
+        v >>= 1;
+    }
+    return width;
+}
+
+/* Residual j of lane l is at j * CODEC_LANES + l, every lane ends up in width words */
+static void pack(const uint16_t *input, uint32_t *output, unsigned width)
+{
+    uint32_t acc[CODEC_LANES];
+    unsigned shift = 0;
+    unsigned j;
+    unsigned l;
+
+    for (l = 0; l < CODEC_LANES; l++) {
+        acc[l] = 0;
+    }
+    for (j = 0; j < CODEC_LANE_VALUES; j++) {
+        const uint16_t *in = input + j * CODEC_LANES;
+
+        for (l = 0; l < CODEC_LANES; l++) {
+            acc[l] |= (uint32_t) in[l] << shift;
+        }
+        shift += width;
+        if (shift >= 32) {
+            memcpy(output, acc, sizeof(acc));
+            output += CODEC_LANES;
+            shift -= 32;
+            for (l = 0; l < CODEC_LANES; l++) {
+                acc[l] = shift != 0 ? (uint32_t) in[l] >> (width - shift) : 0;
+            }
+        }
+    }
+}
+
+static void unpack(const uint32_t *input, uint16_t *output, unsigned width)
+{
+    const uint32_t mask = (1u << width) - 1;
+    unsigned shift = 0;
+    unsigned j;
+    unsigned l;
+
+    for (j = 0; j < CODEC_LANE_VALUES; j++) {
+        uint16_t *out = output + j * CODEC_LANES;
+
+        if (shift + width <= 32) {
+            for (l = 0; l < CODEC_LANES; l++) {
+                out[l] = (uint16_t) ((input[l] >> shift) & mask);
+            }
+            shift += width;
+            if (shift == 32) {
+                input += CODEC_LANES;
+                shift = 0;
+            }
+        } else {
+            for (l = 0; l < CODEC_LANES; l++) {
+                out[l] = (uint16_t) (((input[l] >> shift) | (input[CODEC_LANES + l] << (32 - shift))) & mask);
+            }
+            input += CODEC_LANES;
+            shift = shift + width - 32;
+        }
+    }
+}
+
+size_t codec_block_bound(uint32_t count)
+{
+    size_t frames = (count + CODEC_FRAME - 1) / CODEC_FRAME;
+
+    return CODEC_BLOCK_HEADER + frames * (CODEC_FRAME_HEADER + CODEC_FRAME * sizeof(uint16_t));
+}
+
+void codec_write_file_header(uint8_t *out, uint32_t flags)
+{
+    put32(out, CODEC_FILE_MAGIC);
+    put32(out + 4, CODEC_VERSION | (flags << 16));
+    put32(out + 8, CODEC_BLOCK_SAMPLES);
+    put32(out + 12, CODEC_FRAME);
+}
+
+/*
+ * The history is carried from frame to frame so that a block only depends
+ * on itself. A short last frame is padded with its last sample, which costs
+ * no bits under any predictor.
+ */
+size_t codec_encode_block(const uint16_t *input, uint32_t count, uint64_t sample_index, uint8_t *out)
+{
+    uint16_t x[CODEC_FRAME + 2];
+    uint16_t offset[CODEC_FRAME];
+    uint16_t delta[CODEC_FRAME];
+    uint16_t linear[CODEC_FRAME];
+    uint8_t *p = out + CODEC_BLOCK_HEADER;
+    uint32_t done;
+
+    /* The last two samples of a frame are the history of the next one */
+    x[CODEC_FRAME] = 2048;
+    x[CODEC_FRAME + 1] = 2048;
+
+    for (done = 0; done < count; done += CODEC_FRAME) {
+        uint32_t n = count - done < CODEC_FRAME ? count - done : CODEC_FRAME;
+        uint16_t base = 0xffff;
+        uint16_t or_offset = 0;
+        uint16_t or_delta = 0;
+        uint16_t or_linear = 0;
+        const uint16_t *residuals;
+        unsigned predictor;
+        unsigned width;
+        uint32_t i;
+
+        x[0] = x[CODEC_FRAME];
+        x[1] = x[CODEC_FRAME + 1];
+        memcpy(x + 2, input + done, n * sizeof(uint16_t));
+        for (i = n; i < CODEC_FRAME; i++) {
+            x[i + 2] = x[n + 1];
+        }
+
+        for (i = 0; i < CODEC_FRAME; i++) {
+            base = x[i + 2] < base ? x[i + 2] : base;
+        }
+        for (i = 0; i < CODEC_FRAME; i++) {
+            offset[i] = (uint16_t) (x[i + 2] - base);
+            delta[i] = zigzag((uint16_t) (x[i + 2] - x[i + 1]));
+            linear[i] = zigzag((uint16_t) (x[i + 2] - 2 * x[i + 1] + x[i]));
+        }
+        for (i = 0; i < CODEC_FRAME; i++) {
+            or_offset |= offset[i];
+            or_delta |= delta[i];
+            or_linear |= linear[i];
+        }
+
+        predictor = CODEC_OFFSET;
+        residuals = offset;
+        width = bit_width(or_offset);
+        if (bit_width(or_delta) < width) {
+            predictor = CODEC_DELTA;
+            residuals = delta;
+            width = bit_width(or_delta);
+        }
+        if (bit_width(or_linear) < width) {
+            predictor = CODEC_LINEAR;
+            residuals = linear;
+            width = bit_width(or_linear);
+        }
+
+        p[0] = (uint8_t) predictor;
+        p[1] = (uint8_t) width;
+        memcpy(p + 2, &base, sizeof(base));
+        p += CODEC_FRAME_HEADER;
+        if (width > 0) {
+            uint32_t words[16 * CODEC_LANES];
+
+            pack(residuals, words, width);
+            memcpy(p, words, width * CODEC_LANES * sizeof(uint32_t));
+            p += width * CODEC_LANES * sizeof(uint32_t);
+        }
+    }
+
+    put32(out, CODEC_BLOCK_MAGIC);
+    put32(out + 4, count);
+    put32(out + 8, (uint32_t) (p - out - CODEC_BLOCK_HEADER));
+    put32(out + 12, 0);
+    put64(out + 16, sample_index);
+
+    return (size_t) (p - out);
+}
+
+size_t codec_block_bytes(const uint8_t *block)
+{
+    return CODEC_BLOCK_HEADER + get32(block + 8);
+}
+
+size_t codec_trailer_bytes(uint64_t index_count)
+{
+    return (size_t) index_count * sizeof(uint64_t) + CODEC_FOOTER;
+}
+
+void codec_write_trailer(uint8_t *out, const uint64_t *offsets, uint64_t index_count, uint64_t blocks,
+    uint64_t samples)
+{
+    uint8_t *footer = out + index_count * sizeof(uint64_t);
+
+    memmove(out, offsets, (size_t) index_count * sizeof(uint64_t));
+    put32(footer, CODEC_FOOTER_MAGIC);
+    put32(footer + 4, CODEC_INDEX_STRIDE);
+    put64(footer + 8, index_count);
+    put64(footer + 16, blocks);
+    put64(footer + 24, samples);
+}
+
+int codec_reader_init(codec_reader_t *reader, const uint8_t *data, uint64_t size)
+{
+    const uint8_t *footer;
+    uint64_t index_count;
+
+    memset(reader, 0, sizeof(*reader));
+    if (size < CODEC_FILE_HEADER || get32(data) != CODEC_FILE_MAGIC || (get32(data + 4) & 0xffff) != CODEC_VERSION) {
+        return -1;
+    }
+    reader->data = data;
+    reader->size = size;
+    reader->flags = get32(data + 4) >> 16;
+    reader->block_samples = get32(data + 8);
+    if (reader->block_samples == 0 || reader->block_samples > CODEC_MAX_BLOCK_SAMPLES || get32(data + 12) != CODEC_FRAME) {
+        return -1;
+    }
+    reader->end = size;
+    reader->pos = CODEC_FILE_HEADER;
+
+    /* Without a trailer, e.g. after a crash, the blocks are still readable in order */
+    if (size < CODEC_FILE_HEADER + CODEC_FOOTER) {
+        return 0;
+    }
+    footer = data + size - CODEC_FOOTER;
+    index_count = get64(footer + 8);
+    if (get32(footer) == CODEC_FOOTER_MAGIC && get32(footer + 4) == CODEC_INDEX_STRIDE &&
+        index_count <= (size - CODEC_FILE_HEADER - CODEC_FOOTER) / sizeof(uint64_t)) {
+        reader->end = size - codec_trailer_bytes(index_count);
+        reader->index = data + reader->end;
+        reader->index_count = index_count;
+        reader->total_samples = get64(footer + 24);
+    }
+
+    return 0;
+}
+
+/* Validates the header of the block at pos and returns its payload size, 0 when there is no block there */
+static uint32_t block_at(const codec_reader_t *reader, uint64_t pos, uint32_t *count, uint64_t *sample_index)
+{
+    const uint8_t *p = reader->data + pos;
+    uint32_t payload;
+
+    if (pos < CODEC_FILE_HEADER || pos >= reader->end || reader->end - pos < CODEC_BLOCK_HEADER) {
+        return 0;
+    }
+    payload = get32(p + 8);
+    if (get32(p) != CODEC_BLOCK_MAGIC || payload == 0 || payload > reader->end - pos - CODEC_BLOCK_HEADER) {
+        return 0;
+    }
+    *count = get32(p + 4);
+    if (*count == 0 || *count > reader->block_samples) {
+        return 0;
+    }
+    *sample_index = get64(p + 16);
+    return payload;
+}
+
+static int decode_block(const uint8_t *p, const uint8_t *stop, uint32_t count, uint16_t *output)
+{
+    uint16_t residuals[CODEC_FRAME];
+    uint16_t frame[CODEC_FRAME];
+    uint32_t words[16 * CODEC_LANES];
+    uint16_t p1 = 2048;
+    uint16_t p2 = 2048;
+    uint32_t done;
+
+    for (done = 0; done < count; done += CODEC_FRAME) {
+        uint32_t n = count - done < CODEC_FRAME ? count - done : CODEC_FRAME;
+        unsigned predictor;
+        unsigned width;
+        size_t bytes;
+        uint16_t base;
+        uint32_t i;
+
+        if (stop - p < CODEC_FRAME_HEADER) {
+            return -1;
+        }
+        predictor = p[0];
+        width = p[1];
+        memcpy(&base, p + 2, sizeof(base));
+        p += CODEC_FRAME_HEADER;
+        bytes = width * CODEC_LANES * sizeof(uint32_t);
+        if (predictor > CODEC_LINEAR || width > 16 || (size_t) (stop - p) < bytes) {
+            return -1;
+        }
+        if (width == 0) {
+            memset(residuals, 0, sizeof(residuals));
+        } else {
+            memcpy(words, p, bytes);
+            unpack(words, residuals, width);
+            p += bytes;
+        }
+
+        switch (predictor) {
+        case CODEC_OFFSET:
+            for (i = 0; i < CODEC_FRAME; i++) {
+                frame[i] = (uint16_t) (residuals[i] + base);
+            }
+            break;
+
+        case CODEC_DELTA:
+            for (i = 0; i < CODEC_FRAME; i++) {
+                p1 = (uint16_t) (p1 + unzigzag(residuals[i]));
+                frame[i] = p1;
+            }
+            break;
+
+        default:
+            for (i = 0; i < CODEC_FRAME; i++) {
+                uint16_t v = (uint16_t) (2 * p1 - p2 + unzigzag(residuals[i]));
+
+                p2 = p1;
+                p1 = v;
+                frame[i] = v;
+            }
+            break;
+        }
+        p2 = frame[CODEC_FRAME - 2];
+        p1 = frame[CODEC_FRAME - 1];
+
+        memcpy(output + done, frame, n * sizeof(uint16_t));
+    }
+
+    return 0;
+}
+
+int codec_reader_next(codec_reader_t *reader, uint16_t *output, uint32_t *count, uint64_t *sample_index)
+{
+    const uint8_t *p;
+    uint32_t payload;
+
+    payload = block_at(reader, reader->pos, count, sample_index);
+    if (payload == 0) {
+        reader->pos = reader->end;
+        return 1;
+    }
+    p = reader->data + reader->pos + CODEC_BLOCK_HEADER;
+    if (decode_block(p, p + payload, *count, output) != 0) {
+        reader->pos = reader->end;
+        return 1;
+    }
+    reader->pos += CODEC_BLOCK_HEADER + payload;
+
+    return 0;
+}
+
+void codec_reader_seek(codec_reader_t *reader, uint64_t sample)
+{
+    uint64_t pos = CODEC_FILE_HEADER;
+    uint64_t first;
+    uint32_t count;
+    uint32_t payload;
+
+    if (reader->index_count > 0) {
+        uint64_t lo = 0;
+        uint64_t hi = reader->index_count;
+
+        /* The last indexed block starting at or before sample */
+        while (hi - lo > 1) {
+            uint64_t mid = lo + (hi - lo) / 2;
+            uint64_t offset = get64(reader->index + mid * sizeof(uint64_t));
+
+            if (block_at(reader, offset, &count, &first) != 0 && first <= sample) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        pos = get64(reader->index + lo * sizeof(uint64_t));
+        if (block_at(reader, pos, &count, &first) == 0) {
+            pos = CODEC_FILE_HEADER;
+        }
+    }
+
+    /* At most CODEC_INDEX_STRIDE - 1 headers from there */
+    for (;;) {
+        uint64_t next;
+
+        payload = block_at(reader, pos, &count, &first);
+        if (payload == 0) {
+            break;
+        }
+        next = pos + CODEC_BLOCK_HEADER + payload;
+        if (block_at(reader, next, &count, &first) == 0 || first > sample) {
+            break;
+        }
+        pos = next;
+    }
+    reader->pos = pos;
+}
+
+void codec_reader_rewind(codec_reader_t *reader)
+{
+    reader->pos = CODEC_FILE_HEADER;
+}
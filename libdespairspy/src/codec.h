@@ -0,0 +1,100 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Lossless compression of raw 16-bit ADC samples, in independent blocks.
+ * Each frame of CODEC_FRAME samples is stored as residuals of the best of
+ * three predictors: the frame's minimum, the previous sample, or a line
+ * through the previous two, bit packed at the width of the largest
+ * residual. Packing is vertical, CODEC_LANES values side by side in 32-bit
+ * words, so that the loops vectorize without intrinsics. All arithmetic is
+ * modulo 2^16, which keeps any input lossless; 12-bit samples just pack
+ * tighter. Files are a header, the blocks, each with a header of its own
+ * giving its size and first sample, and a trailer with the offset of every
+ * CODEC_INDEX_STRIDE-th block. Multi-byte fields are in host order, like
+ * the raw sample files, so little endian in practice.
+ */
+
+#define CODEC_LANES 8
+#define CODEC_LANE_VALUES 32
+#define CODEC_FRAME (CODEC_LANES * CODEC_LANE_VALUES)
+#define CODEC_BLOCK_SAMPLES 65536
+#define CODEC_MAX_BLOCK_SAMPLES (1 << 20)
+#define CODEC_INDEX_STRIDE 64
+
+#define CODEC_FILE_HEADER 16
+#define CODEC_BLOCK_HEADER 24
+#define CODEC_FOOTER 32
+
+#define CODEC_FLAG_PACKED (1 << 0)  /* Recorded from the 12-bit packed wire format */
+
+/* Bytes a block of count samples takes at most, header included */
+size_t codec_block_bound(uint32_t count);
+
+void codec_write_file_header(uint8_t *out, uint32_t flags);
+
+/* Encodes count samples, starting at sample_index in the file, and returns the bytes written to out */
+size_t codec_encode_block(const uint16_t *input, uint32_t count, uint64_t sample_index, uint8_t *out);
+
+/* Header plus payload of an encoded block */
+size_t codec_block_bytes(const uint8_t *block);
+
+/* The trailer for block offsets[0], offsets[CODEC_INDEX_STRIDE], ...; offsets may be at out */
+size_t codec_trailer_bytes(uint64_t index_count);
+void codec_write_trailer(uint8_t *out, const uint64_t *offsets, uint64_t index_count, uint64_t blocks,
+    uint64_t samples);
+
+typedef struct
+{
+    const uint8_t *data;
+    uint64_t size;
+    uint32_t flags;
+    uint32_t block_samples;
+    uint64_t end;           /* Where the blocks stop, at the trailer if there is one */
+    const uint8_t *index;
+    uint64_t index_count;
+    uint64_t total_samples; /* From the trailer, 0 without one */
+    uint64_t pos;           /* Offset of the next block */
+} codec_reader_t;
+
+/* Returns nonzero unless data starts with a codec file header */
+int codec_reader_init(codec_reader_t *reader, const uint8_t *data, uint64_t size);
+
+/*
+ * Decodes the next block into output, which has room for block_samples.
+ * Returns 1 at the end of the blocks, which is also where a truncated or
+ * damaged block is, e.g. after a crash while recording.
+ */
+int codec_reader_next(codec_reader_t *reader, uint16_t *output, uint32_t *count, uint64_t *sample_index);
+
+/* Moves to the block holding sample, or the last one before it; O(log n) with a trailer */
+void codec_reader_seek(codec_reader_t *reader, uint64_t sample);
+void codec_reader_rewind(codec_reader_t *reader);
+
+#endif // CODEC_H
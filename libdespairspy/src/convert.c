@@ -0,0 +1,591 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "convert.h"
+#include "codec.h"
+#include "file_source.h"
+#include "iqconverter_int16.h"
+#include "packing.h"
+#include "recorder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* Chunks and priming are whole groups of eight samples, a packed triple of words */
+#define CONVERT_GROUP 8
+
+#define CONVERT_META_MAX (1 << 20)
+
+typedef struct
+{
+    const uint8_t *input;
+    uint64_t samples;
+    int packed;
+    int fd;
+    int serial;
+    uint32_t chunk_samples;
+    uint32_t prime_samples;
+    const int16_t *hb_kernel;
+    int hb_len;
+
+    pthread_mutex_t lock;
+    uint64_t next_chunk;
+    uint64_t chunk_count;
+    int result;
+} convert_job_t;
+
+#ifndef _WIN32
+
+static int convert_pwrite(int fd, const uint8_t *data, uint64_t length, uint64_t offset)
+{
+    ssize_t written;
+
+    while (length > 0) {
+        written = pwrite(fd, data, length, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += written;
+        length -= written;
+        offset += written;
+    }
+
+    return 0;
+}
+
+/* Input samples [start, start + count) as 16-bit values; both are multiples of CONVERT_GROUP */
+static void convert_load(const convert_job_t *job, uint16_t *output, uint64_t start, uint32_t count)
+{
+    if (job->packed) {
+        unpack_samples((const uint32_t *) (job->input + start / CONVERT_GROUP * 12), output, count);
+    } else {
+        memcpy(output, job->input + start * sizeof(uint16_t), count * sizeof(uint16_t));
+    }
+}
+
+static void convert_fail(convert_job_t *job, int result)
+{
+    pthread_mutex_lock(&job->lock);
+    if (job->result == AIRSPY_SUCCESS) {
+        job->result = result;
+    }
+    pthread_mutex_unlock(&job->lock);
+}
+
+static void *convert_worker(void *arg)
+{
+    convert_job_t *job = (convert_job_t *) arg;
+    iqconverter_int16_t cnv;
+    uint16_t *buffer;
+    uint64_t index;
+    uint64_t start;
+    uint32_t count;
+    uint32_t prime;
+
+    buffer = (uint16_t *) malloc(((size_t) job->prime_samples + job->chunk_samples) * sizeof(uint16_t));
+    if (NULL == buffer) {
+        convert_fail(job, AIRSPY_ERROR_NO_MEM);
+        return NULL;
+    }
+
+    if (iqconverter_int16_init(&cnv, job->hb_kernel, job->hb_len) != 0) {
+        free(buffer);
+        convert_fail(job, AIRSPY_ERROR_NO_MEM);
+        return NULL;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        if (job->result != AIRSPY_SUCCESS || job->next_chunk == job->chunk_count) {
+            pthread_mutex_unlock(&job->lock);
+            break;
+        }
+        index = job->next_chunk++;
+        pthread_mutex_unlock(&job->lock);
+
+        start = index * job->chunk_samples;
+        count = (uint32_t) (job->samples - start < job->chunk_samples ? job->samples - start : job->chunk_samples);
+
+        /* A serial conversion carries one converter through; the first chunk starts from reset either way */
+        prime = 0;
+        if (!job->serial) {
+            prime = start < job->prime_samples ? (uint32_t) start : job->prime_samples;
+        }
+
+        convert_load(job, buffer, start - prime, prime + count);
+
+        if (prime > 0) {
+            iqconverter_int16_prime(&cnv, buffer, prime);
+        } else if (!job->serial) {
+            iqconverter_int16_reset(&cnv);
+        }
+        iqconverter_int16_process(&cnv, buffer + prime, count);
+
+        if (convert_pwrite(job->fd, (const uint8_t *) (buffer + prime), (uint64_t) count * sizeof(int16_t),
+                start * sizeof(int16_t)) != 0) {
+            convert_fail(job, AIRSPY_ERROR_OTHER);
+        }
+    }
+
+    iqconverter_int16_free(&cnv);
+    free(buffer);
+
+    return NULL;
+}
+
+static int convert_write_meta(const char *output_path, double sample_rate)
+{
+    char *meta_path;
+    FILE *f;
+
+    meta_path = recorder_meta_path(output_path);
+    if (NULL == meta_path) {
+        return -1;
+    }
+
+    f = fopen(meta_path, "w");
+    free(meta_path);
+    if (NULL == f) {
+        return -1;
+    }
+
+    fprintf(f, "{\n    \"global\": {\n");
+    fprintf(f, "        \"core:datatype\": \"ci16_le\",\n");
+    fprintf(f, "        \"core:sample_rate\": %.1f,\n", sample_rate);
+    fprintf(f, "        \"core:version\": \"1.0.0\",\n");
+    fprintf(f, "        \"core:recorder\": \"libdespairspy %s\"\n", AIRSPY_VERSION);
+    fprintf(f, "    },\n    \"captures\": [\n");
+    fprintf(f, "        {\n            \"core:sample_start\": 0\n        }\n");
+    fprintf(f, "    ],\n    \"annotations\": []\n}\n");
+
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+int convert_file(const char *input_path, const char *output_path, const airspy_convert_params_t *params,
+    const int16_t *hb_kernel, int len)
+{
+    convert_job_t job;
+    file_source_t *fs;
+    pthread_t *threads;
+    uint64_t size;
+    uint32_t thread_count;
+    uint32_t started;
+    uint32_t i;
+    double sample_rate;
+    int meta_packed;
+    int has_meta;
+    int result;
+
+    if (NULL == input_path || NULL == output_path) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    memset(&job, 0, sizeof(job));
+    job.hb_kernel = hb_kernel;
+    job.hb_len = len;
+    job.chunk_samples = CONVERT_DEFAULT_CHUNK;
+    job.prime_samples = CONVERT_DEFAULT_PRIME;
+    thread_count = 0;
+
+    if (NULL != params) {
+        job.packed = params->packed;
+        thread_count = params->threads;
+        if (params->chunk_samples != 0) {
+            job.chunk_samples = params->chunk_samples;
+        }
+        if (params->prime_samples != 0) {
+            job.prime_samples = params->prime_samples;
+        }
+    }
+
+    job.chunk_samples -= job.chunk_samples % CONVERT_GROUP;
+    job.prime_samples += (CONVERT_GROUP - job.prime_samples % CONVERT_GROUP) % CONVERT_GROUP;
+    if (0 == job.chunk_samples) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    has_meta = file_source_read_meta(input_path, &sample_rate, &meta_packed) == 0;
+    if (has_meta) {
+        job.packed = meta_packed;
+    }
+
+    result = file_source_open(&fs, input_path);
+    if (result != AIRSPY_SUCCESS) {
+        return result;
+    }
+
+    /* The workers split up the mapping, which a compressed capture has to be expanded for first */
+    if (file_source_compressed(fs)) {
+        file_source_close(fs);
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    /* A partial group at the end can't be unpacked and is dropped */
+    job.input = file_source_map(fs, &size);
+    job.samples = job.packed ? size / 12 * CONVERT_GROUP : size / sizeof(uint16_t);
+    job.samples -= job.samples % CONVERT_GROUP;
+    job.chunk_count = (job.samples + job.chunk_samples - 1) / job.chunk_samples;
+
+    if (0 == thread_count) {
+        thread_count = (uint32_t) sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    job.serial = thread_count == 1;
+    if (thread_count > job.chunk_count) {
+        thread_count = job.chunk_count > 0 ? (uint32_t) job.chunk_count : 1;
+    }
+
+    job.fd = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (job.fd < 0) {
+        file_source_close(fs);
+        return AIRSPY_ERROR_OTHER;
+    }
+
+    /* Sized up front so the workers can fill it in any order */
+    if (ftruncate(job.fd, (off_t) (job.samples * sizeof(int16_t))) != 0) {
+        close(job.fd);
+        file_source_close(fs);
+        return AIRSPY_ERROR_OTHER;
+    }
+
+    threads = (pthread_t *) malloc(thread_count * sizeof(pthread_t));
+    if (NULL == threads) {
+        close(job.fd);
+        file_source_close(fs);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    pthread_mutex_init(&job.lock, NULL);
+    job.result = AIRSPY_SUCCESS;
+
+    for (started = 0; started < thread_count; started++) {
+        if (pthread_create(&threads[started], NULL, convert_worker, &job) != 0) {
+            break;
+        }
+    }
+    if (0 == started) {
+        job.result = AIRSPY_ERROR_THREAD;
+    }
+
+    for (i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&job.lock);
+    free(threads);
+    file_source_close(fs);
+
+    if (close(job.fd) != 0 && job.result == AIRSPY_SUCCESS) {
+        job.result = AIRSPY_ERROR_OTHER;
+    }
+
+    /* Raw captures are described at the real ADC rate, the output has half as many complex samples */
+    if (job.result == AIRSPY_SUCCESS && has_meta && convert_write_meta(output_path, sample_rate / 2) != 0) {
+        job.result = AIRSPY_ERROR_OTHER;
+    }
+
+    return job.result;
+}
+
+/*
+ * Copies the metadata of a capture we wrote, dropping the line with
+ * remove_key and putting add_line after the datatype. Nothing to do
+ * without input metadata.
+ */
+static int convert_copy_meta(const char *input_path, const char *output_path, const char *remove_key,
+    const char *add_line)
+{
+    char *meta_path;
+    char *meta;
+    char *line;
+    char *next;
+    size_t len;
+    FILE *in;
+    FILE *out;
+
+    meta_path = recorder_meta_path(input_path);
+    if (NULL == meta_path) {
+        return -1;
+    }
+    in = fopen(meta_path, "rb");
+    free(meta_path);
+    if (NULL == in) {
+        return 0;
+    }
+
+    meta = (char *) malloc(CONVERT_META_MAX + 1);
+    if (NULL == meta) {
+        fclose(in);
+        return -1;
+    }
+    len = fread(meta, 1, CONVERT_META_MAX, in);
+    fclose(in);
+    meta[len] = '\0';
+
+    meta_path = recorder_meta_path(output_path);
+    out = meta_path != NULL ? fopen(meta_path, "w") : NULL;
+    free(meta_path);
+    if (NULL == out) {
+        free(meta);
+        return -1;
+    }
+
+    for (line = meta; *line != '\0'; line = next) {
+        next = strchr(line, '\n');
+        next = next != NULL ? next + 1 : line + strlen(line);
+        if (strstr(line, remove_key) != NULL && strstr(line, remove_key) < next) {
+            continue;
+        }
+        fwrite(line, 1, (size_t) (next - line), out);
+        if (add_line != NULL && strstr(line, "\"core:datatype\"") != NULL && strstr(line, "\"core:datatype\"") < next) {
+            fprintf(out, "        %s\n", add_line);
+        }
+    }
+
+    free(meta);
+    return fclose(out) == 0 ? 0 : -1;
+}
+
+int convert_compress(const char *input_path, const char *output_path, int packed)
+{
+    file_source_t *fs;
+    const uint8_t *input;
+    uint64_t size;
+    uint64_t samples;
+    uint64_t done;
+    uint64_t offset;
+    uint64_t blocks;
+    uint64_t *index;
+    uint16_t *unpacked;
+    uint8_t *encoded;
+    uint8_t header[CODEC_FILE_HEADER];
+    double sample_rate;
+    size_t length;
+    uint32_t n;
+    int meta_packed;
+    int has_meta;
+    int result;
+    int fd;
+
+    if (NULL == input_path || NULL == output_path) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    has_meta = file_source_read_meta(input_path, &sample_rate, &meta_packed) == 0;
+    if (has_meta) {
+        packed = meta_packed;
+    }
+
+    result = file_source_open(&fs, input_path);
+    if (result != AIRSPY_SUCCESS) {
+        return result;
+    }
+    if (file_source_compressed(fs)) {
+        file_source_close(fs);
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    input = file_source_map(fs, &size);
+    /* Only whole samples, or whole groups when packed, come back byte for byte */
+    if (size % (packed ? 12 : sizeof(uint16_t)) != 0) {
+        file_source_close(fs);
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+    samples = packed ? size / 12 * CONVERT_GROUP : size / sizeof(uint16_t);
+    blocks = (samples + CODEC_BLOCK_SAMPLES - 1) / CODEC_BLOCK_SAMPLES;
+
+    unpacked = (uint16_t *) malloc(CODEC_BLOCK_SAMPLES * sizeof(uint16_t));
+    encoded = (uint8_t *) malloc(codec_block_bound(CODEC_BLOCK_SAMPLES));
+    index = (uint64_t *) malloc(codec_trailer_bytes(blocks / CODEC_INDEX_STRIDE + 1));
+    fd = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (NULL == unpacked || NULL == encoded || NULL == index || fd < 0) {
+        result = fd < 0 ? AIRSPY_ERROR_OTHER : AIRSPY_ERROR_NO_MEM;
+        goto done;
+    }
+
+    codec_write_file_header(header, packed ? CODEC_FLAG_PACKED : 0);
+    offset = 0;
+    result = convert_pwrite(fd, header, sizeof(header), offset) == 0 ? AIRSPY_SUCCESS : AIRSPY_ERROR_OTHER;
+    offset += sizeof(header);
+
+    /* Blocks are whole groups, so a packed block unpacks on its own */
+    for (done = 0, blocks = 0; done < samples && result == AIRSPY_SUCCESS; done += n, blocks++) {
+        n = samples - done < CODEC_BLOCK_SAMPLES ? (uint32_t) (samples - done) : CODEC_BLOCK_SAMPLES;
+        if (packed) {
+            unpack_samples((const uint32_t *) (input + done / CONVERT_GROUP * 12), unpacked, (int) n);
+        } else {
+            memcpy(unpacked, input + done * sizeof(uint16_t), n * sizeof(uint16_t));
+        }
+        if (blocks % CODEC_INDEX_STRIDE == 0) {
+            index[blocks / CODEC_INDEX_STRIDE] = offset;
+        }
+        length = codec_encode_block(unpacked, n, done, encoded);
+        if (convert_pwrite(fd, encoded, length, offset) != 0) {
+            result = AIRSPY_ERROR_OTHER;
+        }
+        offset += length;
+    }
+
+    if (result == AIRSPY_SUCCESS) {
+        uint64_t index_count = (blocks + CODEC_INDEX_STRIDE - 1) / CODEC_INDEX_STRIDE;
+
+        /* The trailer goes together right behind the offsets */
+        codec_write_trailer((uint8_t *) index, index, index_count, blocks, samples);
+        if (convert_pwrite(fd, (const uint8_t *) index, codec_trailer_bytes(index_count), offset) != 0) {
+            result = AIRSPY_ERROR_OTHER;
+        }
+    }
+
+done:
+    if (fd >= 0 && close(fd) != 0 && result == AIRSPY_SUCCESS) {
+        result = AIRSPY_ERROR_OTHER;
+    }
+    free(index);
+    free(encoded);
+    free(unpacked);
+    file_source_close(fs);
+
+    if (result == AIRSPY_SUCCESS && has_meta &&
+            convert_copy_meta(input_path, output_path, "\"despairspy:packed\"", "\"despairspy:compressed\": true,") != 0) {
+        result = AIRSPY_ERROR_OTHER;
+    }
+
+    return result;
+}
+
+int convert_expand(const char *input_path, const char *output_path)
+{
+    file_source_t *fs;
+    codec_reader_t reader;
+    const uint8_t *input;
+    uint64_t size;
+    uint64_t offset;
+    uint64_t first;
+    uint16_t *decoded;
+    uint32_t *words;
+    uint32_t carry;
+    uint32_t count;
+    uint32_t whole;
+    int packed;
+    int result;
+    int fd;
+
+    if (NULL == input_path || NULL == output_path) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    result = file_source_open(&fs, input_path);
+    if (result != AIRSPY_SUCCESS) {
+        return result;
+    }
+    input = file_source_map(fs, &size);
+    if (codec_reader_init(&reader, input, size) != 0) {
+        file_source_close(fs);
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+    packed = (reader.flags & CODEC_FLAG_PACKED) != 0;
+
+    /* Room for a group carried over from the last block in front of the next one */
+    decoded = (uint16_t *) malloc((reader.block_samples + CONVERT_GROUP) * sizeof(uint16_t));
+    words = (uint32_t *) malloc((reader.block_samples + CONVERT_GROUP) / CONVERT_GROUP * 12);
+    fd = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (NULL == decoded || NULL == words || fd < 0) {
+        result = fd < 0 ? AIRSPY_ERROR_OTHER : AIRSPY_ERROR_NO_MEM;
+        goto done;
+    }
+
+    offset = 0;
+    carry = 0;
+    while (result == AIRSPY_SUCCESS && codec_reader_next(&reader, decoded + carry, &count, &first) == 0) {
+        count += carry;
+        if (packed) {
+            whole = count - count % CONVERT_GROUP;
+            pack_samples(decoded, words, (int) whole);
+            if (convert_pwrite(fd, (const uint8_t *) words, whole / CONVERT_GROUP * 12, offset) != 0) {
+                result = AIRSPY_ERROR_OTHER;
+            }
+            offset += whole / CONVERT_GROUP * 12;
+            carry = count - whole;
+            memmove(decoded, decoded + whole, carry * sizeof(uint16_t));
+        } else {
+            if (convert_pwrite(fd, (const uint8_t *) decoded, count * sizeof(uint16_t), offset) != 0) {
+                result = AIRSPY_ERROR_OTHER;
+            }
+            offset += count * sizeof(uint16_t);
+        }
+    }
+
+done:
+    if (fd >= 0 && close(fd) != 0 && result == AIRSPY_SUCCESS) {
+        result = AIRSPY_ERROR_OTHER;
+    }
+    free(words);
+    free(decoded);
+    file_source_close(fs);
+
+    if (result == AIRSPY_SUCCESS &&
+            convert_copy_meta(input_path, output_path, "\"despairspy:compressed\"", packed ? "\"despairspy:packed\": true," : NULL) != 0) {
+        result = AIRSPY_ERROR_OTHER;
+    }
+
+    return result;
+}
+
+#else
+
+int convert_file(const char *input_path, const char *output_path, const airspy_convert_params_t *params,
+    const int16_t *hb_kernel, int len)
+{
+    (void) input_path;
+    (void) output_path;
+    (void) params;
+    (void) hb_kernel;
+    (void) len;
+    return AIRSPY_ERROR_OTHER;
+}
+
+int convert_compress(const char *input_path, const char *output_path, int packed)
+{
+    (void) input_path;
+    (void) output_path;
+    (void) packed;
+    return AIRSPY_ERROR_OTHER;
+}
+
+int convert_expand(const char *input_path, const char *output_path)
+{
+    (void) input_path;
+    (void) output_path;
+    return AIRSPY_ERROR_OTHER;
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef CONVERT_H
+#define CONVERT_H
+
+#include <stdint.h>
+
+#include "airspy.h"
+
+#define CONVERT_DEFAULT_CHUNK (1 << 22)
+
+/*
+ * Real samples run through a chunk's converter before the chunk itself.
+ * The FIR and delay line are rebuilt exactly from the last 48. The DC
+ * blocker's fixed-point state only converges onto the serial one, at a
+ * rate of 0.98 per sample: primed with 256 samples, chunk starts were off
+ * by up to 12 LSB on test captures, and from 1024 on the output was
+ * identical to a serial conversion. The default leaves margin on top.
+ */
+#define CONVERT_DEFAULT_PRIME 4096
+
+/*
+ * Converts a raw capture to interleaved int16 IQ, a chunk at a time across
+ * worker threads that write their part of the output directly.
+ * hb_kernel/len is the half-band kernel for iqconverter_int16_init().
+ */
+int convert_file(const char *input_path, const char *output_path, const airspy_convert_params_t *params,
+    const int16_t *hb_kernel, int len);
+
+/*
+ * Raw captures to and from the lossless codec, a block at a time on the
+ * calling thread. Expanding writes back the packed format if that is what
+ * was compressed, so the original file comes out byte for byte.
+ */
+int convert_compress(const char *input_path, const char *output_path, int packed);
+int convert_expand(const char *input_path, const char *output_path);
+
+#endif // CONVERT_H
@@ -0,0 +1,338 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "convert_pool.h"
+#include "convert.h"
+#include "iqconverter_int16.h"
+#include "packing.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+typedef struct
+{
+    uint8_t *raw;       /* History and block as received; aliases samples when unpacked */
+    uint16_t *samples;  /* History and block as 16-bit samples, converted in place */
+    uint32_t prime;     /* Real samples of history ahead of the block */
+    airspy_transfer_t transfer;
+    int done;
+} convert_slot_t;
+
+typedef struct
+{
+    convert_pool_t *pool;
+    pthread_t thread;
+    iqconverter_int16_t cnv;
+} convert_worker_t;
+
+struct convert_pool
+{
+    uint32_t block_bytes;
+    uint32_t block_samples;
+    int packed;
+
+    /* Tail of the last submitted block, as received */
+    uint8_t *history;
+    uint32_t history_bytes;
+    uint32_t history_len;
+
+    convert_slot_t *slots;
+    uint32_t slot_count;
+    convert_worker_t *workers;
+    uint32_t worker_count;
+    uint32_t workers_started;
+
+    /*
+     * Blocks [head, claimed) are with a worker or converted, [claimed, tail)
+     * are waiting for one. Only the submitting thread moves head and tail.
+     */
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    uint64_t head;
+    uint64_t claimed;
+    uint64_t tail;
+    int stopping;
+};
+
+static uint32_t convert_pool_real_samples(const convert_pool_t *pool, uint32_t bytes)
+{
+    return pool->packed ? bytes / 12 * 8 : bytes / sizeof(uint16_t);
+}
+
+static void convert_pool_convert(convert_pool_t *pool, convert_worker_t *worker, convert_slot_t *slot)
+{
+    if (pool->packed) {
+        unpack_samples((const uint32_t *) slot->raw, slot->samples, slot->prime + pool->block_samples);
+    }
+
+    if (slot->prime > 0) {
+        iqconverter_int16_prime(&worker->cnv, slot->samples, slot->prime);
+    } else {
+        iqconverter_int16_reset(&worker->cnv);
+    }
+    iqconverter_int16_process(&worker->cnv, slot->samples + slot->prime, pool->block_samples);
+
+    slot->transfer.samples = slot->samples + slot->prime;
+}
+
+static void *convert_pool_worker(void *arg)
+{
+    convert_worker_t *worker = (convert_worker_t *) arg;
+    convert_pool_t *pool = worker->pool;
+    convert_slot_t *slot;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stopping && pool->claimed == pool->tail) {
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        }
+        if (pool->stopping) {
+            break;
+        }
+
+        slot = &pool->slots[pool->claimed % pool->slot_count];
+        pool->claimed++;
+        pthread_mutex_unlock(&pool->lock);
+
+        convert_pool_convert(pool, worker, slot);
+
+        pthread_mutex_lock(&pool->lock);
+        slot->done = 1;
+        pthread_cond_broadcast(&pool->done_cond);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+int convert_pool_create(convert_pool_t **pool_out, uint32_t workers, uint32_t block_bytes, int packed,
+    const int16_t *hb_kernel, int len)
+{
+    convert_pool_t *pool;
+    uint32_t prime_bytes;
+    uint32_t i;
+
+    if (NULL == pool_out || 0 == workers || 0 == block_bytes) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    pool = (convert_pool_t *) calloc(1, sizeof(convert_pool_t));
+    if (NULL == pool) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    pool->block_bytes = block_bytes;
+    pool->packed = packed;
+    pool->block_samples = convert_pool_real_samples(pool, block_bytes);
+
+    prime_bytes = packed ? CONVERT_DEFAULT_PRIME / 8 * 12 : CONVERT_DEFAULT_PRIME * sizeof(uint16_t);
+    pool->history_bytes = prime_bytes < block_bytes ? prime_bytes : block_bytes;
+
+    pool->worker_count = workers;
+    pool->slot_count = workers * CONVERT_POOL_SLOTS_PER_WORKER;
+
+    pool->history = (uint8_t *) malloc(pool->history_bytes);
+    pool->slots = (convert_slot_t *) calloc(pool->slot_count, sizeof(convert_slot_t));
+    pool->workers = (convert_worker_t *) calloc(pool->worker_count, sizeof(convert_worker_t));
+    if (NULL == pool->history || NULL == pool->slots || NULL == pool->workers) {
+        convert_pool_destroy(pool);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    for (i = 0; i < pool->slot_count; i++) {
+        pool->slots[i].samples = (uint16_t *) malloc(convert_pool_storage_bytes(pool));
+        if (NULL == pool->slots[i].samples) {
+            convert_pool_destroy(pool);
+            return AIRSPY_ERROR_NO_MEM;
+        }
+
+        if (packed) {
+            pool->slots[i].raw = (uint8_t *) malloc((size_t) pool->history_bytes + block_bytes);
+            if (NULL == pool->slots[i].raw) {
+                convert_pool_destroy(pool);
+                return AIRSPY_ERROR_NO_MEM;
+            }
+        } else {
+            pool->slots[i].raw = (uint8_t *) pool->slots[i].samples;
+        }
+    }
+
+    for (i = 0; i < pool->worker_count; i++) {
+        pool->workers[i].pool = pool;
+        if (iqconverter_int16_init(&pool->workers[i].cnv, hb_kernel, len) != 0) {
+            convert_pool_destroy(pool);
+            return AIRSPY_ERROR_NO_MEM;
+        }
+        if (pthread_create(&pool->workers[i].thread, NULL, convert_pool_worker, &pool->workers[i]) != 0) {
+            iqconverter_int16_free(&pool->workers[i].cnv);
+            convert_pool_destroy(pool);
+            return AIRSPY_ERROR_THREAD;
+        }
+        pool->workers_started++;
+    }
+
+    *pool_out = pool;
+
+    return AIRSPY_SUCCESS;
+}
+
+size_t convert_pool_storage_bytes(const convert_pool_t *pool)
+{
+    return ((size_t) convert_pool_real_samples(pool, pool->history_bytes) + pool->block_samples) * sizeof(uint16_t);
+}
+
+void convert_pool_destroy(convert_pool_t *pool)
+{
+    uint32_t i;
+
+    if (NULL == pool) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->workers_started; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+        iqconverter_int16_free(&pool->workers[i].cnv);
+    }
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->lock);
+
+    if (pool->slots != NULL) {
+        for (i = 0; i < pool->slot_count; i++) {
+            if (pool->packed) {
+                free(pool->slots[i].raw);
+            }
+            free(pool->slots[i].samples);
+        }
+    }
+
+    free(pool->workers);
+    free(pool->slots);
+    free(pool->history);
+    free(pool);
+}
+
+/* Waits for the oldest block and hands it to deliver, or drops it when deliver is NULL */
+static void convert_pool_deliver_head(convert_pool_t *pool, convert_pool_deliver_fn deliver, void *ctx)
+{
+    convert_slot_t *slot;
+    void *storage;
+
+    slot = &pool->slots[pool->head % pool->slot_count];
+
+    pthread_mutex_lock(&pool->lock);
+    while (!slot->done) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    if (deliver != NULL) {
+        storage = slot->samples;
+        deliver(ctx, &slot->transfer, &storage);
+        slot->samples = (uint16_t *) storage;
+        if (!pool->packed) {
+            slot->raw = (uint8_t *) slot->samples;
+        }
+    }
+    pool->head++;
+}
+
+static int convert_pool_head_done(convert_pool_t *pool)
+{
+    int done;
+
+    if (pool->head == pool->tail) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    done = pool->slots[pool->head % pool->slot_count].done;
+    pthread_mutex_unlock(&pool->lock);
+
+    return done;
+}
+
+int convert_pool_submit(convert_pool_t *pool, const uint8_t *block, const airspy_transfer_t *transfer,
+    convert_pool_deliver_fn deliver, void *ctx)
+{
+    convert_slot_t *slot;
+    int waited;
+
+    convert_pool_deliver(pool, deliver, ctx);
+
+    waited = 0;
+    while (pool->tail - pool->head == pool->slot_count) {
+        waited = 1;
+        convert_pool_deliver_head(pool, deliver, ctx);
+    }
+
+    /* Workers don't look at the slot until tail moves past it */
+    slot = &pool->slots[pool->tail % pool->slot_count];
+    memcpy(slot->raw, pool->history, pool->history_len);
+    memcpy(slot->raw + pool->history_len, block, pool->block_bytes);
+    slot->prime = convert_pool_real_samples(pool, pool->history_len);
+    slot->transfer = *transfer;
+    slot->done = 0;
+
+    memcpy(pool->history, block + pool->block_bytes - pool->history_bytes, pool->history_bytes);
+    pool->history_len = pool->history_bytes;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->tail++;
+    pthread_cond_signal(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    return waited;
+}
+
+void convert_pool_deliver(convert_pool_t *pool, convert_pool_deliver_fn deliver, void *ctx)
+{
+    while (convert_pool_head_done(pool)) {
+        convert_pool_deliver_head(pool, deliver, ctx);
+    }
+}
+
+void convert_pool_drain(convert_pool_t *pool, convert_pool_deliver_fn deliver, void *ctx)
+{
+    while (pool->head != pool->tail) {
+        convert_pool_deliver_head(pool, deliver, ctx);
+    }
+    pool->history_len = 0;
+}
+
+void convert_pool_reset(convert_pool_t *pool)
+{
+    pool->history_len = 0;
+}
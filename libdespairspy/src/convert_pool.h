@@ -0,0 +1,81 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef CONVERT_POOL_H
+#define CONVERT_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "airspy.h"
+
+/* Blocks that can be queued or in conversion at once, per worker */
+#define CONVERT_POOL_SLOTS_PER_WORKER 2
+
+typedef struct convert_pool convert_pool_t;
+
+/*
+ * Receives each converted block, in the order the blocks were submitted.
+ * transfer->samples points into *storage, the slot's sample buffer, and is
+ * only valid until it returns unless the callee takes *storage over,
+ * leaving another allocation of convert_pool_storage_bytes() in its place.
+ */
+typedef void (*convert_pool_deliver_fn)(void *ctx, airspy_transfer_t *transfer, void **storage);
+
+/*
+ * Converts successive blocks of a stream on worker threads. Each block is
+ * submitted together with the tail of the one before it, which primes the
+ * worker's converter (CONVERT_DEFAULT_PRIME real samples), so the output
+ * matches a single converter carried through the stream.
+ *
+ * Blocks are block_bytes as received, packed or not. Submitting and
+ * delivering happen on one thread, the one calling convert_pool_submit()
+ * and convert_pool_deliver(); the callback runs there too.
+ */
+int convert_pool_create(convert_pool_t **pool, uint32_t workers, uint32_t block_bytes, int packed,
+    const int16_t *hb_kernel, int len);
+void convert_pool_destroy(convert_pool_t *pool);
+size_t convert_pool_storage_bytes(const convert_pool_t *pool);
+
+/*
+ * Hands over a block. The data is copied, so the buffer can be reused on
+ * return. transfer carries the block's metadata; samples is filled in on
+ * delivery. While every slot is taken, delivers converted blocks as they
+ * become ready and waits for one to free up; returns nonzero if it had to.
+ */
+int convert_pool_submit(convert_pool_t *pool, const uint8_t *block, const airspy_transfer_t *transfer,
+    convert_pool_deliver_fn deliver, void *ctx);
+
+/* Delivers the blocks converted so far, up to the first one still in conversion */
+void convert_pool_deliver(convert_pool_t *pool, convert_pool_deliver_fn deliver, void *ctx);
+
+/*
+ * Waits for every submitted block and delivers it, or drops it when deliver
+ * is NULL. Leaves the pool empty with its history cleared.
+ */
+void convert_pool_drain(convert_pool_t *pool, convert_pool_deliver_fn deliver, void *ctx);
+
+/* The next block starts from a reset converter instead of the previous block's tail */
+void convert_pool_reset(convert_pool_t *pool);
+
+#endif // CONVERT_POOL_H
@@ -0,0 +1,418 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "convolver.h"
+#include "fft_float.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct airspy_convolver
+{
+    uint32_t tap_count;
+    uint32_t history;           /* tap_count - 1 samples, kept from block to block */
+    uint32_t flags;
+    float *taps;                /* As given, interleaved when complex */
+    float *taps_re;             /* Direct form: reversed, so it runs forward over the samples */
+    float *taps_im;             /* NULL for real taps */
+
+    /* The plan for blocks of up to capacity samples */
+    int use_fft;
+    fft_float_t fft;
+    uint32_t fft_size;          /* 0 until an FFT is set up */
+    uint32_t fft_step;          /* Outputs per overlap-save chunk */
+    float *spectrum;            /* Of the taps padded to fft_size, scaled by 1 / fft_size */
+    float *work;
+
+    /* history + block samples, split, and the block's outputs */
+    float *re;
+    float *im;
+    float *acc_re;
+    float *acc_im;
+    uint32_t capacity;
+
+    /* Subscriber only */
+    airspy_sample_block_cb_fn callback;
+    void *ctx;
+    float *output;
+    int started;
+    uint64_t next_index;
+};
+
+static void convolver_free_fft(convolver_t *convolver)
+{
+    if (convolver->fft_size > 0) {
+        fft_float_free(&convolver->fft);
+    }
+    free(convolver->spectrum);
+    free(convolver->work);
+    convolver->spectrum = NULL;
+    convolver->work = NULL;
+    convolver->fft_size = 0;
+}
+
+void convolver_free(convolver_t *convolver)
+{
+    if (NULL == convolver) {
+        return;
+    }
+
+    convolver_free_fft(convolver);
+    free(convolver->taps);
+    free(convolver->taps_re);
+    free(convolver->taps_im);
+    free(convolver->re);
+    free(convolver->im);
+    free(convolver->acc_re);
+    free(convolver->acc_im);
+    free(convolver->output);
+    free(convolver);
+}
+
+int convolver_create(convolver_t **out, const float *taps, uint32_t tap_count, uint32_t flags)
+{
+    convolver_t *convolver;
+    uint32_t values;
+    uint32_t k;
+
+    if (NULL == taps || tap_count == 0 || tap_count > CONVOLVER_MAX_TAPS ||
+            ((flags & AIRSPY_CONVOLVER_DIRECT) && (flags & AIRSPY_CONVOLVER_FFT))) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    convolver = (convolver_t *) calloc(1, sizeof(convolver_t));
+    if (NULL == convolver) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+    convolver->tap_count = tap_count;
+    convolver->history = tap_count - 1;
+    convolver->flags = flags;
+
+    values = flags & AIRSPY_CONVOLVER_COMPLEX ? 2 * tap_count : tap_count;
+    convolver->taps = (float *) malloc(values * sizeof(float));
+    convolver->taps_re = (float *) malloc(tap_count * sizeof(float));
+    if (flags & AIRSPY_CONVOLVER_COMPLEX) {
+        convolver->taps_im = (float *) malloc(tap_count * sizeof(float));
+    }
+    convolver->re = (float *) calloc(convolver->history, sizeof(float));
+    convolver->im = (float *) calloc(convolver->history, sizeof(float));
+    if (NULL == convolver->taps || NULL == convolver->taps_re ||
+            ((flags & AIRSPY_CONVOLVER_COMPLEX) && NULL == convolver->taps_im) ||
+            (convolver->history > 0 && (NULL == convolver->re || NULL == convolver->im))) {
+        convolver_free(convolver);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    memcpy(convolver->taps, taps, values * sizeof(float));
+    for (k = 0; k < tap_count; k++) {
+        if (flags & AIRSPY_CONVOLVER_COMPLEX) {
+            convolver->taps_re[k] = taps[2 * (tap_count - 1 - k)];
+            convolver->taps_im[k] = taps[2 * (tap_count - 1 - k) + 1];
+        } else {
+            convolver->taps_re[k] = taps[tap_count - 1 - k];
+        }
+    }
+
+    *out = convolver;
+    return AIRSPY_SUCCESS;
+}
+
+void convolver_reset(convolver_t *convolver)
+{
+    if (convolver->history > 0) {
+        memset(convolver->re, 0, convolver->history * sizeof(float));
+        memset(convolver->im, 0, convolver->history * sizeof(float));
+    }
+}
+
+/*
+ * Per block, the direct form costs a tap per output (two for complex
+ * taps) and an FFT plan its chunks' butterflies, forward and inverse,
+ * plus the spectral product. Sizes from just above the history up are
+ * tried; a size much larger than the block wastes most of its outputs.
+ */
+static uint32_t convolver_fft_size(const convolver_t *convolver, uint32_t count, double *cost)
+{
+    uint32_t best = 0;
+    uint32_t size;
+    uint32_t bits;
+    uint32_t chunks;
+    double c;
+
+    for (size = FFT_FLOAT_MIN_SIZE, bits = 4; size <= FFT_FLOAT_MAX_SIZE; size <<= 1, bits++) {
+        if (size <= convolver->history) {
+            continue;
+        }
+        chunks = (count + size - convolver->history - 1) / (size - convolver->history);
+        c = (double) chunks * size * (bits + 1) * CONVOLVER_FFT_WEIGHT;
+        if (0 == best || c < *cost) {
+            best = size;
+            *cost = c;
+        }
+    }
+
+    return best;
+}
+
+/*
+ * Plans for blocks of count samples, the largest given so far: the
+ * cheaper form for the tap count at that size unless the flags force one,
+ * and for the FFT the size of least cost over the whole block. Smaller
+ * blocks keep the plan.
+ */
+static int convolver_plan(convolver_t *convolver, uint32_t count)
+{
+    double direct;
+    double fft = 0.0;
+    uint32_t size;
+    uint32_t k;
+
+    direct = (double) count * convolver->tap_count * (convolver->taps_im != NULL ? 2 : 1);
+    size = convolver_fft_size(convolver, count, &fft);
+
+    if (convolver->flags & AIRSPY_CONVOLVER_FFT) {
+        convolver->use_fft = 1;
+    } else if (convolver->flags & AIRSPY_CONVOLVER_DIRECT) {
+        convolver->use_fft = 0;
+    } else {
+        convolver->use_fft = fft < direct;
+    }
+    if (!convolver->use_fft || size == convolver->fft_size) {
+        return AIRSPY_SUCCESS;
+    }
+
+    convolver_free_fft(convolver);
+    if (fft_float_init(&convolver->fft, (int) size) != 0) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+    convolver->fft_size = size;
+    convolver->fft_step = size - convolver->history;
+    convolver->spectrum = (float *) calloc((size_t) size * 2, sizeof(float));
+    convolver->work = (float *) malloc((size_t) size * 2 * sizeof(float));
+    if (NULL == convolver->spectrum || NULL == convolver->work) {
+        convolver_free_fft(convolver);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    for (k = 0; k < convolver->tap_count; k++) {
+        if (convolver->taps_im != NULL) {
+            convolver->spectrum[2 * k] = convolver->taps[2 * k] / (float) size;
+            convolver->spectrum[2 * k + 1] = convolver->taps[2 * k + 1] / (float) size;
+        } else {
+            convolver->spectrum[2 * k] = convolver->taps[k] / (float) size;
+        }
+    }
+    fft_float_forward(&convolver->fft, convolver->spectrum);
+
+    return AIRSPY_SUCCESS;
+}
+
+/* Grows the buffers for blocks of count samples and plans for them; only the history has to survive */
+static int convolver_reserve(convolver_t *convolver, uint32_t count)
+{
+    size_t size = (size_t) convolver->history + count;
+    float *re;
+    float *im;
+
+    if (count <= convolver->capacity) {
+        return AIRSPY_SUCCESS;
+    }
+
+    re = (float *) realloc(convolver->re, size * sizeof(float));
+    if (re != NULL) {
+        convolver->re = re;
+    }
+    im = (float *) realloc(convolver->im, size * sizeof(float));
+    if (im != NULL) {
+        convolver->im = im;
+    }
+    free(convolver->acc_re);
+    free(convolver->acc_im);
+    convolver->acc_re = (float *) malloc(count * sizeof(float));
+    convolver->acc_im = (float *) malloc(count * sizeof(float));
+    if (NULL == re || NULL == im || NULL == convolver->acc_re || NULL == convolver->acc_im ||
+            convolver_plan(convolver, count) != AIRSPY_SUCCESS) {
+        convolver->capacity = 0;
+        return AIRSPY_ERROR_NO_MEM;
+    }
+    convolver->capacity = count;
+
+    return AIRSPY_SUCCESS;
+}
+
+/* Output i of the block is the taps over the samples ending at its sample i, history + i of re and im */
+static void convolver_direct(convolver_t *convolver, uint32_t count)
+{
+    const float *taps_re = convolver->taps_re;
+    const float *taps_im = convolver->taps_im;
+    float *acc_re = convolver->acc_re;
+    float *acc_im = convolver->acc_im;
+    uint32_t tile;
+    uint32_t end;
+    size_t i;
+    size_t k;
+
+    memset(acc_re, 0, count * sizeof(float));
+    memset(acc_im, 0, count * sizeof(float));
+
+    for (tile = 0; tile < count; tile += CONVOLVER_TILE) {
+        end = tile + CONVOLVER_TILE < count ? tile + CONVOLVER_TILE : count;
+
+        for (k = 0; k < convolver->tap_count; k++) {
+            const float hr = taps_re[k];
+            const float *xr = convolver->re + k;
+            const float *xi = convolver->im + k;
+
+            if (NULL == taps_im) {
+                for (i = tile; i < end; i++) {
+                    acc_re[i] += hr * xr[i];
+                    acc_im[i] += hr * xi[i];
+                }
+            } else {
+                const float hi = taps_im[k];
+
+                for (i = tile; i < end; i++) {
+                    acc_re[i] += hr * xr[i] - hi * xi[i];
+                    acc_im[i] += hr * xi[i] + hi * xr[i];
+                }
+            }
+        }
+    }
+}
+
+/* Chunk by chunk: samples from start, zero padded, times the taps' spectrum; the first history outputs wrap around */
+static void convolver_fft(convolver_t *convolver, uint32_t count)
+{
+    const uint32_t n = convolver->fft_size;
+    const uint32_t history = convolver->history;
+    const float *h = convolver->spectrum;
+    float *work = convolver->work;
+    uint32_t size = history + count;
+    uint32_t start;
+    uint32_t avail;
+    uint32_t outputs;
+    size_t i;
+
+    for (start = 0; start < count; start += convolver->fft_step) {
+        avail = size - start < n ? size - start : n;
+        for (i = 0; i < avail; i++) {
+            work[2 * i] = convolver->re[start + i];
+            work[2 * i + 1] = convolver->im[start + i];
+        }
+        memset(work + 2 * avail, 0, (n - avail) * 2 * sizeof(float));
+        fft_float_forward(&convolver->fft, work);
+
+        for (i = 0; i < n; i++) {
+            float xr = work[2 * i];
+            float xi = work[2 * i + 1];
+
+            work[2 * i] = xr * h[2 * i] - xi * h[2 * i + 1];
+            work[2 * i + 1] = xr * h[2 * i + 1] + xi * h[2 * i];
+        }
+        fft_float_inverse(&convolver->fft, work);
+
+        outputs = count - start < convolver->fft_step ? count - start : convolver->fft_step;
+        for (i = 0; i < outputs; i++) {
+            convolver->acc_re[start + i] = work[2 * (history + i)];
+            convolver->acc_im[start + i] = work[2 * (history + i) + 1];
+        }
+    }
+}
+
+int convolver_process(convolver_t *convolver, const float *input, uint32_t count, float *output)
+{
+    const uint32_t history = convolver->history;
+    size_t i;
+    int result;
+
+    if (count == 0) {
+        return AIRSPY_SUCCESS;
+    }
+
+    result = convolver_reserve(convolver, count);
+    if (result != AIRSPY_SUCCESS) {
+        return result;
+    }
+
+    for (i = 0; i < count; i++) {
+        convolver->re[history + i] = input[2 * i];
+        convolver->im[history + i] = input[2 * i + 1];
+    }
+
+    if (convolver->use_fft) {
+        convolver_fft(convolver, count);
+    } else {
+        convolver_direct(convolver, count);
+    }
+
+    for (i = 0; i < count; i++) {
+        output[2 * i] = convolver->acc_re[i];
+        output[2 * i + 1] = convolver->acc_im[i];
+    }
+
+    memmove(convolver->re, convolver->re + count, history * sizeof(float));
+    memmove(convolver->im, convolver->im + count, history * sizeof(float));
+
+    return AIRSPY_SUCCESS;
+}
+
+void convolver_bind(convolver_t *convolver, airspy_sample_block_cb_fn callback, void *ctx)
+{
+    convolver->callback = callback;
+    convolver->ctx = ctx;
+}
+
+int convolver_block(struct airspy_device *device, void *ctx, airspy_transfer_t *transfer)
+{
+    convolver_t *convolver = (convolver_t *) ctx;
+    airspy_transfer_t filtered;
+    uint32_t count = (uint32_t) transfer->sample_count;
+    float *output;
+
+    /* A gap starts the filter over, like a new stream */
+    if (!convolver->started || transfer->sample_index != convolver->next_index ||
+            (transfer->flags & AIRSPY_TRANSFER_DISCONTINUITY)) {
+        convolver_reset(convolver);
+        convolver->started = 1;
+    }
+    convolver->next_index = transfer->sample_index + count;
+
+    /* The subscriber's block may be shared, so the filtered one has a buffer of its own, grown with the blocks */
+    if (count > convolver->capacity) {
+        output = (float *) realloc(convolver->output, (size_t) count * 2 * sizeof(float));
+        if (NULL == output) {
+            return 1;
+        }
+        convolver->output = output;
+    }
+
+    /* Out of memory ends this subscriber only */
+    if (convolver_process(convolver, (const float *) transfer->samples, count, convolver->output) != AIRSPY_SUCCESS) {
+        return 1;
+    }
+
+    filtered = *transfer;
+    filtered.samples = convolver->output;
+    filtered.buffer = NULL;
+    return convolver->callback(device, convolver->ctx, &filtered);
+}
@@ -0,0 +1,61 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef CONVOLVER_H
+#define CONVOLVER_H
+
+#include <stdint.h>
+
+#include "airspy.h"
+
+#define CONVOLVER_MAX_TAPS 32768
+/* Positions the direct form accumulates at a time, so they stay in L1 across the taps */
+#define CONVOLVER_TILE 512
+/* What a complex FFT butterfly costs against a direct form tap, see airspy_convolver_bench */
+#define CONVOLVER_FFT_WEIGHT 10.0
+
+typedef struct airspy_convolver convolver_t;
+
+/*
+ * A FIR filter over float IQ with user taps, run in the direct form or
+ * by overlap-save FFT convolution. The direct form runs tap by tap over
+ * a tile of positions, which vectorizes without reordering any sums.
+ * The FFT is sized for the largest block seen, to the plan of fewest
+ * butterflies for the whole block, and the cheaper of the two is picked
+ * then unless the flags say otherwise. Blocks are filtered as they come,
+ * with no latency beyond the filter's own.
+ */
+int convolver_create(convolver_t **convolver, const float *taps, uint32_t tap_count, uint32_t flags);
+void convolver_free(convolver_t *convolver);
+
+/* Clears the history */
+void convolver_reset(convolver_t *convolver);
+
+/* count interleaved samples in stream order; output may be input */
+int convolver_process(convolver_t *convolver, const float *input, uint32_t count, float *output);
+
+/* For the subscriber a convolver is attached to: filtered blocks go to callback */
+void convolver_bind(convolver_t *convolver, airspy_sample_block_cb_fn callback, void *ctx);
+int convolver_block(struct airspy_device *device, void *ctx, airspy_transfer_t *transfer);
+
+#endif // CONVOLVER_H
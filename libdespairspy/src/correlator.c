@@ -0,0 +1,490 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "correlator.h"
+#include "fft_float.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef struct {
+    uint32_t length;
+    float threshold;
+    double energy;
+    int fft;
+    float *re; /* Direct form: the template, split */
+    float *im;
+    float *spectrum; /* FFT: of the template padded to the FFT size, over that size */
+
+    /* The hit being followed: the best score since the threshold was crossed */
+    int run;
+    uint64_t run_start;
+    uint64_t best_index;
+    float best_score;
+    float best_phase;
+} correlator_template_t;
+
+struct airspy_correlator
+{
+    correlator_template_t templates[CORRELATOR_MAX_TEMPLATES];
+    uint32_t count;
+    uint32_t history; /* The longest template less one, kept from block to block */
+
+    fft_float_t fft;
+    uint32_t fft_size;
+    uint32_t fft_step; /* Positions per overlap-save chunk */
+    int fft_used;
+
+    int started;
+    uint64_t next_index;
+    uint64_t valid_from; /* Windows starting before this reach back into samples that weren't seen */
+
+    /* history + block samples, split, and the running sum of their |x|^2 */
+    float *re;
+    float *im;
+    double *prefix;
+    float *acc_re;
+    float *acc_im;
+    float *spectra; /* The forward transforms of the block's chunks */
+    float *work;
+    uint32_t capacity;
+    uint32_t chunk_capacity;
+
+    airspy_correlation_cb_fn callback;
+    void *ctx;
+};
+
+static void correlator_template_free(correlator_template_t *t)
+{
+    free(t->re);
+    free(t->im);
+    free(t->spectrum);
+}
+
+void correlator_free(correlator_t *correlator)
+{
+    uint32_t i;
+
+    if (NULL == correlator) {
+        return;
+    }
+
+    for (i = 0; i < correlator->count; i++) {
+        correlator_template_free(&correlator->templates[i]);
+    }
+    if (correlator->fft_used) {
+        fft_float_free(&correlator->fft);
+    }
+    free(correlator->re);
+    free(correlator->im);
+    free(correlator->prefix);
+    free(correlator->acc_re);
+    free(correlator->acc_im);
+    free(correlator->spectra);
+    free(correlator->work);
+    free(correlator);
+}
+
+int correlator_create(correlator_t **out, const airspy_template_t *templates, uint32_t count, uint32_t flags)
+{
+    correlator_t *correlator;
+    correlator_template_t *t;
+    uint32_t fft_length = 0;
+    uint32_t longest = 0;
+    uint32_t i;
+    uint32_t k;
+
+    if (count == 0 || count > CORRELATOR_MAX_TEMPLATES) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+    for (i = 0; i < count; i++) {
+        if (NULL == templates[i].samples || templates[i].length == 0 || templates[i].length > CORRELATOR_MAX_LENGTH) {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+    }
+
+    correlator = (correlator_t *) calloc(1, sizeof(correlator_t));
+    if (NULL == correlator) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    for (i = 0; i < count; i++) {
+        t = &correlator->templates[i];
+        t->length = templates[i].length;
+        t->threshold = templates[i].threshold;
+        for (k = 0; k < t->length; k++) {
+            t->energy += (double) templates[i].samples[2 * k] * templates[i].samples[2 * k] +
+                (double) templates[i].samples[2 * k + 1] * templates[i].samples[2 * k + 1];
+        }
+
+        if (flags & AIRSPY_CORRELATOR_FFT) {
+            t->fft = 1;
+        } else if (flags & AIRSPY_CORRELATOR_DIRECT) {
+            t->fft = 0;
+        } else {
+            t->fft = t->length >= CORRELATOR_FFT_LENGTH;
+        }
+
+        if (t->fft && t->length > fft_length) {
+            fft_length = t->length;
+        }
+        if (t->length > longest) {
+            longest = t->length;
+        }
+    }
+    correlator->count = count;
+    correlator->history = longest - 1;
+
+    if (fft_length > 0) {
+        correlator->fft_size = CORRELATOR_MIN_FFT_SIZE;
+        while (correlator->fft_size < 4 * fft_length && correlator->fft_size < FFT_FLOAT_MAX_SIZE) {
+            correlator->fft_size <<= 1;
+        }
+        /* Every chunk serves the longest template of all, whatever goes through the FFT */
+        if (correlator->fft_size <= correlator->history + 1) {
+            correlator_free(correlator);
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+        correlator->fft_step = correlator->fft_size - correlator->history;
+        if (fft_float_init(&correlator->fft, (int) correlator->fft_size) != 0) {
+            correlator_free(correlator);
+            return AIRSPY_ERROR_NO_MEM;
+        }
+        correlator->fft_used = 1;
+    }
+
+    for (i = 0; i < count; i++) {
+        t = &correlator->templates[i];
+
+        if (t->fft) {
+            t->spectrum = (float *) calloc((size_t) correlator->fft_size * 2, sizeof(float));
+            if (NULL == t->spectrum) {
+                correlator_free(correlator);
+                return AIRSPY_ERROR_NO_MEM;
+            }
+            for (k = 0; k < 2 * t->length; k++) {
+                t->spectrum[k] = templates[i].samples[k] / (float) correlator->fft_size;
+            }
+            fft_float_forward(&correlator->fft, t->spectrum);
+        } else {
+            t->re = (float *) malloc(t->length * sizeof(float));
+            t->im = (float *) malloc(t->length * sizeof(float));
+            if (NULL == t->re || NULL == t->im) {
+                correlator_free(correlator);
+                return AIRSPY_ERROR_NO_MEM;
+            }
+            for (k = 0; k < t->length; k++) {
+                t->re[k] = templates[i].samples[2 * k];
+                t->im[k] = templates[i].samples[2 * k + 1];
+            }
+        }
+    }
+
+    *out = correlator;
+    return AIRSPY_SUCCESS;
+}
+
+void correlator_bind(correlator_t *correlator, airspy_correlation_cb_fn callback, void *ctx)
+{
+    correlator->callback = callback;
+    correlator->ctx = ctx;
+}
+
+/* Grows the buffers for blocks of count samples; only the history has to survive */
+static int correlator_reserve(correlator_t *correlator, uint32_t count)
+{
+    uint32_t size = correlator->history + count;
+    uint32_t chunks;
+    float *re;
+    float *im;
+
+    if (count > correlator->capacity) {
+        re = (float *) realloc(correlator->re, size * sizeof(float));
+        if (re != NULL) {
+            correlator->re = re;
+        }
+        im = (float *) realloc(correlator->im, size * sizeof(float));
+        if (im != NULL) {
+            correlator->im = im;
+        }
+        free(correlator->prefix);
+        free(correlator->acc_re);
+        free(correlator->acc_im);
+        correlator->prefix = (double *) malloc((size + 1) * sizeof(double));
+        correlator->acc_re = (float *) malloc(count * sizeof(float));
+        correlator->acc_im = (float *) malloc(count * sizeof(float));
+        if (NULL == re || NULL == im || NULL == correlator->prefix || NULL == correlator->acc_re ||
+                NULL == correlator->acc_im) {
+            correlator->capacity = 0;
+            return AIRSPY_ERROR_NO_MEM;
+        }
+        correlator->capacity = count;
+    }
+
+    if (correlator->fft_used) {
+        chunks = (size + correlator->fft_step - 1) / correlator->fft_step;
+        if (chunks > correlator->chunk_capacity) {
+            free(correlator->spectra);
+            correlator->spectra = (float *) malloc((size_t) chunks * correlator->fft_size * 2 * sizeof(float));
+            if (NULL == correlator->work) {
+                correlator->work = (float *) malloc((size_t) correlator->fft_size * 2 * sizeof(float));
+            }
+            if (NULL == correlator->spectra || NULL == correlator->work) {
+                correlator->chunk_capacity = 0;
+                return AIRSPY_ERROR_NO_MEM;
+            }
+            correlator->chunk_capacity = chunks;
+        }
+    }
+
+    return AIRSPY_SUCCESS;
+}
+
+static void correlator_report(correlator_template_t *t, uint32_t n, airspy_correlation_cb_fn callback, void *ctx)
+{
+    airspy_correlation_hit_t hit;
+
+    hit.sample_index = t->best_index;
+    hit.template_index = n;
+    hit.score = t->best_score;
+    hit.phase = t->best_phase;
+    t->run = 0;
+    callback(ctx, &hit);
+}
+
+/* Position i of the block, the window ending at its sample i, correlates as acc_re[i] + j acc_im[i] */
+static void correlator_direct(correlator_t *correlator, const correlator_template_t *t, uint32_t count)
+{
+    const float *re = correlator->re + correlator->history + 1 - t->length;
+    const float *im = correlator->im + correlator->history + 1 - t->length;
+    float *acc_re = correlator->acc_re;
+    float *acc_im = correlator->acc_im;
+    uint32_t tile;
+    uint32_t end;
+    uint32_t i;
+    uint32_t k;
+
+    memset(acc_re, 0, count * sizeof(float));
+    memset(acc_im, 0, count * sizeof(float));
+
+    for (tile = 0; tile < count; tile += CORRELATOR_TILE) {
+        end = tile + CORRELATOR_TILE < count ? tile + CORRELATOR_TILE : count;
+
+        for (k = 0; k < t->length; k++) {
+            const float tr = t->re[k];
+            const float ti = t->im[k];
+            const float *xr = re + k;
+            const float *xi = im + k;
+
+            /* x times the template's conjugate */
+            for (i = tile; i < end; i++) {
+                acc_re[i] += xr[i] * tr + xi[i] * ti;
+                acc_im[i] += xi[i] * tr - xr[i] * ti;
+            }
+        }
+    }
+}
+
+/* The forward transforms of every chunk, chunk c starting at position c * fft_step of history + block */
+static void correlator_chunks(correlator_t *correlator, uint32_t count)
+{
+    uint32_t size = correlator->history + count;
+    uint32_t start;
+    uint32_t avail;
+    size_t i;
+    float *spectrum;
+
+    for (start = 0, spectrum = correlator->spectra; start < size;
+            start += correlator->fft_step, spectrum += correlator->fft_size * 2) {
+        avail = size - start < correlator->fft_size ? size - start : correlator->fft_size;
+        for (i = 0; i < avail; i++) {
+            spectrum[2 * i] = correlator->re[start + i];
+            spectrum[2 * i + 1] = correlator->im[start + i];
+        }
+        memset(spectrum + 2 * avail, 0, (correlator->fft_size - avail) * 2 * sizeof(float));
+        fft_float_forward(&correlator->fft, spectrum);
+    }
+}
+
+static void correlator_fft(correlator_t *correlator, const correlator_template_t *t, uint32_t count)
+{
+    const uint32_t n = correlator->fft_size;
+    const float *h = t->spectrum;
+    uint32_t size = correlator->history + count;
+    uint32_t first = correlator->history + 1 - t->length; /* Where the window ending at the block's first sample starts */
+    uint32_t start;
+    uint32_t from;
+    uint32_t to;
+    size_t i;
+    const float *spectrum;
+    float *work = correlator->work;
+
+    for (start = 0, spectrum = correlator->spectra; start < size;
+            start += correlator->fft_step, spectrum += correlator->fft_size * 2) {
+        from = start > first ? start : first;
+        to = start + correlator->fft_step < first + count ? start + correlator->fft_step : first + count;
+        if (from >= to) {
+            continue;
+        }
+
+        for (i = 0; i < n; i++) {
+            float xr = spectrum[2 * i];
+            float xi = spectrum[2 * i + 1];
+            float tr = h[2 * i];
+            float ti = h[2 * i + 1];
+
+            work[2 * i] = xr * tr + xi * ti;
+            work[2 * i + 1] = xi * tr - xr * ti;
+        }
+        fft_float_inverse(&correlator->fft, work);
+
+        for (i = from; i < to; i++) {
+            correlator->acc_re[i - first] = work[2 * (i - start)];
+            correlator->acc_im[i - first] = work[2 * (i - start) + 1];
+        }
+    }
+}
+
+static void correlator_scan(correlator_t *correlator, uint32_t n, uint64_t index, uint32_t count,
+    airspy_correlation_cb_fn callback, void *ctx)
+{
+    correlator_template_t *t = &correlator->templates[n];
+    const double *prefix = correlator->prefix + correlator->history + 1 - t->length;
+    uint64_t position;
+    double energy;
+    float power;
+    float score;
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        position = index + i + 1 - t->length;
+        if (index + i + 1 < correlator->valid_from + t->length) {
+            continue;
+        }
+
+        power = correlator->acc_re[i] * correlator->acc_re[i] + correlator->acc_im[i] * correlator->acc_im[i];
+        energy = (prefix[i + t->length] - prefix[i]) * t->energy;
+        score = energy > 0.0 ? (float) (power / energy) : 0.0f;
+
+        if (score >= t->threshold) {
+            if (!t->run) {
+                t->run = 1;
+                t->run_start = position;
+                t->best_score = -1.0f;
+            }
+            if (score > t->best_score) {
+                t->best_score = score;
+                t->best_index = position;
+                t->best_phase = atan2f(correlator->acc_im[i], correlator->acc_re[i]);
+            }
+            /* A match that goes on is reported once per template length */
+            if (position + 1 - t->run_start >= t->length) {
+                correlator_report(t, n, callback, ctx);
+            }
+        } else if (t->run) {
+            correlator_report(t, n, callback, ctx);
+        }
+    }
+}
+
+int correlator_process(correlator_t *correlator, const airspy_transfer_t *transfer, airspy_correlation_cb_fn callback,
+    void *ctx)
+{
+    const float *iq = (const float *) transfer->samples;
+    uint32_t count = (uint32_t) transfer->sample_count;
+    uint32_t history = correlator->history;
+    size_t i;
+    double sum;
+    int fresh;
+    int result;
+
+    fresh = !correlator->started || transfer->sample_index != correlator->next_index ||
+        (transfer->flags & AIRSPY_TRANSFER_DISCONTINUITY);
+    if (fresh) {
+        for (i = 0; i < correlator->count; i++) {
+            if (correlator->templates[i].run) {
+                correlator_report(&correlator->templates[i], (uint32_t) i, callback, ctx);
+            }
+        }
+        correlator->valid_from = transfer->sample_index;
+        correlator->started = 1;
+    }
+    correlator->next_index = transfer->sample_index + count;
+
+    if (count == 0) {
+        /* Nothing to clear the history with yet */
+        correlator->started = !fresh;
+        return AIRSPY_SUCCESS;
+    }
+
+    result = correlator_reserve(correlator, count);
+    if (result != AIRSPY_SUCCESS) {
+        correlator->started = 0;
+        return result;
+    }
+    if (fresh) {
+        memset(correlator->re, 0, history * sizeof(float));
+        memset(correlator->im, 0, history * sizeof(float));
+    }
+
+    for (i = 0; i < count; i++) {
+        correlator->re[history + i] = iq[2 * i];
+        correlator->im[history + i] = iq[2 * i + 1];
+    }
+
+    sum = 0.0;
+    correlator->prefix[0] = 0.0;
+    for (i = 0; i < history + count; i++) {
+        sum += (double) correlator->re[i] * correlator->re[i] + (double) correlator->im[i] * correlator->im[i];
+        correlator->prefix[i + 1] = sum;
+    }
+
+    if (correlator->fft_used) {
+        correlator_chunks(correlator, count);
+    }
+
+    for (i = 0; i < correlator->count; i++) {
+        if (correlator->templates[i].fft) {
+            correlator_fft(correlator, &correlator->templates[i], count);
+        } else {
+            correlator_direct(correlator, &correlator->templates[i], count);
+        }
+        correlator_scan(correlator, (uint32_t) i, transfer->sample_index, count, callback, ctx);
+    }
+
+    memmove(correlator->re, correlator->re + count, history * sizeof(float));
+    memmove(correlator->im, correlator->im + count, history * sizeof(float));
+
+    return AIRSPY_SUCCESS;
+}
+
+int correlator_block(struct airspy_device *device, void *ctx, airspy_transfer_t *transfer)
+{
+    correlator_t *correlator = (correlator_t *) ctx;
+
+    (void) device;
+
+    /* Out of memory ends this subscriber only */
+    return correlator_process(correlator, transfer, correlator->callback, correlator->ctx) != AIRSPY_SUCCESS;
+}
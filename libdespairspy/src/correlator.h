@@ -0,0 +1,65 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef CORRELATOR_H
+#define CORRELATOR_H
+
+#include <stdint.h>
+
+#include "airspy.h"
+
+#define CORRELATOR_MAX_TEMPLATES 64
+#define CORRELATOR_MAX_LENGTH 16384
+/* Templates this long or longer go through the FFT unless the flags say otherwise, see airspy_correlator_bench */
+#define CORRELATOR_FFT_LENGTH 64
+/* The FFT is at least this large, and four times the longest template it serves */
+#define CORRELATOR_MIN_FFT_SIZE 4096
+/* Positions the direct form accumulates at a time, so they stay in L1 across the taps */
+#define CORRELATOR_TILE 512
+
+typedef struct airspy_correlator correlator_t;
+
+/*
+ * A bank of complex templates slid over float IQ. The direct form runs
+ * tap by tap over a tile of positions, which vectorizes without
+ * reordering any sums; long templates share one forward FFT per
+ * overlap-save chunk and need one multiply and inverse FFT each.
+ * Scores are normalized by the energy of the samples under the template,
+ * so a threshold doesn't depend on the signal level.
+ */
+int correlator_create(correlator_t **correlator, const airspy_template_t *templates, uint32_t count, uint32_t flags);
+void correlator_free(correlator_t *correlator);
+
+/*
+ * transfer holds float IQ. Hits are reported once the score falls back
+ * below the threshold, so a hit may come with a later block. A gap in
+ * sample_index reports what is pending and starts over.
+ */
+int correlator_process(correlator_t *correlator, const airspy_transfer_t *transfer, airspy_correlation_cb_fn callback,
+    void *ctx);
+
+/* For the subscriber a correlator is attached to: hits go to callback */
+void correlator_bind(correlator_t *correlator, airspy_correlation_cb_fn callback, void *ctx);
+int correlator_block(struct airspy_device *device, void *ctx, airspy_transfer_t *transfer);
+
+#endif // CORRELATOR_H
@@ -0,0 +1,1054 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "fanout.h"
+#include "fft_float.h"
+#include "resampler.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define FANOUT_FULL_SCALE 32768.0f
+
+enum fanout_kind
+{
+    FANOUT_STAGE_RAW,
+    FANOUT_STAGE_INT16,
+    FANOUT_STAGE_FLOAT,
+    FANOUT_STAGE_PSD
+};
+
+typedef struct fanout_stage fanout_stage_t;
+
+typedef struct fanout_block
+{
+    fanout_stage_t *stage;
+    uint32_t refs;
+    void *data;
+    airspy_transfer_t transfer;
+    struct fanout_block *next;
+} fanout_block_t;
+
+/*
+ * INT16 at decimation 1 passes on the converted block, and the other
+ * stages take their input from the FLOAT stage at the same rate, which
+ * converts, decimates or resamples the converted block. Stages are kept
+ * in an order where every input comes first.
+ */
+struct fanout_stage
+{
+    enum fanout_kind kind;
+    uint32_t decimation;
+    uint32_t interpolation;
+    uint32_t fft_size;
+    fanout_stage_t *input;
+    int threaded;       /* Some subscriber keeps this stage's blocks past the round */
+    size_t block_bytes;
+    fanout_block_t *free_blocks;
+
+    /* This round's output; samples may point into the caller's block when nothing keeps it */
+    airspy_transfer_t out;
+    fanout_block_t *block;
+    int produced;
+
+    /* Decimating FLOAT: complex history of tap_count - 1 input samples, followed by the block */
+    float *taps;
+    uint32_t tap_count;
+    float *work;
+
+    /* Resampling FLOAT: the block is converted into work and resampled from there */
+    resampler_t *resampler;
+
+    /* PSD: the frame being filled and where it started, at the stage's rate */
+    fft_float_t fft;
+    int fft_ready;
+    float *window;
+    float power_scale;
+    float *frame;
+    float *spectrum;
+    uint32_t frame_fill;
+    uint64_t frame_index;
+
+    fanout_stage_t *next;
+};
+
+typedef struct
+{
+    fanout_block_t *block;
+    uint64_t dropped;   /* Samples lost to a full queue just before this block */
+} fanout_entry_t;
+
+struct airspy_subscriber
+{
+    fanout_t *fanout;
+    airspy_subscriber_params_t params;
+    airspy_sample_block_cb_fn callback;
+    void *ctx;
+    fanout_stage_t *stage;
+    volatile int stopped;
+
+    /* Threaded subscribers only; the queue and stats are under the fanout's lock */
+    pthread_t thread;
+    pthread_cond_t cond;
+    fanout_entry_t *queue;
+    uint32_t queue_depth;
+    uint32_t head;
+    uint32_t count;
+    uint64_t pending_dropped;
+    int exiting;
+    airspy_subscriber_stats_t stats;
+
+    struct airspy_subscriber *next;
+};
+
+struct fanout
+{
+    struct airspy_device *device;
+    struct airspy_subscriber *subscribers;
+    fanout_stage_t *stages;
+    int dirty;
+    uint32_t block_samples;
+    uint32_t raw_bytes;
+
+    /* The block an inline subscriber is being called with */
+    fanout_block_t *current;
+
+    pthread_mutex_t lock;
+    pthread_cond_t idle_cond;
+    uint32_t outstanding;   /* Block references held by subscriber queues and fanout_hold() */
+};
+
+static int fanout_threaded(const struct airspy_subscriber *sub)
+{
+    return (sub->params.flags & AIRSPY_SUBSCRIBER_INLINE) == 0;
+}
+
+static uint32_t fanout_decimation(const airspy_subscriber_params_t *params)
+{
+    return params->decimation > 1 ? params->decimation : 1;
+}
+
+static uint32_t fanout_interpolation(const airspy_subscriber_params_t *params)
+{
+    return params->interpolation > 1 ? params->interpolation : 1;
+}
+
+static fanout_block_t *fanout_block_get(fanout_t *fanout, fanout_stage_t *stage)
+{
+    fanout_block_t *block;
+
+    pthread_mutex_lock(&fanout->lock);
+    block = stage->free_blocks;
+    if (block != NULL) {
+        stage->free_blocks = block->next;
+    }
+    pthread_mutex_unlock(&fanout->lock);
+
+    if (NULL == block) {
+        block = (fanout_block_t *) calloc(1, sizeof(fanout_block_t));
+        if (NULL == block) {
+            return NULL;
+        }
+        block->data = malloc(stage->block_bytes);
+        if (NULL == block->data) {
+            free(block);
+            return NULL;
+        }
+        block->stage = stage;
+    }
+
+    block->refs = 1;
+    block->next = NULL;
+
+    return block;
+}
+
+/* Called with the lock held */
+static void fanout_block_put(fanout_block_t *block)
+{
+    if (--block->refs == 0) {
+        block->next = block->stage->free_blocks;
+        block->stage->free_blocks = block;
+    }
+}
+
+static void fanout_release_block(fanout_t *fanout, fanout_block_t *block)
+{
+    fanout_block_put(block);
+    fanout->outstanding--;
+    if (0 == fanout->outstanding) {
+        pthread_cond_broadcast(&fanout->idle_cond);
+    }
+}
+
+static void *fanout_subscriber_thread(void *arg)
+{
+    struct airspy_subscriber *sub = (struct airspy_subscriber *) arg;
+    fanout_t *fanout = sub->fanout;
+    fanout_entry_t entry;
+    airspy_transfer_t transfer;
+
+    pthread_mutex_lock(&fanout->lock);
+    for (;;) {
+        while (!sub->exiting && 0 == sub->count) {
+            pthread_cond_wait(&sub->cond, &fanout->lock);
+        }
+
+        if (sub->exiting) {
+            /* Anything still queued is dropped */
+            while (sub->count > 0) {
+                fanout_release_block(fanout, sub->queue[sub->head].block);
+                sub->head = (sub->head + 1) % sub->queue_depth;
+                sub->count--;
+            }
+            break;
+        }
+
+        entry = sub->queue[sub->head];
+        sub->head = (sub->head + 1) % sub->queue_depth;
+        sub->count--;
+        pthread_mutex_unlock(&fanout->lock);
+
+        transfer = entry.block->transfer;
+        if (entry.dropped != 0) {
+            transfer.flags |= AIRSPY_TRANSFER_DISCONTINUITY;
+            transfer.dropped_samples += entry.dropped;
+        }
+        if (!sub->stopped && 0 != sub->callback(fanout->device, sub->ctx, &transfer)) {
+            sub->stopped = 1;
+        }
+
+        pthread_mutex_lock(&fanout->lock);
+        sub->stats.blocks++;
+        fanout_release_block(fanout, entry.block);
+    }
+    pthread_mutex_unlock(&fanout->lock);
+
+    return NULL;
+}
+
+/* Hands this round's output of stage to its subscribers */
+static void fanout_emit(fanout_t *fanout, fanout_stage_t *stage)
+{
+    struct airspy_subscriber *sub;
+    airspy_transfer_t transfer;
+    uint32_t slot;
+
+    for (sub = fanout->subscribers; sub != NULL; sub = sub->next) {
+        if (sub->stage != stage || sub->stopped) {
+            continue;
+        }
+
+        if (!fanout_threaded(sub)) {
+            transfer = stage->out;
+            fanout->current = stage->block;
+            if (0 != sub->callback(fanout->device, sub->ctx, &transfer)) {
+                sub->stopped = 1;
+            }
+            fanout->current = NULL;
+            pthread_mutex_lock(&fanout->lock);
+            sub->stats.blocks++;
+            pthread_mutex_unlock(&fanout->lock);
+            continue;
+        }
+
+        pthread_mutex_lock(&fanout->lock);
+        if (sub->count == sub->queue_depth) {
+            sub->stats.dropped_blocks++;
+            sub->pending_dropped += stage->out.dropped_samples + stage->out.sample_count;
+        } else {
+            slot = (sub->head + sub->count) % sub->queue_depth;
+            sub->queue[slot].block = stage->block;
+            sub->queue[slot].dropped = sub->pending_dropped;
+            sub->pending_dropped = 0;
+            sub->count++;
+            if (sub->count > sub->stats.queue_high_water) {
+                sub->stats.queue_high_water = sub->count;
+            }
+            stage->block->refs++;
+            fanout->outstanding++;
+            pthread_cond_signal(&sub->cond);
+        }
+        pthread_mutex_unlock(&fanout->lock);
+    }
+}
+
+/* Takes a block for this round's output, which is then written into it; returns NULL when out of memory */
+static void *fanout_output(fanout_t *fanout, fanout_stage_t *stage)
+{
+    stage->block = fanout_block_get(fanout, stage);
+    if (NULL == stage->block) {
+        return NULL;
+    }
+    return stage->block->data;
+}
+
+static void fanout_decimated_range(const airspy_transfer_t *in, uint32_t decimation, airspy_transfer_t *out)
+{
+    uint64_t first;
+    uint64_t end;
+
+    /* Outputs are the input samples whose index is a multiple of the decimation */
+    first = (in->sample_index + decimation - 1) / decimation * decimation;
+    end = in->sample_index + in->sample_count;
+
+    *out = *in;
+    out->sample_index = first / decimation;
+    out->sample_count = end > first ? (int) ((end - first + decimation - 1) / decimation) : 0;
+    out->dropped_samples = in->dropped_samples / decimation;
+    out->buffer = NULL;
+}
+
+static void fanout_run_float(fanout_t *fanout, fanout_stage_t *stage, const airspy_transfer_t *in)
+{
+    const int16_t *samples = (const int16_t *) in->samples;
+    const float scale = 1.0f / FANOUT_FULL_SCALE;
+    uint32_t history;
+    uint32_t offset;
+    uint32_t i;
+    uint32_t k;
+    float *output;
+    float *x;
+    float re;
+    float im;
+
+    output = (float *) fanout_output(fanout, stage);
+    if (NULL == output) {
+        return;
+    }
+
+    if (stage->resampler != NULL) {
+        for (i = 0; i < (uint32_t) in->sample_count * 2; i++) {
+            stage->work[i] = samples[i] * scale;
+        }
+        stage->out = *in;
+        stage->out.buffer = NULL;
+        stage->out.sample_index = resampler_align(stage->resampler, in->sample_index);
+        stage->out.sample_count = (int) resampler_process(stage->resampler, stage->work, (uint32_t) in->sample_count,
+            output);
+        stage->out.dropped_samples = in->dropped_samples * stage->interpolation / stage->decimation;
+        stage->out.samples = output;
+        stage->produced = 1;
+        return;
+    }
+
+    if (1 == stage->decimation) {
+        stage->out = *in;
+        stage->out.buffer = NULL;
+        for (i = 0; i < (uint32_t) in->sample_count * 2; i++) {
+            output[i] = samples[i] * scale;
+        }
+        stage->out.samples = output;
+        stage->produced = 1;
+        return;
+    }
+
+    history = stage->tap_count - 1;
+    x = stage->work + history * 2;
+    for (i = 0; i < (uint32_t) in->sample_count * 2; i++) {
+        x[i] = samples[i] * scale;
+    }
+
+    fanout_decimated_range(in, stage->decimation, &stage->out);
+    offset = (uint32_t) (stage->out.sample_index * stage->decimation - in->sample_index);
+
+    for (i = 0; i < (uint32_t) stage->out.sample_count; i++) {
+        /* The newest input sample is x[offset + i * decimation], the oldest tap_count - 1 before it */
+        const float *newest = x + 2 * (offset + i * stage->decimation);
+
+        re = 0.0f;
+        im = 0.0f;
+        for (k = 0; k < stage->tap_count; k++) {
+            re += stage->taps[k] * newest[-2 * (int) k];
+            im += stage->taps[k] * newest[-2 * (int) k + 1];
+        }
+        output[2 * i] = re;
+        output[2 * i + 1] = im;
+    }
+
+    memmove(stage->work, stage->work + (size_t) in->sample_count * 2, history * 2 * sizeof(float));
+
+    stage->out.samples = output;
+    stage->produced = 1;
+}
+
+static void fanout_run_int16(fanout_t *fanout, fanout_stage_t *stage, const airspy_transfer_t *in)
+{
+    const float *input;
+    int16_t *output;
+    float v;
+    uint32_t i;
+
+    if (1 == stage->decimation) {
+        stage->out = *in;
+        stage->out.buffer = NULL;
+        if (stage->threaded) {
+            /* Someone keeps it past the round: one copy shared by all of them */
+            output = (int16_t *) fanout_output(fanout, stage);
+            if (NULL == output) {
+                return;
+            }
+            memcpy(output, in->samples, (size_t) in->sample_count * 2 * sizeof(int16_t));
+            stage->out.samples = output;
+        }
+        stage->produced = 1;
+        return;
+    }
+
+    if (!stage->input->produced) {
+        return;
+    }
+
+    output = (int16_t *) fanout_output(fanout, stage);
+    if (NULL == output) {
+        return;
+    }
+
+    stage->out = stage->input->out;
+    input = (const float *) stage->out.samples;
+    for (i = 0; i < (uint32_t) stage->out.sample_count * 2; i++) {
+        v = input[i] * FANOUT_FULL_SCALE;
+        output[i] = v >= 32767.0f ? 32767 : v <= -32768.0f ? -32768 : (int16_t) lrintf(v);
+    }
+    stage->out.samples = output;
+    stage->produced = 1;
+}
+
+static void fanout_run_psd(fanout_t *fanout, fanout_stage_t *stage)
+{
+    const airspy_transfer_t *in = &stage->input->out;
+    const float *input;
+    uint32_t n = stage->fft_size;
+    uint32_t spectra;
+    uint32_t take;
+    uint32_t used;
+    uint32_t i;
+    float *output;
+    float re;
+    float im;
+
+    if (!stage->input->produced) {
+        return;
+    }
+
+    output = (float *) fanout_output(fanout, stage);
+    if (NULL == output) {
+        return;
+    }
+
+    /* A frame doesn't span lost samples */
+    if (in->flags & AIRSPY_TRANSFER_DISCONTINUITY) {
+        stage->frame_fill = 0;
+    }
+
+    stage->out = *in;
+    stage->out.samples = output;
+    spectra = 0;
+    input = (const float *) in->samples;
+    used = 0;
+
+    while (used < (uint32_t) in->sample_count) {
+        if (0 == stage->frame_fill) {
+            stage->frame_index = in->sample_index + used;
+        }
+
+        take = n - stage->frame_fill;
+        if (take > (uint32_t) in->sample_count - used) {
+            take = (uint32_t) in->sample_count - used;
+        }
+        memcpy(stage->frame + 2 * stage->frame_fill, input + 2 * used, take * 2 * sizeof(float));
+        stage->frame_fill += take;
+        used += take;
+
+        if (stage->frame_fill < n) {
+            break;
+        }
+        stage->frame_fill = 0;
+
+        if (0 == spectra) {
+            stage->out.sample_index = stage->frame_index;
+        }
+
+        for (i = 0; i < n; i++) {
+            stage->spectrum[2 * i] = stage->frame[2 * i] * stage->window[i];
+            stage->spectrum[2 * i + 1] = stage->frame[2 * i + 1] * stage->window[i];
+        }
+        fft_float_forward(&stage->fft, stage->spectrum);
+
+        /* DC in the middle */
+        for (i = 0; i < n; i++) {
+            re = stage->spectrum[2 * ((i + n / 2) & (n - 1))];
+            im = stage->spectrum[2 * ((i + n / 2) & (n - 1)) + 1];
+            output[spectra * n + i] = 10.0f * log10f((re * re + im * im) * stage->power_scale + 1e-20f);
+        }
+        spectra++;
+    }
+
+    stage->out.sample_count = (int) (spectra * n);
+    stage->produced = spectra > 0;
+}
+
+void fanout_raw(fanout_t *fanout, const void *data, const airspy_transfer_t *transfer)
+{
+    fanout_stage_t *stage;
+    void *output;
+
+    for (stage = fanout->stages; stage != NULL; stage = stage->next) {
+        if (stage->kind != FANOUT_STAGE_RAW) {
+            continue;
+        }
+
+        stage->out = *transfer;
+        stage->out.samples = (void *) data;
+        stage->out.sample_count = transfer->sample_count * 2;
+        stage->out.sample_index = transfer->sample_index * 2;
+        stage->out.dropped_samples = transfer->dropped_samples * 2;
+        stage->out.buffer = NULL;
+        stage->block = NULL;
+
+        if (stage->threaded) {
+            output = fanout_output(fanout, stage);
+            if (NULL == output) {
+                return;
+            }
+            memcpy(output, data, fanout->raw_bytes);
+            stage->out.samples = output;
+            stage->block->transfer = stage->out;
+        }
+
+        fanout_emit(fanout, stage);
+
+        if (stage->block != NULL) {
+            pthread_mutex_lock(&fanout->lock);
+            fanout_block_put(stage->block);
+            pthread_mutex_unlock(&fanout->lock);
+            stage->block = NULL;
+        }
+    }
+}
+
+void fanout_iq(fanout_t *fanout, const airspy_transfer_t *transfer)
+{
+    fanout_stage_t *stage;
+
+    for (stage = fanout->stages; stage != NULL; stage = stage->next) {
+        stage->produced = 0;
+        stage->block = NULL;
+
+        switch (stage->kind) {
+        case FANOUT_STAGE_RAW:
+            continue;
+
+        case FANOUT_STAGE_INT16:
+            fanout_run_int16(fanout, stage, transfer);
+            break;
+
+        case FANOUT_STAGE_FLOAT:
+            fanout_run_float(fanout, stage, transfer);
+            break;
+
+        case FANOUT_STAGE_PSD:
+            fanout_run_psd(fanout, stage);
+            break;
+        }
+
+        if (stage->block != NULL) {
+            stage->block->transfer = stage->out;
+        }
+        if (stage->produced && stage->out.sample_count > 0) {
+            fanout_emit(fanout, stage);
+        }
+    }
+
+    /* Later stages read their input's output, so blocks are only handed back once the round is over */
+    pthread_mutex_lock(&fanout->lock);
+    for (stage = fanout->stages; stage != NULL; stage = stage->next) {
+        if (stage->kind != FANOUT_STAGE_RAW && stage->block != NULL) {
+            fanout_block_put(stage->block);
+            stage->block = NULL;
+        }
+    }
+    pthread_mutex_unlock(&fanout->lock);
+}
+
+static void fanout_stage_free(fanout_stage_t *stage)
+{
+    fanout_block_t *block;
+
+    while (stage->free_blocks != NULL) {
+        block = stage->free_blocks;
+        stage->free_blocks = block->next;
+        free(block->data);
+        free(block);
+    }
+
+    if (stage->fft_ready) {
+        fft_float_free(&stage->fft);
+    }
+    resampler_free(stage->resampler);
+    free(stage->taps);
+    free(stage->work);
+    free(stage->window);
+    free(stage->frame);
+    free(stage->spectrum);
+    free(stage);
+}
+
+static void fanout_free_stages(fanout_t *fanout)
+{
+    fanout_stage_t *stage;
+
+    while (fanout->stages != NULL) {
+        stage = fanout->stages;
+        fanout->stages = stage->next;
+        fanout_stage_free(stage);
+    }
+}
+
+/* Finds the stage producing kind, or appends one after the stages it reads from */
+static fanout_stage_t *fanout_stage_get(fanout_t *fanout, enum fanout_kind kind, uint32_t decimation,
+    uint32_t interpolation, uint32_t fft_size)
+{
+    fanout_stage_t *stage;
+    fanout_stage_t *input;
+    fanout_stage_t **tail;
+
+    for (stage = fanout->stages; stage != NULL; stage = stage->next) {
+        if (stage->kind == kind && stage->decimation == decimation && stage->interpolation == interpolation &&
+                stage->fft_size == fft_size) {
+            return stage;
+        }
+    }
+
+    input = NULL;
+    if (FANOUT_STAGE_PSD == kind || (FANOUT_STAGE_INT16 == kind && (decimation > 1 || interpolation > 1))) {
+        input = fanout_stage_get(fanout, FANOUT_STAGE_FLOAT, decimation, interpolation, 0);
+        if (NULL == input) {
+            return NULL;
+        }
+    }
+
+    stage = (fanout_stage_t *) calloc(1, sizeof(fanout_stage_t));
+    if (NULL == stage) {
+        return NULL;
+    }
+    stage->kind = kind;
+    stage->decimation = decimation;
+    stage->interpolation = interpolation;
+    stage->fft_size = fft_size;
+    stage->input = input;
+
+    for (tail = &fanout->stages; *tail != NULL; tail = &(*tail)->next) {
+    }
+    *tail = stage;
+
+    return stage;
+}
+
+/* Lowpass at half the output rate, Blackman windowed, unity gain at DC */
+static int fanout_design_decimator(fanout_stage_t *stage)
+{
+    double sum;
+    double t;
+    double w;
+    double h;
+    uint32_t i;
+
+    stage->tap_count = FANOUT_TAPS_PER_FACTOR * stage->decimation + 1;
+    stage->taps = (float *) malloc(stage->tap_count * sizeof(float));
+    if (NULL == stage->taps) {
+        return -1;
+    }
+
+    sum = 0.0;
+    for (i = 0; i < stage->tap_count; i++) {
+        t = (double) i - (stage->tap_count - 1) / 2.0;
+        h = t == 0.0 ? 1.0 : sin(M_PI * t / stage->decimation) / (M_PI * t / stage->decimation);
+        w = 0.42 - 0.5 * cos(2.0 * M_PI * i / (stage->tap_count - 1)) + 0.08 * cos(4.0 * M_PI * i / (stage->tap_count - 1));
+        stage->taps[i] = (float) (h * w);
+        sum += h * w;
+    }
+    for (i = 0; i < stage->tap_count; i++) {
+        stage->taps[i] = (float) (stage->taps[i] / sum);
+    }
+
+    return 0;
+}
+
+/* Largest output of a stage for one input block */
+static size_t fanout_stage_bytes(enum fanout_kind kind, uint32_t decimation, uint32_t interpolation, uint32_t fft_size,
+    uint32_t block_samples, uint32_t raw_bytes)
+{
+    uint32_t max_out;
+
+    max_out = (uint32_t) ((uint64_t) block_samples * interpolation / decimation + 1);
+
+    switch (kind) {
+    case FANOUT_STAGE_RAW:
+        return raw_bytes;
+    case FANOUT_STAGE_INT16:
+        return (size_t) max_out * 2 * sizeof(int16_t);
+    case FANOUT_STAGE_FLOAT:
+        return (size_t) max_out * 2 * sizeof(float);
+    case FANOUT_STAGE_PSD:
+        /* Whole spectra, counting the part of a frame left over from the last block */
+        return (size_t) ((max_out + fft_size - 1) / fft_size) * fft_size * sizeof(float);
+    }
+
+    return 0;
+}
+
+static int fanout_stage_setup(fanout_t *fanout, fanout_stage_t *stage)
+{
+    airspy_resampler_params_t resampler_params;
+    double window_sum;
+    uint32_t i;
+    int result;
+
+    stage->block_bytes = fanout_stage_bytes(stage->kind, stage->decimation, stage->interpolation, stage->fft_size,
+        fanout->block_samples, fanout->raw_bytes);
+
+    switch (stage->kind) {
+    case FANOUT_STAGE_RAW:
+    case FANOUT_STAGE_INT16:
+        break;
+
+    case FANOUT_STAGE_FLOAT:
+        if (stage->interpolation > 1) {
+            resampler_params.interpolation = stage->interpolation;
+            resampler_params.decimation = stage->decimation;
+            resampler_params.ratio = 0.0;
+            resampler_params.zero_crossings = 0;
+            result = resampler_create(&stage->resampler, &resampler_params);
+            if (result != AIRSPY_SUCCESS) {
+                return result;
+            }
+            stage->work = (float *) malloc((size_t) fanout->block_samples * 2 * sizeof(float));
+            if (NULL == stage->work) {
+                return AIRSPY_ERROR_NO_MEM;
+            }
+        } else if (stage->decimation > 1) {
+            if (fanout_design_decimator(stage) != 0) {
+                return AIRSPY_ERROR_NO_MEM;
+            }
+            stage->work = (float *) calloc(((size_t) stage->tap_count - 1 + fanout->block_samples) * 2, sizeof(float));
+            if (NULL == stage->work) {
+                return AIRSPY_ERROR_NO_MEM;
+            }
+        }
+        break;
+
+    case FANOUT_STAGE_PSD:
+        if (fft_float_init(&stage->fft, (int) stage->fft_size) != 0) {
+            return AIRSPY_ERROR_NO_MEM;
+        }
+        stage->fft_ready = 1;
+
+        stage->window = (float *) malloc(stage->fft_size * sizeof(float));
+        stage->frame = (float *) malloc(stage->fft_size * 2 * sizeof(float));
+        stage->spectrum = (float *) malloc(stage->fft_size * 2 * sizeof(float));
+        if (NULL == stage->window || NULL == stage->frame || NULL == stage->spectrum) {
+            return AIRSPY_ERROR_NO_MEM;
+        }
+
+        /* Hann window, scaled so that a full scale complex tone reads 0 dBFS */
+        window_sum = 0.0;
+        for (i = 0; i < stage->fft_size; i++) {
+            stage->window[i] = (float) (0.5 - 0.5 * cos(2.0 * M_PI * i / stage->fft_size));
+            window_sum += stage->window[i];
+        }
+        stage->power_scale = (float) (1.0 / (window_sum * window_sum));
+        break;
+    }
+
+    return AIRSPY_SUCCESS;
+}
+
+static enum fanout_kind fanout_kind_of(enum airspy_subscriber_format format)
+{
+    switch (format) {
+    case AIRSPY_SUBSCRIBER_RAW:
+        return FANOUT_STAGE_RAW;
+    case AIRSPY_SUBSCRIBER_IQ_FLOAT32:
+        return FANOUT_STAGE_FLOAT;
+    case AIRSPY_SUBSCRIBER_PSD:
+        return FANOUT_STAGE_PSD;
+    default:
+        return FANOUT_STAGE_INT16;
+    }
+}
+
+size_t fanout_block_bytes(const airspy_subscriber_params_t *params, uint32_t block_samples, uint32_t raw_bytes)
+{
+    return fanout_stage_bytes(fanout_kind_of(params->format), fanout_decimation(params), fanout_interpolation(params),
+        params->fft_size, block_samples, raw_bytes);
+}
+
+static int fanout_build(fanout_t *fanout)
+{
+    struct airspy_subscriber *sub;
+    fanout_stage_t *stage;
+    int result;
+
+    for (sub = fanout->subscribers; sub != NULL; sub = sub->next) {
+        sub->stage = fanout_stage_get(fanout, fanout_kind_of(sub->params.format), fanout_decimation(&sub->params),
+            fanout_interpolation(&sub->params), sub->params.format == AIRSPY_SUBSCRIBER_PSD ? sub->params.fft_size : 0);
+        if (NULL == sub->stage) {
+            return AIRSPY_ERROR_NO_MEM;
+        }
+        if (fanout_threaded(sub) || (sub->params.flags & FANOUT_SUBSCRIBER_HOLD) != 0) {
+            sub->stage->threaded = 1;
+        }
+    }
+
+    for (stage = fanout->stages; stage != NULL; stage = stage->next) {
+        result = fanout_stage_setup(fanout, stage);
+        if (result != AIRSPY_SUCCESS) {
+            return result;
+        }
+    }
+
+    return AIRSPY_SUCCESS;
+}
+
+int fanout_start(fanout_t *fanout, uint32_t block_samples, uint32_t raw_bytes)
+{
+    fanout_stage_t *stage;
+    int result;
+
+    if (fanout->dirty || block_samples != fanout->block_samples || raw_bytes != fanout->raw_bytes) {
+        /* Subscriber threads may still hold blocks of the old stages */
+        pthread_mutex_lock(&fanout->lock);
+        while (fanout->outstanding > 0) {
+            pthread_cond_wait(&fanout->idle_cond, &fanout->lock);
+        }
+        pthread_mutex_unlock(&fanout->lock);
+
+        fanout_free_stages(fanout);
+        fanout->block_samples = block_samples;
+        fanout->raw_bytes = raw_bytes;
+
+        result = fanout_build(fanout);
+        if (result != AIRSPY_SUCCESS) {
+            fanout_free_stages(fanout);
+            return result;
+        }
+        fanout->dirty = 0;
+    }
+
+    for (stage = fanout->stages; stage != NULL; stage = stage->next) {
+        if (stage->resampler != NULL) {
+            resampler_reset(stage->resampler);
+        } else if (stage->work != NULL) {
+            memset(stage->work, 0, (stage->tap_count - 1) * 2 * sizeof(float));
+        }
+        stage->frame_fill = 0;
+    }
+
+    return AIRSPY_SUCCESS;
+}
+
+int fanout_create(fanout_t **fanout_out, struct airspy_device *device)
+{
+    fanout_t *fanout;
+
+    fanout = (fanout_t *) calloc(1, sizeof(fanout_t));
+    if (NULL == fanout) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    fanout->device = device;
+    fanout->dirty = 1;
+    pthread_mutex_init(&fanout->lock, NULL);
+    pthread_cond_init(&fanout->idle_cond, NULL);
+
+    *fanout_out = fanout;
+
+    return AIRSPY_SUCCESS;
+}
+
+void fanout_free(fanout_t *fanout)
+{
+    if (NULL == fanout) {
+        return;
+    }
+
+    while (fanout->subscribers != NULL) {
+        fanout_unsubscribe(fanout, fanout->subscribers);
+    }
+    fanout_free_stages(fanout);
+
+    pthread_cond_destroy(&fanout->idle_cond);
+    pthread_mutex_destroy(&fanout->lock);
+    free(fanout);
+}
+
+/* Subscribers at the same rate share stages, whatever the terms they asked for it in */
+static void fanout_reduce(airspy_subscriber_params_t *params)
+{
+    uint32_t a = fanout_interpolation(params);
+    uint32_t b = fanout_decimation(params);
+    uint32_t t;
+
+    while (b != 0) {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+    params->interpolation = fanout_interpolation(params) / a;
+    params->decimation = fanout_decimation(params) / a;
+}
+
+int fanout_subscribe(fanout_t *fanout, const airspy_subscriber_params_t *params, airspy_sample_block_cb_fn callback,
+    void *ctx, struct airspy_subscriber **subscriber)
+{
+    struct airspy_subscriber *sub;
+    struct airspy_subscriber **tail;
+
+    if (NULL == params || NULL == callback || NULL == subscriber || params->format > AIRSPY_SUBSCRIBER_PSD) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+    if (AIRSPY_SUBSCRIBER_RAW == params->format &&
+            (fanout_decimation(params) > 1 || fanout_interpolation(params) > 1)) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+    if (AIRSPY_SUBSCRIBER_PSD == params->format && (params->fft_size < FFT_FLOAT_MIN_SIZE ||
+            params->fft_size > FFT_FLOAT_MAX_SIZE || (params->fft_size & (params->fft_size - 1)) != 0)) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    sub = (struct airspy_subscriber *) calloc(1, sizeof(struct airspy_subscriber));
+    if (NULL == sub) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+    sub->fanout = fanout;
+    sub->params = *params;
+    fanout_reduce(&sub->params);
+    if (sub->params.interpolation > RESAMPLER_MAX_PHASES || (sub->params.interpolation > 1 &&
+            (uint64_t) 2 * RESAMPLER_ZERO_CROSSINGS * sub->params.decimation >
+            (uint64_t) RESAMPLER_MAX_TAPS * sub->params.interpolation)) {
+        free(sub);
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+    sub->callback = callback;
+    sub->ctx = ctx;
+
+    if (fanout_threaded(sub)) {
+        sub->queue_depth = params->queue_depth > 0 ? params->queue_depth : FANOUT_DEFAULT_QUEUE_DEPTH;
+        sub->queue = (fanout_entry_t *) calloc(sub->queue_depth, sizeof(fanout_entry_t));
+        if (NULL == sub->queue) {
+            free(sub);
+            return AIRSPY_ERROR_NO_MEM;
+        }
+
+        pthread_cond_init(&sub->cond, NULL);
+        if (pthread_create(&sub->thread, NULL, fanout_subscriber_thread, sub) != 0) {
+            pthread_cond_destroy(&sub->cond);
+            free(sub->queue);
+            free(sub);
+            return AIRSPY_ERROR_THREAD;
+        }
+    }
+
+    for (tail = &fanout->subscribers; *tail != NULL; tail = &(*tail)->next) {
+    }
+    *tail = sub;
+    fanout->dirty = 1;
+
+    *subscriber = sub;
+
+    return AIRSPY_SUCCESS;
+}
+
+int fanout_unsubscribe(fanout_t *fanout, struct airspy_subscriber *subscriber)
+{
+    struct airspy_subscriber **link;
+
+    for (link = &fanout->subscribers; *link != NULL && *link != subscriber; link = &(*link)->next) {
+    }
+    if (NULL == *link) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+    *link = subscriber->next;
+    fanout->dirty = 1;
+
+    if (fanout_threaded(subscriber)) {
+        pthread_mutex_lock(&fanout->lock);
+        subscriber->exiting = 1;
+        pthread_cond_signal(&subscriber->cond);
+        pthread_mutex_unlock(&fanout->lock);
+
+        pthread_join(subscriber->thread, NULL);
+        pthread_cond_destroy(&subscriber->cond);
+        free(subscriber->queue);
+    }
+    free(subscriber);
+
+    return AIRSPY_SUCCESS;
+}
+
+void *fanout_hold(fanout_t *fanout)
+{
+    fanout_block_t *block = fanout->current;
+
+    if (NULL == block) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&fanout->lock);
+    block->refs++;
+    fanout->outstanding++;
+    pthread_mutex_unlock(&fanout->lock);
+
+    return block;
+}
+
+void fanout_release(fanout_t *fanout, void *hold)
+{
+    pthread_mutex_lock(&fanout->lock);
+    fanout_release_block(fanout, (fanout_block_t *) hold);
+    pthread_mutex_unlock(&fanout->lock);
+}
+
+int fanout_get_stats(fanout_t *fanout, struct airspy_subscriber *subscriber, airspy_subscriber_stats_t *stats)
+{
+    struct airspy_subscriber *sub;
+
+    for (sub = fanout->subscribers; sub != NULL && sub != subscriber; sub = sub->next) {
+    }
+    if (NULL == sub || NULL == stats) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    pthread_mutex_lock(&fanout->lock);
+    *stats = sub->stats;
+    pthread_mutex_unlock(&fanout->lock);
+
+    return AIRSPY_SUCCESS;
+}
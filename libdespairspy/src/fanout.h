@@ -0,0 +1,90 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef FANOUT_H
+#define FANOUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "airspy.h"
+
+#define FANOUT_DEFAULT_QUEUE_DEPTH 16
+
+/* Decimation filter length per unit of decimation */
+#define FANOUT_TAPS_PER_FACTOR 16
+
+/* Not for applications, airspy_subscribe() clears it */
+#define FANOUT_SUBSCRIBER_HOLD (1u << 31)
+
+typedef struct fanout fanout_t;
+
+/*
+ * Delivers the stream to subscribers through a graph of stages, one per
+ * distinct format/decimation/FFT size, built at fanout_start() from the
+ * current subscribers. fanout_raw() and fanout_iq() run on the
+ * airspy_do_rx() thread, which also calls inline subscribers.
+ *
+ * Subscribers asking for the same thing share a stage and its one buffer
+ * per block, every format at a given decimation is fed by one decimator,
+ * and a block queued for several threads is reference counted rather
+ * than copied. Decimation is a windowed-sinc FIR, flat to about two
+ * thirds of the output band. With an interpolation above 1 the stage
+ * goes through the rational resampler instead, and sample_index counts
+ * the outputs whose newest input is at or after the block's first.
+ */
+int fanout_create(fanout_t **fanout, struct airspy_device *device);
+void fanout_free(fanout_t *fanout);
+
+int fanout_subscribe(fanout_t *fanout, const airspy_subscriber_params_t *params, airspy_sample_block_cb_fn callback,
+    void *ctx, struct airspy_subscriber **subscriber);
+int fanout_unsubscribe(fanout_t *fanout, struct airspy_subscriber *subscriber);
+int fanout_get_stats(fanout_t *fanout, struct airspy_subscriber *subscriber, airspy_subscriber_stats_t *stats);
+
+/*
+ * An inline subscriber with FANOUT_SUBSCRIBER_HOLD always gets blocks of
+ * the stage's own, and may call fanout_hold() from its callback to keep
+ * the samples past it, until the matching fanout_release() from any
+ * thread. fanout_start() waits for blocks still held when it rebuilds.
+ */
+void *fanout_hold(fanout_t *fanout);
+void fanout_release(fanout_t *fanout, void *hold);
+
+/*
+ * Readies the stages for a stream of blocks of block_samples IQ samples,
+ * raw_bytes as received. When the subscribers or the block size changed
+ * since the last stream, waits for subscriber threads to finish with the
+ * old stages' blocks and builds new ones.
+ */
+int fanout_start(fanout_t *fanout, uint32_t block_samples, uint32_t raw_bytes);
+
+/* Upper bound on the size of a block delivered to a subscriber with these params */
+size_t fanout_block_bytes(const airspy_subscriber_params_t *params, uint32_t block_samples, uint32_t raw_bytes);
+
+/* A block as received; transfer indices are in IQ samples */
+void fanout_raw(fanout_t *fanout, const void *data, const airspy_transfer_t *transfer);
+
+/* A converted block of int16 IQ */
+void fanout_iq(fanout_t *fanout, const airspy_transfer_t *transfer);
+
+#endif // FANOUT_H
@@ -0,0 +1,157 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "fft_float.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+int fft_float_init(fft_float_t *fft, int len)
+{
+    int i;
+    int j;
+    int log2_len;
+
+    fft->twiddle = NULL;
+    fft->bitrev = NULL;
+
+    if (len < FFT_FLOAT_MIN_SIZE || len > FFT_FLOAT_MAX_SIZE || (len & (len - 1)) != 0) {
+        return -1;
+    }
+
+    for (log2_len = 0; (1 << log2_len) < len; log2_len++);
+
+    fft->len = len;
+    fft->log2_len = log2_len;
+
+    fft->twiddle = (float *) malloc(len * sizeof(float));
+    fft->bitrev = (int *) malloc(len * sizeof(int));
+    if (NULL == fft->twiddle || NULL == fft->bitrev) {
+        fft_float_free(fft);
+        return -1;
+    }
+
+    /* One twiddle per butterfly span of the largest stage, interleaved cos/-sin */
+    for (i = 0; i < len / 2; i++)
+    {
+        fft->twiddle[2 * i + 0] = (float) cos(2.0 * M_PI * i / len);
+        fft->twiddle[2 * i + 1] = (float) -sin(2.0 * M_PI * i / len);
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        int rev = 0;
+        for (j = 0; j < log2_len; j++)
+        {
+            rev |= ((i >> j) & 1) << (log2_len - 1 - j);
+        }
+        fft->bitrev[i] = rev;
+    }
+
+    return 0;
+}
+
+void fft_float_free(fft_float_t *fft)
+{
+    free(fft->twiddle);
+    free(fft->bitrev);
+    fft->twiddle = NULL;
+    fft->bitrev = NULL;
+}
+
+static void fft_float_permute(fft_float_t *fft, float *data)
+{
+    int i;
+    int j;
+    float re;
+    float im;
+
+    for (i = 0; i < fft->len; i++)
+    {
+        j = fft->bitrev[i];
+        if (j > i)
+        {
+            re = data[2 * i];
+            im = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = re;
+            data[2 * j + 1] = im;
+        }
+    }
+}
+
+/*
+ * Iterative radix-2 decimation in time. sign selects the direction by
+ * conjugating the twiddles.
+ */
+static void fft_float_transform(fft_float_t *fft, float *data, float sign)
+{
+    int span;
+    int start;
+    int k;
+    int stride;
+    float *a;
+    float *b;
+    float wr;
+    float wi;
+    float tr;
+    float ti;
+
+    fft_float_permute(fft, data);
+
+    for (span = 1, stride = fft->len / 2; span < fft->len; span <<= 1, stride >>= 1)
+    {
+        for (start = 0; start < fft->len; start += span << 1)
+        {
+            for (k = 0; k < span; k++)
+            {
+                wr = fft->twiddle[2 * k * stride];
+                wi = sign * fft->twiddle[2 * k * stride + 1];
+
+                a = data + 2 * (start + k);
+                b = data + 2 * (start + k + span);
+
+                tr = b[0] * wr - b[1] * wi;
+                ti = b[0] * wi + b[1] * wr;
+
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+}
+
+void fft_float_forward(fft_float_t *fft, float *data)
+{
+    fft_float_transform(fft, data, 1.0f);
+}
+
+void fft_float_inverse(fft_float_t *fft, float *data)
+{
+    fft_float_transform(fft, data, -1.0f);
+}
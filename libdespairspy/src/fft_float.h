@@ -0,0 +1,45 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef FFT_FLOAT_H
+#define FFT_FLOAT_H
+
+#include <stdint.h>
+
+#define FFT_FLOAT_MIN_SIZE 16
+#define FFT_FLOAT_MAX_SIZE 65536
+
+typedef struct {
+	int len;
+	int log2_len;
+	float *twiddle;
+	int *bitrev;
+} fft_float_t;
+
+/* len shall be a power of two between FFT_FLOAT_MIN_SIZE and FFT_FLOAT_MAX_SIZE */
+int fft_float_init(fft_float_t *fft, int len);
+void fft_float_free(fft_float_t *fft);
+
+/* In-place transforms of len complex values stored as interleaved re/im pairs. The inverse is not scaled. */
+void fft_float_forward(fft_float_t *fft, float *data);
+void fft_float_inverse(fft_float_t *fft, float *data);
+
+#endif // FFT_FLOAT_H
@@ -0,0 +1,338 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "file_source.h"
+#include "recorder.h"
+#include "codec.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define FILE_SOURCE_META_MAX (1 << 20)
+
+struct file_source
+{
+    const uint8_t *data;
+    uint64_t size;
+    uint64_t pos;
+
+    /* Compressed captures only */
+    int compressed;
+    codec_reader_t codec;
+    uint16_t *decoded;
+    uint32_t decoded_alloc;
+    uint32_t decoded_fill;
+    uint32_t decoded_pos;
+};
+
+#ifndef _WIN32
+
+int file_source_open(file_source_t **out, const char *path)
+{
+    file_source_t *fs;
+    struct stat st;
+    void *data;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return AIRSPY_ERROR_NOT_FOUND;
+    }
+
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+#ifdef MADV_SEQUENTIAL
+    madvise(data, (size_t) st.st_size, MADV_SEQUENTIAL);
+#endif
+
+    fs = (file_source_t *) calloc(1, sizeof(file_source_t));
+    if (NULL == fs) {
+        munmap(data, (size_t) st.st_size);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    fs->data = (const uint8_t *) data;
+    fs->size = (uint64_t) st.st_size;
+    fs->compressed = codec_reader_init(&fs->codec, fs->data, fs->size) == 0;
+
+    *out = fs;
+    return AIRSPY_SUCCESS;
+}
+
+void file_source_close(file_source_t *fs)
+{
+    munmap((void *) fs->data, (size_t) fs->size);
+    free(fs->decoded);
+    free(fs);
+}
+
+/* Decodes whole blocks until length bytes are ready, keeping the rest for the next call */
+static const uint8_t *file_source_decode(file_source_t *fs, uint32_t length, int loop)
+{
+    uint32_t need = length / sizeof(uint16_t);
+    uint32_t count;
+    uint64_t first;
+    uint16_t *grown;
+    int rewound = 0;
+
+    if (need + fs->codec.block_samples > fs->decoded_alloc) {
+        grown = (uint16_t *) realloc(fs->decoded, (size_t) (need + fs->codec.block_samples) * sizeof(uint16_t));
+        if (NULL == grown) {
+            return NULL;
+        }
+        fs->decoded = grown;
+        fs->decoded_alloc = need + fs->codec.block_samples;
+    }
+
+    fs->decoded_fill -= fs->decoded_pos;
+    memmove(fs->decoded, fs->decoded + fs->decoded_pos, fs->decoded_fill * sizeof(uint16_t));
+    fs->decoded_pos = 0;
+
+    while (fs->decoded_fill < need) {
+        if (codec_reader_next(&fs->codec, fs->decoded + fs->decoded_fill, &count, &first) != 0) {
+            /* Same as uncompressed: the partial block at the end is skipped */
+            if (!loop || rewound) {
+                return NULL;
+            }
+            codec_reader_rewind(&fs->codec);
+            fs->decoded_fill = 0;
+            rewound = 1;
+            continue;
+        }
+        fs->decoded_fill += count;
+    }
+
+    fs->decoded_pos = need;
+    return (const uint8_t *) fs->decoded;
+}
+
+const uint8_t *file_source_next(file_source_t *fs, uint32_t length, int loop)
+{
+    const uint8_t *block;
+
+    if (fs->compressed) {
+        return file_source_decode(fs, length, loop);
+    }
+
+    if (length > fs->size) {
+        return NULL;
+    }
+
+    if (fs->size - fs->pos < length) {
+        if (!loop) {
+            return NULL;
+        }
+        fs->pos = 0;
+    }
+
+    block = fs->data + fs->pos;
+    fs->pos += length;
+    return block;
+}
+
+static uint64_t file_source_seek_decoded(file_source_t *fs, uint64_t sample)
+{
+    uint16_t *grown;
+    uint64_t first;
+    uint32_t count;
+
+    if (fs->codec.block_samples > fs->decoded_alloc) {
+        grown = (uint16_t *) realloc(fs->decoded, (size_t) fs->codec.block_samples * sizeof(uint16_t));
+        if (NULL == grown) {
+            return sample;
+        }
+        fs->decoded = grown;
+        fs->decoded_alloc = fs->codec.block_samples;
+    }
+
+    fs->decoded_fill = 0;
+    fs->decoded_pos = 0;
+    codec_reader_seek(&fs->codec, sample);
+    if (codec_reader_next(&fs->codec, fs->decoded, &count, &first) != 0) {
+        /* Past the end, where the next read ends the replay or loops */
+        return sample;
+    }
+
+    fs->decoded_fill = count;
+    if (sample > first) {
+        fs->decoded_pos = sample - first < count ? (uint32_t) (sample - first) : count;
+    }
+    return first + fs->decoded_pos;
+}
+
+uint64_t file_source_seek(file_source_t *fs, uint64_t sample, int packed)
+{
+    uint64_t pos;
+
+    sample -= sample % 8;
+    if (fs->compressed) {
+        return file_source_seek_decoded(fs, sample);
+    }
+
+    pos = packed ? sample / 8 * 12 : sample * sizeof(uint16_t);
+    fs->pos = pos < fs->size ? pos : fs->size;
+    return sample;
+}
+
+const uint8_t *file_source_map(file_source_t *fs, uint64_t *size)
+{
+    *size = fs->size;
+    return fs->data;
+}
+
+int file_source_compressed(file_source_t *fs)
+{
+    return fs->compressed;
+}
+
+/* Just enough of a look at the metadata we write ourselves to set up a replay, not a JSON parser */
+static const char *file_source_meta_value(const char *meta, const char *key)
+{
+    const char *p;
+
+    p = strstr(meta, key);
+    if (NULL == p) {
+        return NULL;
+    }
+    p = strchr(p + strlen(key), ':');
+    if (NULL == p) {
+        return NULL;
+    }
+    p++;
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+        p++;
+    }
+    return p;
+}
+
+int file_source_read_meta(const char *path, double *sample_rate, int *packed)
+{
+    char *meta_path;
+    char *meta;
+    const char *value;
+    size_t len;
+    FILE *f;
+    int result;
+
+    meta_path = recorder_meta_path(path);
+    if (NULL == meta_path) {
+        return -1;
+    }
+    f = fopen(meta_path, "rb");
+    free(meta_path);
+    if (NULL == f) {
+        return -1;
+    }
+
+    meta = (char *) malloc(FILE_SOURCE_META_MAX + 1);
+    if (NULL == meta) {
+        fclose(f);
+        return -1;
+    }
+    len = fread(meta, 1, FILE_SOURCE_META_MAX, f);
+    fclose(f);
+    meta[len] = '\0';
+
+    result = -1;
+    value = file_source_meta_value(meta, "\"core:datatype\"");
+    if (value != NULL && strncmp(value, "\"ru16_le\"", 9) == 0) {
+        value = file_source_meta_value(meta, "\"core:sample_rate\"");
+        if (value != NULL) {
+            *sample_rate = strtod(value, NULL);
+            value = file_source_meta_value(meta, "\"despairspy:packed\"");
+            *packed = value != NULL && strncmp(value, "true", 4) == 0;
+            result = 0;
+        }
+    }
+
+    free(meta);
+    return result;
+}
+
+#else
+
+int file_source_open(file_source_t **fs, const char *path)
+{
+    (void) fs;
+    (void) path;
+    return AIRSPY_ERROR_OTHER;
+}
+
+void file_source_close(file_source_t *fs)
+{
+    (void) fs;
+}
+
+const uint8_t *file_source_next(file_source_t *fs, uint32_t length, int loop)
+{
+    (void) fs;
+    (void) length;
+    (void) loop;
+    return NULL;
+}
+
+const uint8_t *file_source_map(file_source_t *fs, uint64_t *size)
+{
+    (void) fs;
+    *size = 0;
+    return NULL;
+}
+
+uint64_t file_source_seek(file_source_t *fs, uint64_t sample, int packed)
+{
+    (void) fs;
+    (void) packed;
+    return sample;
+}
+
+int file_source_compressed(file_source_t *fs)
+{
+    (void) fs;
+    return 0;
+}
+
+int file_source_read_meta(const char *path, double *sample_rate, int *packed)
+{
+    (void) path;
+    (void) sample_rate;
+    (void) packed;
+    return -1;
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef FILE_SOURCE_H
+#define FILE_SOURCE_H
+
+#include <stdint.h>
+
+typedef struct file_source file_source_t;
+
+/*
+ * Maps a raw capture read-only. Returns an AIRSPY_ERROR code. A compressed
+ * capture (see codec.h) is recognized by its header and decoded block by
+ * block as it is read, to unpacked 16-bit samples whatever it was recorded
+ * from.
+ */
+int file_source_open(file_source_t **fs, const char *path);
+void file_source_close(file_source_t *fs);
+
+/*
+ * Returns a pointer to the next length bytes of the mapping, or NULL once
+ * fewer than length bytes are left. With loop set, playback wraps to the
+ * start instead; the partial block at the end is skipped either way.
+ */
+const uint8_t *file_source_next(file_source_t *fs, uint32_t length, int loop);
+
+/*
+ * Moves to real sample sample of the capture, rounded down to a group of
+ * eight, and returns where it ended up. packed is the replay's format;
+ * compressed captures are decoded from the block holding sample.
+ */
+uint64_t file_source_seek(file_source_t *fs, uint64_t sample, int packed);
+
+/* The whole mapping, for callers that split it up themselves */
+const uint8_t *file_source_map(file_source_t *fs, uint64_t *size);
+
+/* Nonzero for a compressed capture, which file_source_map() returns encoded */
+int file_source_compressed(file_source_t *fs);
+
+/*
+ * Reads core:sample_rate, core:datatype and despairspy:packed from the SigMF
+ * metadata next to path. Returns 0 if a raw (ru16_le) capture was described.
+ */
+int file_source_read_meta(const char *path, double *sample_rate, int *packed);
+
+#endif // FILE_SOURCE_H
@@ -52,10 +52,14 @@ THE SOFTWARE.
 
 int iqconverter_int16_init(iqconverter_int16_t *cnv, const int16_t *hb_kernel, int len)
 {
-    int ret = 0;
+    int ret = -1;
     int i;
     size_t buffer_size;
 
+    cnv->fir_kernel = NULL;
+    cnv->fir_queue = NULL;
+    cnv->delay_line = NULL;
+
     cnv->len = len / 2 + 1;
 
     buffer_size = cnv->len * sizeof(int32_t);
@@ -79,6 +83,8 @@ int iqconverter_int16_init(iqconverter_int16_t *cnv, const int16_t *hb_kernel, i
         cnv->fir_kernel[i] = hb_kernel[i * 2];
     }
 
+    ret = 0;
+
 done:
     if (0 != ret) {
         if (NULL != cnv->fir_kernel) {
@@ -109,8 +115,14 @@ void iqconverter_int16_reset(iqconverter_int16_t *cnv)
     cnv->old_x = 0;
     cnv->old_y = 0;
     cnv->old_e = 0;
-    memset(cnv->delay_line, 0, cnv->len * sizeof(int16_t) / 4);
-    memset(cnv->fir_queue, 0, cnv->len * sizeof(int16_t) * SIZE_FACTOR);
+    memset(cnv->delay_line, 0, (cnv->len / 2) * sizeof(int16_t));
+    memset(cnv->fir_queue, 0, cnv->len * sizeof(int32_t) * SIZE_FACTOR);
+}
+
+void iqconverter_int16_prime(iqconverter_int16_t *cnv, uint16_t *samples, int len)
+{
+    iqconverter_int16_reset(cnv);
+    iqconverter_int16_process(cnv, samples, len);
 }
 
 static void fir_interleaved(iqconverter_int16_t *cnv, int16_t *samples, int len)
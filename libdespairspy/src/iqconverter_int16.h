@@ -42,4 +42,14 @@ void iqconverter_int16_free(iqconverter_int16_t *cnv);
 void iqconverter_int16_reset(iqconverter_int16_t *cnv);
 void iqconverter_int16_process(iqconverter_int16_t *cnv, uint16_t *samples, int len);
 
+/*
+ * Rebuilds the filter state for converting from some point of a stream
+ * onwards without the stream before it: resets cnv and runs samples, the
+ * input just ahead of that point, through it. samples are overwritten and
+ * the output discarded. len must be a multiple of 4 to keep the fs/4
+ * translation in phase. The FIR and delay line are exact after 48 samples;
+ * the DC blocker only converges (see CONVERT_DEFAULT_PRIME).
+ */
+void iqconverter_int16_prime(iqconverter_int16_t *cnv, uint16_t *samples, int len);
+
 #endif // IQCONVERTER_INT16_H
@@ -0,0 +1,157 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "loan.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+
+struct loan_pool
+{
+    size_t size;
+    uint32_t count;
+    uint32_t outstanding;
+    struct airspy_buffer *buffers;
+    struct airspy_buffer *free_list;
+    pthread_mutex_t lock;
+};
+
+int loan_pool_create(loan_pool_t **pool_out, uint32_t count, size_t size)
+{
+    loan_pool_t *pool;
+    uint32_t i;
+
+    if (NULL == pool_out || 0 == count || 0 == size) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    pool = (loan_pool_t *) calloc(1, sizeof(loan_pool_t));
+    if (NULL == pool) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pool->size = size;
+    pool->count = count;
+
+    pool->buffers = (struct airspy_buffer *) calloc(count, sizeof(struct airspy_buffer));
+    if (NULL == pool->buffers) {
+        loan_pool_destroy(pool);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    for (i = 0; i < count; i++) {
+        pool->buffers[i].data = malloc(size);
+        if (NULL == pool->buffers[i].data) {
+            loan_pool_destroy(pool);
+            return AIRSPY_ERROR_NO_MEM;
+        }
+        pool->buffers[i].next = pool->free_list;
+        pool->free_list = &pool->buffers[i];
+    }
+
+    *pool_out = pool;
+
+    return AIRSPY_SUCCESS;
+}
+
+void loan_pool_destroy(loan_pool_t *pool)
+{
+    uint32_t i;
+
+    if (NULL == pool) {
+        return;
+    }
+
+    if (pool->buffers != NULL) {
+        for (i = 0; i < pool->count; i++) {
+            free(pool->buffers[i].data);
+        }
+        free(pool->buffers);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
+
+size_t loan_pool_size(const loan_pool_t *pool)
+{
+    return pool->size;
+}
+
+uint32_t loan_pool_outstanding(loan_pool_t *pool)
+{
+    uint32_t outstanding;
+
+    pthread_mutex_lock(&pool->lock);
+    outstanding = pool->outstanding;
+    pthread_mutex_unlock(&pool->lock);
+
+    return outstanding;
+}
+
+struct airspy_buffer *loan_pool_take(loan_pool_t *pool, void **storage)
+{
+    struct airspy_buffer *buffer;
+    void *spare;
+
+    pthread_mutex_lock(&pool->lock);
+    buffer = pool->free_list;
+    if (buffer != NULL) {
+        pool->free_list = buffer->next;
+        buffer->next = NULL;
+        buffer->loaned = 1;
+        pool->outstanding++;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    if (NULL == buffer || NULL == storage) {
+        return buffer;
+    }
+
+    spare = buffer->data;
+    buffer->data = *storage;
+    *storage = spare;
+
+    return buffer;
+}
+
+int loan_pool_release(loan_pool_t *pool, struct airspy_buffer *buffer)
+{
+    if (buffer < pool->buffers || buffer >= pool->buffers + pool->count) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    if (!buffer->loaned) {
+        pthread_mutex_unlock(&pool->lock);
+        return -1;
+    }
+    buffer->loaned = 0;
+    buffer->next = pool->free_list;
+    pool->free_list = buffer;
+    pool->outstanding--;
+    pthread_mutex_unlock(&pool->lock);
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef LOAN_H
+#define LOAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "airspy.h"
+
+/*
+ * Buffers handed to the application with a block, and kept by it until
+ * airspy_release_buffer(). Every buffer always owns exactly one allocation
+ * of the pool's size: a free buffer holds a spare, a loaned one the block.
+ */
+struct airspy_buffer
+{
+    void *data;
+    struct airspy_buffer *next;
+    int loaned;
+};
+
+typedef struct loan_pool loan_pool_t;
+
+int loan_pool_create(loan_pool_t **pool, uint32_t count, size_t size);
+/* Frees every buffer, including those still on loan */
+void loan_pool_destroy(loan_pool_t *pool);
+size_t loan_pool_size(const loan_pool_t *pool);
+uint32_t loan_pool_outstanding(loan_pool_t *pool);
+
+/*
+ * Loans out a free buffer, or NULL when every buffer is on loan. With
+ * storage NULL the caller fills the buffer's own allocation. Otherwise
+ * *storage, an allocation of the pool's size already holding the block,
+ * is handed over instead and the buffer's spare is left in its place.
+ */
+struct airspy_buffer *loan_pool_take(loan_pool_t *pool, void **storage);
+
+/* May be called from any thread. Returns nonzero for a buffer that isn't on loan from this pool */
+int loan_pool_release(loan_pool_t *pool, struct airspy_buffer *buffer);
+
+#endif // LOAN_H
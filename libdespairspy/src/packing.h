@@ -0,0 +1,60 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef PACKING_H
+#define PACKING_H
+
+#include <stdint.h>
+
+/* The 12-bit wire format: eight samples in three little-endian words, most significant first */
+
+static inline void unpack_samples(const uint32_t *input, uint16_t *output, int length)
+{
+    int i, j;
+
+    for (i = 0, j = 0; j < length; i += 3, j += 8)
+    {
+        output[j + 0] = (input[i] >> 20) & 0xfff;
+        output[j + 1] = (input[i] >> 8) & 0xfff;
+        output[j + 2] = ((input[i] & 0xff) << 4) | ((input[i + 1] >> 28) & 0xf);
+        output[j + 3] = ((input[i + 1] & 0xfff0000) >> 16);
+        output[j + 4] = ((input[i + 1] & 0xfff0) >> 4);
+        output[j + 5] = ((input[i + 1] & 0xf) << 8) | ((input[i + 2] & 0xff000000) >> 24);
+        output[j + 6] = ((input[i + 2] >> 12) & 0xfff);
+        output[j + 7] = ((input[i + 2] & 0xfff));
+    }
+}
+
+static inline void pack_samples(const uint16_t *input, uint32_t *output, int length)
+{
+    int i, j;
+
+    for (i = 0, j = 0; i + 8 <= length; i += 8, j += 3)
+    {
+        output[j + 0] = ((uint32_t)input[i + 0] << 20) | ((uint32_t)input[i + 1] << 8) | (input[i + 2] >> 4);
+        output[j + 1] = ((uint32_t)(input[i + 2] & 0xf) << 28) | ((uint32_t)input[i + 3] << 16) |
+            ((uint32_t)input[i + 4] << 4) | (input[i + 5] >> 8);
+        output[j + 2] = ((uint32_t)(input[i + 5] & 0xff) << 24) | ((uint32_t)input[i + 6] << 12) | input[i + 7];
+    }
+}
+
+#endif // PACKING_H
@@ -0,0 +1,988 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "pyramid.h"
+#include "recorder.h"
+#include "fft_float.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* |x|^2 of a full scale int16 sample, 0 dBFS */
+#define PYRAMID_FULL_SCALE (32768.0 * 32768.0)
+
+/* The bucket being filled at one level, and the entries waiting to be written */
+typedef struct {
+    uint64_t bucket;
+    double sum;
+    float min;
+    float max;
+    uint64_t samples;
+    uint32_t spectra;
+    float *bin_min;
+    float *bin_max;
+    double *bin_sum;
+    uint8_t *chunk;
+    uint32_t chunk_count;
+    uint64_t chunk_first;
+} pyramid_level_t;
+
+typedef struct {
+    int16_t *iq;
+    uint32_t count;
+    uint32_t capacity;
+    uint64_t sample_index;
+} pyramid_block_t;
+
+struct pyramid
+{
+    int fd;
+    int error;
+    uint32_t bucket_samples;
+    uint32_t fft_size;
+    uint32_t entry_bytes;
+    uint32_t chunk_entries;
+    double sample_rate;
+    uint64_t offset;
+
+    /* Summary thread only */
+    int started;
+    uint64_t first_sample_index;
+    uint64_t next_index;
+    pyramid_level_t levels[PYRAMID_MAX_LEVELS];
+    pyramid_table_entry_t *table;
+    uint64_t table_count;
+    uint64_t table_alloc;
+    uint8_t *entry;
+    fft_float_t fft;
+    float *window;
+    float power_scale;
+    float *frame;
+    uint32_t frame_fill;
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int exit;
+    pyramid_block_t queue[PYRAMID_QUEUE_DEPTH];
+    uint32_t queue_head;
+    uint32_t queue_count;
+    uint64_t dropped;
+};
+
+struct airspy_power_pyramid
+{
+    const uint8_t *data;
+    uint64_t size;
+    const pyramid_header_t *header;
+    uint32_t levels;
+    uint64_t entries[PYRAMID_MAX_LEVELS];
+    /* Chunks per level, in entry order */
+    pyramid_table_entry_t *chunks[PYRAMID_MAX_LEVELS];
+    uint64_t chunk_count[PYRAMID_MAX_LEVELS];
+};
+
+#ifndef _WIN32
+
+static int pyramid_pwrite(int fd, const uint8_t *data, size_t length, uint64_t offset)
+{
+    ssize_t written;
+
+    while (length > 0) {
+        written = pwrite(fd, data, length, (off_t) offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        data += written;
+        length -= (size_t) written;
+        offset += (uint64_t) written;
+    }
+
+    return 0;
+}
+
+static void pyramid_reset(pyramid_t *pyramid, pyramid_level_t *level)
+{
+    uint32_t i;
+
+    level->sum = 0.0;
+    level->min = INFINITY;
+    level->max = 0.0f;
+    level->samples = 0;
+    level->spectra = 0;
+    for (i = 0; i < pyramid->fft_size; i++) {
+        level->bin_min[i] = INFINITY;
+        level->bin_max[i] = 0.0f;
+        level->bin_sum[i] = 0.0;
+    }
+}
+
+static void pyramid_flush_chunk(pyramid_t *pyramid, uint32_t n)
+{
+    pyramid_level_t *level = &pyramid->levels[n];
+    pyramid_chunk_t chunk;
+    pyramid_table_entry_t *table;
+    int error;
+
+    if (0 == level->chunk_count) {
+        return;
+    }
+
+    if (pyramid->table_count == pyramid->table_alloc) {
+        pyramid->table_alloc = pyramid->table_alloc != 0 ? pyramid->table_alloc * 2 : 64;
+        table = (pyramid_table_entry_t *) realloc(pyramid->table, pyramid->table_alloc * sizeof(pyramid_table_entry_t));
+        if (NULL == table) {
+            pyramid->error = ENOMEM;
+            level->chunk_first += level->chunk_count;
+            level->chunk_count = 0;
+            return;
+        }
+        pyramid->table = table;
+    }
+
+    memset(&chunk, 0, sizeof(chunk));
+    chunk.magic = PYRAMID_CHUNK_MAGIC;
+    chunk.level = n;
+    chunk.first = level->chunk_first;
+    chunk.count = level->chunk_count;
+
+    error = pyramid_pwrite(pyramid->fd, (const uint8_t *) &chunk, sizeof(chunk), pyramid->offset);
+    if (0 == error) {
+        error = pyramid_pwrite(pyramid->fd, level->chunk, (size_t) level->chunk_count * pyramid->entry_bytes,
+            pyramid->offset + sizeof(chunk));
+    }
+    if (error != 0) {
+        if (0 == pyramid->error) {
+            pyramid->error = error;
+        }
+    } else {
+        table = &pyramid->table[pyramid->table_count++];
+        table->offset = pyramid->offset;
+        table->first = chunk.first;
+        table->level = n;
+        table->count = chunk.count;
+        pyramid->offset += sizeof(chunk) + (uint64_t) level->chunk_count * pyramid->entry_bytes;
+    }
+
+    level->chunk_first += level->chunk_count;
+    level->chunk_count = 0;
+}
+
+static float pyramid_db(double power)
+{
+    return (float) (10.0 * log10(power + 1e-20));
+}
+
+static void pyramid_advance(pyramid_t *pyramid, uint32_t n, uint64_t bucket);
+
+/* Writes out the bucket being filled at level n and merges it into the one above */
+static void pyramid_emit(pyramid_t *pyramid, uint32_t n)
+{
+    pyramid_level_t *level = &pyramid->levels[n];
+    pyramid_level_t *parent;
+    pyramid_entry_t *entry = (pyramid_entry_t *) pyramid->entry;
+    float *bins = (float *) (pyramid->entry + sizeof(pyramid_entry_t));
+    uint32_t fft_size = pyramid->fft_size;
+    uint32_t i;
+
+    if (level->samples > 0) {
+        entry->min_db = pyramid_db(level->min);
+        entry->max_db = pyramid_db(level->max);
+        entry->mean_db = pyramid_db(level->sum / (double) level->samples);
+    } else {
+        entry->min_db = NAN;
+        entry->max_db = NAN;
+        entry->mean_db = NAN;
+    }
+    entry->samples = level->samples > UINT32_MAX ? UINT32_MAX : (uint32_t) level->samples;
+
+    for (i = 0; i < fft_size; i++) {
+        if (level->spectra > 0) {
+            bins[i] = pyramid_db(level->bin_min[i]);
+            bins[fft_size + i] = pyramid_db(level->bin_max[i]);
+            bins[2 * fft_size + i] = pyramid_db(level->bin_sum[i] / level->spectra);
+        } else {
+            bins[i] = NAN;
+            bins[fft_size + i] = NAN;
+            bins[2 * fft_size + i] = NAN;
+        }
+    }
+
+    memcpy(level->chunk + (size_t) level->chunk_count * pyramid->entry_bytes, pyramid->entry, pyramid->entry_bytes);
+    level->chunk_count++;
+    if (level->chunk_count == pyramid->chunk_entries) {
+        pyramid_flush_chunk(pyramid, n);
+    }
+
+    if (n + 1 < PYRAMID_MAX_LEVELS) {
+        pyramid_advance(pyramid, n + 1, level->bucket / PYRAMID_FACTOR);
+        parent = &pyramid->levels[n + 1];
+        if (level->samples > 0) {
+            parent->min = level->min < parent->min ? level->min : parent->min;
+            parent->max = level->max > parent->max ? level->max : parent->max;
+            parent->sum += level->sum;
+            parent->samples += level->samples;
+        }
+        if (level->spectra > 0) {
+            for (i = 0; i < fft_size; i++) {
+                parent->bin_min[i] = level->bin_min[i] < parent->bin_min[i] ? level->bin_min[i] : parent->bin_min[i];
+                parent->bin_max[i] = level->bin_max[i] > parent->bin_max[i] ? level->bin_max[i] : parent->bin_max[i];
+                parent->bin_sum[i] += level->bin_sum[i];
+            }
+            parent->spectra += level->spectra;
+        }
+    }
+
+    pyramid_reset(pyramid, level);
+}
+
+/* Moves level n on to bucket, with an empty entry for every bucket skipped over */
+static void pyramid_advance(pyramid_t *pyramid, uint32_t n, uint64_t bucket)
+{
+    pyramid_level_t *level = &pyramid->levels[n];
+
+    while (level->bucket < bucket) {
+        pyramid_emit(pyramid, n);
+        level->bucket++;
+    }
+}
+
+static void pyramid_spectrum(pyramid_t *pyramid)
+{
+    pyramid_level_t *level = &pyramid->levels[0];
+    float *spectrum = pyramid->frame;
+    uint32_t n = pyramid->fft_size;
+    uint32_t i;
+    uint32_t k;
+    float re;
+    float im;
+    float power;
+
+    for (i = 0; i < n; i++) {
+        spectrum[2 * i] *= pyramid->window[i];
+        spectrum[2 * i + 1] *= pyramid->window[i];
+    }
+    fft_float_forward(&pyramid->fft, spectrum);
+
+    /* DC in the middle */
+    for (i = 0; i < n; i++) {
+        k = (i + n / 2) & (n - 1);
+        re = spectrum[2 * k];
+        im = spectrum[2 * k + 1];
+        power = (re * re + im * im) * pyramid->power_scale;
+        level->bin_min[i] = power < level->bin_min[i] ? power : level->bin_min[i];
+        level->bin_max[i] = power > level->bin_max[i] ? power : level->bin_max[i];
+        level->bin_sum[i] += power;
+    }
+    level->spectra++;
+}
+
+/* Frames start on multiples of fft_size from bucket 0, so none spans two buckets */
+static void pyramid_frames(pyramid_t *pyramid, const int16_t *iq, uint32_t count, uint64_t position)
+{
+    uint32_t n = pyramid->fft_size;
+    uint32_t used = 0;
+    uint32_t take;
+    uint32_t i;
+    float *frame;
+
+    if (0 == pyramid->frame_fill && position % n != 0) {
+        used = n - (uint32_t) (position % n);
+    }
+
+    while (used < count) {
+        take = n - pyramid->frame_fill;
+        if (take > count - used) {
+            take = count - used;
+        }
+        frame = pyramid->frame + 2 * pyramid->frame_fill;
+        for (i = 0; i < 2 * take; i++) {
+            frame[i] = iq[2 * used + i] * (1.0f / 32768.0f);
+        }
+        pyramid->frame_fill += take;
+        used += take;
+
+        if (pyramid->frame_fill == n) {
+            pyramid_spectrum(pyramid);
+            pyramid->frame_fill = 0;
+        }
+    }
+}
+
+static void pyramid_write_header(pyramid_t *pyramid)
+{
+    pyramid_header_t header;
+    int error;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = PYRAMID_MAGIC;
+    header.version = PYRAMID_VERSION;
+    header.bucket_samples = pyramid->bucket_samples;
+    header.factor = PYRAMID_FACTOR;
+    header.fft_size = pyramid->fft_size;
+    header.entry_bytes = pyramid->entry_bytes;
+    header.sample_rate = pyramid->sample_rate;
+    header.first_sample_index = pyramid->first_sample_index;
+
+    error = pyramid_pwrite(pyramid->fd, (const uint8_t *) &header, sizeof(header), 0);
+    if (error != 0 && 0 == pyramid->error) {
+        pyramid->error = error;
+    }
+}
+
+static void pyramid_process(pyramid_t *pyramid, const int16_t *iq, uint32_t count, uint64_t sample_index)
+{
+    pyramid_level_t *level = &pyramid->levels[0];
+    uint64_t position;
+    uint32_t used;
+    uint32_t take;
+    uint32_t i;
+    uint32_t power;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+
+    if (!pyramid->started) {
+        pyramid->started = 1;
+        pyramid->first_sample_index = sample_index;
+        pyramid->next_index = sample_index;
+        pyramid_write_header(pyramid);
+    }
+
+    /* Bucket indices only grow, e.g. a replay seeking back is left out */
+    if (sample_index < pyramid->next_index) {
+        return;
+    }
+    if (sample_index != pyramid->next_index) {
+        pyramid->frame_fill = 0;
+    }
+    pyramid->next_index = sample_index + count;
+
+    used = 0;
+    while (used < count) {
+        position = sample_index + used - pyramid->first_sample_index;
+        pyramid_advance(pyramid, 0, position / pyramid->bucket_samples);
+
+        take = pyramid->bucket_samples - (uint32_t) (position % pyramid->bucket_samples);
+        if (take > count - used) {
+            take = count - used;
+        }
+
+        min = UINT32_MAX;
+        max = 0;
+        sum = 0;
+        for (i = 0; i < take; i++) {
+            int32_t re = iq[2 * (used + i)];
+            int32_t im = iq[2 * (used + i) + 1];
+
+            power = (uint32_t) (re * re) + (uint32_t) (im * im);
+            min = power < min ? power : min;
+            max = power > max ? power : max;
+            sum += power;
+        }
+        level->min = fminf(level->min, (float) (min / PYRAMID_FULL_SCALE));
+        level->max = fmaxf(level->max, (float) (max / PYRAMID_FULL_SCALE));
+        level->sum += sum / PYRAMID_FULL_SCALE;
+        level->samples += take;
+
+        if (pyramid->fft_size != 0) {
+            pyramid_frames(pyramid, iq + 2 * used, take, position);
+        }
+        used += take;
+    }
+}
+
+static void *pyramid_thread(void *arg)
+{
+    pyramid_t *pyramid = (pyramid_t *) arg;
+    pyramid_block_t *block;
+
+    pthread_mutex_lock(&pyramid->lock);
+    for (;;) {
+        while (0 == pyramid->queue_count && !pyramid->exit) {
+            pthread_cond_wait(&pyramid->cond, &pyramid->lock);
+        }
+        if (0 == pyramid->queue_count) {
+            break;
+        }
+
+        /* The block stays queued while it is summarized, so pyramid_write() doesn't reuse it */
+        block = &pyramid->queue[pyramid->queue_head];
+        pthread_mutex_unlock(&pyramid->lock);
+
+        pyramid_process(pyramid, block->iq, block->count, block->sample_index);
+
+        pthread_mutex_lock(&pyramid->lock);
+        pyramid->queue_head = (pyramid->queue_head + 1) % PYRAMID_QUEUE_DEPTH;
+        pyramid->queue_count--;
+    }
+    pthread_mutex_unlock(&pyramid->lock);
+
+    return NULL;
+}
+
+static void pyramid_release(pyramid_t *pyramid)
+{
+    uint32_t i;
+
+    for (i = 0; i < PYRAMID_MAX_LEVELS; i++) {
+        free(pyramid->levels[i].bin_min);
+        free(pyramid->levels[i].bin_max);
+        free(pyramid->levels[i].bin_sum);
+        free(pyramid->levels[i].chunk);
+    }
+    for (i = 0; i < PYRAMID_QUEUE_DEPTH; i++) {
+        free(pyramid->queue[i].iq);
+    }
+    if (pyramid->fft_size != 0) {
+        fft_float_free(&pyramid->fft);
+    }
+    if (pyramid->fd >= 0) {
+        close(pyramid->fd);
+    }
+    free(pyramid->window);
+    free(pyramid->frame);
+    free(pyramid->entry);
+    free(pyramid->table);
+    free(pyramid);
+}
+
+static int pyramid_alloc(pyramid_t *pyramid)
+{
+    pyramid_level_t *level;
+    double window_sum;
+    uint32_t i;
+
+    pyramid->entry = (uint8_t *) malloc(pyramid->entry_bytes);
+    if (NULL == pyramid->entry) {
+        return -1;
+    }
+
+    for (i = 0; i < PYRAMID_MAX_LEVELS; i++) {
+        level = &pyramid->levels[i];
+        level->chunk = (uint8_t *) malloc((size_t) pyramid->chunk_entries * pyramid->entry_bytes);
+        if (pyramid->fft_size != 0) {
+            level->bin_min = (float *) malloc(pyramid->fft_size * sizeof(float));
+            level->bin_max = (float *) malloc(pyramid->fft_size * sizeof(float));
+            level->bin_sum = (double *) malloc(pyramid->fft_size * sizeof(double));
+            if (NULL == level->bin_min || NULL == level->bin_max || NULL == level->bin_sum) {
+                return -1;
+            }
+        }
+        if (NULL == level->chunk) {
+            return -1;
+        }
+        pyramid_reset(pyramid, level);
+    }
+
+    if (0 == pyramid->fft_size) {
+        return 0;
+    }
+
+    if (fft_float_init(&pyramid->fft, (int) pyramid->fft_size) != 0) {
+        pyramid->fft_size = 0;
+        return -1;
+    }
+    pyramid->window = (float *) malloc(pyramid->fft_size * sizeof(float));
+    pyramid->frame = (float *) malloc(2 * pyramid->fft_size * sizeof(float));
+    if (NULL == pyramid->window || NULL == pyramid->frame) {
+        return -1;
+    }
+
+    /* Hann window, scaled so that a full scale complex tone reads 0 dBFS */
+    window_sum = 0.0;
+    for (i = 0; i < pyramid->fft_size; i++) {
+        pyramid->window[i] = (float) (0.5 - 0.5 * cos(2.0 * M_PI * i / pyramid->fft_size));
+        window_sum += pyramid->window[i];
+    }
+    pyramid->power_scale = (float) (1.0 / (window_sum * window_sum));
+
+    return 0;
+}
+
+int pyramid_open(pyramid_t **out, const char *capture_path, uint32_t bucket_samples, uint32_t fft_size,
+    double sample_rate)
+{
+    pyramid_t *pyramid;
+    char *path;
+
+    if (0 == bucket_samples || (fft_size != 0 && (fft_size < FFT_FLOAT_MIN_SIZE || fft_size > PYRAMID_MAX_FFT_SIZE ||
+            (fft_size & (fft_size - 1)) != 0 || bucket_samples % fft_size != 0))) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    pyramid = (pyramid_t *) calloc(1, sizeof(pyramid_t));
+    if (NULL == pyramid) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+    pyramid->fd = -1;
+    pyramid->bucket_samples = bucket_samples;
+    pyramid->fft_size = fft_size;
+    pyramid->sample_rate = sample_rate;
+    pyramid->entry_bytes = (uint32_t) (sizeof(pyramid_entry_t) + 3 * fft_size * sizeof(float));
+    pyramid->chunk_entries = PYRAMID_CHUNK_BYTES / pyramid->entry_bytes;
+    if (0 == pyramid->chunk_entries) {
+        pyramid->chunk_entries = 1;
+    }
+
+    if (pyramid_alloc(pyramid) != 0) {
+        pyramid_release(pyramid);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    path = recorder_sidecar_path(capture_path, PYRAMID_SUFFIX);
+    if (NULL == path) {
+        pyramid_release(pyramid);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+    pyramid->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    free(path);
+    if (pyramid->fd < 0) {
+        pyramid_release(pyramid);
+        return AIRSPY_ERROR_OTHER;
+    }
+    /* Written again with the first block's sample index */
+    pyramid_write_header(pyramid);
+    pyramid->offset = sizeof(pyramid_header_t);
+
+    pthread_mutex_init(&pyramid->lock, NULL);
+    pthread_cond_init(&pyramid->cond, NULL);
+
+    if (pthread_create(&pyramid->thread, NULL, pyramid_thread, pyramid) != 0) {
+        pthread_cond_destroy(&pyramid->cond);
+        pthread_mutex_destroy(&pyramid->lock);
+        pyramid_release(pyramid);
+        return AIRSPY_ERROR_THREAD;
+    }
+
+    *out = pyramid;
+    return AIRSPY_SUCCESS;
+}
+
+void pyramid_write(pyramid_t *pyramid, const int16_t *iq, uint32_t count, uint64_t sample_index)
+{
+    pyramid_block_t *block;
+    int16_t *grown;
+
+    pthread_mutex_lock(&pyramid->lock);
+    if (PYRAMID_QUEUE_DEPTH == pyramid->queue_count) {
+        pyramid->dropped++;
+        pthread_mutex_unlock(&pyramid->lock);
+        return;
+    }
+    /* Only this thread touches the slot past the queued ones */
+    block = &pyramid->queue[(pyramid->queue_head + pyramid->queue_count) % PYRAMID_QUEUE_DEPTH];
+    pthread_mutex_unlock(&pyramid->lock);
+
+    if (block->capacity < count) {
+        grown = (int16_t *) realloc(block->iq, (size_t) count * 2 * sizeof(int16_t));
+        if (NULL == grown) {
+            pthread_mutex_lock(&pyramid->lock);
+            pyramid->dropped++;
+            pthread_mutex_unlock(&pyramid->lock);
+            return;
+        }
+        block->iq = grown;
+        block->capacity = count;
+    }
+    memcpy(block->iq, iq, (size_t) count * 2 * sizeof(int16_t));
+    block->count = count;
+    block->sample_index = sample_index;
+
+    pthread_mutex_lock(&pyramid->lock);
+    pyramid->queue_count++;
+    pthread_cond_signal(&pyramid->cond);
+    pthread_mutex_unlock(&pyramid->lock);
+}
+
+uint64_t pyramid_dropped(pyramid_t *pyramid)
+{
+    uint64_t dropped;
+
+    pthread_mutex_lock(&pyramid->lock);
+    dropped = pyramid->dropped;
+    pthread_mutex_unlock(&pyramid->lock);
+
+    return dropped;
+}
+
+int pyramid_close(pyramid_t *pyramid)
+{
+    pyramid_footer_t footer;
+    uint32_t levels;
+    uint32_t i;
+    int error;
+
+    pthread_mutex_lock(&pyramid->lock);
+    pyramid->exit = 1;
+    pthread_cond_signal(&pyramid->cond);
+    pthread_mutex_unlock(&pyramid->lock);
+    pthread_join(pyramid->thread, NULL);
+
+    memset(&footer, 0, sizeof(footer));
+    footer.magic = PYRAMID_FOOTER_MAGIC;
+
+    /* Up to the first level that fits everything in one bucket */
+    levels = 0;
+    if (pyramid->started) {
+        for (i = 0; i < PYRAMID_MAX_LEVELS; i++) {
+            pyramid_emit(pyramid, i);
+            footer.entries[i] = pyramid->levels[i].bucket + 1;
+            levels = i + 1;
+            if (0 == pyramid->levels[i].bucket) {
+                break;
+            }
+        }
+        for (i = 0; i < levels; i++) {
+            pyramid_flush_chunk(pyramid, i);
+        }
+    }
+    footer.levels = levels;
+    footer.chunk_count = pyramid->table_count;
+
+    error = pyramid->error;
+    if (0 == error && pyramid->table_count > 0) {
+        error = pyramid_pwrite(pyramid->fd, (const uint8_t *) pyramid->table,
+            pyramid->table_count * sizeof(pyramid_table_entry_t), pyramid->offset);
+        pyramid->offset += pyramid->table_count * sizeof(pyramid_table_entry_t);
+    }
+    if (0 == error) {
+        error = pyramid_pwrite(pyramid->fd, (const uint8_t *) &footer, sizeof(footer), pyramid->offset);
+    }
+
+    pthread_cond_destroy(&pyramid->cond);
+    pthread_mutex_destroy(&pyramid->lock);
+    pyramid_release(pyramid);
+
+    return error != 0 ? AIRSPY_ERROR_OTHER : AIRSPY_SUCCESS;
+}
+
+static int pyramid_reader_chunk_ok(pyramid_reader_t *reader, const pyramid_table_entry_t *entry)
+{
+    uint64_t bytes = sizeof(pyramid_chunk_t) + (uint64_t) entry->count * reader->header->entry_bytes;
+
+    return entry->level < PYRAMID_MAX_LEVELS && entry->offset >= sizeof(pyramid_header_t) &&
+        entry->offset <= reader->size && bytes <= reader->size - entry->offset;
+}
+
+/* Without a footer: the chunks that made it to disk, up to the first one that didn't */
+static uint64_t pyramid_reader_walk(pyramid_reader_t *reader, pyramid_table_entry_t **out)
+{
+    pyramid_chunk_t chunk;
+    pyramid_table_entry_t entry;
+    pyramid_table_entry_t *table = NULL;
+    pyramid_table_entry_t *grown;
+    uint64_t count = 0;
+    uint64_t alloc = 0;
+    uint64_t offset = sizeof(pyramid_header_t);
+
+    while (reader->size - offset >= sizeof(chunk)) {
+        memcpy(&chunk, reader->data + offset, sizeof(chunk));
+        entry.offset = offset;
+        entry.first = chunk.first;
+        entry.level = chunk.level;
+        entry.count = chunk.count;
+        if (chunk.magic != PYRAMID_CHUNK_MAGIC || !pyramid_reader_chunk_ok(reader, &entry)) {
+            break;
+        }
+
+        if (count == alloc) {
+            alloc = alloc != 0 ? alloc * 2 : 64;
+            grown = (pyramid_table_entry_t *) realloc(table, alloc * sizeof(pyramid_table_entry_t));
+            if (NULL == grown) {
+                break;
+            }
+            table = grown;
+        }
+        table[count++] = entry;
+        offset += sizeof(chunk) + (uint64_t) chunk.count * reader->header->entry_bytes;
+    }
+
+    *out = table;
+    return count;
+}
+
+/* Sorts the chunks by level; within one they are already in entry order */
+static int pyramid_reader_levels(pyramid_reader_t *reader, const pyramid_table_entry_t *table, uint64_t count)
+{
+    uint64_t filled[PYRAMID_MAX_LEVELS];
+    uint64_t entries[PYRAMID_MAX_LEVELS];
+    uint64_t i;
+    uint32_t level;
+
+    memset(filled, 0, sizeof(filled));
+    memset(entries, 0, sizeof(entries));
+    for (i = 0; i < count; i++) {
+        reader->chunk_count[table[i].level]++;
+    }
+    for (level = 0; level < PYRAMID_MAX_LEVELS; level++) {
+        if (reader->chunk_count[level] > 0) {
+            reader->chunks[level] = (pyramid_table_entry_t *) malloc(reader->chunk_count[level] * sizeof(pyramid_table_entry_t));
+            if (NULL == reader->chunks[level]) {
+                return -1;
+            }
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        level = table[i].level;
+        /* A level ends at its first gap */
+        if (table[i].first != entries[level]) {
+            continue;
+        }
+        reader->chunks[level][filled[level]++] = table[i];
+        entries[level] += table[i].count;
+    }
+
+    reader->levels = 0;
+    for (level = 0; level < PYRAMID_MAX_LEVELS; level++) {
+        reader->chunk_count[level] = filled[level];
+        if (entries[level] < reader->entries[level] || 0 == reader->entries[level]) {
+            reader->entries[level] = entries[level];
+        }
+        if (0 == reader->entries[level]) {
+            break;
+        }
+        reader->levels = level + 1;
+    }
+
+    return 0;
+}
+
+void pyramid_reader_close(pyramid_reader_t *reader)
+{
+    uint32_t i;
+
+    for (i = 0; i < PYRAMID_MAX_LEVELS; i++) {
+        free(reader->chunks[i]);
+    }
+    munmap((void *) reader->data, (size_t) reader->size);
+    free(reader);
+}
+
+int pyramid_reader_open(pyramid_reader_t **out, const char *capture_path)
+{
+    pyramid_reader_t *reader;
+    pyramid_footer_t footer;
+    pyramid_table_entry_t *table;
+    pyramid_table_entry_t *walked = NULL;
+    struct stat st;
+    uint64_t count;
+    uint64_t i;
+    char *path;
+    void *data;
+    int fd;
+    int result;
+
+    path = recorder_sidecar_path(capture_path, PYRAMID_SUFFIX);
+    if (NULL == path) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+    fd = open(path, O_RDONLY);
+    free(path);
+    if (fd < 0) {
+        return AIRSPY_ERROR_NOT_FOUND;
+    }
+
+    if (fstat(fd, &st) != 0 || (uint64_t) st.st_size < sizeof(pyramid_header_t)) {
+        close(fd);
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    reader = (pyramid_reader_t *) calloc(1, sizeof(pyramid_reader_t));
+    if (NULL == reader) {
+        munmap(data, (size_t) st.st_size);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+    reader->data = (const uint8_t *) data;
+    reader->size = (uint64_t) st.st_size;
+    reader->header = (const pyramid_header_t *) data;
+
+    if (reader->header->magic != PYRAMID_MAGIC || reader->header->version != PYRAMID_VERSION ||
+            reader->header->entry_bytes != sizeof(pyramid_entry_t) + 3 * reader->header->fft_size * sizeof(float)) {
+        pyramid_reader_close(reader);
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    /* The footer and chunk table, if the recording was closed */
+    count = 0;
+    table = NULL;
+    if (reader->size >= sizeof(pyramid_header_t) + sizeof(footer)) {
+        memcpy(&footer, reader->data + reader->size - sizeof(footer), sizeof(footer));
+        if (footer.magic == PYRAMID_FOOTER_MAGIC && footer.levels <= PYRAMID_MAX_LEVELS &&
+                footer.chunk_count <= (reader->size - sizeof(pyramid_header_t) - sizeof(footer)) / sizeof(pyramid_table_entry_t)) {
+            table = (pyramid_table_entry_t *) (reader->data + reader->size - sizeof(footer) -
+                footer.chunk_count * sizeof(pyramid_table_entry_t));
+            count = footer.chunk_count;
+            for (i = 0; i < count; i++) {
+                if (!pyramid_reader_chunk_ok(reader, &table[i])) {
+                    break;
+                }
+            }
+            if (i < count) {
+                table = NULL;
+                count = 0;
+            } else {
+                for (i = 0; i < footer.levels; i++) {
+                    reader->entries[i] = footer.entries[i];
+                }
+            }
+        }
+    }
+    if (NULL == table) {
+        count = pyramid_reader_walk(reader, &walked);
+        table = walked;
+    }
+
+    result = pyramid_reader_levels(reader, table, count);
+    free(walked);
+    if (result != 0) {
+        pyramid_reader_close(reader);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    *out = reader;
+    return AIRSPY_SUCCESS;
+}
+
+#else
+
+int pyramid_open(pyramid_t **pyramid, const char *capture_path, uint32_t bucket_samples, uint32_t fft_size,
+    double sample_rate)
+{
+    (void) pyramid;
+    (void) capture_path;
+    (void) bucket_samples;
+    (void) fft_size;
+    (void) sample_rate;
+    return AIRSPY_ERROR_OTHER;
+}
+
+void pyramid_write(pyramid_t *pyramid, const int16_t *iq, uint32_t count, uint64_t sample_index)
+{
+    (void) pyramid;
+    (void) iq;
+    (void) count;
+    (void) sample_index;
+}
+
+uint64_t pyramid_dropped(pyramid_t *pyramid)
+{
+    (void) pyramid;
+    return 0;
+}
+
+int pyramid_close(pyramid_t *pyramid)
+{
+    (void) pyramid;
+    return AIRSPY_ERROR_OTHER;
+}
+
+int pyramid_reader_open(pyramid_reader_t **reader, const char *capture_path)
+{
+    (void) reader;
+    (void) capture_path;
+    return AIRSPY_ERROR_OTHER;
+}
+
+void pyramid_reader_close(pyramid_reader_t *reader)
+{
+    (void) reader;
+}
+
+#endif
+
+void pyramid_reader_info(pyramid_reader_t *reader, airspy_power_info_t *info)
+{
+    uint32_t i;
+
+    memset(info, 0, sizeof(*info));
+    info->sample_rate = reader->header->sample_rate;
+    info->first_sample_index = reader->header->first_sample_index;
+    info->bucket_samples = reader->header->bucket_samples;
+    info->factor = reader->header->factor;
+    info->fft_size = reader->header->fft_size;
+    info->levels = reader->levels;
+    for (i = 0; i < reader->levels; i++) {
+        info->buckets[i] = reader->entries[i];
+    }
+}
+
+void pyramid_reader_read(pyramid_reader_t *reader, uint32_t level, uint64_t first, uint32_t count,
+    airspy_power_summary_t *summaries, float *bins)
+{
+    const pyramid_table_entry_t *chunks = reader->chunks[level];
+    const uint8_t *entry;
+    uint32_t entry_bytes = reader->header->entry_bytes;
+    uint32_t bin_floats = 3 * reader->header->fft_size;
+    uint64_t lo = 0;
+    uint64_t hi = reader->chunk_count[level];
+    uint64_t index;
+    uint32_t i;
+
+    /* The last chunk starting at or before first */
+    while (hi - lo > 1) {
+        uint64_t mid = lo + (hi - lo) / 2;
+
+        if (chunks[mid].first <= first) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        index = first + i;
+        while (index >= chunks[lo].first + chunks[lo].count) {
+            lo++;
+        }
+        entry = reader->data + chunks[lo].offset + sizeof(pyramid_chunk_t) + (index - chunks[lo].first) * entry_bytes;
+        memcpy(&summaries[i], entry, sizeof(pyramid_entry_t));
+        if (bins != NULL && bin_floats > 0) {
+            memcpy(bins + (size_t) i * bin_floats, entry + sizeof(pyramid_entry_t), bin_floats * sizeof(float));
+        }
+    }
+}
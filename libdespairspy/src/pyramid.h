@@ -0,0 +1,116 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#include <stdint.h>
+
+#include "airspy.h"
+
+#define PYRAMID_SUFFIX ".sigmf-power"
+#define PYRAMID_MAGIC 0x59505344u /* "DSPY" */
+#define PYRAMID_CHUNK_MAGIC 0x43505344u /* "DSPC" */
+#define PYRAMID_FOOTER_MAGIC 0x54505344u /* "DSPT" */
+#define PYRAMID_VERSION 1
+
+#define PYRAMID_FACTOR 4 /* Buckets of one level merged into one of the next */
+#define PYRAMID_MAX_LEVELS AIRSPY_POWER_MAX_LEVELS
+#define PYRAMID_MAX_FFT_SIZE 4096
+#define PYRAMID_CHUNK_BYTES (64 << 10) /* Entries of a level are written in chunks of about this */
+#define PYRAMID_QUEUE_DEPTH 8 /* Blocks waiting for the summary thread */
+
+/*
+ * The power summaries of a recording: this header, then chunks of
+ * consecutive entries of one level, each behind a pyramid_chunk_t, in the
+ * order they filled up. Closing appends the table of every chunk and the
+ * footer, which a reader finds at the end; without them (the recording
+ * was cut short) the chunks are walked from the start instead.
+ *
+ * An entry is a pyramid_entry_t, followed with an FFT size by min, max and
+ * mean per bin, each an array of fft_size floats, DC in the middle. Values
+ * are dBFS, NaN where nothing went in.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t bucket_samples; /* IQ samples per entry of level 0 */
+    uint32_t factor;
+    uint32_t fft_size; /* 0 without per-bin summaries */
+    uint32_t entry_bytes;
+    double sample_rate;
+    uint64_t first_sample_index; /* In the stream, where bucket 0 starts */
+} pyramid_header_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t level;
+    uint64_t first; /* Entry */
+    uint32_t count;
+    uint32_t reserved;
+} pyramid_chunk_t;
+
+typedef struct {
+    uint64_t offset; /* Of the chunk's pyramid_chunk_t */
+    uint64_t first;
+    uint32_t level;
+    uint32_t count;
+} pyramid_table_entry_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t levels;
+    uint64_t chunk_count; /* Table entries just before the footer */
+    uint64_t entries[PYRAMID_MAX_LEVELS];
+} pyramid_footer_t;
+
+typedef airspy_power_summary_t pyramid_entry_t;
+
+typedef struct pyramid pyramid_t;
+
+/*
+ * pyramid_write() runs on the airspy_do_rx() thread and only copies the
+ * block for the summary thread, which owns the file; a block that finds
+ * the queue full is left out and counted. Bucket 0 starts at the first
+ * block written. Per-bin summaries take Hann windowed frames of fft_size
+ * samples aligned to the buckets; a frame that loses samples is skipped.
+ */
+int pyramid_open(pyramid_t **pyramid, const char *capture_path, uint32_t bucket_samples, uint32_t fft_size,
+    double sample_rate);
+void pyramid_write(pyramid_t *pyramid, const int16_t *iq, uint32_t count, uint64_t sample_index);
+uint64_t pyramid_dropped(pyramid_t *pyramid);
+/* Summarizes the partly filled buckets and writes the chunk table. Returns the first write error, if any. */
+int pyramid_close(pyramid_t *pyramid);
+
+struct airspy_power_pyramid;
+typedef struct airspy_power_pyramid pyramid_reader_t;
+
+/* Maps the summaries next to a capture, read-only */
+int pyramid_reader_open(pyramid_reader_t **reader, const char *capture_path);
+void pyramid_reader_close(pyramid_reader_t *reader);
+void pyramid_reader_info(pyramid_reader_t *reader, airspy_power_info_t *info);
+/* Entries first to first + count of level, which the caller checked are there; bins may be NULL */
+void pyramid_reader_read(pyramid_reader_t *reader, uint32_t level, uint64_t first, uint32_t count,
+    airspy_power_summary_t *summaries, float *bins);
+
+#endif // PYRAMID_H
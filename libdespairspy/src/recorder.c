@@ -0,0 +1,1297 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "recorder.h"
+#include "capture_index.h"
+#include "codec.h"
+#include "packing.h"
+#include "pyramid.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#endif
+
+#if defined(HAVE_LINUX_IO_URING_H)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define RECORDER_HAVE_URING
+#endif
+#endif
+
+#define RECORDER_META_SUFFIX ".sigmf-meta"
+#define RECORDER_DATA_SUFFIX ".sigmf-data"
+
+typedef struct {
+    uint8_t *data;
+    uint64_t offset;
+    uint32_t length;
+#ifndef _WIN32
+    struct iovec iov;
+#endif
+} recorder_chunk_t;
+
+typedef struct {
+    uint64_t sample_start;
+    uint64_t global_index;
+    uint32_t freq_hz;
+} recorder_capture_t;
+
+#ifdef RECORDER_HAVE_URING
+/* Just enough of io_uring to keep a few writes in flight, without liburing */
+typedef struct {
+    int fd;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+    unsigned in_flight;
+    unsigned to_submit;
+} recorder_uring_t;
+#endif
+
+struct recorder
+{
+    int fd;
+    int direct;
+    char *meta_path;
+    char *description;
+    char *hw;
+    const char *datatype;
+    double sample_rate;
+    int packed;
+    int compressed;
+    int wait;
+    char datetime[32];
+
+    uint32_t chunk_size;
+    uint32_t chunk_count;
+    recorder_chunk_t *chunks;
+
+    /* Streaming side, only touched from the airspy_do_rx() thread */
+    recorder_chunk_t *fill;
+    uint64_t next_offset;
+    uint64_t total_bytes;
+    uint64_t file_samples;
+    uint64_t next_index;
+    int index_valid;
+    recorder_capture_t *captures;
+    uint32_t capture_count;
+    uint32_t capture_alloc;
+    uint32_t capture_freq_hz;
+    volatile uint32_t freq_hz;
+    uint16_t *unpacked;
+    uint8_t *encoded;
+    size_t encoded_alloc;
+    uint64_t codec_blocks;
+    uint64_t *codec_index;
+    uint64_t codec_index_count;
+    uint64_t codec_index_alloc;
+    int codec_index_failed;
+    volatile uint32_t gain;
+    uint32_t index_freq_hz;
+    uint32_t index_gain;
+    int64_t wall_base_ns;
+    int64_t mono_base_ns;
+    pyramid_t *pyramid;
+
+    /* Shared between both sides, protected by lock */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_cond_t freed; /* For recorder_write() to wait on in wait mode */
+    recorder_chunk_t **free_chunks;
+    uint32_t free_count;
+    recorder_chunk_t **queue;
+    uint32_t queue_head;
+    uint32_t queue_count;
+    int exit;
+    int error;
+    airspy_record_stats_t stats;
+    capture_index_record_t *index_pending;
+    uint32_t index_pending_count;
+    uint32_t index_pending_alloc;
+
+    /* Writer side */
+    pthread_t thread;
+    char *index_path;
+    int index_fd;
+    uint64_t index_bytes;
+    int index_error;
+    capture_index_record_t *index_writing;
+    uint32_t index_writing_alloc;
+    int use_uring;
+#ifdef RECORDER_HAVE_URING
+    recorder_uring_t ring;
+#endif
+};
+
+#ifndef _WIN32
+
+#ifdef RECORDER_HAVE_URING
+static void recorder_uring_free(recorder_uring_t *ring)
+{
+    if (ring->sqes != NULL && ring->sqes != MAP_FAILED) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring != NULL && ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring != NULL && ring->sq_ring != MAP_FAILED) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    if (ring->fd >= 0) {
+        close(ring->fd);
+    }
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+}
+
+static int recorder_uring_init(recorder_uring_t *ring, unsigned depth)
+{
+    struct io_uring_params params;
+    uint8_t *sq;
+    uint8_t *cq;
+
+    memset(ring, 0, sizeof(*ring));
+    memset(&params, 0, sizeof(params));
+
+    ring->fd = (int) syscall(__NR_io_uring_setup, depth, &params);
+    if (ring->fd < 0) {
+        /* Not built into the kernel or blocked by a seccomp policy */
+        ring->fd = -1;
+        return -1;
+    }
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+#ifdef IORING_FEAT_SINGLE_MMAP
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_ring_size > ring->sq_ring_size) {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+#endif
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        recorder_uring_free(ring);
+        return -1;
+    }
+
+#ifdef IORING_FEAT_SINGLE_MMAP
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring = ring->sq_ring;
+    } else
+#endif
+    {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            recorder_uring_free(ring);
+            return -1;
+        }
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe *) mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        recorder_uring_free(ring);
+        return -1;
+    }
+
+    sq = (uint8_t *) ring->sq_ring;
+    cq = (uint8_t *) ring->cq_ring;
+    ring->sq_tail = (unsigned *) (sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned *) (sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *) (sq + params.sq_off.array);
+    ring->cq_head = (unsigned *) (cq + params.cq_off.head);
+    ring->cq_tail = (unsigned *) (cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned *) (cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+
+    return 0;
+}
+
+static void recorder_uring_queue(recorder_uring_t *ring, int fd, recorder_chunk_t *chunk, uint32_t length)
+{
+    struct io_uring_sqe *sqe;
+    unsigned tail;
+    unsigned index;
+
+    chunk->iov.iov_base = chunk->data;
+    chunk->iov.iov_len = length;
+
+    tail = *ring->sq_tail;
+    index = tail & *ring->sq_mask;
+    sqe = &ring->sqes[index];
+
+    /* WRITEV rather than WRITE so kernels from 5.1 on are covered */
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_WRITEV;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t) (uintptr_t) &chunk->iov;
+    sqe->len = 1;
+    sqe->off = chunk->offset;
+    sqe->user_data = (uint64_t) (uintptr_t) chunk;
+
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    ring->to_submit++;
+    ring->in_flight++;
+}
+
+static int recorder_uring_enter(recorder_uring_t *ring, unsigned min_complete)
+{
+    int result;
+
+    do {
+        result = (int) syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, min_complete,
+                min_complete > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    } while (result < 0 && errno == EINTR);
+
+    if (result < 0) {
+        return -1;
+    }
+
+    ring->to_submit -= (unsigned) result;
+    return 0;
+}
+#endif
+
+static int recorder_pwrite(int fd, const uint8_t *data, uint32_t length, uint64_t offset)
+{
+    ssize_t written;
+
+    while (length > 0) {
+        written = pwrite(fd, data, length, (off_t) offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        data += written;
+        length -= (uint32_t) written;
+        offset += (uint64_t) written;
+    }
+
+    return 0;
+}
+
+/* O_DIRECT needs whole blocks; the tail is padded here and truncated away at close */
+static uint32_t recorder_write_length(recorder_t *rec, recorder_chunk_t *chunk)
+{
+    uint32_t length;
+
+    length = chunk->length;
+    if (rec->direct && (length & (RECORDER_ALIGN - 1)) != 0) {
+        length = (length + RECORDER_ALIGN - 1) & ~(uint32_t) (RECORDER_ALIGN - 1);
+        memset(chunk->data + chunk->length, 0, length - chunk->length);
+    }
+
+    return length;
+}
+
+static void recorder_chunk_done(recorder_t *rec, recorder_chunk_t *chunk, int error)
+{
+    pthread_mutex_lock(&rec->lock);
+    if (error != 0) {
+        if (rec->error == 0) {
+            rec->error = error;
+        }
+        rec->stats.write_errors++;
+    } else {
+        rec->stats.bytes_written += chunk->length;
+    }
+    rec->free_chunks[rec->free_count++] = chunk;
+    if (rec->wait) {
+        pthread_cond_signal(&rec->freed);
+    }
+    pthread_mutex_unlock(&rec->lock);
+}
+
+#ifdef RECORDER_HAVE_URING
+static void recorder_uring_reap(recorder_t *rec)
+{
+    recorder_uring_t *ring = &rec->ring;
+    struct io_uring_cqe *cqe;
+    recorder_chunk_t *chunk;
+    unsigned head;
+    unsigned tail;
+    uint32_t length;
+    int error;
+
+    head = *ring->cq_head;
+    tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+    while (head != tail) {
+        cqe = &ring->cqes[head & *ring->cq_mask];
+        chunk = (recorder_chunk_t *) (uintptr_t) cqe->user_data;
+        length = (uint32_t) chunk->iov.iov_len;
+
+        if (cqe->res < 0) {
+            error = -cqe->res;
+        } else if ((uint32_t) cqe->res < length) {
+            /* Short writes are rare enough to finish synchronously */
+            error = recorder_pwrite(rec->fd, chunk->data + cqe->res, length - cqe->res, chunk->offset + cqe->res);
+        } else {
+            error = 0;
+        }
+
+        ring->in_flight--;
+        recorder_chunk_done(rec, chunk, error);
+        head++;
+    }
+
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+}
+
+/*
+ * The ring failed: entries the kernel never saw are taken back off the
+ * submission queue and written with pwrite, and writes it did take are
+ * reaped as they complete. Chunks still outstanding after the grace period
+ * are counted as failed and kept out of the free list, since the kernel may
+ * yet read them.
+ */
+static void recorder_uring_abandon(recorder_t *rec)
+{
+    recorder_uring_t *ring = &rec->ring;
+    struct timespec pause = { 0, 1000000 };
+    recorder_chunk_t *chunk;
+    unsigned tail;
+    uint32_t waited;
+
+    /* Rewound so the kernel never sees them, should the ring be entered again */
+    tail = *ring->sq_tail;
+    __atomic_store_n(ring->sq_tail, tail - ring->to_submit, __ATOMIC_RELEASE);
+    while (ring->to_submit > 0) {
+        chunk = (recorder_chunk_t *) (uintptr_t) ring->sqes[(tail - ring->to_submit) & *ring->sq_mask].user_data;
+        ring->to_submit--;
+        ring->in_flight--;
+        recorder_chunk_done(rec, chunk, recorder_pwrite(rec->fd, chunk->data, (uint32_t) chunk->iov.iov_len,
+                chunk->offset));
+    }
+
+    for (waited = 0; ring->in_flight > 0 && waited < RECORDER_URING_DRAIN_MS; waited++) {
+        recorder_uring_reap(rec);
+        if (ring->in_flight > 0) {
+            nanosleep(&pause, NULL);
+        }
+    }
+
+    pthread_mutex_lock(&rec->lock);
+    rec->stats.write_errors += ring->in_flight;
+    pthread_mutex_unlock(&rec->lock);
+    ring->in_flight = 0;
+}
+#endif
+
+/* Called with the lock held: swaps the records the stream side made for the writer's empty buffer */
+static uint32_t recorder_take_index(recorder_t *rec)
+{
+    capture_index_record_t *records;
+    uint32_t alloc;
+    uint32_t count;
+
+    count = rec->index_pending_count;
+    if (count == 0) {
+        return 0;
+    }
+    records = rec->index_writing;
+    alloc = rec->index_writing_alloc;
+    rec->index_writing = rec->index_pending;
+    rec->index_writing_alloc = rec->index_pending_alloc;
+    rec->index_pending = records;
+    rec->index_pending_alloc = alloc;
+    rec->index_pending_count = 0;
+
+    return count;
+}
+
+/* Records can land before the samples they describe, a reader of a live recording has to allow for that */
+static void recorder_write_index(recorder_t *rec, uint32_t count)
+{
+    uint32_t length = count * (uint32_t) sizeof(capture_index_record_t);
+
+    if (count == 0 || rec->index_error != 0) {
+        return;
+    }
+    rec->index_error = recorder_pwrite(rec->index_fd, (const uint8_t *) rec->index_writing, length, rec->index_bytes);
+    rec->index_bytes += length;
+    if (rec->index_error != 0) {
+        pthread_mutex_lock(&rec->lock);
+        rec->stats.write_errors++;
+        pthread_mutex_unlock(&rec->lock);
+    }
+}
+
+static void *recorder_thread(void *arg)
+{
+    recorder_t *rec = (recorder_t *) arg;
+    recorder_chunk_t *batch[RECORDER_URING_DEPTH];
+    uint32_t batch_count;
+    uint32_t index_count;
+    uint32_t room;
+    uint32_t in_flight;
+    uint32_t i;
+
+    for (;;) {
+        in_flight = 0;
+#ifdef RECORDER_HAVE_URING
+        if (rec->use_uring) {
+            in_flight = rec->ring.in_flight;
+        }
+#endif
+        room = rec->use_uring ? RECORDER_URING_DEPTH - in_flight : 1;
+
+        pthread_mutex_lock(&rec->lock);
+        while (rec->queue_count == 0 && in_flight == 0 && !rec->exit) {
+            pthread_cond_wait(&rec->cond, &rec->lock);
+        }
+        index_count = recorder_take_index(rec);
+        if (rec->queue_count == 0 && in_flight == 0) {
+            pthread_mutex_unlock(&rec->lock);
+            recorder_write_index(rec, index_count);
+            break;
+        }
+        batch_count = 0;
+        while (rec->queue_count > 0 && batch_count < room) {
+            batch[batch_count++] = rec->queue[rec->queue_head];
+            rec->queue_head = (rec->queue_head + 1) % rec->chunk_count;
+            rec->queue_count--;
+        }
+        pthread_mutex_unlock(&rec->lock);
+        recorder_write_index(rec, index_count);
+
+#ifdef RECORDER_HAVE_URING
+        if (rec->use_uring) {
+            for (i = 0; i < batch_count; i++) {
+                recorder_uring_queue(&rec->ring, rec->fd, batch[i], recorder_write_length(rec, batch[i]));
+            }
+
+            /* Only block for a completion when there is nothing new to hand over */
+            if (recorder_uring_enter(&rec->ring, (batch_count == 0 || rec->ring.in_flight == RECORDER_URING_DEPTH) ? 1 : 0) != 0 &&
+                    errno != EAGAIN && errno != EBUSY) {
+                /* Fail the recording, and go on with pwrite from what the ring still holds */
+                pthread_mutex_lock(&rec->lock);
+                if (rec->error == 0) {
+                    rec->error = errno;
+                }
+                rec->stats.write_errors++;
+                rec->stats.io_uring = 0;
+                pthread_mutex_unlock(&rec->lock);
+                recorder_uring_abandon(rec);
+                rec->use_uring = 0;
+                continue;
+            }
+
+            /* Unsubmitted entries after EAGAIN/EBUSY are retried on the next pass */
+            recorder_uring_reap(rec);
+            continue;
+        }
+#endif
+
+        for (i = 0; i < batch_count; i++) {
+            recorder_chunk_done(rec, batch[i], recorder_pwrite(rec->fd, batch[i]->data,
+                    recorder_write_length(rec, batch[i]), batch[i]->offset));
+        }
+    }
+
+    return NULL;
+}
+
+static char *recorder_strdup(const char *str)
+{
+    char *copy;
+
+    if (str == NULL) {
+        return NULL;
+    }
+
+    copy = (char *) malloc(strlen(str) + 1);
+    if (copy != NULL) {
+        strcpy(copy, str);
+    }
+    return copy;
+}
+
+char *recorder_sidecar_path(const char *path, const char *suffix)
+{
+    size_t len;
+    size_t data_len;
+    char *sidecar;
+
+    len = strlen(path);
+    data_len = strlen(RECORDER_DATA_SUFFIX);
+    if (len >= data_len && strcmp(path + len - data_len, RECORDER_DATA_SUFFIX) == 0) {
+        len -= data_len;
+    }
+
+    sidecar = (char *) malloc(len + strlen(suffix) + 1);
+    if (sidecar != NULL) {
+        memcpy(sidecar, path, len);
+        strcpy(sidecar + len, suffix);
+    }
+    return sidecar;
+}
+
+char *recorder_meta_path(const char *path)
+{
+    return recorder_sidecar_path(path, RECORDER_META_SUFFIX);
+}
+
+static void recorder_release(recorder_t *rec)
+{
+    uint32_t i;
+
+#ifdef RECORDER_HAVE_URING
+    /* Before the chunks, which writes a failed ring never finished may still point into */
+    if (rec->ring.fd >= 0) {
+        recorder_uring_free(&rec->ring);
+    }
+#endif
+    if (rec->chunks != NULL) {
+        for (i = 0; i < rec->chunk_count; i++) {
+            free(rec->chunks[i].data);
+        }
+    }
+    if (rec->fd >= 0) {
+        close(rec->fd);
+    }
+    if (rec->index_fd >= 0) {
+        close(rec->index_fd);
+    }
+    if (rec->pyramid != NULL) {
+        pyramid_close(rec->pyramid);
+    }
+    free(rec->index_pending);
+    free(rec->index_writing);
+    free(rec->index_path);
+    free(rec->chunks);
+    free(rec->free_chunks);
+    free(rec->queue);
+    free(rec->captures);
+    free(rec->unpacked);
+    free(rec->encoded);
+    free(rec->codec_index);
+    free(rec->meta_path);
+    free(rec->description);
+    free(rec->hw);
+    free(rec);
+}
+
+static int recorder_open_file(recorder_t *rec, const airspy_record_params_t *params)
+{
+    int flags;
+
+    flags = O_WRONLY | O_CREAT | O_TRUNC;
+
+#ifdef O_DIRECT
+    if (params->flags & AIRSPY_RECORD_DIRECT_IO) {
+        rec->fd = open(params->path, flags | O_DIRECT, 0644);
+        if (rec->fd >= 0) {
+            rec->direct = 1;
+            return 0;
+        }
+        /* e.g. tmpfs refuses O_DIRECT, go through the page cache instead */
+        if (errno != EINVAL) {
+            return -1;
+        }
+    }
+#endif
+
+    rec->fd = open(params->path, flags, 0644);
+    return rec->fd >= 0 ? 0 : -1;
+}
+
+static void recorder_append(recorder_t *rec, const uint8_t *src, uint32_t bytes);
+
+static int64_t recorder_clock_ns(clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+    return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int recorder_open_index(recorder_t *rec, const recorder_meta_t *meta)
+{
+    capture_index_header_t header;
+
+    rec->index_fd = open(rec->index_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (rec->index_fd < 0) {
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = CAPTURE_INDEX_MAGIC;
+    header.version = CAPTURE_INDEX_VERSION;
+    header.record_size = sizeof(capture_index_record_t);
+    header.flags = meta->raw ? CAPTURE_INDEX_RAW : 0;
+    header.sample_rate = meta->sample_rate;
+    if (recorder_pwrite(rec->index_fd, (const uint8_t *) &header, sizeof(header), 0) != 0) {
+        return -1;
+    }
+    rec->index_bytes = sizeof(header);
+
+    /* Entry times follow the monotonic clock from the wall clock's reading now, so they never step back */
+    rec->wall_base_ns = recorder_clock_ns(CLOCK_REALTIME);
+    rec->mono_base_ns = recorder_clock_ns(CLOCK_MONOTONIC);
+
+    return 0;
+}
+
+static void recorder_preallocate(recorder_t *rec, uint64_t bytes)
+{
+    if (bytes == 0) {
+        return;
+    }
+
+#if defined(__linux__) && defined(FALLOC_FL_KEEP_SIZE)
+    /* Keep the size so a short recording doesn't leave a long file behind */
+    if (fallocate(rec->fd, FALLOC_FL_KEEP_SIZE, 0, (off_t) bytes) == 0) {
+        return;
+    }
+#endif
+    posix_fallocate(rec->fd, 0, (off_t) bytes);
+}
+
+int recorder_open(recorder_t **out, const airspy_record_params_t *params, const recorder_meta_t *meta)
+{
+    recorder_t *rec;
+    uint32_t backlog;
+    uint32_t i;
+    int result;
+    time_t now;
+    struct tm tm_now;
+
+    if (params == NULL || params->path == NULL) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    rec = (recorder_t *) calloc(1, sizeof(recorder_t));
+    if (NULL == rec) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+    rec->fd = -1;
+    rec->index_fd = -1;
+#ifdef RECORDER_HAVE_URING
+    rec->ring.fd = -1;
+#endif
+
+    backlog = params->backlog_bytes != 0 ? params->backlog_bytes : RECORDER_DEFAULT_BACKLOG;
+    rec->chunk_size = RECORDER_CHUNK_SIZE;
+    rec->chunk_count = backlog / rec->chunk_size;
+    if (rec->chunk_count < RECORDER_MIN_CHUNKS) {
+        rec->chunk_count = RECORDER_MIN_CHUNKS;
+    }
+
+    rec->datatype = meta->datatype;
+    rec->sample_rate = meta->sample_rate;
+    rec->packed = meta->packed;
+    rec->compressed = meta->compressed;
+    rec->wait = meta->wait;
+    rec->freq_hz = meta->freq_hz;
+    rec->gain = meta->gain;
+    rec->meta_path = recorder_meta_path(params->path);
+    rec->index_path = recorder_sidecar_path(params->path, CAPTURE_INDEX_SUFFIX);
+    rec->description = recorder_strdup(params->description);
+    rec->hw = recorder_strdup(meta->hw);
+    rec->chunks = (recorder_chunk_t *) calloc(rec->chunk_count, sizeof(recorder_chunk_t));
+    rec->free_chunks = (recorder_chunk_t **) calloc(rec->chunk_count, sizeof(recorder_chunk_t *));
+    rec->queue = (recorder_chunk_t **) calloc(rec->chunk_count, sizeof(recorder_chunk_t *));
+    if (NULL == rec->meta_path || NULL == rec->index_path || NULL == rec->chunks || NULL == rec->free_chunks || NULL == rec->queue ||
+            (params->description != NULL && NULL == rec->description) || (meta->hw != NULL && NULL == rec->hw)) {
+        recorder_release(rec);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    for (i = 0; i < rec->chunk_count; i++) {
+        if (posix_memalign((void **) &rec->chunks[i].data, RECORDER_ALIGN, rec->chunk_size) != 0) {
+            rec->chunks[i].data = NULL;
+            recorder_release(rec);
+            return AIRSPY_ERROR_NO_MEM;
+        }
+        rec->free_chunks[rec->free_count++] = &rec->chunks[i];
+    }
+
+    if (params->power_bucket != 0) {
+        result = pyramid_open(&rec->pyramid, params->path, params->power_bucket, params->power_fft_size,
+            meta->raw ? meta->sample_rate / 2.0 : meta->sample_rate);
+        if (result != AIRSPY_SUCCESS) {
+            rec->pyramid = NULL;
+            recorder_release(rec);
+            return result;
+        }
+    }
+
+    if (recorder_open_file(rec, params) != 0 || recorder_open_index(rec, meta) != 0) {
+        recorder_release(rec);
+        return AIRSPY_ERROR_OTHER;
+    }
+    recorder_preallocate(rec, params->preallocate_bytes);
+
+#ifdef RECORDER_HAVE_URING
+    if (!(params->flags & AIRSPY_RECORD_NO_IO_URING) && recorder_uring_init(&rec->ring, RECORDER_URING_DEPTH) == 0) {
+        rec->use_uring = 1;
+    }
+#endif
+    rec->stats.io_uring = rec->use_uring;
+    rec->stats.direct_io = rec->direct;
+
+    now = time(NULL);
+    gmtime_r(&now, &tm_now);
+    strftime(rec->datetime, sizeof(rec->datetime), "%Y-%m-%dT%H:%M:%SZ", &tm_now);
+
+    pthread_mutex_init(&rec->lock, NULL);
+    pthread_cond_init(&rec->cond, NULL);
+    pthread_cond_init(&rec->freed, NULL);
+
+    if (pthread_create(&rec->thread, NULL, recorder_thread, rec) != 0) {
+        pthread_cond_destroy(&rec->freed);
+        pthread_cond_destroy(&rec->cond);
+        pthread_mutex_destroy(&rec->lock);
+        recorder_release(rec);
+        return AIRSPY_ERROR_THREAD;
+    }
+
+    if (rec->compressed) {
+        uint8_t header[CODEC_FILE_HEADER];
+
+        codec_write_file_header(header, rec->packed ? CODEC_FLAG_PACKED : 0);
+        recorder_append(rec, header, sizeof(header));
+    }
+
+    *out = rec;
+    return AIRSPY_SUCCESS;
+}
+
+static void recorder_queue(recorder_t *rec, recorder_chunk_t *chunk)
+{
+    pthread_mutex_lock(&rec->lock);
+    rec->queue[(rec->queue_head + rec->queue_count) % rec->chunk_count] = chunk;
+    rec->queue_count++;
+    pthread_cond_signal(&rec->cond);
+    pthread_mutex_unlock(&rec->lock);
+}
+
+static int recorder_add_capture(recorder_t *rec, uint64_t sample_index)
+{
+    recorder_capture_t *captures;
+    uint32_t alloc;
+
+    if (rec->capture_count == rec->capture_alloc) {
+        alloc = rec->capture_alloc != 0 ? rec->capture_alloc * 2 : 16;
+        captures = (recorder_capture_t *) realloc(rec->captures, alloc * sizeof(recorder_capture_t));
+        if (NULL == captures) {
+            return -1;
+        }
+        rec->captures = captures;
+        rec->capture_alloc = alloc;
+    }
+
+    rec->capture_freq_hz = rec->freq_hz;
+    rec->captures[rec->capture_count].sample_start = rec->file_samples;
+    rec->captures[rec->capture_count].global_index = sample_index;
+    rec->captures[rec->capture_count].freq_hz = rec->capture_freq_hz;
+    rec->capture_count++;
+
+    return 0;
+}
+
+/* The sidecar index record of an accepted block, before the file position moves past it */
+static void recorder_add_record(recorder_t *rec, uint32_t samples, uint64_t sample_index)
+{
+    capture_index_record_t record;
+    capture_index_record_t *grown;
+    uint32_t alloc;
+
+    record.sample_start = rec->file_samples;
+    record.sample_index = sample_index;
+    record.byte_offset = rec->total_bytes;
+    record.time_ns = rec->wall_base_ns + recorder_clock_ns(CLOCK_MONOTONIC) - rec->mono_base_ns;
+    record.sample_count = samples;
+    record.freq_hz = rec->freq_hz;
+    record.gain = rec->gain;
+    record.flags = 0;
+    if (!rec->index_valid || sample_index != rec->next_index) {
+        record.flags |= AIRSPY_INDEX_DISCONTINUITY;
+    }
+    if (rec->index_valid && record.freq_hz != rec->index_freq_hz) {
+        record.flags |= AIRSPY_INDEX_RETUNED;
+    }
+    if (rec->index_valid && record.gain != rec->index_gain) {
+        record.flags |= AIRSPY_INDEX_GAIN_CHANGED;
+    }
+    rec->index_freq_hz = record.freq_hz;
+    rec->index_gain = record.gain;
+
+    pthread_mutex_lock(&rec->lock);
+    if (rec->index_pending_count == rec->index_pending_alloc) {
+        /* Only grows while the writer is behind; a record that can't be kept leaves a gap in the index */
+        alloc = rec->index_pending_alloc != 0 ? rec->index_pending_alloc * 2 : 64;
+        grown = (capture_index_record_t *) realloc(rec->index_pending, alloc * sizeof(capture_index_record_t));
+        if (NULL == grown) {
+            pthread_mutex_unlock(&rec->lock);
+            return;
+        }
+        rec->index_pending = grown;
+        rec->index_pending_alloc = alloc;
+    }
+    rec->index_pending[rec->index_pending_count++] = record;
+    pthread_mutex_unlock(&rec->lock);
+}
+
+/* Copies into the backlog, whose free space the caller checked */
+static void recorder_append(recorder_t *rec, const uint8_t *src, uint32_t bytes)
+{
+    uint32_t n;
+
+    rec->total_bytes += bytes;
+
+    while (bytes > 0) {
+        if (NULL == rec->fill) {
+            /* Enough chunks were free when checked and only this side takes them */
+            pthread_mutex_lock(&rec->lock);
+            rec->fill = rec->free_chunks[--rec->free_count];
+            pthread_mutex_unlock(&rec->lock);
+            rec->fill->length = 0;
+            rec->fill->offset = rec->next_offset;
+            rec->next_offset += rec->chunk_size;
+        }
+
+        n = rec->chunk_size - rec->fill->length;
+        if (n > bytes) {
+            n = bytes;
+        }
+        memcpy(rec->fill->data + rec->fill->length, src, n);
+        rec->fill->length += n;
+        src += n;
+        bytes -= n;
+
+        if (rec->fill->length == rec->chunk_size) {
+            recorder_queue(rec, rec->fill);
+            rec->fill = NULL;
+        }
+    }
+}
+
+/* Encodes samples into rec->encoded as codec blocks following the ones already in the file */
+static int recorder_encode(recorder_t *rec, const void *data, uint32_t samples, uint32_t *bytes)
+{
+    const uint16_t *input = (const uint16_t *) data;
+    uint32_t blocks = (samples + CODEC_BLOCK_SAMPLES - 1) / CODEC_BLOCK_SAMPLES;
+    size_t need = blocks * codec_block_bound(CODEC_BLOCK_SAMPLES);
+    size_t length = 0;
+    uint32_t done;
+    uint32_t n;
+    void *grown;
+
+    /* Transfers are all the same size, so this only allocates on the first block */
+    if (need > rec->encoded_alloc) {
+        grown = realloc(rec->encoded, need);
+        if (NULL == grown) {
+            return -1;
+        }
+        rec->encoded = (uint8_t *) grown;
+        grown = realloc(rec->unpacked, (size_t) blocks * CODEC_BLOCK_SAMPLES * sizeof(uint16_t));
+        if (NULL == grown) {
+            return -1;
+        }
+        rec->unpacked = (uint16_t *) grown;
+        rec->encoded_alloc = need;
+    }
+
+    if (rec->packed) {
+        unpack_samples((const uint32_t *) data, rec->unpacked, (int) samples);
+        input = rec->unpacked;
+    }
+
+    for (done = 0; done < samples; done += n) {
+        n = samples - done < CODEC_BLOCK_SAMPLES ? samples - done : CODEC_BLOCK_SAMPLES;
+        length += codec_encode_block(input + done, n, rec->file_samples + done, rec->encoded + length);
+    }
+
+    *bytes = (uint32_t) length;
+    return 0;
+}
+
+/* Notes the file offset of every CODEC_INDEX_STRIDE-th block of an accepted rec->encoded */
+static int recorder_index_blocks(recorder_t *rec, uint32_t bytes)
+{
+    uint64_t *grown;
+    uint64_t alloc;
+    size_t offset;
+
+    for (offset = 0; offset < bytes; offset += codec_block_bytes(rec->encoded + offset)) {
+        if (rec->codec_blocks++ % CODEC_INDEX_STRIDE != 0) {
+            continue;
+        }
+        if (rec->codec_index_count == rec->codec_index_alloc) {
+            alloc = rec->codec_index_alloc != 0 ? rec->codec_index_alloc * 2 : 256;
+            grown = (uint64_t *) realloc(rec->codec_index, alloc * sizeof(uint64_t));
+            if (NULL == grown) {
+                return -1;
+            }
+            rec->codec_index = grown;
+            rec->codec_index_alloc = alloc;
+        }
+        rec->codec_index[rec->codec_index_count++] = rec->total_bytes + offset;
+    }
+
+    return 0;
+}
+
+int recorder_write(recorder_t *rec, const void *data, uint32_t bytes, uint32_t samples, uint64_t sample_index)
+{
+    uint32_t space;
+    uint32_t backlog;
+
+    if (rec->compressed) {
+        if (recorder_encode(rec, data, samples, &bytes) != 0) {
+            pthread_mutex_lock(&rec->lock);
+            rec->stats.blocks_dropped++;
+            rec->stats.samples_dropped += samples;
+            pthread_mutex_unlock(&rec->lock);
+            return AIRSPY_ERROR_NO_MEM;
+        }
+        data = rec->encoded;
+    }
+
+    pthread_mutex_lock(&rec->lock);
+    space = rec->free_count * rec->chunk_size + (rec->fill != NULL ? rec->chunk_size - rec->fill->length : 0);
+    /* The chunk being filled only goes out once full, so a block must fit in the others to be worth waiting for */
+    while (rec->wait && space < bytes && rec->error == 0 && bytes <= (rec->chunk_count - 1) * rec->chunk_size) {
+        pthread_cond_wait(&rec->freed, &rec->lock);
+        space = rec->free_count * rec->chunk_size + (rec->fill != NULL ? rec->chunk_size - rec->fill->length : 0);
+    }
+    if (space < bytes || rec->error != 0) {
+        rec->stats.blocks_dropped++;
+        rec->stats.samples_dropped += samples;
+        pthread_mutex_unlock(&rec->lock);
+        return AIRSPY_ERROR_BUSY;
+    }
+    rec->stats.blocks_recorded++;
+    backlog = (rec->chunk_count - rec->free_count) * rec->chunk_size + bytes;
+    if (backlog > rec->stats.backlog_high_water) {
+        rec->stats.backlog_high_water = backlog;
+    }
+    pthread_mutex_unlock(&rec->lock);
+
+    recorder_add_record(rec, samples, sample_index);
+    if (!rec->index_valid || sample_index != rec->next_index || rec->freq_hz != rec->capture_freq_hz) {
+        recorder_add_capture(rec, sample_index);
+    }
+    rec->index_valid = 1;
+    rec->next_index = sample_index + samples;
+    rec->file_samples += samples;
+
+    if (rec->compressed && !rec->codec_index_failed && recorder_index_blocks(rec, bytes) != 0) {
+        /* Seeking falls back to walking the blocks without the index */
+        rec->codec_index_failed = 1;
+        rec->codec_index_count = 0;
+    }
+    recorder_append(rec, (const uint8_t *) data, bytes);
+
+    return AIRSPY_SUCCESS;
+}
+
+void recorder_set_freq(recorder_t *rec, uint32_t freq_hz)
+{
+    rec->freq_hz = freq_hz;
+}
+
+void recorder_set_gain(recorder_t *rec, uint32_t gain)
+{
+    rec->gain = gain;
+}
+
+void recorder_power(recorder_t *rec, const int16_t *iq, uint32_t count, uint64_t sample_index)
+{
+    if (rec->pyramid != NULL) {
+        pyramid_write(rec->pyramid, iq, count, sample_index);
+    }
+}
+
+void recorder_get_stats(recorder_t *rec, airspy_record_stats_t *stats)
+{
+    pthread_mutex_lock(&rec->lock);
+    memcpy(stats, &rec->stats, sizeof(*stats));
+    pthread_mutex_unlock(&rec->lock);
+    if (rec->pyramid != NULL) {
+        stats->power_blocks_dropped = pyramid_dropped(rec->pyramid);
+    }
+}
+
+static void recorder_json_string(FILE *f, const char *str)
+{
+    fputc('"', f);
+    for (; *str != '\0'; str++) {
+        if (*str == '"' || *str == '\\') {
+            fprintf(f, "\\%c", *str);
+        } else if ((unsigned char) *str < 0x20) {
+            fprintf(f, "\\u%04x", (unsigned char) *str);
+        } else {
+            fputc(*str, f);
+        }
+    }
+    fputc('"', f);
+}
+
+static int recorder_write_meta(recorder_t *rec)
+{
+    FILE *f;
+    uint32_t i;
+
+    f = fopen(rec->meta_path, "w");
+    if (NULL == f) {
+        return -1;
+    }
+
+    fprintf(f, "{\n    \"global\": {\n");
+    fprintf(f, "        \"core:datatype\": \"%s\",\n", rec->datatype);
+    fprintf(f, "        \"core:sample_rate\": %.1f,\n", rec->sample_rate);
+    fprintf(f, "        \"core:version\": \"1.0.0\",\n");
+    fprintf(f, "        \"core:recorder\": \"libdespairspy %s\",\n", AIRSPY_VERSION);
+    if (rec->hw != NULL) {
+        fprintf(f, "        \"core:hw\": ");
+        recorder_json_string(f, rec->hw);
+        fprintf(f, ",\n");
+    }
+    if (rec->description != NULL) {
+        fprintf(f, "        \"core:description\": ");
+        recorder_json_string(f, rec->description);
+        fprintf(f, ",\n");
+    }
+    if (rec->compressed) {
+        /* Decodes to ru16_le; the codec header says whether the stream was packed */
+        fprintf(f, "        \"despairspy:compressed\": true,\n");
+    } else if (rec->packed) {
+        /* No SigMF datatype for this; readers have to know the extension */
+        fprintf(f, "        \"despairspy:packed\": true,\n");
+    }
+    fprintf(f, "        \"despairspy:dropped_samples\": %llu\n", (unsigned long long) rec->stats.samples_dropped);
+    fprintf(f, "    },\n    \"captures\": [");
+
+    for (i = 0; i < rec->capture_count; i++) {
+        fprintf(f, "%s\n        {\n", i > 0 ? "," : "");
+        fprintf(f, "            \"core:sample_start\": %llu,\n", (unsigned long long) rec->captures[i].sample_start);
+        if (i == 0) {
+            fprintf(f, "            \"core:datetime\": \"%s\",\n", rec->datetime);
+        }
+        if (rec->captures[i].freq_hz != 0) {
+            fprintf(f, "            \"core:frequency\": %u,\n", rec->captures[i].freq_hz);
+        }
+        fprintf(f, "            \"core:global_index\": %llu\n        }", (unsigned long long) rec->captures[i].global_index);
+    }
+
+    fprintf(f, "%s],\n    \"annotations\": []\n}\n", rec->capture_count > 0 ? "\n    " : "");
+
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+/* The block index goes after the blocks, past the O_DIRECT padding truncated away before */
+static int recorder_write_trailer(recorder_t *rec)
+{
+    uint8_t *trailer;
+    size_t length;
+    int error;
+
+    length = codec_trailer_bytes(rec->codec_index_count);
+    trailer = (uint8_t *) malloc(length);
+    if (NULL == trailer) {
+        return ENOMEM;
+    }
+    codec_write_trailer(trailer, rec->codec_index, rec->codec_index_count, rec->codec_blocks, rec->file_samples);
+
+#ifdef O_DIRECT
+    if (rec->direct) {
+        fcntl(rec->fd, F_SETFL, fcntl(rec->fd, F_GETFL) & ~O_DIRECT);
+    }
+#endif
+    error = recorder_pwrite(rec->fd, trailer, (uint32_t) length, rec->total_bytes);
+    free(trailer);
+
+    return error;
+}
+
+int recorder_close(recorder_t *rec)
+{
+    int result;
+
+    if (rec->fill != NULL) {
+        if (rec->fill->length > 0) {
+            recorder_queue(rec, rec->fill);
+        } else {
+            pthread_mutex_lock(&rec->lock);
+            rec->free_chunks[rec->free_count++] = rec->fill;
+            pthread_mutex_unlock(&rec->lock);
+        }
+        rec->fill = NULL;
+    }
+
+    pthread_mutex_lock(&rec->lock);
+    rec->exit = 1;
+    pthread_cond_signal(&rec->cond);
+    pthread_mutex_unlock(&rec->lock);
+    pthread_join(rec->thread, NULL);
+
+    result = rec->error != 0 ? AIRSPY_ERROR_OTHER : AIRSPY_SUCCESS;
+
+    /* Drops the O_DIRECT padding and any unused preallocation */
+    if (ftruncate(rec->fd, (off_t) rec->total_bytes) != 0) {
+        result = AIRSPY_ERROR_OTHER;
+    }
+
+    if (rec->compressed && recorder_write_trailer(rec) != 0) {
+        result = AIRSPY_ERROR_OTHER;
+    }
+
+    if (rec->index_error != 0) {
+        result = AIRSPY_ERROR_OTHER;
+    }
+
+    if (rec->pyramid != NULL) {
+        if (pyramid_close(rec->pyramid) != AIRSPY_SUCCESS) {
+            result = AIRSPY_ERROR_OTHER;
+        }
+        rec->pyramid = NULL;
+    }
+
+    if (recorder_write_meta(rec) != 0) {
+        result = AIRSPY_ERROR_OTHER;
+    }
+
+    pthread_cond_destroy(&rec->freed);
+    pthread_cond_destroy(&rec->cond);
+    pthread_mutex_destroy(&rec->lock);
+    recorder_release(rec);
+
+    return result;
+}
+
+#else
+
+int recorder_open(recorder_t **rec, const airspy_record_params_t *params, const recorder_meta_t *meta)
+{
+    (void) rec;
+    (void) params;
+    (void) meta;
+    return AIRSPY_ERROR_OTHER;
+}
+
+int recorder_write(recorder_t *rec, const void *data, uint32_t bytes, uint32_t samples, uint64_t sample_index)
+{
+    (void) rec;
+    (void) data;
+    (void) bytes;
+    (void) samples;
+    (void) sample_index;
+    return AIRSPY_ERROR_OTHER;
+}
+
+void recorder_set_freq(recorder_t *rec, uint32_t freq_hz)
+{
+    (void) rec;
+    (void) freq_hz;
+}
+
+void recorder_set_gain(recorder_t *rec, uint32_t gain)
+{
+    (void) rec;
+    (void) gain;
+}
+
+void recorder_power(recorder_t *rec, const int16_t *iq, uint32_t count, uint64_t sample_index)
+{
+    (void) rec;
+    (void) iq;
+    (void) count;
+    (void) sample_index;
+}
+
+void recorder_get_stats(recorder_t *rec, airspy_record_stats_t *stats)
+{
+    (void) rec;
+    memset(stats, 0, sizeof(*stats));
+}
+
+/* The block index goes after the blocks, past the O_DIRECT padding truncated away before */
+static int recorder_write_trailer(recorder_t *rec)
+{
+    uint8_t *trailer;
+    size_t length;
+    int error;
+
+    length = codec_trailer_bytes(rec->codec_index_count);
+    trailer = (uint8_t *) malloc(length);
+    if (NULL == trailer) {
+        return ENOMEM;
+    }
+    codec_write_trailer(trailer, rec->codec_index, rec->codec_index_count, rec->codec_blocks, rec->file_samples);
+
+#ifdef O_DIRECT
+    if (rec->direct) {
+        fcntl(rec->fd, F_SETFL, fcntl(rec->fd, F_GETFL) & ~O_DIRECT);
+    }
+#endif
+    error = recorder_pwrite(rec->fd, trailer, (uint32_t) length, rec->total_bytes);
+    free(trailer);
+
+    return error;
+}
+
+int recorder_close(recorder_t *rec)
+{
+    (void) rec;
+    return AIRSPY_ERROR_OTHER;
+}
+
+#endif
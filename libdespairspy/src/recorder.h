@@ -0,0 +1,80 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdint.h>
+
+#include "airspy.h"
+
+#define RECORDER_ALIGN 4096
+#define RECORDER_CHUNK_SIZE (1 << 20)
+#define RECORDER_DEFAULT_BACKLOG (64 << 20)
+#define RECORDER_MIN_CHUNKS 4
+#define RECORDER_URING_DEPTH 8
+#define RECORDER_URING_DRAIN_MS 1000 /* How long a failed ring is given to finish the writes it took */
+
+typedef struct recorder recorder_t;
+
+/* Fixed properties of the recording, written to the SigMF metadata */
+typedef struct {
+	const char *datatype;
+	double sample_rate;
+	uint32_t freq_hz; /* 0 if unknown */
+	const char *hw; /* May be NULL */
+	int packed; /* Raw capture in the 12-bit packed wire format */
+	int compressed; /* Raw capture through the lossless codec, see codec.h */
+	int raw; /* Real ADC samples rather than IQ */
+	uint32_t gain; /* CAPTURE_INDEX_GAIN() of the settings at the start */
+	int wait; /* recorder_write() waits for room in the backlog instead of dropping, for writers off the stream thread */
+} recorder_meta_t;
+
+/*
+ * recorder_write() runs on the airspy_do_rx() thread and only copies into the
+ * backlog; a writer thread owns the file. A block that doesn't fit in the
+ * backlog is dropped whole. A gap in sample_index or a frequency change
+ * starts a new SigMF capture segment. A compressed recording is encoded
+ * before the copy, on the same thread, and its block index is appended to
+ * the file at close. Every accepted block also gets a record in the
+ * sidecar index (see capture_index.h), written by the writer thread.
+ * With params->power_bucket, recorder_power() passes the converted IQ on
+ * to the power summaries (see pyramid.h) whatever the recording's format.
+ */
+int recorder_open(recorder_t **rec, const airspy_record_params_t *params, const recorder_meta_t *meta);
+int recorder_write(recorder_t *rec, const void *data, uint32_t bytes, uint32_t samples, uint64_t sample_index);
+void recorder_power(recorder_t *rec, const int16_t *iq, uint32_t count, uint64_t sample_index);
+void recorder_set_freq(recorder_t *rec, uint32_t freq_hz);
+/* CAPTURE_INDEX_GAIN() of the current settings, for the index */
+void recorder_set_gain(recorder_t *rec, uint32_t gain);
+void recorder_get_stats(recorder_t *rec, airspy_record_stats_t *stats);
+
+/* Flushes the backlog, writes the metadata and frees rec. Returns the first write error, if any. */
+int recorder_close(recorder_t *rec);
+
+/* The .sigmf-meta name belonging to a sample file, to be freed by the caller */
+char *recorder_meta_path(const char *path);
+/* The same for any other suffix */
+char *recorder_sidecar_path(const char *path, const char *suffix);
+
+#endif // RECORDER_H
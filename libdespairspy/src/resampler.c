@@ -0,0 +1,318 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "resampler.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Farrow positions are 32.32 fixed point input samples */
+#define RESAMPLER_ONE 4294967296.0
+
+struct airspy_resampler
+{
+    int farrow;
+    uint32_t interpolation;     /* Rational form, reduced */
+    uint32_t decimation;
+    uint64_t step;              /* Farrow form: input samples per output */
+    uint32_t taps;              /* Per phase, a multiple of RESAMPLER_LANES */
+    uint32_t phases;
+    float *bank;                /* phases rows of taps, oldest input first */
+    float *weights;             /* Farrow form: the taps of the output being computed */
+
+    /* Newest input of the next output from the start of the chunk, in 1/interpolation or 32.32 */
+    uint64_t position;
+    float *re;                  /* taps - 1 samples of history, then the chunk */
+    float *im;
+};
+
+static uint32_t resampler_gcd(uint32_t a, uint32_t b)
+{
+    uint32_t t;
+
+    while (b != 0) {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* Windowed sinc u input samples from the centre of a support of taps samples */
+static double resampler_prototype(double u, double cutoff, uint32_t taps)
+{
+    double half = taps / 2.0;
+    double h;
+    double w;
+
+    if (fabs(u) >= half) {
+        return 0.0;
+    }
+    h = u == 0.0 ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * u) / (M_PI * u);
+    w = 0.42 + 0.5 * cos(M_PI * u / half) + 0.08 * cos(2.0 * M_PI * u / half);
+    return h * w;
+}
+
+/* Taps for an output frac input samples past the newest input, unity gain at DC */
+static void resampler_design_row(float *row, double frac, double cutoff, uint32_t taps)
+{
+    double sum = 0.0;
+    double h;
+    uint32_t j;
+
+    for (j = 0; j < taps; j++) {
+        h = resampler_prototype(frac + (taps - 1 - j) - taps / 2.0, cutoff, taps);
+        row[j] = (float) h;
+        sum += h;
+    }
+    for (j = 0; j < taps; j++) {
+        row[j] = (float) (row[j] / sum);
+    }
+}
+
+int resampler_create(resampler_t **out, const airspy_resampler_params_t *params)
+{
+    resampler_t *resampler;
+    uint32_t zero_crossings;
+    uint32_t divisor;
+    uint32_t i;
+    double ratio;
+    double narrow;
+    double taps;
+
+    zero_crossings = params->zero_crossings > 0 ? params->zero_crossings : RESAMPLER_ZERO_CROSSINGS;
+    if (zero_crossings > RESAMPLER_MAX_ZERO_CROSSINGS) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    resampler = (resampler_t *) calloc(1, sizeof(resampler_t));
+    if (NULL == resampler) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    if (params->ratio > 0.0) {
+        ratio = params->ratio;
+        resampler->farrow = 1;
+        resampler->step = (uint64_t) llround(RESAMPLER_ONE / ratio);
+        resampler->phases = RESAMPLER_FARROW_PHASES + 3;
+        if (ratio > 65536.0 || resampler->step == 0) {
+            free(resampler);
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+    } else {
+        if (0 == params->interpolation || 0 == params->decimation) {
+            free(resampler);
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+        divisor = resampler_gcd(params->interpolation, params->decimation);
+        resampler->interpolation = params->interpolation / divisor;
+        resampler->decimation = params->decimation / divisor;
+        resampler->phases = resampler->interpolation;
+        if (resampler->interpolation > RESAMPLER_MAX_PHASES) {
+            free(resampler);
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+        ratio = (double) resampler->interpolation / resampler->decimation;
+    }
+
+    /* Stopband from the lower Nyquist rate on; a Blackman transition is about 5.5 / taps wide */
+    narrow = ratio < 1.0 ? ratio : 1.0;
+    taps = ceil(2.0 * zero_crossings / narrow / RESAMPLER_LANES) * RESAMPLER_LANES;
+    if (taps > RESAMPLER_MAX_TAPS) {
+        free(resampler);
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+    resampler->taps = (uint32_t) taps;
+
+    resampler->bank = (float *) malloc((size_t) resampler->phases * resampler->taps * sizeof(float));
+    resampler->weights = (float *) malloc(resampler->taps * sizeof(float));
+    resampler->re = (float *) calloc((size_t) resampler->taps - 1 + RESAMPLER_CHUNK, sizeof(float));
+    resampler->im = (float *) calloc((size_t) resampler->taps - 1 + RESAMPLER_CHUNK, sizeof(float));
+    if (NULL == resampler->bank || NULL == resampler->weights || NULL == resampler->re || NULL == resampler->im) {
+        resampler_free(resampler);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    for (i = 0; i < resampler->phases; i++) {
+        /* Farrow rows run from one table step before the newest input to one past the next */
+        resampler_design_row(resampler->bank + (size_t) i * resampler->taps,
+            resampler->farrow ? ((double) i - 1.0) / RESAMPLER_FARROW_PHASES : (double) i / resampler->interpolation,
+            0.5 * narrow - 2.75 / taps, resampler->taps);
+    }
+
+    *out = resampler;
+    return AIRSPY_SUCCESS;
+}
+
+void resampler_free(resampler_t *resampler)
+{
+    if (NULL == resampler) {
+        return;
+    }
+
+    free(resampler->bank);
+    free(resampler->weights);
+    free(resampler->re);
+    free(resampler->im);
+    free(resampler);
+}
+
+void resampler_reset(resampler_t *resampler)
+{
+    memset(resampler->re, 0, (resampler->taps - 1) * sizeof(float));
+    memset(resampler->im, 0, (resampler->taps - 1) * sizeof(float));
+    resampler->position = 0;
+}
+
+uint32_t resampler_max_output(const resampler_t *resampler, uint32_t count)
+{
+    if (resampler->farrow) {
+        return (uint32_t) ((((uint64_t) count << 32) + resampler->step - 1) / resampler->step + 1);
+    }
+    return (uint32_t) ((uint64_t) count * resampler->interpolation / resampler->decimation + 1);
+}
+
+uint64_t resampler_align(resampler_t *resampler, uint64_t input_index)
+{
+    uint64_t scaled = input_index * resampler->interpolation;
+    uint64_t n = (scaled + resampler->decimation - 1) / resampler->decimation;
+
+    resampler->position = n * resampler->decimation - scaled;
+    return n;
+}
+
+/* Lanes of partial sums across the taps, which the compiler keeps in vector registers */
+static void resampler_dot(const float *taps, const float *re, const float *im, uint32_t count, float *out)
+{
+    float acc_re[RESAMPLER_LANES];
+    float acc_im[RESAMPLER_LANES];
+    size_t k;
+    size_t l;
+
+    for (l = 0; l < RESAMPLER_LANES; l++) {
+        acc_re[l] = 0.0f;
+        acc_im[l] = 0.0f;
+    }
+    for (k = 0; k < count; k += RESAMPLER_LANES) {
+        for (l = 0; l < RESAMPLER_LANES; l++) {
+            acc_re[l] += taps[k + l] * re[k + l];
+            acc_im[l] += taps[k + l] * im[k + l];
+        }
+    }
+    for (l = 1; l < RESAMPLER_LANES; l++) {
+        acc_re[0] += acc_re[l];
+        acc_im[0] += acc_im[l];
+    }
+    out[0] = acc_re[0];
+    out[1] = acc_im[0];
+}
+
+static uint32_t resampler_run_polyphase(resampler_t *resampler, uint32_t chunk, float *output)
+{
+    uint32_t n = 0;
+    uint64_t newest;
+
+    while ((newest = resampler->position / resampler->interpolation) < chunk) {
+        resampler_dot(resampler->bank + (size_t) (resampler->position % resampler->interpolation) * resampler->taps,
+            resampler->re + newest, resampler->im + newest, resampler->taps, output + 2 * n);
+        resampler->position += resampler->decimation;
+        n++;
+    }
+    resampler->position -= (uint64_t) chunk * resampler->interpolation;
+
+    return n;
+}
+
+static uint32_t resampler_run_farrow(resampler_t *resampler, uint32_t chunk, float *output)
+{
+    const uint32_t taps = resampler->taps;
+    const float *rows;
+    float *w = resampler->weights;
+    uint32_t n = 0;
+    uint32_t q;
+    size_t j;
+    uint64_t newest;
+    double s;
+    float mu;
+    float c0;
+    float c1;
+    float c2;
+    float c3;
+
+    while ((newest = resampler->position >> 32) < chunk) {
+        s = (double) (resampler->position & 0xffffffffu) * (RESAMPLER_FARROW_PHASES / RESAMPLER_ONE);
+        q = (uint32_t) s;
+        mu = (float) (s - q);
+
+        /* Cubic Lagrange through the table rows for q - 1 .. q + 2, the first of which is row q */
+        c0 = -mu * (mu - 1.0f) * (mu - 2.0f) / 6.0f;
+        c1 = (mu + 1.0f) * (mu - 1.0f) * (mu - 2.0f) / 2.0f;
+        c2 = -(mu + 1.0f) * mu * (mu - 2.0f) / 2.0f;
+        c3 = (mu + 1.0f) * mu * (mu - 1.0f) / 6.0f;
+        rows = resampler->bank + (size_t) q * taps;
+        for (j = 0; j < taps; j++) {
+            w[j] = c0 * rows[j] + c1 * rows[taps + j] + c2 * rows[2 * taps + j] + c3 * rows[3 * taps + j];
+        }
+
+        resampler_dot(w, resampler->re + newest, resampler->im + newest, taps, output + 2 * n);
+        resampler->position += resampler->step;
+        n++;
+    }
+    resampler->position -= (uint64_t) chunk << 32;
+
+    return n;
+}
+
+uint32_t resampler_process(resampler_t *resampler, const float *input, uint32_t count, float *output)
+{
+    const size_t history = resampler->taps - 1;
+    uint32_t produced = 0;
+    uint32_t chunk;
+    size_t i;
+
+    while (count > 0) {
+        chunk = count < RESAMPLER_CHUNK ? count : RESAMPLER_CHUNK;
+        for (i = 0; i < chunk; i++) {
+            resampler->re[history + i] = input[2 * i];
+            resampler->im[history + i] = input[2 * i + 1];
+        }
+
+        if (resampler->farrow) {
+            produced += resampler_run_farrow(resampler, chunk, output + 2 * (size_t) produced);
+        } else {
+            produced += resampler_run_polyphase(resampler, chunk, output + 2 * (size_t) produced);
+        }
+
+        memmove(resampler->re, resampler->re + chunk, history * sizeof(float));
+        memmove(resampler->im, resampler->im + chunk, history * sizeof(float));
+        input += 2 * (size_t) chunk;
+        count -= chunk;
+    }
+
+    return produced;
+}
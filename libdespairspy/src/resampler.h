@@ -0,0 +1,76 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <stdint.h>
+
+#include "airspy.h"
+
+/* Lowpass zero crossings on each side of the centre, scaled up when decimating */
+#define RESAMPLER_ZERO_CROSSINGS 16
+#define RESAMPLER_MAX_ZERO_CROSSINGS 64
+/* Polyphase banks have up to this many phases once the ratio is reduced, other ratios need the Farrow form */
+#define RESAMPLER_MAX_PHASES 1024
+#define RESAMPLER_MAX_TAPS 16384
+/* Phases of the Farrow form's table, interpolated in between with a cubic */
+#define RESAMPLER_FARROW_PHASES 64
+/* Taps are padded to a multiple of this, and the dot product keeps as many partial sums */
+#define RESAMPLER_LANES 8
+/* Input samples deinterleaved at a time behind the history */
+#define RESAMPLER_CHUNK 8192
+
+typedef struct airspy_resampler resampler_t;
+
+/*
+ * Complex float resampler. A rational ratio runs through a bank of
+ * precomputed polyphase filters, one per output phase; any other ratio
+ * through the Farrow form, which interpolates each output's taps from a
+ * finely sampled table of the same prototype. The prototype is a
+ * Blackman windowed sinc with its stopband at the lower of the two
+ * Nyquist rates. Filters are stored in input order and the dot product
+ * sums RESAMPLER_LANES lanes at once over split re/im history, so it
+ * vectorizes without reordering float sums.
+ */
+int resampler_create(resampler_t **resampler, const airspy_resampler_params_t *params);
+void resampler_free(resampler_t *resampler);
+
+/* Clears the history and restarts output timing at the next input sample */
+void resampler_reset(resampler_t *resampler);
+
+/* Upper bound on the outputs of count inputs */
+uint32_t resampler_max_output(const resampler_t *resampler, uint32_t count);
+
+/* Interleaved re/im in and out; returns the number of outputs */
+uint32_t resampler_process(resampler_t *resampler, const float *input, uint32_t count, float *output);
+
+/*
+ * Rational form only: times the next output from the stream position of
+ * the next input, so a gap keeps outputs on the grid of the input index
+ * scaled by the ratio. Returns the index of the next output, the first
+ * whose newest input is at or after input_index.
+ */
+uint64_t resampler_align(resampler_t *resampler, uint64_t input_index);
+
+#endif // RESAMPLER_H
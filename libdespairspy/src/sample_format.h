@@ -0,0 +1,58 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef SAMPLE_FORMAT_H
+#define SAMPLE_FORMAT_H
+
+#include <stdint.h>
+
+#include "airspy.h"
+
+/* Bytes per IQ sample handed to the callback */
+uint32_t sample_format_size(enum airspy_sample_type type);
+
+/*
+ * The callback's sample types, from converted int16 IQ. Output may
+ * overlap the input if it starts at the same address: every output
+ * element is written after the IQ pair it comes from was read, and is no
+ * larger than it.
+ */
+void sample_format_magnitude(const int16_t *iq, uint16_t *magnitude, uint32_t count);
+void sample_format_power(const int16_t *iq, uint32_t *power, uint32_t count);
+
+/*
+ * Block floating point: the smallest shift that brings the largest
+ * component into int8, for the whole block, with rounding and
+ * saturation. Returns the shift, the exponent of the block's scale.
+ */
+uint32_t sample_format_int8(const int16_t *iq, int8_t *output, uint32_t count);
+
+/*
+ * Real ADC samples, in place: offset binary codes to signed full scale
+ * int16, less dc, which is in output units. sample_format_sum() is for
+ * working out the DC.
+ */
+void sample_format_real(uint16_t *samples, uint32_t count, int32_t dc);
+uint64_t sample_format_sum(const uint16_t *samples, uint32_t count);
+
+#endif // SAMPLE_FORMAT_H
@@ -0,0 +1,1138 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "server.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#ifdef __linux__
+#include <linux/errqueue.h>
+#endif
+#if defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define SERVER_HAVE_ZEROCOPY
+#endif
+#endif
+
+#define SERVER_POLL_MS 100
+#define SERVER_VITA_HEADER 16
+#define SERVER_UDP_BATCH 64
+
+/* rtl_tcp's greeting: an R820T, which has 29 gain steps */
+#define SERVER_RTL_TUNER 5
+#define SERVER_RTL_GAINS 29
+
+typedef struct server_feed
+{
+    server_t *server;
+    uint32_t decimation;
+    struct airspy_subscriber *subscriber;
+} server_feed_t;
+
+typedef struct
+{
+    void *hold;
+    const int16_t *samples;
+    uint32_t sample_count;
+    uint64_t sample_index;
+    int zerocopy;       /* Some of it went out with MSG_ZEROCOPY */
+    uint32_t zc_end;    /* Zerocopy id after its last send */
+} server_entry_t;
+
+typedef struct
+{
+    int fd;             /* -1 while the slot is free */
+    int udp;
+    enum airspy_server_format format;
+    uint32_t decimation;
+    enum airspy_server_format next_format;
+    uint32_t next_decimation;
+
+    /* head to head + count are held, the first sent of them went out in full */
+    server_entry_t *queue;
+    uint32_t head;
+    uint32_t count;
+    uint32_t sent;
+    size_t offset;      /* Bytes of the entry being sent that went out */
+
+    /* The entry being sent, converted to the client's format */
+    uint8_t *scratch;
+    size_t scratch_size;
+    size_t scratch_bytes;
+    int converted;
+
+    int zerocopy;
+    uint32_t zc_next;
+    uint32_t zc_done;
+
+    uint8_t command[5];
+    uint32_t command_fill;
+    uint32_t packet_count;
+} server_client_t;
+
+struct server
+{
+    struct airspy_device *device;
+    fanout_t *fanout;
+    uint32_t flags;
+    uint32_t queue_depth;
+    uint32_t stream_id;
+    uint32_t offered;
+    uint32_t default_decimation;
+
+    server_feed_t feeds[SERVER_MAX_DECIMATION_BITS];
+    uint32_t feed_count;
+
+    int listen_fd;
+    int wake_fds[2];
+    pthread_t thread;
+    int thread_started;
+    volatile int exiting;
+
+    /* Queues and stats; the server thread alone changes anything else about a client */
+    pthread_mutex_t lock;
+    server_client_t *clients;
+    uint32_t client_slots;  /* max_clients, then the UDP destination */
+    airspy_server_stats_t stats;
+};
+
+#ifndef _WIN32
+
+static void server_wake(server_t *server)
+{
+    char c = 0;
+    ssize_t result;
+
+    result = write(server->wake_fds[1], &c, 1);
+    (void) result;
+}
+
+static int server_feed_block(struct airspy_device *device, void *ctx, airspy_transfer_t *transfer)
+{
+    server_feed_t *feed = (server_feed_t *) ctx;
+    server_t *server = feed->server;
+    server_client_t *client;
+    server_entry_t *entry;
+    void *hold;
+    int queued = 0;
+    uint32_t i;
+
+    (void) device;
+
+    pthread_mutex_lock(&server->lock);
+    for (i = 0; i < server->client_slots; i++) {
+        client = &server->clients[i];
+        if (client->fd < 0 || client->decimation != feed->decimation) {
+            continue;
+        }
+        if (client->count == server->queue_depth) {
+            server->stats.blocks_dropped++;
+            continue;
+        }
+
+        hold = fanout_hold(server->fanout);
+        if (NULL == hold) {
+            continue;
+        }
+
+        entry = &client->queue[(client->head + client->count) % server->queue_depth];
+        entry->hold = hold;
+        entry->samples = (const int16_t *) transfer->samples;
+        entry->sample_count = (uint32_t) transfer->sample_count;
+        entry->sample_index = transfer->sample_index;
+        entry->zerocopy = 0;
+        client->count++;
+        queued = 1;
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    if (queued) {
+        server_wake(server);
+    }
+
+    return 0;
+}
+
+static void server_put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t) (v >> 24);
+    p[1] = (uint8_t) (v >> 16);
+    p[2] = (uint8_t) (v >> 8);
+    p[3] = (uint8_t) v;
+}
+
+static size_t server_sample_bytes(enum airspy_server_format format)
+{
+    switch (format) {
+    case AIRSPY_SERVER_U8:
+        return 2;
+    case AIRSPY_SERVER_FLOAT32:
+        return 2 * sizeof(float);
+    default:
+        return 2 * sizeof(int16_t);
+    }
+}
+
+static int server_reserve(server_client_t *client, size_t bytes)
+{
+    uint8_t *scratch;
+
+    if (bytes <= client->scratch_size) {
+        return 0;
+    }
+
+    scratch = (uint8_t *) realloc(client->scratch, bytes);
+    if (NULL == scratch) {
+        return -1;
+    }
+    client->scratch = scratch;
+    client->scratch_size = bytes;
+
+    return 0;
+}
+
+/* count complex samples in format; big endian for VITA-49 */
+static void server_convert(const int16_t *input, uint32_t count, enum airspy_server_format format, int big_endian,
+    uint8_t *output)
+{
+    union { float f; uint32_t u; } v;
+    uint32_t i;
+
+    switch (format) {
+    case AIRSPY_SERVER_U8:
+        for (i = 0; i < count * 2; i++) {
+            output[i] = (uint8_t) ((input[i] >> 8) + 128);
+        }
+        break;
+
+    case AIRSPY_SERVER_FLOAT32:
+        for (i = 0; i < count * 2; i++) {
+            v.f = input[i] * (1.0f / 32768.0f);
+            if (big_endian) {
+                server_put_be32(output + i * 4, v.u);
+            } else {
+                memcpy(output + i * 4, &v.f, sizeof(float));
+            }
+        }
+        break;
+
+    default:
+        for (i = 0; i < count * 2; i++) {
+            output[i * 2] = (uint8_t) ((uint16_t) input[i] >> 8);
+            output[i * 2 + 1] = (uint8_t) input[i];
+        }
+        break;
+    }
+}
+
+static void server_retire(server_t *server, server_client_t *client)
+{
+    server_entry_t *entry;
+    void *holds[SERVER_UDP_BATCH];
+    uint32_t released = 0;
+    uint32_t i;
+
+    pthread_mutex_lock(&server->lock);
+    while (client->sent > 0 && released < SERVER_UDP_BATCH) {
+        entry = &client->queue[client->head];
+        if (entry->zerocopy && (int32_t) (client->zc_done - entry->zc_end) < 0) {
+            break;
+        }
+        holds[released++] = entry->hold;
+        client->head = (client->head + 1) % server->queue_depth;
+        client->count--;
+        client->sent--;
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    for (i = 0; i < released; i++) {
+        fanout_release(server->fanout, holds[i]);
+    }
+}
+
+/* Hands back everything queued from entry skip on */
+static void server_drop_queue(server_t *server, server_client_t *client, uint32_t skip)
+{
+    void *hold;
+
+    for (;;) {
+        pthread_mutex_lock(&server->lock);
+        if (client->count <= skip) {
+            pthread_mutex_unlock(&server->lock);
+            break;
+        }
+        client->count--;
+        hold = client->queue[(client->head + client->count) % server->queue_depth].hold;
+        pthread_mutex_unlock(&server->lock);
+
+        fanout_release(server->fanout, hold);
+    }
+}
+
+static void server_close_client(server_t *server, server_client_t *client)
+{
+    int fd = client->fd;
+
+    /* Stops the feeds queueing for it first */
+    pthread_mutex_lock(&server->lock);
+    client->fd = -1;
+    pthread_mutex_unlock(&server->lock);
+
+    client->sent = 0;
+    server_drop_queue(server, client, 0);
+    client->head = 0;
+    client->offset = 0;
+    client->converted = 0;
+
+    close(fd);
+}
+
+#ifdef SERVER_HAVE_ZEROCOPY
+static void server_completions(server_t *server, server_client_t *client)
+{
+    struct sock_extended_err *err;
+    struct cmsghdr *cm;
+    struct msghdr msg;
+    char control[128];
+
+    for (;;) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(client->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            break;
+        }
+
+        for (cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (!((SOL_IP == cm->cmsg_level && IP_RECVERR == cm->cmsg_type) ||
+                    (SOL_IPV6 == cm->cmsg_level && IPV6_RECVERR == cm->cmsg_type))) {
+                continue;
+            }
+            err = (struct sock_extended_err *) CMSG_DATA(cm);
+            if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+
+            /* ee_info to ee_data, inclusive; TCP completes them in order */
+            if (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                pthread_mutex_lock(&server->lock);
+                server->stats.zerocopy_copied += err->ee_data - err->ee_info + 1;
+                pthread_mutex_unlock(&server->lock);
+            }
+            if ((int32_t) (err->ee_data + 1 - client->zc_done) > 0) {
+                client->zc_done = err->ee_data + 1;
+            }
+        }
+    }
+}
+#endif
+
+/* Format and decimation changes wait for the entry being sent to go out in full */
+static void server_apply_changes(server_t *server, server_client_t *client)
+{
+    if (client->offset != 0 || client->converted) {
+        return;
+    }
+
+    client->format = client->next_format;
+    if (client->next_decimation != client->decimation) {
+        server_drop_queue(server, client, client->sent);
+        pthread_mutex_lock(&server->lock);
+        client->decimation = client->next_decimation;
+        pthread_mutex_unlock(&server->lock);
+    }
+}
+
+/* Returns -1 when the client has gone */
+static int server_send_tcp(server_t *server, server_client_t *client)
+{
+    server_entry_t *entry;
+    const uint8_t *data;
+    uint64_t bytes_sent = 0;
+    uint64_t blocks_sent = 0;
+    uint64_t zerocopy_sends = 0;
+    uint32_t count;
+    size_t length;
+    ssize_t n;
+    int flags;
+    int zerocopy;
+
+    for (;;) {
+        server_apply_changes(server, client);
+
+        pthread_mutex_lock(&server->lock);
+        count = client->count;
+        pthread_mutex_unlock(&server->lock);
+        if (client->sent == count) {
+            break;
+        }
+
+        entry = &client->queue[(client->head + client->sent) % server->queue_depth];
+        if (AIRSPY_SERVER_INT16 == client->format) {
+            data = (const uint8_t *) entry->samples;
+            length = (size_t) entry->sample_count * 2 * sizeof(int16_t);
+        } else {
+            if (!client->converted) {
+                client->scratch_bytes = entry->sample_count * server_sample_bytes(client->format);
+                if (server_reserve(client, client->scratch_bytes) != 0) {
+                    return -1;
+                }
+                server_convert(entry->samples, entry->sample_count, client->format, 0, client->scratch);
+                client->converted = 1;
+            }
+            data = client->scratch;
+            length = client->scratch_bytes;
+        }
+
+        flags = MSG_DONTWAIT | MSG_NOSIGNAL;
+        zerocopy = 0;
+#ifdef SERVER_HAVE_ZEROCOPY
+        if (client->zerocopy && data == (const uint8_t *) entry->samples && length - client->offset >= SERVER_ZEROCOPY_MIN) {
+            zerocopy = 1;
+            flags |= MSG_ZEROCOPY;
+        }
+#endif
+
+        n = send(client->fd, data + client->offset, length - client->offset, flags);
+        if (n < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            if (ENOBUFS == errno && zerocopy) {
+                /* Out of pinned memory allowance, the kernel's copy will do */
+                client->zerocopy = 0;
+                continue;
+            }
+            if (EAGAIN == errno || EWOULDBLOCK == errno) {
+                break;
+            }
+            return -1;
+        }
+
+        if (zerocopy) {
+            entry->zerocopy = 1;
+            entry->zc_end = ++client->zc_next;
+            zerocopy_sends++;
+        }
+        bytes_sent += (uint64_t) n;
+        client->offset += (size_t) n;
+        if (client->offset == length) {
+            client->offset = 0;
+            client->converted = 0;
+            client->sent++;
+            blocks_sent++;
+        }
+    }
+
+    pthread_mutex_lock(&server->lock);
+    server->stats.bytes_sent += bytes_sent;
+    server->stats.blocks_sent += blocks_sent;
+    server->stats.zerocopy_sends += zerocopy_sends;
+    pthread_mutex_unlock(&server->lock);
+
+    return 0;
+}
+
+/* Packs queued blocks into VITA-49 IF data packets; what the socket can't take is lost */
+static void server_send_udp(server_t *server, server_client_t *client)
+{
+#ifdef __linux__
+    struct mmsghdr messages[SERVER_UDP_BATCH];
+#endif
+    struct iovec iov[SERVER_UDP_BATCH];
+    server_entry_t *entry;
+    size_t sample_bytes;
+    size_t packet_size;
+    uint32_t per_packet;
+    uint32_t packets;
+    uint32_t batch;
+    uint32_t done;
+    uint32_t first;
+    uint32_t samples;
+    uint32_t count;
+    uint32_t words;
+    uint32_t i;
+    uint8_t *packet;
+    uint64_t sent = 0;
+    uint64_t dropped = 0;
+    uint64_t bytes = 0;
+    uint64_t blocks = 0;
+    int result;
+
+    sample_bytes = server_sample_bytes(client->format);
+    per_packet = (uint32_t) (SERVER_VITA_PAYLOAD / sample_bytes);
+    packet_size = SERVER_VITA_HEADER + per_packet * sample_bytes;
+
+    for (;;) {
+        pthread_mutex_lock(&server->lock);
+        count = client->count;
+        pthread_mutex_unlock(&server->lock);
+        if (client->sent == count) {
+            break;
+        }
+
+        entry = &client->queue[(client->head + client->sent) % server->queue_depth];
+        packets = (entry->sample_count + per_packet - 1) / per_packet;
+
+        for (done = 0; done < packets; done += batch) {
+            batch = packets - done < SERVER_UDP_BATCH ? packets - done : SERVER_UDP_BATCH;
+            if (server_reserve(client, batch * packet_size) != 0) {
+                dropped += packets - done;
+                break;
+            }
+
+            for (i = 0; i < batch; i++) {
+                first = (done + i) * per_packet;
+                samples = entry->sample_count - first < per_packet ? entry->sample_count - first : per_packet;
+                packet = client->scratch + i * packet_size;
+                words = (uint32_t) ((SERVER_VITA_HEADER + samples * sample_bytes) / 4);
+
+                /* IF data with stream ID, no class ID or trailer, no integer timestamp, a sample count one */
+                server_put_be32(packet, (1u << 28) | (1u << 20) | ((client->packet_count++ & 0xf) << 16) | words);
+                server_put_be32(packet + 4, server->stream_id);
+                server_put_be32(packet + 8, (uint32_t) ((entry->sample_index + first) >> 32));
+                server_put_be32(packet + 12, (uint32_t) (entry->sample_index + first));
+                server_convert(entry->samples + (size_t) first * 2, samples, client->format, 1, packet + SERVER_VITA_HEADER);
+
+                iov[i].iov_base = packet;
+                iov[i].iov_len = words * 4;
+#ifdef __linux__
+                memset(&messages[i], 0, sizeof(messages[i]));
+                messages[i].msg_hdr.msg_iov = &iov[i];
+                messages[i].msg_hdr.msg_iovlen = 1;
+#endif
+                bytes += words * 4;
+            }
+
+#ifdef __linux__
+            result = sendmmsg(client->fd, messages, batch, MSG_DONTWAIT);
+#else
+            for (result = 0; result < (int) batch; result++) {
+                if (send(client->fd, iov[result].iov_base, iov[result].iov_len, MSG_DONTWAIT) < 0) {
+                    break;
+                }
+            }
+            if (0 == result && batch > 0) {
+                result = -1;
+            }
+#endif
+            if (result < 0) {
+                result = 0;
+            }
+            sent += (uint64_t) result;
+            dropped += batch - (uint32_t) result;
+        }
+
+        client->sent++;
+        blocks++;
+    }
+
+    pthread_mutex_lock(&server->lock);
+    server->stats.udp_packets += sent;
+    server->stats.udp_dropped += dropped;
+    server->stats.bytes_sent += bytes;
+    server->stats.blocks_sent += blocks;
+    pthread_mutex_unlock(&server->lock);
+}
+
+static int server_offered(const server_t *server, uint32_t decimation)
+{
+    uint32_t bit;
+
+    for (bit = 0; bit < SERVER_MAX_DECIMATION_BITS; bit++) {
+        if ((1u << bit) == decimation) {
+            return (server->offered & (1u << bit)) != 0;
+        }
+    }
+
+    return 0;
+}
+
+static void server_command(server_t *server, server_client_t *client)
+{
+    uint32_t value;
+    uint32_t gain;
+
+    value = ((uint32_t) client->command[1] << 24) | ((uint32_t) client->command[2] << 16) |
+        ((uint32_t) client->command[3] << 8) | client->command[4];
+
+    switch (client->command[0]) {
+    case AIRSPY_SERVER_CMD_FORMAT:
+        if (value <= AIRSPY_SERVER_FLOAT32) {
+            client->next_format = (enum airspy_server_format) value;
+        }
+        return;
+
+    case AIRSPY_SERVER_CMD_DECIMATION:
+        if (server_offered(server, value)) {
+            client->next_decimation = value;
+        }
+        return;
+
+    default:
+        break;
+    }
+
+    if ((server->flags & AIRSPY_SERVER_CONTROL) == 0) {
+        return;
+    }
+
+    switch (client->command[0]) {
+    case 0x01:
+        airspy_set_freq(server->device, value);
+        break;
+
+    case 0x08:
+        airspy_set_lna_agc(server->device, value != 0);
+        airspy_set_mixer_agc(server->device, value != 0);
+        break;
+
+    case 0x0d:
+        /* Gain by index, spread over the linearity gain steps */
+        gain = value >= SERVER_RTL_GAINS ? SERVER_RTL_GAINS - 1 : value;
+        airspy_set_linearity_gain(server->device, (uint8_t) (gain * 21 / (SERVER_RTL_GAINS - 1)));
+        break;
+
+    default:
+        /* Sample rate, PPM and the rest are left alone */
+        break;
+    }
+}
+
+/* Returns -1 when the client has gone */
+static int server_receive(server_t *server, server_client_t *client)
+{
+    uint8_t buffer[256];
+    ssize_t n;
+    ssize_t i;
+
+    for (;;) {
+        n = recv(client->fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (0 == n) {
+            return -1;
+        }
+        if (n < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return EAGAIN == errno || EWOULDBLOCK == errno ? 0 : -1;
+        }
+
+        for (i = 0; i < n; i++) {
+            client->command[client->command_fill++] = buffer[i];
+            if (sizeof(client->command) == client->command_fill) {
+                server_command(server, client);
+                client->command_fill = 0;
+            }
+        }
+    }
+}
+
+static void server_accept(server_t *server)
+{
+    server_client_t *client = NULL;
+    uint8_t greeting[12];
+    ssize_t result;
+    uint32_t i;
+    int one = 1;
+    int fd;
+
+    fd = accept(server->listen_fd, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+
+    for (i = 0; i + 1 < server->client_slots; i++) {
+        if (server->clients[i].fd < 0) {
+            client = &server->clients[i];
+            break;
+        }
+    }
+    if (NULL == client) {
+        close(fd);
+        return;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    memcpy(greeting, "RTL0", 4);
+    server_put_be32(greeting + 4, SERVER_RTL_TUNER);
+    server_put_be32(greeting + 8, SERVER_RTL_GAINS);
+    result = send(fd, greeting, sizeof(greeting), MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (result != (ssize_t) sizeof(greeting)) {
+        close(fd);
+        return;
+    }
+
+    client->zerocopy = 0;
+#ifdef SERVER_HAVE_ZEROCOPY
+    client->zerocopy = setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0;
+#else
+    (void) one;
+#endif
+    client->udp = 0;
+    client->format = AIRSPY_SERVER_U8;
+    client->next_format = AIRSPY_SERVER_U8;
+    client->next_decimation = server->default_decimation;
+    client->head = 0;
+    client->count = 0;
+    client->sent = 0;
+    client->offset = 0;
+    client->converted = 0;
+    client->zc_next = 0;
+    client->zc_done = 0;
+    client->command_fill = 0;
+
+    pthread_mutex_lock(&server->lock);
+    client->decimation = server->default_decimation;
+    client->fd = fd;
+    pthread_mutex_unlock(&server->lock);
+}
+
+static void *server_thread(void *arg)
+{
+    server_t *server = (server_t *) arg;
+    server_client_t *client;
+    struct pollfd *fds;
+    uint32_t *slot_of;
+    uint32_t nfds;
+    uint32_t count;
+    uint32_t active;
+    uint32_t i;
+    uint32_t j;
+    char drain[64];
+    int gone;
+
+    fds = (struct pollfd *) calloc(server->client_slots + 2, sizeof(struct pollfd));
+    slot_of = (uint32_t *) calloc(server->client_slots + 2, sizeof(uint32_t));
+    if (NULL == fds || NULL == slot_of) {
+        free(fds);
+        free(slot_of);
+        return NULL;
+    }
+
+    while (!server->exiting) {
+        nfds = 0;
+        fds[nfds].fd = server->wake_fds[0];
+        fds[nfds].events = POLLIN;
+        nfds++;
+
+        active = 0;
+        for (i = 0; i < server->client_slots; i++) {
+            client = &server->clients[i];
+            if (client->fd < 0) {
+                continue;
+            }
+            if (!client->udp) {
+                active++;
+            }
+
+            pthread_mutex_lock(&server->lock);
+            count = client->count;
+            pthread_mutex_unlock(&server->lock);
+
+            fds[nfds].fd = client->fd;
+            fds[nfds].events = client->udp ? 0 : POLLIN;
+            if (client->sent < count) {
+                fds[nfds].events |= POLLOUT;
+            }
+            slot_of[nfds] = i;
+            nfds++;
+        }
+
+        if (server->listen_fd >= 0 && active + 1 < server->client_slots) {
+            fds[nfds].fd = server->listen_fd;
+            fds[nfds].events = POLLIN;
+            slot_of[nfds] = UINT32_MAX;
+            nfds++;
+        }
+
+        for (i = 0; i < nfds; i++) {
+            fds[i].revents = 0;
+        }
+        if (poll(fds, nfds, SERVER_POLL_MS) < 0 && errno != EINTR) {
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            while (read(server->wake_fds[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+
+        for (j = 1; j < nfds; j++) {
+            if (UINT32_MAX == slot_of[j]) {
+                if (fds[j].revents & POLLIN) {
+                    server_accept(server);
+                }
+                continue;
+            }
+
+            client = &server->clients[slot_of[j]];
+            gone = 0;
+
+#ifdef SERVER_HAVE_ZEROCOPY
+            if (client->zerocopy && (fds[j].revents & POLLERR)) {
+                server_completions(server, client);
+            }
+#endif
+            if (!client->udp && (fds[j].revents & (POLLIN | POLLHUP))) {
+                gone = server_receive(server, client) != 0;
+            }
+            if (!gone) {
+                if (client->udp) {
+                    server_send_udp(server, client);
+                } else if (fds[j].revents & POLLOUT) {
+                    gone = server_send_tcp(server, client) != 0;
+                }
+            }
+
+            if (gone) {
+                server_close_client(server, client);
+            } else {
+                server_retire(server, client);
+            }
+        }
+    }
+
+    free(fds);
+    free(slot_of);
+
+    return NULL;
+}
+
+static int server_resolve(const char *host, const char *port, int socktype, int passive, struct addrinfo **result)
+{
+    struct addrinfo hints;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = socktype;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+
+    return getaddrinfo(host, port, &hints, result);
+}
+
+static int server_listen(server_t *server, const airspy_server_params_t *params)
+{
+    struct addrinfo *info;
+    char port[8];
+    int one = 1;
+    int fd;
+
+    snprintf(port, sizeof(port), "%u", (unsigned) params->tcp_port);
+    if (server_resolve(params->address, port, SOCK_STREAM, 1, &info) != 0) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+    if (fd < 0) {
+        freeaddrinfo(info);
+        return AIRSPY_ERROR_OTHER;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    if (bind(fd, info->ai_addr, info->ai_addrlen) != 0 || listen(fd, 8) != 0) {
+        freeaddrinfo(info);
+        close(fd);
+        return AIRSPY_ERROR_BUSY;
+    }
+    freeaddrinfo(info);
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    server->listen_fd = fd;
+
+    return AIRSPY_SUCCESS;
+}
+
+static int server_connect_udp(server_t *server, const airspy_server_params_t *params)
+{
+    server_client_t *client = &server->clients[server->client_slots - 1];
+    struct addrinfo *info;
+    const char *colon;
+    char host[256];
+    size_t length;
+    int fd;
+
+    if (params->udp_format != AIRSPY_SERVER_INT16 && params->udp_format != AIRSPY_SERVER_FLOAT32) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    colon = strrchr(params->udp_destination, ':');
+    if (NULL == colon) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+    length = (size_t) (colon - params->udp_destination);
+    if (length >= sizeof(host)) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+    /* Brackets around an IPv6 address */
+    if (length >= 2 && '[' == params->udp_destination[0] && ']' == colon[-1]) {
+        memcpy(host, params->udp_destination + 1, length - 2);
+        host[length - 2] = '\0';
+    } else {
+        memcpy(host, params->udp_destination, length);
+        host[length] = '\0';
+    }
+
+    if (server_resolve(host, colon + 1, SOCK_DGRAM, 0, &info) != 0) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+    if (fd < 0 || connect(fd, info->ai_addr, info->ai_addrlen) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        freeaddrinfo(info);
+        return AIRSPY_ERROR_OTHER;
+    }
+    freeaddrinfo(info);
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    client->udp = 1;
+    client->format = params->udp_format;
+    client->next_format = params->udp_format;
+    client->decimation = params->udp_decimation > 1 ? params->udp_decimation : 1;
+    client->next_decimation = client->decimation;
+    client->fd = fd;
+
+    return AIRSPY_SUCCESS;
+}
+
+int server_create(server_t **server_out, fanout_t *fanout, struct airspy_device *device, const airspy_server_params_t *params)
+{
+    airspy_subscriber_params_t sub;
+    server_t *server;
+    uint32_t max_clients;
+    uint32_t udp_bits = 0;
+    uint32_t bit;
+    uint32_t i;
+    int result;
+
+    if (NULL == params || (0 == params->tcp_port && NULL == params->udp_destination) ||
+            (params->decimations >> SERVER_MAX_DECIMATION_BITS) != 0) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    if (params->udp_destination != NULL) {
+        for (bit = 0; bit < SERVER_MAX_DECIMATION_BITS; bit++) {
+            if ((1u << bit) == (params->udp_decimation > 1 ? params->udp_decimation : 1)) {
+                udp_bits = 1u << bit;
+            }
+        }
+        if (0 == udp_bits) {
+            return AIRSPY_ERROR_INVALID_PARAM;
+        }
+    }
+
+    server = (server_t *) calloc(1, sizeof(server_t));
+    if (NULL == server) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    max_clients = params->tcp_port != 0 ? (params->max_clients > 0 ? params->max_clients : SERVER_DEFAULT_CLIENTS) : 0;
+    server->device = device;
+    server->fanout = fanout;
+    server->flags = params->flags;
+    server->queue_depth = params->queue_depth > 0 ? params->queue_depth : SERVER_DEFAULT_QUEUE_DEPTH;
+    server->stream_id = params->stream_id;
+    server->listen_fd = -1;
+    server->wake_fds[0] = -1;
+    server->wake_fds[1] = -1;
+    server->client_slots = max_clients + 1;
+    pthread_mutex_init(&server->lock, NULL);
+
+    /* Whatever TCP clients are offered, and what the UDP destination takes */
+    server->offered = params->tcp_port != 0 ? (params->decimations != 0 ? params->decimations : 1) : 0;
+    for (bit = 0; bit < SERVER_MAX_DECIMATION_BITS; bit++) {
+        if (server->offered & (1u << bit)) {
+            server->default_decimation = 1u << bit;
+            break;
+        }
+    }
+    server->offered |= udp_bits;
+
+    server->clients = (server_client_t *) calloc(server->client_slots, sizeof(server_client_t));
+    if (NULL == server->clients) {
+        server_free(server);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+    for (i = 0; i < server->client_slots; i++) {
+        server->clients[i].fd = -1;
+        server->clients[i].queue = (server_entry_t *) calloc(server->queue_depth, sizeof(server_entry_t));
+        if (NULL == server->clients[i].queue) {
+            server_free(server);
+            return AIRSPY_ERROR_NO_MEM;
+        }
+    }
+
+    if (pipe(server->wake_fds) != 0) {
+        server->wake_fds[0] = -1;
+        server->wake_fds[1] = -1;
+        server_free(server);
+        return AIRSPY_ERROR_OTHER;
+    }
+    fcntl(server->wake_fds[0], F_SETFL, fcntl(server->wake_fds[0], F_GETFL) | O_NONBLOCK);
+    fcntl(server->wake_fds[1], F_SETFL, fcntl(server->wake_fds[1], F_GETFL) | O_NONBLOCK);
+
+    if (params->tcp_port != 0) {
+        result = server_listen(server, params);
+        if (result != AIRSPY_SUCCESS) {
+            server_free(server);
+            return result;
+        }
+    }
+
+    if (params->udp_destination != NULL) {
+        result = server_connect_udp(server, params);
+        if (result != AIRSPY_SUCCESS) {
+            server_free(server);
+            return result;
+        }
+    }
+
+    memset(&sub, 0, sizeof(sub));
+    sub.format = AIRSPY_SUBSCRIBER_IQ_INT16;
+    sub.flags = AIRSPY_SUBSCRIBER_INLINE | FANOUT_SUBSCRIBER_HOLD;
+    for (bit = 0; bit < SERVER_MAX_DECIMATION_BITS; bit++) {
+        if ((server->offered & (1u << bit)) == 0) {
+            continue;
+        }
+        server->feeds[server->feed_count].server = server;
+        server->feeds[server->feed_count].decimation = 1u << bit;
+        sub.decimation = 1u << bit;
+        result = fanout_subscribe(fanout, &sub, server_feed_block, &server->feeds[server->feed_count],
+            &server->feeds[server->feed_count].subscriber);
+        if (result != AIRSPY_SUCCESS) {
+            server_free(server);
+            return result;
+        }
+        server->feed_count++;
+    }
+
+    if (pthread_create(&server->thread, NULL, server_thread, server) != 0) {
+        server_free(server);
+        return AIRSPY_ERROR_THREAD;
+    }
+    server->thread_started = 1;
+
+    *server_out = server;
+
+    return AIRSPY_SUCCESS;
+}
+
+void server_free(server_t *server)
+{
+    uint32_t i;
+
+    if (NULL == server) {
+        return;
+    }
+
+    if (server->thread_started) {
+        server->exiting = 1;
+        server_wake(server);
+        pthread_join(server->thread, NULL);
+    }
+
+    if (server->clients != NULL) {
+        for (i = 0; i < server->client_slots; i++) {
+            if (server->clients[i].fd >= 0) {
+                server_close_client(server, &server->clients[i]);
+            }
+            free(server->clients[i].queue);
+            free(server->clients[i].scratch);
+        }
+        free(server->clients);
+    }
+
+    for (i = 0; i < server->feed_count; i++) {
+        fanout_unsubscribe(server->fanout, server->feeds[i].subscriber);
+    }
+
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+    }
+    if (server->wake_fds[0] >= 0) {
+        close(server->wake_fds[0]);
+        close(server->wake_fds[1]);
+    }
+
+    pthread_mutex_destroy(&server->lock);
+    free(server);
+}
+
+void server_get_stats(server_t *server, airspy_server_stats_t *stats)
+{
+    uint32_t i;
+
+    pthread_mutex_lock(&server->lock);
+    *stats = server->stats;
+    stats->clients = 0;
+    for (i = 0; i + 1 < server->client_slots; i++) {
+        if (server->clients[i].fd >= 0) {
+            stats->clients++;
+        }
+    }
+    pthread_mutex_unlock(&server->lock);
+}
+
+#else
+
+int server_create(server_t **server, fanout_t *fanout, struct airspy_device *device, const airspy_server_params_t *params)
+{
+    (void) server;
+    (void) fanout;
+    (void) device;
+    (void) params;
+    return AIRSPY_ERROR_OTHER;
+}
+
+void server_free(server_t *server)
+{
+    (void) server;
+}
+
+void server_get_stats(server_t *server, airspy_server_stats_t *stats)
+{
+    (void) server;
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdint.h>
+
+#include "airspy.h"
+#include "fanout.h"
+
+#define SERVER_DEFAULT_CLIENTS 8
+#define SERVER_DEFAULT_QUEUE_DEPTH 16
+#define SERVER_MAX_DECIMATION_BITS 8
+
+/* VITA-49 payload per packet, so that a packet fits an Ethernet frame */
+#define SERVER_VITA_PAYLOAD 1440
+
+/* Below this, pinning pages for MSG_ZEROCOPY costs more than the copy */
+#define SERVER_ZEROCOPY_MIN 16384
+
+typedef struct server server_t;
+
+/*
+ * Subscribes one int16 stage per offered decimation to fanout, with
+ * FANOUT_SUBSCRIBER_HOLD so that queued blocks are references into the
+ * stages' blocks, and starts the thread that accepts clients and sends
+ * to them. Only while not streaming.
+ */
+int server_create(server_t **server, fanout_t *fanout, struct airspy_device *device, const airspy_server_params_t *params);
+/* Disconnects everyone, hands back every held block and unsubscribes; only while not streaming */
+void server_free(server_t *server);
+
+void server_get_stats(server_t *server, airspy_server_stats_t *stats);
+
+#endif // SERVER_H
@@ -0,0 +1,619 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "sim.h"
+#include "airspy_commands.h"
+#include "packing.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define SIM_TONE_AMPLITUDE 1000.0
+#define SIM_NOISE_MASK 0xf
+
+typedef struct
+{
+    struct libusb_transfer *transfer;
+    uint64_t due_us;
+    int cancelled;
+} sim_entry_t;
+
+struct sim
+{
+    /* Held across a completion callback, like the libusb event lock */
+    pthread_mutex_t event_lock;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+
+    airspy_sim_params_t params;
+    uint32_t samplerate;
+    int packed;
+    int running;
+    int halted;
+    int departed;
+    uint32_t rng;
+
+    /* When the next block started to accumulate, and how late it will land */
+    uint64_t block_start_us;
+    uint32_t late_us;
+    uint32_t length;
+    uint64_t blocks;
+
+    /* In submission order; the first filled entries have landed and wait to be reaped */
+    sim_entry_t queue[SIM_MAX_QUEUED];
+    uint32_t queued;
+    uint32_t filled;
+
+    /* One block of the test tone in wire format, rebuilt when the block size or packing changes */
+    uint8_t *block;
+    uint32_t block_length;
+    int block_packed;
+
+    airspy_sim_stats_t stats;
+};
+
+#ifndef _WIN32
+
+static uint64_t sim_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* xorshift32; the fault pattern only has to be cheap and repeatable per seed */
+static uint32_t sim_random(sim_t *sim)
+{
+    sim->rng ^= sim->rng << 13;
+    sim->rng ^= sim->rng >> 17;
+    sim->rng ^= sim->rng << 5;
+    return sim->rng;
+}
+
+static uint32_t sim_jitter(sim_t *sim)
+{
+    if (0 == sim->params.jitter_us) {
+        return 0;
+    }
+    return sim_random(sim) % (sim->params.jitter_us + 1);
+}
+
+static uint64_t sim_block_us(const sim_t *sim, uint32_t length)
+{
+    uint64_t iq_samples;
+
+    iq_samples = sim->packed ? length / 3 : length / 4;
+    return iq_samples * 1000000 / sim->samplerate;
+}
+
+/*
+ * A real tone a little above fs/4, which the converter moves to fs/64 in
+ * the IQ output, plus a few LSBs of noise. The tone completes a whole
+ * number of cycles per block, so consecutive blocks join up.
+ */
+static int sim_build_block(sim_t *sim, uint32_t length)
+{
+    uint16_t *samples;
+    uint32_t count;
+    uint32_t cycles;
+    uint32_t i;
+    uint8_t *block;
+
+    count = sim->packed ? length / 12 * 8 : length / 2;
+    cycles = count / 4 + count / 64;
+
+    block = (uint8_t *) malloc(length);
+    samples = (uint16_t *) malloc(count * sizeof(uint16_t));
+    if (NULL == block || NULL == samples) {
+        free(block);
+        free(samples);
+        return -1;
+    }
+
+    for (i = 0; i < count; i++) {
+        samples[i] = (uint16_t) (2048.0 + SIM_TONE_AMPLITUDE * cos(2.0 * M_PI * cycles * i / count)) +
+            (sim_random(sim) & SIM_NOISE_MASK);
+    }
+
+    memset(block, 0, length);
+    if (sim->packed) {
+        pack_samples(samples, (uint32_t *) block, count);
+    } else {
+        memcpy(block, samples, count * sizeof(uint16_t));
+    }
+    free(samples);
+
+    free(sim->block);
+    sim->block = block;
+    sim->block_length = length;
+    sim->block_packed = sim->packed;
+
+    return 0;
+}
+
+static struct libusb_transfer *sim_dequeue(sim_t *sim, uint32_t index)
+{
+    struct libusb_transfer *transfer;
+
+    transfer = sim->queue[index].transfer;
+    memmove(&sim->queue[index], &sim->queue[index + 1], (sim->queued - index - 1) * sizeof(sim->queue[0]));
+    sim->queued--;
+
+    return transfer;
+}
+
+/* A halted endpoint fails whatever is queued straight away */
+static void sim_fail_halted(sim_t *sim, uint64_t now_us)
+{
+    sim_entry_t *entry;
+
+    while (sim->halted && sim->filled < sim->queued) {
+        entry = &sim->queue[sim->filled++];
+        entry->transfer->status = LIBUSB_TRANSFER_STALL;
+        entry->transfer->actual_length = 0;
+        entry->due_us = now_us;
+    }
+}
+
+/* Land a block in a transfer, or fail the transfer the way a fault would */
+static void sim_fill(sim_t *sim, sim_entry_t *entry, uint64_t due_us)
+{
+    struct libusb_transfer *transfer;
+    uint32_t draw;
+
+    transfer = entry->transfer;
+    transfer->actual_length = 0;
+    entry->due_us = due_us;
+
+    draw = sim_random(sim) % 1000000;
+    if (draw < sim->params.error_ppm) {
+        sim->stats.errors_injected++;
+        transfer->status = LIBUSB_TRANSFER_ERROR;
+        return;
+    }
+    draw -= sim->params.error_ppm;
+    if (draw < sim->params.stall_ppm) {
+        /* Like the real endpoint, it stays halted until cleared */
+        sim->stats.stalls_injected++;
+        sim->halted = 1;
+        transfer->status = LIBUSB_TRANSFER_STALL;
+        return;
+    }
+    draw -= sim->params.stall_ppm;
+
+    if (NULL == sim->block || sim->block_length != (uint32_t) transfer->length || sim->block_packed != sim->packed) {
+        if (sim_build_block(sim, transfer->length) != 0) {
+            transfer->status = LIBUSB_TRANSFER_ERROR;
+            return;
+        }
+    }
+
+    transfer->status = LIBUSB_TRANSFER_COMPLETED;
+    transfer->actual_length = transfer->length;
+    if (draw < sim->params.short_ppm) {
+        sim->stats.short_injected++;
+        transfer->actual_length = transfer->length / 2;
+    }
+    memcpy(transfer->buffer, sim->block, transfer->actual_length);
+
+    sim->stats.blocks_completed++;
+    sim->blocks++;
+    if (sim->params.disconnect_after != 0 && sim->blocks >= sim->params.disconnect_after) {
+        sim->departed = 1;
+    }
+}
+
+/*
+ * Run the device clock up to now_us. Each block that falls due lands in the
+ * oldest queued transfer that is still empty, or is lost if there is none,
+ * whether or not anyone is handling events at the time.
+ */
+static void sim_advance(sim_t *sim, uint64_t now_us)
+{
+    uint64_t block_us;
+    uint64_t due_us;
+    uint32_t length;
+
+    if (!sim->running || sim->departed) {
+        return;
+    }
+
+    sim_fail_halted(sim, now_us);
+
+    if (sim->params.flags & AIRSPY_SIM_UNPACED) {
+        while (sim->filled < sim->queued && !sim->halted && !sim->departed) {
+            sim_fill(sim, &sim->queue[sim->filled++], now_us);
+        }
+        sim_fail_halted(sim, now_us);
+        return;
+    }
+
+    while (!sim->departed) {
+        length = sim->filled < sim->queued ? (uint32_t) sim->queue[sim->filled].transfer->length : sim->length;
+        block_us = sim_block_us(sim, length);
+        due_us = sim->block_start_us + block_us + sim->late_us;
+        if (0 == block_us || due_us > now_us) {
+            break;
+        }
+
+        sim->block_start_us += block_us;
+        sim->late_us = sim_jitter(sim);
+
+        if (sim->filled < sim->queued && !sim->queue[sim->filled].cancelled && !sim->halted) {
+            sim_fill(sim, &sim->queue[sim->filled++], due_us);
+            sim_fail_halted(sim, now_us);
+        } else {
+            sim->stats.blocks_overrun++;
+        }
+    }
+}
+
+/* Due time of the next block, or 0 if nothing is going to land */
+static uint64_t sim_next_due(const sim_t *sim)
+{
+    uint32_t length;
+    uint64_t block_us;
+
+    if (!sim->running || sim->departed || (sim->params.flags & AIRSPY_SIM_UNPACED)) {
+        return 0;
+    }
+
+    length = sim->filled < sim->queued ? (uint32_t) sim->queue[sim->filled].transfer->length : sim->length;
+    block_us = sim_block_us(sim, length);
+    if (0 == block_us) {
+        return 0;
+    }
+
+    return sim->block_start_us + block_us + sim->late_us;
+}
+
+/* Take the next transfer to hand back: landed ones in order, then cancelled ones, then all once the device is gone */
+static struct libusb_transfer *sim_reap(sim_t *sim, uint64_t now_us)
+{
+    struct libusb_transfer *transfer;
+    uint32_t late_us;
+    uint32_t i;
+
+    if (sim->filled > 0) {
+        late_us = (uint32_t) (now_us - sim->queue[0].due_us);
+        if (late_us > sim->stats.max_late_us) {
+            sim->stats.max_late_us = late_us;
+        }
+        sim->filled--;
+        return sim_dequeue(sim, 0);
+    }
+
+    for (i = 0; i < sim->queued; i++) {
+        if (sim->queue[i].cancelled || sim->departed) {
+            transfer = sim_dequeue(sim, i);
+            transfer->status = sim->departed ? LIBUSB_TRANSFER_NO_DEVICE : LIBUSB_TRANSFER_CANCELLED;
+            transfer->actual_length = 0;
+            return transfer;
+        }
+    }
+
+    return NULL;
+}
+
+static void sim_wait_until(sim_t *sim, uint64_t until_us)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t) (until_us / 1000000);
+    ts.tv_nsec = (long) (until_us % 1000000) * 1000;
+    pthread_cond_timedwait(&sim->wake, &sim->lock, &ts);
+}
+
+static int sim_control(void *handle, uint8_t request_type, uint8_t request, uint16_t value, uint16_t index,
+    unsigned char *data, uint16_t length, unsigned int timeout)
+{
+    sim_t *sim = (sim_t *) handle;
+    static const char version[] = "AirSpy simulator";
+    uint32_t word;
+
+    (void) timeout;
+
+    pthread_mutex_lock(&sim->lock);
+
+    if (sim->departed) {
+        pthread_mutex_unlock(&sim->lock);
+        return LIBUSB_ERROR_NO_DEVICE;
+    }
+
+    if ((request_type & LIBUSB_ENDPOINT_IN) && data != NULL) {
+        memset(data, 0, length);
+    }
+
+    switch (request) {
+    case AIRSPY_RECEIVER_MODE:
+        sim_advance(sim, sim_now_us());
+        sim->running = (value == RECEIVER_MODE_RX);
+        sim->block_start_us = sim_now_us();
+        sim->late_us = sim_jitter(sim);
+        pthread_cond_broadcast(&sim->wake);
+        break;
+
+    case AIRSPY_GET_SAMPLERATES:
+        /* A single rate is on offer, any other can be set by value */
+        word = index == 0 ? 1 : sim->params.samplerate;
+        if (NULL != data && length >= sizeof(word)) {
+            memcpy(data, &word, sizeof(word));
+        }
+        break;
+
+    case AIRSPY_SET_SAMPLERATE:
+        if (index == 0) {
+            sim->samplerate = sim->params.samplerate;
+        } else if (index >= 1000) {
+            sim->samplerate = (uint32_t) index * 1000;
+        } else {
+            pthread_mutex_unlock(&sim->lock);
+            return LIBUSB_ERROR_INVALID_PARAM;
+        }
+        if (NULL != data && length > 0) {
+            data[0] = 1;
+        }
+        break;
+
+    case AIRSPY_SET_PACKING:
+        sim->packed = (index != 0);
+        if (NULL != data && length > 0) {
+            data[0] = 1;
+        }
+        break;
+
+    case AIRSPY_VERSION_STRING_READ:
+        if (NULL != data) {
+            memcpy(data, version, length < sizeof(version) ? length : sizeof(version));
+        }
+        break;
+
+    default:
+        /* Everything else is accepted and reads back zeroes */
+        break;
+    }
+
+    pthread_mutex_unlock(&sim->lock);
+
+    return length;
+}
+
+static int sim_submit(void *handle, struct libusb_transfer *transfer)
+{
+    sim_t *sim = (sim_t *) handle;
+
+    pthread_mutex_lock(&sim->lock);
+
+    if (sim->departed) {
+        pthread_mutex_unlock(&sim->lock);
+        return LIBUSB_ERROR_NO_DEVICE;
+    }
+
+    if (sim->queued == SIM_MAX_QUEUED) {
+        pthread_mutex_unlock(&sim->lock);
+        return LIBUSB_ERROR_BUSY;
+    }
+
+    /* Blocks due before this transfer existed can't land in it */
+    sim_advance(sim, sim_now_us());
+
+    sim->queue[sim->queued].transfer = transfer;
+    sim->queue[sim->queued].cancelled = 0;
+    sim->queued++;
+    sim->length = transfer->length;
+
+    pthread_cond_broadcast(&sim->wake);
+    pthread_mutex_unlock(&sim->lock);
+
+    return 0;
+}
+
+static int sim_cancel(void *handle, struct libusb_transfer *transfer)
+{
+    sim_t *sim = (sim_t *) handle;
+    uint32_t i;
+    int result;
+
+    result = LIBUSB_ERROR_NOT_FOUND;
+
+    pthread_mutex_lock(&sim->lock);
+    sim_advance(sim, sim_now_us());
+
+    /* A transfer a block already landed in completes normally */
+    for (i = sim->filled; i < sim->queued; i++) {
+        if (sim->queue[i].transfer == transfer) {
+            sim->queue[i].cancelled = 1;
+            result = 0;
+            pthread_cond_broadcast(&sim->wake);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sim->lock);
+
+    return result;
+}
+
+static int sim_clear_halt(void *handle, unsigned char endpoint)
+{
+    sim_t *sim = (sim_t *) handle;
+    int result;
+
+    (void) endpoint;
+
+    pthread_mutex_lock(&sim->lock);
+    result = sim->departed ? LIBUSB_ERROR_NO_DEVICE : 0;
+    sim->halted = 0;
+    pthread_mutex_unlock(&sim->lock);
+
+    return result;
+}
+
+/* Hands back at most one transfer per call, waiting up to timeout for one */
+static int sim_handle_events(void *handle, struct timeval *timeout)
+{
+    sim_t *sim = (sim_t *) handle;
+    struct libusb_transfer *transfer;
+    uint64_t now_us;
+    uint64_t deadline_us;
+    uint64_t wait_us;
+    uint64_t due_us;
+
+    transfer = NULL;
+    deadline_us = sim_now_us();
+    if (NULL != timeout) {
+        deadline_us += (uint64_t) timeout->tv_sec * 1000000 + timeout->tv_usec;
+    }
+
+    pthread_mutex_lock(&sim->event_lock);
+    pthread_mutex_lock(&sim->lock);
+
+    for (;;) {
+        now_us = sim_now_us();
+
+        sim_advance(sim, now_us);
+        transfer = sim_reap(sim, now_us);
+        if (NULL != transfer || now_us >= deadline_us) {
+            break;
+        }
+
+        wait_us = deadline_us;
+        due_us = sim_next_due(sim);
+        if (due_us != 0 && due_us < wait_us) {
+            wait_us = due_us;
+        }
+        sim_wait_until(sim, wait_us);
+    }
+
+    pthread_mutex_unlock(&sim->lock);
+
+    if (NULL != transfer) {
+        transfer->callback(transfer);
+    }
+
+    pthread_mutex_unlock(&sim->event_lock);
+
+    return 0;
+}
+
+int sim_open(sim_t **out, const airspy_sim_params_t *params)
+{
+    sim_t *sim;
+    pthread_condattr_t attr;
+
+    *out = NULL;
+
+    sim = (sim_t *) calloc(1, sizeof(sim_t));
+    if (NULL == sim) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    if (NULL != params) {
+        sim->params = *params;
+    }
+    if (0 == sim->params.samplerate) {
+        sim->params.samplerate = SIM_DEFAULT_SAMPLERATE;
+    }
+    sim->samplerate = sim->params.samplerate;
+    sim->rng = sim->params.seed != 0 ? sim->params.seed : 1;
+
+    pthread_mutex_init(&sim->event_lock, NULL);
+    pthread_mutex_init(&sim->lock, NULL);
+
+    /* Deadlines are on the monotonic clock */
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&sim->wake, &attr);
+    pthread_condattr_destroy(&attr);
+
+    *out = sim;
+
+    return AIRSPY_SUCCESS;
+}
+
+void sim_close(sim_t *sim)
+{
+    if (NULL == sim) {
+        return;
+    }
+
+    pthread_cond_destroy(&sim->wake);
+    pthread_mutex_destroy(&sim->lock);
+    pthread_mutex_destroy(&sim->event_lock);
+    free(sim->block);
+    free(sim);
+}
+
+void sim_get_stats(sim_t *sim, airspy_sim_stats_t *stats)
+{
+    pthread_mutex_lock(&sim->lock);
+    *stats = sim->stats;
+    pthread_mutex_unlock(&sim->lock);
+}
+
+const transport_ops_t sim_transport = {
+    sim_control,
+    sim_submit,
+    sim_cancel,
+    sim_clear_halt,
+    sim_handle_events
+};
+
+#else
+
+int sim_open(sim_t **out, const airspy_sim_params_t *params)
+{
+    (void) params;
+    *out = NULL;
+    return AIRSPY_ERROR_OTHER;
+}
+
+void sim_close(sim_t *sim)
+{
+    (void) sim;
+}
+
+void sim_get_stats(sim_t *sim, airspy_sim_stats_t *stats)
+{
+    (void) sim;
+    memset(stats, 0, sizeof(*stats));
+}
+
+const transport_ops_t sim_transport = {
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+#endif
@@ -0,0 +1,50 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef SIM_H
+#define SIM_H
+
+#include "airspy.h"
+#include "transport.h"
+
+#define SIM_DEFAULT_SAMPLERATE 10000000
+#define SIM_MAX_QUEUED 64
+
+typedef struct sim sim_t;
+
+/*
+ * An AirSpy in software behind the transport_ops_t interface. The firmware
+ * side answers the vendor requests the library relies on (sample rates,
+ * packing, receiver mode, version string) and accepts the rest. Once the
+ * receiver runs, one block per transfer length falls due at the simulated
+ * rate and lands in the oldest empty queued transfer; with none queued it is
+ * lost, like a device FIFO overrun. Landed transfers are handed back by
+ * handle_events(), so a host slow to reap them runs out of queued transfers
+ * just as it would on the bus.
+ */
+int sim_open(sim_t **sim, const airspy_sim_params_t *params);
+void sim_close(sim_t *sim);
+void sim_get_stats(sim_t *sim, airspy_sim_stats_t *stats);
+
+extern const transport_ops_t sim_transport;
+
+#endif // SIM_H
@@ -0,0 +1,301 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "squelch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* |x|^2 of a full scale int16 sample, 0 dBFS */
+#define SQUELCH_FULL_SCALE (32768.0 * 32768.0)
+
+struct squelch
+{
+    uint32_t window;
+    uint32_t pre;
+    uint32_t post;
+    double ratio;
+    uint32_t floor_ms;
+    double alpha;
+
+    double floor;
+    int floor_valid;
+    uint64_t window_sum;
+    uint32_t window_fill;
+    uint64_t next_index;
+
+    /* The gate: open from start, until hold at least */
+    int open;
+    int opening;
+    uint64_t start;
+    uint64_t hold;
+    uint64_t emitted;
+
+    /* Flags and lost samples waiting for the next segment */
+    uint32_t flags;
+    uint64_t dropped;
+
+    /* The last pre + window samples before the block, for pre-padding */
+    int16_t *history;
+    uint32_t history_size;
+    uint32_t history_count;
+
+    airspy_squelch_stats_t stats;
+};
+
+int squelch_create(squelch_t **out, const airspy_squelch_params_t *params)
+{
+    squelch_t *squelch;
+
+    if (params->window > SQUELCH_MAX_WINDOW || params->pre_samples > SQUELCH_MAX_WINDOW * 16) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    squelch = (squelch_t *) calloc(1, sizeof(squelch_t));
+    if (NULL == squelch) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    squelch->window = params->window != 0 ? params->window : SQUELCH_DEFAULT_WINDOW;
+    squelch->pre = params->pre_samples;
+    squelch->post = params->post_samples;
+    squelch->ratio = pow(10.0, params->snr_db / 10.0);
+    squelch->floor_ms = params->floor_ms != 0 ? params->floor_ms : SQUELCH_DEFAULT_FLOOR_MS;
+
+    squelch->history_size = squelch->pre + squelch->window;
+    squelch->history = (int16_t *) malloc((size_t) squelch->history_size * 2 * sizeof(int16_t));
+    if (NULL == squelch->history) {
+        free(squelch);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    *out = squelch;
+    return AIRSPY_SUCCESS;
+}
+
+void squelch_free(squelch_t *squelch)
+{
+    if (squelch != NULL) {
+        free(squelch->history);
+        free(squelch);
+    }
+}
+
+void squelch_reset(squelch_t *squelch, double sample_rate)
+{
+    squelch->alpha = squelch->window / (squelch->floor_ms * sample_rate / 1000.0);
+    if (squelch->alpha > 1.0) {
+        squelch->alpha = 1.0;
+    }
+    squelch->floor_valid = 0;
+    squelch->window_sum = 0;
+    squelch->window_fill = 0;
+    squelch->next_index = 0;
+    squelch->open = 0;
+    squelch->emitted = 0;
+    squelch->flags = 0;
+    squelch->dropped = 0;
+    squelch->history_count = 0;
+    memset(&squelch->stats, 0, sizeof(squelch->stats));
+}
+
+/* Samples from..to of the stream, which lie in the history and the block starting at index */
+static void squelch_emit(squelch_t *squelch, const airspy_transfer_t *transfer, uint64_t from, uint64_t to, int end,
+    squelch_emit_fn emit, void *ctx)
+{
+    airspy_transfer_t segment;
+    uint64_t index = transfer->sample_index;
+    uint64_t split;
+
+    memset(&segment, 0, sizeof(segment));
+
+    do {
+        split = from < index ? (to < index ? to : index) : to;
+
+        segment.sample_index = from;
+        segment.sample_count = (int) (split - from);
+        segment.flags = squelch->flags;
+        segment.dropped_samples = squelch->dropped;
+        if (squelch->opening) {
+            segment.flags |= AIRSPY_TRANSFER_BURST_START;
+        }
+        if (end && split == to) {
+            segment.flags |= AIRSPY_TRANSFER_BURST_END;
+        }
+        if (from < index) {
+            segment.samples = squelch->history + (squelch->history_count - (index - from)) * 2;
+        } else {
+            segment.samples = (int16_t *) transfer->samples + (from - index) * 2;
+        }
+
+        squelch->opening = 0;
+        squelch->flags = 0;
+        squelch->dropped = 0;
+        squelch->stats.samples_forwarded += split - from;
+        emit(ctx, &segment);
+
+        from = split;
+    } while (from < to);
+
+    squelch->emitted = to;
+}
+
+/*
+ * A window ending at end was judged. A gap of pre samples after the hold
+ * can no longer be bridged by the windows still to come, so the burst is
+ * over.
+ */
+static void squelch_window(squelch_t *squelch, const airspy_transfer_t *transfer, uint64_t end,
+    squelch_emit_fn emit, void *ctx)
+{
+    uint64_t start = end - squelch->window;
+    uint64_t oldest = transfer->sample_index - squelch->history_count;
+    double power = (double) squelch->window_sum / squelch->window;
+    int active;
+
+    if (!squelch->floor_valid) {
+        squelch->floor = power;
+        squelch->floor_valid = 1;
+    }
+    active = power > squelch->floor * squelch->ratio;
+    squelch->floor += (power - squelch->floor) * (active ? squelch->alpha / SQUELCH_BURST_SLOWDOWN : squelch->alpha);
+
+    if (active) {
+        if (!squelch->open) {
+            start = start > squelch->pre ? start - squelch->pre : 0;
+            start = start > oldest ? start : oldest;
+            squelch->start = start > squelch->emitted ? start : squelch->emitted;
+            squelch->open = 1;
+            squelch->opening = 1;
+            squelch->stats.bursts++;
+        }
+        if (end + squelch->post > squelch->hold) {
+            squelch->hold = end + squelch->post;
+        }
+    } else if (squelch->open && squelch->hold + squelch->pre <= end) {
+        squelch_emit(squelch, transfer, squelch->start, squelch->hold > squelch->start ? squelch->hold : squelch->start,
+            1, emit, ctx);
+        squelch->open = 0;
+    }
+}
+
+static void squelch_history(squelch_t *squelch, const int16_t *iq, uint32_t count)
+{
+    uint32_t keep;
+
+    if (count >= squelch->history_size) {
+        memcpy(squelch->history, iq + (size_t) (count - squelch->history_size) * 2,
+            (size_t) squelch->history_size * 2 * sizeof(int16_t));
+        squelch->history_count = squelch->history_size;
+        return;
+    }
+
+    keep = squelch->history_size - count;
+    if (keep > squelch->history_count) {
+        keep = squelch->history_count;
+    }
+    memmove(squelch->history, squelch->history + (size_t) (squelch->history_count - keep) * 2,
+        (size_t) keep * 2 * sizeof(int16_t));
+    memcpy(squelch->history + (size_t) keep * 2, iq, (size_t) count * 2 * sizeof(int16_t));
+    squelch->history_count = keep + count;
+}
+
+void squelch_process(squelch_t *squelch, const airspy_transfer_t *transfer, squelch_emit_fn emit, void *ctx)
+{
+    const int16_t *iq = (const int16_t *) transfer->samples;
+    const int16_t *p;
+    uint32_t count = (uint32_t) transfer->sample_count;
+    uint64_t index = transfer->sample_index;
+    uint64_t end;
+    uint64_t sum;
+    uint32_t kept;
+    uint32_t used;
+    uint32_t take;
+    size_t i;
+
+    if (index != squelch->next_index || (transfer->flags & AIRSPY_TRANSFER_DISCONTINUITY)) {
+        /* Neither windows nor padding span lost samples; a burst cut short this way has no end segment */
+        squelch->window_sum = 0;
+        squelch->window_fill = 0;
+        squelch->history_count = 0;
+        squelch->open = 0;
+        squelch->flags |= transfer->flags & AIRSPY_TRANSFER_DISCONTINUITY;
+        squelch->dropped += transfer->dropped_samples;
+    }
+    squelch->next_index = index + count;
+    squelch->stats.samples_in += count;
+
+    used = 0;
+    while (used < count) {
+        take = squelch->window - squelch->window_fill;
+        if (take > count - used) {
+            take = count - used;
+        }
+
+        /* size_t indices off a base pointer; uint32_t ones that may wrap keep gcc from vectorizing */
+        p = iq + (size_t) used * 2;
+        sum = 0;
+        for (i = 0; i < take; i++) {
+            int32_t re = p[2 * i];
+            int32_t im = p[2 * i + 1];
+
+            sum += (uint32_t) (re * re) + (uint32_t) (im * im);
+        }
+        squelch->window_sum += sum;
+        squelch->window_fill += take;
+        used += take;
+
+        if (squelch->window_fill == squelch->window) {
+            squelch_window(squelch, transfer, index + used, emit, ctx);
+            squelch->window_sum = 0;
+            squelch->window_fill = 0;
+        }
+    }
+
+    /*
+     * What is open so far goes out now, except what the history keeps: the
+     * burst may end before the next block, and its end segment shouldn't
+     * come out empty.
+     */
+    if (squelch->open) {
+        end = index + count;
+        kept = squelch->history_count + count < squelch->history_size ? squelch->history_count + count : squelch->history_size;
+        end -= kept;
+        if (squelch->hold < end) {
+            end = squelch->hold;
+        }
+        if (end > squelch->start) {
+            squelch_emit(squelch, transfer, squelch->start, end, 0, emit, ctx);
+            squelch->start = end;
+        }
+    }
+
+    squelch_history(squelch, iq, count);
+}
+
+void squelch_get_stats(squelch_t *squelch, airspy_squelch_stats_t *stats)
+{
+    memcpy(stats, &squelch->stats, sizeof(*stats));
+    stats->noise_floor_db = squelch->floor_valid ? (float) (10.0 * log10(squelch->floor / SQUELCH_FULL_SCALE + 1e-20)) : NAN;
+}
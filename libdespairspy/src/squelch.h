@@ -0,0 +1,64 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef SQUELCH_H
+#define SQUELCH_H
+
+#include <stdint.h>
+
+#include "airspy.h"
+
+#define SQUELCH_DEFAULT_WINDOW 256
+#define SQUELCH_MAX_WINDOW 65536
+#define SQUELCH_DEFAULT_FLOOR_MS 1000
+/* The floor follows windows above the threshold this much slower, so a lasting rise in the noise wins out eventually */
+#define SQUELCH_BURST_SLOWDOWN 64
+
+typedef struct squelch squelch_t;
+
+typedef void (*squelch_emit_fn)(void *ctx, airspy_transfer_t *segment);
+
+/*
+ * Gates the converted stream on the mean power of fixed windows against
+ * an adaptive noise floor: an exponential average of the windows' power,
+ * which only follows windows above the threshold SQUELCH_BURST_SLOWDOWN
+ * times slower. Every window above the threshold opens the gate for
+ * pre_samples before it to post_samples after it. Pre-padding that lies
+ * before the block comes from a copy of the previous block's tail.
+ */
+int squelch_create(squelch_t **squelch, const airspy_squelch_params_t *params);
+void squelch_free(squelch_t *squelch);
+
+/* Before a new stream: sample indices, the floor and the counters start over */
+void squelch_reset(squelch_t *squelch, double sample_rate);
+
+/*
+ * Calls emit for every run of samples of the block to forward, in order.
+ * A segment points into the block or into the squelch's copy of the
+ * previous block's tail; either is only valid during the call.
+ */
+void squelch_process(squelch_t *squelch, const airspy_transfer_t *transfer, squelch_emit_fn emit, void *ctx);
+
+void squelch_get_stats(squelch_t *squelch, airspy_squelch_stats_t *stats);
+
+#endif // SQUELCH_H
@@ -0,0 +1,444 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "sweep.h"
+#include "fft_float.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define SWEEP_MIN_FFT_SIZE 64
+#define SWEEP_FULL_SCALE 32768.0
+
+enum sweep_state
+{
+    SWEEP_STATE_SETTLE,
+    SWEEP_STATE_DWELL,
+    SWEEP_STATE_RETUNE
+};
+
+typedef struct {
+    uint64_t sweep_index;
+    uint32_t step;
+    int16_t *samples;
+} sweep_job_t;
+
+struct sweep
+{
+    struct airspy_device *device;
+    airspy_sweep_cb_fn callback;
+    void *ctx;
+
+    uint32_t freq_start_hz;
+    double step_hz;
+    double bin_width_hz;
+    uint32_t step_count;
+    uint32_t fft_size;
+    uint32_t averages;
+    uint32_t bins_per_step;
+    uint32_t dwell_samples;
+    uint32_t settle_samples;
+
+    /* Streaming side, only touched from the airspy_do_rx() thread */
+    enum sweep_state state;
+    uint32_t step;
+    uint64_t sweep_index;
+    uint32_t settle_remaining;
+    uint32_t dwell_fill;
+    sweep_job_t *job;
+
+    /* Shared between both sides, protected by lock */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    sweep_job_t jobs[SWEEP_JOB_COUNT];
+    sweep_job_t *free_jobs[SWEEP_JOB_COUNT];
+    int free_count;
+    sweep_job_t *ready_jobs[SWEEP_JOB_COUNT];
+    int ready_head;
+    int ready_count;
+    uint32_t dropped_steps;
+    int exit;
+    volatile int stop_requested;
+
+    /* Worker side */
+    pthread_t thread;
+    fft_float_t fft;
+    float *window;
+    float *frame;
+    float *accum;
+    float *spectrum;
+    float power_scale;
+    uint64_t spectrum_index;
+    int spectrum_pending;
+};
+
+static void sweep_emit(sweep_t *sweep)
+{
+    airspy_sweep_result_t result;
+
+    pthread_mutex_lock(&sweep->lock);
+    result.dropped_steps = sweep->dropped_steps;
+    sweep->dropped_steps = 0;
+    pthread_mutex_unlock(&sweep->lock);
+
+    result.sweep_index = sweep->spectrum_index;
+    result.freq_start_hz = sweep->freq_start_hz;
+    result.bin_width_hz = sweep->bin_width_hz;
+    result.bin_count = sweep->step_count * sweep->bins_per_step;
+    result.power_db = sweep->spectrum;
+
+    if (0 != sweep->callback(sweep->device, sweep->ctx, &result)) {
+        sweep->stop_requested = 1;
+    }
+
+    sweep->spectrum_pending = 0;
+}
+
+/*
+ * Average the power spectrum of one dwell and place the usable centre bins
+ * in the stitched spectrum.
+ */
+static void sweep_process_job(sweep_t *sweep, sweep_job_t *job)
+{
+    uint32_t i;
+    uint32_t frame;
+    uint32_t fft_size;
+    uint32_t first_bin;
+    const int16_t *samples;
+    float *out;
+    float re;
+    float im;
+
+    fft_size = sweep->fft_size;
+
+    if (sweep->spectrum_pending && sweep->spectrum_index != job->sweep_index) {
+        /* The last step of the previous sweep was dropped */
+        sweep_emit(sweep);
+    }
+
+    if (!sweep->spectrum_pending) {
+        for (i = 0; i < sweep->step_count * sweep->bins_per_step; i++)
+        {
+            sweep->spectrum[i] = NAN;
+        }
+        sweep->spectrum_index = job->sweep_index;
+        sweep->spectrum_pending = 1;
+    }
+
+    memset(sweep->accum, 0, fft_size * sizeof(float));
+
+    samples = job->samples;
+    for (frame = 0; frame < sweep->averages; frame++)
+    {
+        for (i = 0; i < fft_size; i++)
+        {
+            sweep->frame[2 * i + 0] = samples[2 * i + 0] * sweep->window[i];
+            sweep->frame[2 * i + 1] = samples[2 * i + 1] * sweep->window[i];
+        }
+
+        fft_float_forward(&sweep->fft, sweep->frame);
+
+        for (i = 0; i < fft_size; i++)
+        {
+            re = sweep->frame[2 * i + 0];
+            im = sweep->frame[2 * i + 1];
+            sweep->accum[i] += re * re + im * im;
+        }
+
+        samples += 2 * fft_size;
+    }
+
+    /* Bin 0 of the FFT is the tuned frequency, so the step is centred on it */
+    first_bin = fft_size - sweep->bins_per_step / 2;
+    out = sweep->spectrum + job->step * sweep->bins_per_step;
+    for (i = 0; i < sweep->bins_per_step; i++)
+    {
+        out[i] = 10.0f * log10f(sweep->accum[(first_bin + i) & (fft_size - 1)] * sweep->power_scale + 1e-20f);
+    }
+
+    if (job->step == sweep->step_count - 1) {
+        sweep_emit(sweep);
+    }
+}
+
+static void *sweep_worker(void *arg)
+{
+    sweep_t *sweep = (sweep_t *)arg;
+    sweep_job_t *job;
+
+    pthread_mutex_lock(&sweep->lock);
+    while (!sweep->exit)
+    {
+        if (0 == sweep->ready_count) {
+            pthread_cond_wait(&sweep->cond, &sweep->lock);
+            continue;
+        }
+
+        job = sweep->ready_jobs[sweep->ready_head];
+        sweep->ready_head = (sweep->ready_head + 1) % SWEEP_JOB_COUNT;
+        sweep->ready_count--;
+        pthread_mutex_unlock(&sweep->lock);
+
+        if (!sweep->stop_requested) {
+            sweep_process_job(sweep, job);
+        }
+
+        pthread_mutex_lock(&sweep->lock);
+        sweep->free_jobs[sweep->free_count++] = job;
+    }
+    pthread_mutex_unlock(&sweep->lock);
+
+    return NULL;
+}
+
+static void sweep_release(sweep_t *sweep)
+{
+    int i;
+
+    fft_float_free(&sweep->fft);
+    for (i = 0; i < SWEEP_JOB_COUNT; i++)
+    {
+        free(sweep->jobs[i].samples);
+    }
+    free(sweep->window);
+    free(sweep->frame);
+    free(sweep->accum);
+    free(sweep->spectrum);
+    free(sweep);
+}
+
+int sweep_init(sweep_t **sweep_out, const airspy_sweep_params_t *params, uint32_t samplerate, uint32_t settle_samples,
+        struct airspy_device *device, airspy_sweep_cb_fn callback, void *ctx)
+{
+    sweep_t *sweep;
+    double step_hz;
+    double window_sum;
+    uint32_t i;
+
+    *sweep_out = NULL;
+
+    if (params->fft_size < SWEEP_MIN_FFT_SIZE || params->fft_size > FFT_FLOAT_MAX_SIZE ||
+            (params->fft_size & (params->fft_size - 1)) != 0 ||
+            params->averages == 0 || params->freq_start_hz >= params->freq_stop_hz || samplerate == 0)
+    {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    if (NULL == (sweep = (sweep_t *)calloc(1, sizeof(sweep_t)))) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    sweep->device = device;
+    sweep->callback = callback;
+    sweep->ctx = ctx;
+    sweep->freq_start_hz = params->freq_start_hz;
+    sweep->fft_size = params->fft_size;
+    sweep->averages = params->averages;
+    sweep->dwell_samples = params->fft_size * params->averages;
+    sweep->settle_samples = settle_samples;
+    sweep->bin_width_hz = (double)samplerate / params->fft_size;
+
+    /* Round the step to whole bins so neighbouring steps butt up exactly */
+    step_hz = params->step_hz;
+    if (step_hz == 0) {
+        step_hz = (double)samplerate * SWEEP_DEFAULT_STEP_NUM / SWEEP_DEFAULT_STEP_DEN;
+    }
+    sweep->bins_per_step = (uint32_t)(step_hz / sweep->bin_width_hz + 0.5);
+    if (sweep->bins_per_step < 1) {
+        sweep->bins_per_step = 1;
+    } else if (sweep->bins_per_step > sweep->fft_size) {
+        sweep->bins_per_step = sweep->fft_size;
+    }
+    sweep->step_hz = sweep->bins_per_step * sweep->bin_width_hz;
+    sweep->step_count = (uint32_t)ceil((params->freq_stop_hz - params->freq_start_hz) / sweep->step_hz);
+
+    sweep->state = SWEEP_STATE_RETUNE;
+    sweep->step = sweep->step_count - 1;
+    sweep->sweep_index = (uint64_t)-1;
+
+    if (0 != fft_float_init(&sweep->fft, sweep->fft_size)) {
+        free(sweep);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    sweep->window = (float *) malloc(sweep->fft_size * sizeof(float));
+    sweep->frame = (float *) malloc(2 * sweep->fft_size * sizeof(float));
+    sweep->accum = (float *) malloc(sweep->fft_size * sizeof(float));
+    sweep->spectrum = (float *) malloc(sweep->step_count * sweep->bins_per_step * sizeof(float));
+    for (i = 0; i < SWEEP_JOB_COUNT; i++)
+    {
+        sweep->jobs[i].samples = (int16_t *) malloc(2 * sweep->dwell_samples * sizeof(int16_t));
+        sweep->free_jobs[sweep->free_count++] = &sweep->jobs[i];
+        if (NULL == sweep->jobs[i].samples) {
+            sweep_release(sweep);
+            return AIRSPY_ERROR_NO_MEM;
+        }
+    }
+
+    if (NULL == sweep->window || NULL == sweep->frame || NULL == sweep->accum || NULL == sweep->spectrum) {
+        sweep_release(sweep);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    /* Hann window, scaled so that a full scale complex tone reads 0 dBFS */
+    window_sum = 0;
+    for (i = 0; i < sweep->fft_size; i++)
+    {
+        sweep->window[i] = (float)(0.5 - 0.5 * cos(2.0 * M_PI * i / sweep->fft_size));
+        window_sum += sweep->window[i];
+    }
+    sweep->power_scale = (float)(1.0 / ((SWEEP_FULL_SCALE * window_sum) * (SWEEP_FULL_SCALE * window_sum) * sweep->averages));
+
+    pthread_mutex_init(&sweep->lock, NULL);
+    pthread_cond_init(&sweep->cond, NULL);
+
+    if (0 != pthread_create(&sweep->thread, NULL, sweep_worker, sweep)) {
+        pthread_cond_destroy(&sweep->cond);
+        pthread_mutex_destroy(&sweep->lock);
+        sweep_release(sweep);
+        return AIRSPY_ERROR_THREAD;
+    }
+
+    *sweep_out = sweep;
+
+    return AIRSPY_SUCCESS;
+}
+
+void sweep_free(sweep_t *sweep)
+{
+    pthread_mutex_lock(&sweep->lock);
+    sweep->exit = 1;
+    pthread_cond_broadcast(&sweep->cond);
+    pthread_mutex_unlock(&sweep->lock);
+
+    pthread_join(sweep->thread, NULL);
+
+    pthread_cond_destroy(&sweep->cond);
+    pthread_mutex_destroy(&sweep->lock);
+
+    sweep_release(sweep);
+}
+
+static void sweep_begin_dwell(sweep_t *sweep)
+{
+    sweep->state = SWEEP_STATE_DWELL;
+    sweep->dwell_fill = 0;
+
+    pthread_mutex_lock(&sweep->lock);
+    if (sweep->free_count > 0) {
+        sweep->job = sweep->free_jobs[--sweep->free_count];
+        sweep->job->sweep_index = sweep->sweep_index;
+        sweep->job->step = sweep->step;
+    } else {
+        /* The worker is behind; keep the tuner moving rather than stall the sweep */
+        sweep->job = NULL;
+        sweep->dropped_steps++;
+    }
+    pthread_mutex_unlock(&sweep->lock);
+}
+
+static void sweep_end_dwell(sweep_t *sweep)
+{
+    sweep->state = SWEEP_STATE_RETUNE;
+
+    if (NULL == sweep->job) {
+        return;
+    }
+
+    pthread_mutex_lock(&sweep->lock);
+    sweep->ready_jobs[(sweep->ready_head + sweep->ready_count) % SWEEP_JOB_COUNT] = sweep->job;
+    sweep->ready_count++;
+    pthread_cond_signal(&sweep->cond);
+    pthread_mutex_unlock(&sweep->lock);
+
+    sweep->job = NULL;
+}
+
+int sweep_process(sweep_t *sweep, const int16_t *samples, int sample_count)
+{
+    uint32_t count;
+
+    while (sample_count > 0 && sweep->state != SWEEP_STATE_RETUNE)
+    {
+        if (sweep->state == SWEEP_STATE_SETTLE)
+        {
+            count = sweep->settle_remaining < (uint32_t)sample_count ? sweep->settle_remaining : (uint32_t)sample_count;
+            sweep->settle_remaining -= count;
+
+            if (0 == sweep->settle_remaining) {
+                sweep_begin_dwell(sweep);
+            }
+        }
+        else
+        {
+            count = sweep->dwell_samples - sweep->dwell_fill;
+            if (count > (uint32_t)sample_count) {
+                count = sample_count;
+            }
+
+            if (NULL != sweep->job) {
+                memcpy(sweep->job->samples + 2 * sweep->dwell_fill, samples, 2 * count * sizeof(int16_t));
+            }
+            sweep->dwell_fill += count;
+
+            if (sweep->dwell_fill == sweep->dwell_samples) {
+                sweep_end_dwell(sweep);
+            }
+        }
+
+        samples += 2 * count;
+        sample_count -= count;
+    }
+
+    return sweep->state == SWEEP_STATE_RETUNE;
+}
+
+uint32_t sweep_next_freq(sweep_t *sweep)
+{
+    if (++sweep->step >= sweep->step_count) {
+        sweep->step = 0;
+        sweep->sweep_index++;
+    }
+
+    return sweep->freq_start_hz + (uint32_t)((sweep->step + 0.5) * sweep->step_hz + 0.5);
+}
+
+void sweep_retuned(sweep_t *sweep)
+{
+    sweep->state = SWEEP_STATE_SETTLE;
+    sweep->settle_remaining = sweep->settle_samples;
+
+    if (0 == sweep->settle_remaining) {
+        sweep_begin_dwell(sweep);
+    }
+}
+
+int sweep_stop_requested(sweep_t *sweep)
+{
+    return sweep->stop_requested;
+}
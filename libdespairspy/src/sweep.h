@@ -0,0 +1,52 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdint.h>
+
+#include "airspy.h"
+
+#define SWEEP_JOB_COUNT 4
+#define SWEEP_DEFAULT_STEP_NUM 3
+#define SWEEP_DEFAULT_STEP_DEN 4
+
+typedef struct sweep sweep_t;
+
+/*
+ * The streaming side (sweep_process(), sweep_next_freq(), sweep_retuned()) runs on the airspy_do_rx()
+ * thread. Completed dwells are handed to a worker thread that owns the FFT and the stitched spectrum.
+ */
+int sweep_init(sweep_t **sweep, const airspy_sweep_params_t *params, uint32_t samplerate, uint32_t settle_samples,
+        struct airspy_device *device, airspy_sweep_cb_fn callback, void *ctx);
+void sweep_free(sweep_t *sweep);
+
+/* Returns non-zero once the current dwell is complete and the tuner should move to the next step */
+int sweep_process(sweep_t *sweep, const int16_t *samples, int sample_count);
+uint32_t sweep_next_freq(sweep_t *sweep);
+void sweep_retuned(sweep_t *sweep);
+
+/* Non-zero once the sweep callback has asked to stop */
+int sweep_stop_requested(sweep_t *sweep);
+
+#endif // SWEEP_H
@@ -0,0 +1,47 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stdint.h>
+#include <libusb.h>
+
+/*
+ * The USB operations the streaming code depends on, so that something other
+ * than libusb can stand behind a device. Transfers are plain libusb_transfer
+ * records either way: submit() queues one, and handle_events() completes
+ * queued ones by setting status and actual_length and calling their
+ * callback, like libusb_handle_events_timeout_completed() would. Return
+ * values follow libusb.
+ */
+typedef struct transport_ops
+{
+    int (*control)(void *handle, uint8_t request_type, uint8_t request, uint16_t value, uint16_t index,
+        unsigned char *data, uint16_t length, unsigned int timeout);
+    int (*submit)(void *handle, struct libusb_transfer *transfer);
+    int (*cancel)(void *handle, struct libusb_transfer *transfer);
+    int (*clear_halt)(void *handle, unsigned char endpoint);
+    int (*handle_events)(void *handle, struct timeval *timeout);
+} transport_ops_t;
+
+#endif // TRANSPORT_H
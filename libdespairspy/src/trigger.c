@@ -0,0 +1,535 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "trigger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+#define TRIGGER_NONE UINT64_MAX
+
+typedef struct {
+    volatile uint64_t seq; /* 2n + 1 while block n is written, 2n + 2 once it is complete */
+    uint64_t sample_index;
+    uint32_t sample_count;
+    uint32_t freq_hz;
+    uint32_t gain;
+    uint32_t reserved;
+} trigger_slot_t;
+
+struct trigger
+{
+    char *path;
+    uint32_t pre_samples;
+    uint32_t post_samples;
+    recorder_meta_t meta;
+    char *hw;
+
+    uint32_t slot_count;
+    uint32_t slot_samples;
+    trigger_slot_t *slots;
+    int16_t *samples;
+    volatile uint64_t write_seq; /* Blocks published */
+
+    /* Stream side */
+    volatile uint32_t freq_hz;
+    volatile uint32_t gain;
+    int power;
+    uint32_t window;
+    uint64_t threshold; /* Sum of |x|^2 over a window, in int16 units */
+    uint64_t window_sum;
+    uint32_t window_fill;
+    uint64_t window_index;
+    uint64_t next_index;
+    int armed;
+    volatile uint64_t triggers_ignored;
+    volatile uint64_t blocks_skipped;
+
+    /* Stream index of the trigger + 1 while a snapshot is pending or being written */
+    volatile uint64_t pending;
+
+    /* Snapshot side */
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int exit;
+    int error;
+    int16_t *copy;
+    airspy_trigger_stats_t stats;
+};
+
+#ifndef _WIN32
+
+static void trigger_deadline(struct timespec *ts, uint32_t ms)
+{
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_nsec += (long) ms * 1000000;
+    ts->tv_sec += ts->tv_nsec / 1000000000;
+    ts->tv_nsec %= 1000000000;
+}
+
+/* Waits for the stream to publish more, or for close; the stream side signals without the lock, hence the timeout */
+static int trigger_wait(trigger_t *trigger)
+{
+    struct timespec deadline;
+    int exit;
+
+    trigger_deadline(&deadline, TRIGGER_WAIT_MS);
+    pthread_mutex_lock(&trigger->lock);
+    if (!trigger->exit) {
+        pthread_cond_timedwait(&trigger->cond, &trigger->lock, &deadline);
+    }
+    exit = trigger->exit;
+    pthread_mutex_unlock(&trigger->lock);
+
+    return exit;
+}
+
+static recorder_t *trigger_start_snapshot(trigger_t *trigger, uint64_t at, uint64_t number)
+{
+    airspy_record_params_t params;
+    recorder_meta_t meta;
+    recorder_t *rec;
+    char description[96];
+    size_t length;
+    char *path;
+
+    length = strlen(trigger->path) + 32;
+    path = (char *) malloc(length);
+    if (NULL == path) {
+        return NULL;
+    }
+    snprintf(path, length, "%s-%llu.sigmf-data", trigger->path, (unsigned long long) number);
+    snprintf(description, sizeof(description), "Triggered at stream sample %llu, %u samples before",
+        (unsigned long long) at, trigger->pre_samples);
+
+    memset(&params, 0, sizeof(params));
+    params.path = path;
+    params.format = AIRSPY_RECORD_IQ_INT16;
+    params.description = description;
+
+    meta = trigger->meta;
+    meta.freq_hz = trigger->freq_hz;
+    meta.gain = trigger->gain;
+
+    if (recorder_open(&rec, &params, &meta) != AIRSPY_SUCCESS) {
+        rec = NULL;
+    }
+    free(path);
+
+    return rec;
+}
+
+/* Writes stream samples at - pre_samples to at + post_samples as far as the ring still has them */
+static void trigger_snapshot(trigger_t *trigger, uint64_t at)
+{
+    trigger_slot_t *slot;
+    recorder_t *rec;
+    uint64_t start;
+    uint64_t end;
+    uint64_t written;
+    uint64_t number;
+    uint64_t n;
+    uint64_t seq;
+    uint64_t index;
+    uint64_t first;
+    uint64_t last;
+    uint32_t count;
+    uint32_t freq_hz;
+    uint32_t gain;
+    int exit = 0;
+    int error;
+
+    start = at > trigger->pre_samples ? at - trigger->pre_samples : 0;
+    end = at + trigger->post_samples;
+
+    pthread_mutex_lock(&trigger->lock);
+    number = trigger->stats.triggers++;
+    trigger->stats.last_trigger_index = at;
+    pthread_mutex_unlock(&trigger->lock);
+
+    rec = trigger_start_snapshot(trigger, at, number);
+    if (NULL == rec) {
+        pthread_mutex_lock(&trigger->lock);
+        trigger->stats.write_errors++;
+        trigger->error = 1;
+        pthread_mutex_unlock(&trigger->lock);
+        return;
+    }
+
+    written = 0;
+    /* The block being written is the oldest one's slot */
+    n = __atomic_load_n(&trigger->write_seq, __ATOMIC_ACQUIRE);
+    n = n >= trigger->slot_count ? n - trigger->slot_count + 1 : 0;
+
+    for (;;) {
+        if (__atomic_load_n(&trigger->write_seq, __ATOMIC_ACQUIRE) <= n) {
+            if (exit) {
+                break;
+            }
+            exit = trigger_wait(trigger);
+            continue;
+        }
+
+        slot = &trigger->slots[n % trigger->slot_count];
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (seq != 2 * n + 2) {
+            /* Overwritten before we got to it */
+            n++;
+            continue;
+        }
+
+        index = slot->sample_index;
+        count = slot->sample_count;
+        freq_hz = slot->freq_hz;
+        gain = slot->gain;
+        if (index >= end) {
+            break;
+        }
+        first = index > start ? index : start;
+        last = index + count < end ? index + count : end;
+        if (first < last) {
+            memcpy(trigger->copy, trigger->samples + ((n % trigger->slot_count) * trigger->slot_samples + (first - index)) * 2,
+                (size_t) (last - first) * 2 * sizeof(int16_t));
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq && first < last) {
+            recorder_set_freq(rec, freq_hz);
+            recorder_set_gain(rec, gain);
+            if (recorder_write(rec, trigger->copy, (uint32_t) (last - first) * 2 * sizeof(int16_t),
+                    (uint32_t) (last - first), first) == AIRSPY_SUCCESS) {
+                written += last - first;
+            }
+        }
+        n++;
+
+        if (index + count >= end) {
+            break;
+        }
+    }
+
+    error = recorder_close(rec);
+
+    pthread_mutex_lock(&trigger->lock);
+    if (error != AIRSPY_SUCCESS) {
+        trigger->stats.write_errors++;
+        trigger->error = 1;
+    } else {
+        trigger->stats.snapshots_written++;
+    }
+    trigger->stats.samples_missing += end - start - written;
+    pthread_mutex_unlock(&trigger->lock);
+}
+
+static void *trigger_thread(void *arg)
+{
+    trigger_t *trigger = (trigger_t *) arg;
+    uint64_t pending;
+
+    for (;;) {
+        pending = __atomic_load_n(&trigger->pending, __ATOMIC_ACQUIRE);
+        if (pending != 0) {
+            trigger_snapshot(trigger, pending - 1);
+            __atomic_store_n(&trigger->pending, 0, __ATOMIC_RELEASE);
+            continue;
+        }
+        if (trigger_wait(trigger)) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static void trigger_release(trigger_t *trigger)
+{
+    free(trigger->slots);
+    free(trigger->samples);
+    free(trigger->copy);
+    free(trigger->path);
+    free(trigger->hw);
+    free(trigger);
+}
+
+int trigger_open(trigger_t **out, const airspy_trigger_params_t *params, const recorder_meta_t *meta,
+    uint32_t block_samples)
+{
+    trigger_t *trigger;
+    uint64_t ring_samples;
+    double threshold;
+
+    if (NULL == params->path || 0 == block_samples) {
+        return AIRSPY_ERROR_INVALID_PARAM;
+    }
+
+    trigger = (trigger_t *) calloc(1, sizeof(trigger_t));
+    if (NULL == trigger) {
+        return AIRSPY_ERROR_NO_MEM;
+    }
+
+    trigger->pre_samples = (uint32_t) (params->pre_ms * meta->sample_rate / 1000.0);
+    trigger->post_samples = (uint32_t) (params->post_ms * meta->sample_rate / 1000.0);
+    trigger->meta = *meta;
+    trigger->meta.wait = 1;
+    trigger->freq_hz = meta->freq_hz;
+    trigger->gain = meta->gain;
+
+    ring_samples = (uint64_t) ((params->pre_ms + TRIGGER_MARGIN_MS) * meta->sample_rate / 1000.0);
+    trigger->slot_samples = block_samples;
+    /* One more for the block being overwritten */
+    trigger->slot_count = (uint32_t) ((ring_samples + block_samples - 1) / block_samples) + 1;
+
+    trigger->power = (params->flags & AIRSPY_TRIGGER_POWER) != 0;
+    trigger->window = params->window != 0 ? params->window : TRIGGER_DEFAULT_WINDOW;
+    threshold = pow(10.0, params->threshold_db / 10.0) * 32768.0 * 32768.0 * trigger->window;
+    trigger->threshold = threshold >= 18446744073709551615.0 ? UINT64_MAX : (uint64_t) threshold;
+    trigger->armed = 1;
+
+    trigger->path = (char *) malloc(strlen(params->path) + 1);
+    trigger->slots = (trigger_slot_t *) calloc(trigger->slot_count, sizeof(trigger_slot_t));
+    trigger->samples = (int16_t *) malloc((size_t) trigger->slot_count * trigger->slot_samples * 2 * sizeof(int16_t));
+    trigger->copy = (int16_t *) malloc((size_t) trigger->slot_samples * 2 * sizeof(int16_t));
+    if (meta->hw != NULL) {
+        trigger->hw = (char *) malloc(strlen(meta->hw) + 1);
+    }
+    if (NULL == trigger->path || NULL == trigger->slots || NULL == trigger->samples || NULL == trigger->copy ||
+            (meta->hw != NULL && NULL == trigger->hw)) {
+        trigger_release(trigger);
+        return AIRSPY_ERROR_NO_MEM;
+    }
+    strcpy(trigger->path, params->path);
+    if (meta->hw != NULL) {
+        strcpy(trigger->hw, meta->hw);
+    }
+    trigger->meta.hw = trigger->hw;
+
+    pthread_mutex_init(&trigger->lock, NULL);
+    pthread_cond_init(&trigger->cond, NULL);
+
+    if (pthread_create(&trigger->thread, NULL, trigger_thread, trigger) != 0) {
+        pthread_cond_destroy(&trigger->cond);
+        pthread_mutex_destroy(&trigger->lock);
+        trigger_release(trigger);
+        return AIRSPY_ERROR_THREAD;
+    }
+
+    *out = trigger;
+    return AIRSPY_SUCCESS;
+}
+
+/* Index of the first window whose power crossed the threshold since it was last below, or TRIGGER_NONE */
+static uint64_t trigger_power(trigger_t *trigger, const int16_t *iq, uint32_t count, uint64_t sample_index)
+{
+    uint64_t fired = TRIGGER_NONE;
+    uint64_t sum;
+    uint32_t used = 0;
+    uint32_t take;
+    uint32_t i;
+
+    /* A window doesn't span lost samples */
+    if (sample_index != trigger->next_index) {
+        trigger->window_fill = 0;
+        trigger->window_sum = 0;
+    }
+    trigger->next_index = sample_index + count;
+
+    while (used < count) {
+        if (0 == trigger->window_fill) {
+            trigger->window_index = sample_index + used;
+        }
+        take = trigger->window - trigger->window_fill;
+        if (take > count - used) {
+            take = count - used;
+        }
+
+        sum = 0;
+        for (i = 0; i < take; i++) {
+            int32_t re = iq[2 * (used + i)];
+            int32_t im = iq[2 * (used + i) + 1];
+
+            sum += (uint32_t) (re * re) + (uint32_t) (im * im);
+        }
+        trigger->window_sum += sum;
+        trigger->window_fill += take;
+        used += take;
+
+        if (trigger->window_fill < trigger->window) {
+            break;
+        }
+
+        if (trigger->window_sum > trigger->threshold) {
+            if (trigger->armed && TRIGGER_NONE == fired) {
+                fired = trigger->window_index;
+            }
+            trigger->armed = 0;
+        } else {
+            trigger->armed = 1;
+        }
+        trigger->window_fill = 0;
+        trigger->window_sum = 0;
+    }
+
+    return fired;
+}
+
+void trigger_write(trigger_t *trigger, const airspy_transfer_t *transfer, int request)
+{
+    trigger_slot_t *slot;
+    uint64_t n;
+    uint64_t crossed;
+    uint64_t at = TRIGGER_NONE;
+
+    if ((uint32_t) transfer->sample_count > trigger->slot_samples) {
+        /* Can't happen unless the packing changed since the ring was sized */
+        trigger->blocks_skipped++;
+    } else {
+        n = trigger->write_seq;
+        slot = &trigger->slots[n % trigger->slot_count];
+
+        __atomic_store_n(&slot->seq, 2 * n + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+
+        slot->sample_index = transfer->sample_index;
+        slot->sample_count = (uint32_t) transfer->sample_count;
+        slot->freq_hz = trigger->freq_hz;
+        slot->gain = trigger->gain;
+        memcpy(trigger->samples + (n % trigger->slot_count) * trigger->slot_samples * 2, transfer->samples,
+            (size_t) transfer->sample_count * 2 * sizeof(int16_t));
+
+        __atomic_store_n(&slot->seq, 2 * n + 2, __ATOMIC_RELEASE);
+        __atomic_store_n(&trigger->write_seq, n + 1, __ATOMIC_RELEASE);
+    }
+
+    if (request) {
+        at = transfer->sample_index;
+    }
+    if (trigger->power) {
+        crossed = trigger_power(trigger, (const int16_t *) transfer->samples, (uint32_t) transfer->sample_count,
+            transfer->sample_index);
+        if (TRIGGER_NONE == at) {
+            at = crossed;
+        }
+    }
+
+    if (at != TRIGGER_NONE) {
+        if (__atomic_load_n(&trigger->pending, __ATOMIC_ACQUIRE) != 0) {
+            trigger->triggers_ignored++;
+        } else {
+            __atomic_store_n(&trigger->pending, at + 1, __ATOMIC_RELEASE);
+        }
+    }
+
+    /* Wakes the snapshot thread for a new trigger or the post-trigger blocks; a miss costs it TRIGGER_WAIT_MS */
+    if (__atomic_load_n(&trigger->pending, __ATOMIC_RELAXED) != 0) {
+        pthread_cond_signal(&trigger->cond);
+    }
+}
+
+void trigger_set_freq(trigger_t *trigger, uint32_t freq_hz)
+{
+    trigger->freq_hz = freq_hz;
+}
+
+void trigger_set_gain(trigger_t *trigger, uint32_t gain)
+{
+    trigger->gain = gain;
+}
+
+void trigger_get_stats(trigger_t *trigger, airspy_trigger_stats_t *stats)
+{
+    pthread_mutex_lock(&trigger->lock);
+    memcpy(stats, &trigger->stats, sizeof(*stats));
+    pthread_mutex_unlock(&trigger->lock);
+    stats->triggers_ignored = trigger->triggers_ignored;
+    stats->blocks_skipped = trigger->blocks_skipped;
+}
+
+int trigger_close(trigger_t *trigger)
+{
+    int error;
+
+    pthread_mutex_lock(&trigger->lock);
+    trigger->exit = 1;
+    pthread_cond_signal(&trigger->cond);
+    pthread_mutex_unlock(&trigger->lock);
+    pthread_join(trigger->thread, NULL);
+
+    error = trigger->error;
+
+    pthread_cond_destroy(&trigger->cond);
+    pthread_mutex_destroy(&trigger->lock);
+    trigger_release(trigger);
+
+    return error != 0 ? AIRSPY_ERROR_OTHER : AIRSPY_SUCCESS;
+}
+
+#else
+
+int trigger_open(trigger_t **trigger, const airspy_trigger_params_t *params, const recorder_meta_t *meta,
+    uint32_t block_samples)
+{
+    (void) trigger;
+    (void) params;
+    (void) meta;
+    (void) block_samples;
+    return AIRSPY_ERROR_OTHER;
+}
+
+void trigger_write(trigger_t *trigger, const airspy_transfer_t *transfer, int request)
+{
+    (void) trigger;
+    (void) transfer;
+    (void) request;
+}
+
+void trigger_set_freq(trigger_t *trigger, uint32_t freq_hz)
+{
+    (void) trigger;
+    (void) freq_hz;
+}
+
+void trigger_set_gain(trigger_t *trigger, uint32_t gain)
+{
+    (void) trigger;
+    (void) gain;
+}
+
+void trigger_get_stats(trigger_t *trigger, airspy_trigger_stats_t *stats)
+{
+    (void) trigger;
+    memset(stats, 0, sizeof(*stats));
+}
+
+int trigger_close(trigger_t *trigger)
+{
+    (void) trigger;
+    return AIRSPY_ERROR_OTHER;
+}
+
+#endif
@@ -0,0 +1,57 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <stdint.h>
+
+#include "airspy.h"
+#include "recorder.h"
+
+#define TRIGGER_DEFAULT_WINDOW 1024
+#define TRIGGER_MARGIN_MS 250 /* Ring kept beyond pre_ms, for the snapshot thread to catch up in */
+#define TRIGGER_WAIT_MS 20
+
+typedef struct trigger trigger_t;
+
+/*
+ * Keeps the last pre_ms of converted IQ in a ring of whole blocks.
+ * trigger_write() runs on the airspy_do_rx() thread and never waits: it
+ * overwrites the oldest block under a sequence number, the way the broker
+ * does, and hands a trigger to the snapshot thread through an atomic.
+ * The snapshot thread copies blocks out of the ring, dropping any that
+ * changed under it, and writes them through a recorder of their own.
+ * meta is the template for every snapshot's metadata.
+ */
+int trigger_open(trigger_t **trigger, const airspy_trigger_params_t *params, const recorder_meta_t *meta,
+    uint32_t block_samples);
+/* request is nonzero when airspy_trigger() was called since the last block */
+void trigger_write(trigger_t *trigger, const airspy_transfer_t *transfer, int request);
+void trigger_set_freq(trigger_t *trigger, uint32_t freq_hz);
+void trigger_set_gain(trigger_t *trigger, uint32_t gain);
+void trigger_get_stats(trigger_t *trigger, airspy_trigger_stats_t *stats);
+/* Finishes a snapshot in progress with what the ring holds. Returns an error if any snapshot failed to write. */
+int trigger_close(trigger_t *trigger);
+
+#endif // TRIGGER_H
@@ -0,0 +1,222 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*
+ * Round trips raw captures through airspy_compress_capture() and
+ * airspy_expand_capture() and checks that every byte comes back, for sizes
+ * that end inside a frame, a block and an index stride, packed or not, and
+ * that inputs with a partial sample or group are refused.
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#define BLOCK_SAMPLES 65536
+#define INDEX_STRIDE 64
+#define GROUP_BYTES 12
+#define GROUP_SAMPLES 8
+
+static const char *raw_path = "test_codec.raw";
+static const char *compressed_path = "test_codec.cmp";
+static const char *expanded_path = "test_codec.out";
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng_next(void)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+/* A tone over noise, so frames pick different predictors and widths */
+static void fill_samples(uint8_t *data, size_t size, int packed)
+{
+    size_t i;
+
+    if (packed) {
+        for (i = 0; i < size; i++) {
+            data[i] = (uint8_t) rng_next();
+        }
+        return;
+    }
+
+    for (i = 0; i + 1 < size; i += 2) {
+        double tone = 1500.0 * sin(0.0123 * (double) (i / 2));
+        uint16_t value = (uint16_t) ((int) (2048.0 + tone) + (int) (rng_next() % 64) - 32) & 0x0fff;
+        data[i] = (uint8_t) value;
+        data[i + 1] = (uint8_t) (value >> 8);
+    }
+    if (size & 1) {
+        data[size - 1] = (uint8_t) rng_next();
+    }
+}
+
+static int write_file(const char *path, const uint8_t *data, size_t size)
+{
+    FILE *f = fopen(path, "wb");
+    size_t written;
+
+    if (NULL == f) {
+        return -1;
+    }
+    written = fwrite(data, 1, size, f);
+    fclose(f);
+    return written == size ? 0 : -1;
+}
+
+static uint8_t *read_file(const char *path, size_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *data;
+    long length;
+
+    if (NULL == f) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data = (uint8_t *) malloc(length > 0 ? (size_t) length : 1);
+    if (NULL != data && fread(data, 1, (size_t) length, f) != (size_t) length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *size = (size_t) length;
+    return data;
+}
+
+static int round_trip(size_t size, int packed)
+{
+    uint8_t *data;
+    uint8_t *restored;
+    size_t restored_size;
+    int result;
+    int failed = 0;
+
+    data = (uint8_t *) malloc(size);
+    if (NULL == data) {
+        return 1;
+    }
+    fill_samples(data, size, packed);
+    if (write_file(raw_path, data, size) != 0) {
+        free(data);
+        return 1;
+    }
+
+    result = airspy_compress_capture(raw_path, compressed_path, (uint8_t) packed);
+    if (result != AIRSPY_SUCCESS) {
+        printf("FAIL %s %lu bytes: compress returned %s\n", packed ? "packed" : "unpacked", (unsigned long) size,
+            airspy_error_name((enum airspy_error) result));
+        failed = 1;
+    } else if ((result = airspy_expand_capture(compressed_path, expanded_path)) != AIRSPY_SUCCESS) {
+        printf("FAIL %s %lu bytes: expand returned %s\n", packed ? "packed" : "unpacked", (unsigned long) size,
+            airspy_error_name((enum airspy_error) result));
+        failed = 1;
+    } else {
+        restored = read_file(expanded_path, &restored_size);
+        if (NULL == restored || restored_size != size || memcmp(restored, data, size) != 0) {
+            printf("FAIL %s %lu bytes: restored %lu bytes that differ\n", packed ? "packed" : "unpacked",
+                (unsigned long) size, (unsigned long) restored_size);
+            failed = 1;
+        }
+        free(restored);
+    }
+
+    if (!failed) {
+        printf("ok   %s %lu bytes\n", packed ? "packed" : "unpacked", (unsigned long) size);
+    }
+    free(data);
+    remove(raw_path);
+    remove(compressed_path);
+    remove(expanded_path);
+    return failed;
+}
+
+static int refused(size_t size, int packed)
+{
+    uint8_t *data;
+    int result;
+
+    data = (uint8_t *) malloc(size);
+    if (NULL == data) {
+        return 1;
+    }
+    fill_samples(data, size, packed);
+    result = write_file(raw_path, data, size) == 0 ?
+        airspy_compress_capture(raw_path, compressed_path, (uint8_t) packed) : AIRSPY_ERROR_OTHER;
+    free(data);
+    remove(raw_path);
+    remove(compressed_path);
+
+    if (result != AIRSPY_ERROR_INVALID_PARAM) {
+        printf("FAIL %s %lu bytes: compress returned %s instead of refusing\n", packed ? "packed" : "unpacked",
+            (unsigned long) size, airspy_error_name((enum airspy_error) result));
+        return 1;
+    }
+    printf("ok   %s %lu bytes refused\n", packed ? "packed" : "unpacked", (unsigned long) size);
+    return 0;
+}
+
+int main(void)
+{
+    static const size_t samples[] = {
+        1,
+        7,
+        256,
+        257,
+        BLOCK_SAMPLES - 1,
+        BLOCK_SAMPLES,
+        BLOCK_SAMPLES + 1,
+        3 * BLOCK_SAMPLES + 1000,
+        INDEX_STRIDE * BLOCK_SAMPLES,
+        (INDEX_STRIDE + 1) * BLOCK_SAMPLES + 777,
+    };
+    static const size_t groups[] = {
+        1,
+        33,
+        BLOCK_SAMPLES / GROUP_SAMPLES,
+        BLOCK_SAMPLES / GROUP_SAMPLES + 1,
+        (INDEX_STRIDE + 1) * BLOCK_SAMPLES / GROUP_SAMPLES + 97,
+    };
+    size_t i;
+    int failures = 0;
+
+    for (i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        failures += round_trip(samples[i] * 2, 0);
+    }
+    for (i = 0; i < sizeof(groups) / sizeof(groups[0]); i++) {
+        failures += round_trip(groups[i] * GROUP_BYTES, 1);
+    }
+
+    failures += refused(1, 0);
+    failures += refused(2 * BLOCK_SAMPLES + 1, 0);
+    failures += refused(GROUP_BYTES + 5, 1);
+    failures += refused(GROUP_BYTES * 1000 + 2, 1);
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,192 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*
+ * Converts a capture with airspy_convert_file() serially and split into
+ * chunks on several threads, and checks that the two outputs are the same
+ * at the default priming, for chunk sizes that do and don't divide the
+ * capture, packed or not.
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#define CAPTURE_SAMPLES (1000000 + 40)
+#define GROUP_BYTES 12
+#define GROUP_SAMPLES 8
+
+static const char *raw_path = "test_convert.raw";
+static const char *serial_path = "test_convert_serial.out";
+static const char *threaded_path = "test_convert_threaded.out";
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng_next(void)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+/* Two tones and an offset over noise, so the DC blocker and filters have work to do */
+static int write_capture(int packed)
+{
+    size_t size = packed ? CAPTURE_SAMPLES / GROUP_SAMPLES * GROUP_BYTES : CAPTURE_SAMPLES * sizeof(uint16_t);
+    uint8_t *data;
+    size_t written;
+    size_t i;
+    FILE *f;
+
+    data = (uint8_t *) malloc(size);
+    if (NULL == data) {
+        return -1;
+    }
+
+    if (packed) {
+        for (i = 0; i < size; i++) {
+            data[i] = (uint8_t) rng_next();
+        }
+    } else {
+        for (i = 0; i < CAPTURE_SAMPLES; i++) {
+            double signal = 2100.0 + 900.0 * sin(0.731 * (double) i) + 400.0 * sin(0.0417 * (double) i);
+            uint16_t value = (uint16_t) ((int) signal + (int) (rng_next() % 128) - 64) & 0x0fff;
+            data[2 * i] = (uint8_t) value;
+            data[2 * i + 1] = (uint8_t) (value >> 8);
+        }
+    }
+
+    f = fopen(raw_path, "wb");
+    if (NULL == f) {
+        free(data);
+        return -1;
+    }
+    written = fwrite(data, 1, size, f);
+    fclose(f);
+    free(data);
+    return written == size ? 0 : -1;
+}
+
+static int16_t *read_output(const char *path, size_t *count)
+{
+    FILE *f = fopen(path, "rb");
+    int16_t *data;
+    long length;
+
+    if (NULL == f) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data = (int16_t *) malloc(length > 0 ? (size_t) length : 1);
+    if (NULL != data && fread(data, 1, (size_t) length, f) != (size_t) length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *count = (size_t) length / sizeof(int16_t);
+    return data;
+}
+
+static int compare(int packed, uint32_t threads, uint32_t chunk_samples)
+{
+    airspy_convert_params_t params;
+    int16_t *serial;
+    int16_t *threaded;
+    size_t serial_count;
+    size_t threaded_count;
+    size_t differ = 0;
+    size_t i;
+    int result;
+    int failed = 0;
+
+    memset(&params, 0, sizeof(params));
+    params.packed = (uint8_t) packed;
+    params.threads = 1;
+    result = airspy_convert_file(raw_path, serial_path, &params);
+    if (result == AIRSPY_SUCCESS) {
+        params.threads = threads;
+        params.chunk_samples = chunk_samples;
+        result = airspy_convert_file(raw_path, threaded_path, &params);
+    }
+    if (result != AIRSPY_SUCCESS) {
+        printf("FAIL %s, %u threads, chunks of %u: convert returned %s\n", packed ? "packed" : "unpacked", threads,
+            chunk_samples, airspy_error_name((enum airspy_error) result));
+        return 1;
+    }
+
+    serial = read_output(serial_path, &serial_count);
+    threaded = read_output(threaded_path, &threaded_count);
+    if (NULL == serial || NULL == threaded || 0 == serial_count || serial_count != threaded_count) {
+        printf("FAIL %s, %u threads, chunks of %u: %lu values against %lu serially\n", packed ? "packed" : "unpacked",
+            threads, chunk_samples, (unsigned long) threaded_count, (unsigned long) serial_count);
+        failed = 1;
+    } else {
+        for (i = 0; i < serial_count; i++) {
+            differ += serial[i] != threaded[i];
+        }
+        if (differ != 0) {
+            printf("FAIL %s, %u threads, chunks of %u: %lu of %lu values differ from the serial conversion\n",
+                packed ? "packed" : "unpacked", threads, chunk_samples, (unsigned long) differ,
+                (unsigned long) serial_count);
+            failed = 1;
+        }
+    }
+
+    if (!failed) {
+        printf("ok   %s, %u threads, chunks of %u\n", packed ? "packed" : "unpacked", threads, chunk_samples);
+    }
+    free(serial);
+    free(threaded);
+    remove(serial_path);
+    remove(threaded_path);
+    return failed;
+}
+
+int main(void)
+{
+    static const uint32_t chunks[] = {
+        8192,
+        65536,
+        100000,
+    };
+    int failures = 0;
+    int packed;
+    size_t i;
+
+    for (packed = 0; packed <= 1; packed++) {
+        if (write_capture(packed) != 0) {
+            printf("FAIL could not write %s\n", raw_path);
+            return EXIT_FAILURE;
+        }
+        for (i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+            failures += compare(packed, 4, chunks[i]);
+        }
+        remove(raw_path);
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
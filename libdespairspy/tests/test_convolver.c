@@ -0,0 +1,189 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*
+ * Checks both forms of the convolver against a direct FIR in double
+ * precision, for real and complex taps from one to a few thousand, with the
+ * input fed in uneven pieces so the FFT form replans and carries its
+ * overlap across calls, and in place as well as into a separate buffer.
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#define SAMPLES 40000
+#define MAX_TAPS 4097
+/* Float rounding in the direct form's sums grows with the square root of the taps */
+#define MAX_ERROR 2e-6
+#define MAX_ERROR_PER_ROOT_TAP 4e-7
+
+static float input[2 * SAMPLES];
+static float output[2 * SAMPLES];
+static double reference[2 * SAMPLES];
+static float taps[2 * MAX_TAPS];
+
+static uint32_t rng_state = 1;
+
+/* Uniform in [-0.5, 0.5) */
+static float rng_float(void)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (float) (rng_state >> 8) / 16777216.0f - 0.5f;
+}
+
+static void fill(uint32_t tap_count, int complex_taps)
+{
+    uint32_t i;
+
+    for (i = 0; i < 2 * SAMPLES; i++) {
+        input[i] = rng_float();
+    }
+    for (i = 0; i < (complex_taps ? 2 : 1) * tap_count; i++) {
+        taps[i] = rng_float() / sqrtf((float) tap_count);
+    }
+}
+
+/* y[n] = sum of taps[k] x[n - k], with zeros before the first sample */
+static void filter_reference(uint32_t tap_count, int complex_taps)
+{
+    uint32_t n;
+    uint32_t k;
+    double re;
+    double im;
+    double t_re;
+    double t_im;
+
+    for (n = 0; n < SAMPLES; n++) {
+        re = 0.0;
+        im = 0.0;
+        for (k = 0; k < tap_count && k <= n; k++) {
+            t_re = complex_taps ? taps[2 * k] : taps[k];
+            t_im = complex_taps ? taps[2 * k + 1] : 0.0;
+            re += t_re * input[2 * (n - k)] - t_im * input[2 * (n - k) + 1];
+            im += t_re * input[2 * (n - k) + 1] + t_im * input[2 * (n - k)];
+        }
+        reference[2 * n] = re;
+        reference[2 * n + 1] = im;
+    }
+}
+
+/* Largest difference from the reference, relative to the reference's RMS */
+static double relative_error(void)
+{
+    double power = 0.0;
+    double worst = 0.0;
+    double d;
+    uint32_t i;
+
+    for (i = 0; i < 2 * SAMPLES; i++) {
+        power += reference[i] * reference[i];
+        d = fabs(output[i] - reference[i]);
+        if (d > worst) {
+            worst = d;
+        }
+    }
+    return worst / sqrt(power / (2 * SAMPLES) + 1e-30);
+}
+
+static int check(uint32_t tap_count, int complex_taps, uint32_t form, int in_place)
+{
+    struct airspy_convolver *convolver;
+    const char *name = form == AIRSPY_CONVOLVER_DIRECT ? "direct" : form == AIRSPY_CONVOLVER_FFT ? "FFT" : "auto";
+    uint32_t flags = form | (complex_taps ? AIRSPY_CONVOLVER_COMPLEX : 0);
+    uint32_t offset = 0;
+    uint32_t piece;
+    uint32_t i = 0;
+    double error;
+    int result;
+
+    result = airspy_convolver_create(&convolver, taps, tap_count, flags);
+    if (result != AIRSPY_SUCCESS) {
+        printf("FAIL %u %s taps, %s: create returned %s\n", tap_count, complex_taps ? "complex" : "real", name,
+            airspy_error_name((enum airspy_error) result));
+        return 1;
+    }
+
+    if (in_place) {
+        memcpy(output, input, sizeof(output));
+    }
+    /* Small and large pieces, so the FFT form grows its plan midway */
+    while (offset < SAMPLES) {
+        piece = i < 8 ? 1 + (i * 37) % 100 : 1 + (i * 7919) % 6000;
+        if (piece > SAMPLES - offset) {
+            piece = SAMPLES - offset;
+        }
+        airspy_convolver_process(convolver, in_place ? output + 2 * offset : input + 2 * offset, piece,
+            output + 2 * offset);
+        offset += piece;
+        i++;
+    }
+    airspy_convolver_free(convolver);
+
+    error = relative_error();
+    if (error > MAX_ERROR + MAX_ERROR_PER_ROOT_TAP * sqrt((double) tap_count)) {
+        printf("FAIL %u %s taps, %s%s: relative error %.2g\n", tap_count, complex_taps ? "complex" : "real", name,
+            in_place ? " in place" : "", error);
+        return 1;
+    }
+    printf("ok   %u %s taps, %s%s: relative error %.2g\n", tap_count, complex_taps ? "complex" : "real", name,
+        in_place ? " in place" : "", error);
+    return 0;
+}
+
+int main(void)
+{
+    static const uint32_t tap_counts[] = {
+        1,
+        31,
+        128,
+        257,
+        1000,
+        MAX_TAPS,
+    };
+    static const uint32_t forms[] = {
+        AIRSPY_CONVOLVER_DIRECT,
+        AIRSPY_CONVOLVER_FFT,
+        0,
+    };
+    int failures = 0;
+    int complex_taps;
+    size_t i;
+    size_t j;
+
+    for (complex_taps = 0; complex_taps <= 1; complex_taps++) {
+        for (i = 0; i < sizeof(tap_counts) / sizeof(tap_counts[0]); i++) {
+            fill(tap_counts[i], complex_taps);
+            filter_reference(tap_counts[i], complex_taps);
+            for (j = 0; j < sizeof(forms) / sizeof(forms[0]); j++) {
+                failures += check(tap_counts[i], complex_taps, forms[j], 0);
+            }
+            failures += check(tap_counts[i], complex_taps, AIRSPY_CONVOLVER_FFT, 1);
+        }
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,275 @@
+/*
+Copyright (c) 2026, despairspy contributors
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+        Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+        Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+        Neither the name of AirSpy nor the names of its contributors may be used to endorse or promote products derived from this software
+        without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*
+ * Holds the resampler to its contract: tones in the band come out as the
+ * ideal tone at the new rate, delayed by half the filter, with no fit of
+ * gain or phase; a tone that would alias onto the band when decimating is
+ * 90 dB down; and feeding the input in uneven pieces gives the same output
+ * as in one go.
+ */
+
+#include <airspy.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define TONE_SAMPLES (1 << 17)
+#define ZERO_CROSSINGS 16
+#define MAX_ERROR_DB -80.0
+#define EDGE_TONE 0.33 /* Edge of the flat part of the band, where it ripples more */
+#define MAX_EDGE_ERROR_DB -65.0
+#define MAX_ALIAS_DB -88.0
+
+typedef struct {
+    const char *text;
+    uint32_t interpolation;
+    uint32_t decimation;
+    double ratio;
+} ratio_t;
+
+static float *input;
+static float *output;
+static float *pieces;
+
+/* A complex tone of amplitude 0.5, freq in cycles per sample */
+static void fill_tone(uint32_t count, double freq)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        input[2 * i] = (float) (0.5 * cos(2.0 * M_PI * freq * i));
+        input[2 * i + 1] = (float) (0.5 * sin(2.0 * M_PI * freq * i));
+    }
+}
+
+static double ratio_value(const ratio_t *ratio)
+{
+    return ratio->ratio > 0.0 ? ratio->ratio : (double) ratio->interpolation / ratio->decimation;
+}
+
+static struct airspy_resampler *create(const ratio_t *ratio)
+{
+    airspy_resampler_params_t params;
+    struct airspy_resampler *resampler;
+
+    memset(&params, 0, sizeof(params));
+    params.interpolation = ratio->interpolation;
+    params.decimation = ratio->decimation;
+    params.ratio = ratio->ratio;
+    params.zero_crossings = ZERO_CROSSINGS;
+    if (airspy_resampler_create(&resampler, &params) != AIRSPY_SUCCESS) {
+        return NULL;
+    }
+    return resampler;
+}
+
+/* Resamples the tone in one go; the first quarter of the outputs, while the filter fills, is left out of the fits */
+static uint32_t resample_tone(const ratio_t *ratio, double freq)
+{
+    struct airspy_resampler *resampler;
+    uint32_t count = 0;
+
+    fill_tone(TONE_SAMPLES, freq);
+    resampler = create(ratio);
+    if (NULL == resampler) {
+        return 0;
+    }
+    airspy_resampler_process(resampler, input, TONE_SAMPLES, output, &count);
+    airspy_resampler_free(resampler);
+    return count;
+}
+
+/*
+ * Everything that differs from the ideal output, in dB relative to it, for a tone at freq (cycles per input
+ * sample): the input tone sampled at the output times, zero_crossings samples at the lower rate later, that
+ * rounded up to the filter's padding of 4 input samples a side
+ */
+static double tone_error(const ratio_t *ratio, double freq)
+{
+    double r = ratio_value(ratio);
+    double delay = ceil(ZERO_CROSSINGS / (r < 1.0 ? r : 1.0) / 4.0) * 4.0;
+    double phase;
+    double d_re;
+    double d_im;
+    double error = 0.0;
+    uint32_t count;
+    uint32_t skip;
+    uint32_t i;
+
+    count = resample_tone(ratio, freq);
+    skip = count / 4;
+    if (count <= skip) {
+        return HUGE_VAL;
+    }
+
+    for (i = skip; i < count; i++) {
+        phase = 2.0 * M_PI * freq * (i / r - delay);
+        d_re = output[2 * i] - 0.5 * cos(phase);
+        d_im = output[2 * i + 1] - 0.5 * sin(phase);
+        error += d_re * d_re + d_im * d_im;
+    }
+    return 10.0 * log10(error / (count - skip) / 0.25 + 1e-30);
+}
+
+/* Output power in dB relative to the input's for a tone at freq */
+static double tone_level(const ratio_t *ratio, double freq)
+{
+    uint32_t count;
+    uint32_t skip;
+    uint32_t i;
+    double power = 0.0;
+
+    count = resample_tone(ratio, freq);
+    skip = count / 4;
+    if (count <= skip) {
+        return 0.0;
+    }
+    for (i = skip; i < count; i++) {
+        power += (double) output[2 * i] * output[2 * i] + (double) output[2 * i + 1] * output[2 * i + 1];
+    }
+    return 10.0 * log10(power / (count - skip) / 0.25 + 1e-30);
+}
+
+/* Feeds the last tone again in pieces of varying size and compares with the output in one go */
+static int pieces_match(const ratio_t *ratio, uint32_t count)
+{
+    struct airspy_resampler *resampler;
+    uint32_t offset = 0;
+    uint32_t total = 0;
+    uint32_t produced;
+    uint32_t piece;
+    uint32_t i = 0;
+
+    resampler = create(ratio);
+    if (NULL == resampler) {
+        return 0;
+    }
+    while (offset < TONE_SAMPLES) {
+        piece = 1 + (i++ * 7919) % 3001;
+        if (piece > TONE_SAMPLES - offset) {
+            piece = TONE_SAMPLES - offset;
+        }
+        airspy_resampler_process(resampler, input + 2 * offset, piece, pieces + 2 * total, &produced);
+        offset += piece;
+        total += produced;
+    }
+    airspy_resampler_free(resampler);
+
+    return total == count && memcmp(pieces, output, (size_t) count * 2 * sizeof(float)) == 0;
+}
+
+int main(void)
+{
+    static const ratio_t ratios[] = {
+        { "6/25", 6, 25, 0.0 },
+        { "12/25", 12, 25, 0.0 },
+        { "3/125", 3, 125, 0.0 },
+        { "5/4", 5, 4, 0.0 },
+        { "0.24", 0, 0, 0.24 },
+        { "0.2973", 0, 0, 0.2973 },
+        { "1.37", 0, 0, 1.37 },
+    };
+    /* Fractions of the narrower rate */
+    static const double tones[] = {
+        0.05,
+        0.2,
+        0.25,
+    };
+    size_t capacity = (size_t) TONE_SAMPLES * 2 + 2;
+    double narrow;
+    double error;
+    double worst;
+    double edge;
+    double alias;
+    uint32_t count;
+    size_t i;
+    size_t j;
+    int failures = 0;
+    int failed;
+
+    input = (float *) malloc((size_t) TONE_SAMPLES * 2 * sizeof(float));
+    output = (float *) malloc(capacity * 2 * sizeof(float));
+    pieces = (float *) malloc(capacity * 2 * sizeof(float));
+    if (NULL == input || NULL == output || NULL == pieces) {
+        printf("FAIL out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < sizeof(ratios) / sizeof(ratios[0]); i++) {
+        narrow = ratio_value(&ratios[i]) < 1.0 ? ratio_value(&ratios[i]) : 1.0;
+        failed = 0;
+
+        worst = -HUGE_VAL;
+        for (j = 0; j < sizeof(tones) / sizeof(tones[0]); j++) {
+            error = tone_error(&ratios[i], tones[j] * narrow);
+            if (error > MAX_ERROR_DB) {
+                printf("FAIL %s: tone at %.2f of the band %.1f dB off the ideal output\n", ratios[i].text, tones[j],
+                    error);
+                failed = 1;
+            }
+            worst = error > worst ? error : worst;
+        }
+        edge = tone_error(&ratios[i], EDGE_TONE * narrow);
+        if (edge > MAX_EDGE_ERROR_DB) {
+            printf("FAIL %s: tone at the band edge %.1f dB off the ideal output\n", ratios[i].text, edge);
+            failed = 1;
+        }
+
+        /* Two thirds of the output rate folds onto the edge of the flat band */
+        alias = 0.0;
+        if (ratio_value(&ratios[i]) < 1.0) {
+            alias = tone_level(&ratios[i], 2.0 * ratio_value(&ratios[i]) / 3.0);
+            if (alias > MAX_ALIAS_DB) {
+                printf("FAIL %s: alias at %.1f dB\n", ratios[i].text, alias);
+                failed = 1;
+            }
+        }
+
+        count = resample_tone(&ratios[i], 0.2 * narrow);
+        if (!pieces_match(&ratios[i], count)) {
+            printf("FAIL %s: output in pieces differs from the output in one go\n", ratios[i].text);
+            failed = 1;
+        }
+
+        if (!failed && ratio_value(&ratios[i]) < 1.0) {
+            printf("ok   %s: %.1f dB off the ideal output, %.1f dB at the edge, alias %.1f dB\n", ratios[i].text, worst,
+                edge, alias);
+        } else if (!failed) {
+            printf("ok   %s: %.1f dB off the ideal output, %.1f dB at the edge\n", ratios[i].text, worst, edge);
+        }
+        failures += failed;
+    }
+
+    free(pieces);
+    free(output);
+    free(input);
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}